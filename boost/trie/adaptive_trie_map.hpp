@@ -0,0 +1,403 @@
+#ifndef BOOST_TRIE_ADAPTIVE_TRIE_MAP_HPP
+#define BOOST_TRIE_ADAPTIVE_TRIE_MAP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "fixed_alphabet_trie.hpp"
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+
+//
+// adaptive_trie_map is a char-keyed map whose nodes pick their child container
+// by depth and fanout.  Near the root, where the fanout is wide, a node has a
+// table of 256 children indexed by byte.  Below, a node with one child keeps
+// it inline, a node with a few keeps them in a sorted block of small_limit
+// labels and nodes, and a node with more gets a table.  A node moves between
+// them on insert and erase; a table goes back to a block only when half of the
+// block would be free, so a fanout going up and down by one does not convert
+// every time.
+//
+// The policy is adaptive_children<DenseDepth, SmallLimit>: the nodes above
+// depth DenseDepth always have a table, root is depth 0.  Like
+// fixed_alphabet_trie the nodes are in one arena and iterate in the unsigned
+// byte order of std::string; the blocks and tables are pools of their own.
+//
+
+namespace boost { namespace tries {
+
+template <size_t DenseDepth = 1, size_t SmallLimit = 8>
+struct adaptive_children {
+	BOOST_STATIC_ASSERT_MSG(SmallLimit >= 2 && SmallLimit <= 255, "adaptive_children: SmallLimit is 2 to 255");
+	BOOST_STATIC_ASSERT_MSG(DenseDepth <= 255, "adaptive_children: DenseDepth is at most 255");
+	enum { dense_depth = DenseDepth, small_limit = SmallLimit };
+};
+
+enum adaptive_child_kind { no_children, single_child, small_children, dense_children };
+
+namespace detail {
+
+template <typename Index>
+struct adaptive_node {
+	// chains the free nodes too
+	Index parent;
+	// the slot in the value table, or none
+	Index value;
+	// values in the sub-trie
+	Index value_count;
+	// the only child, or the small block or the table
+	Index slot;
+	// the byte of the edge from the parent
+	unsigned char label;
+	unsigned char kind;
+	// up to 255
+	unsigned char depth;
+	// children in a small block
+	unsigned char count;
+};
+
+template <typename Value, typename Index, class Children>
+struct adaptive_arena : public dense_arena<adaptive_arena<Value, Index, Children>, char, Value, Index, adaptive_node<Index> >
+{
+	typedef char key_type;
+	typedef Index index_type;
+	typedef adaptive_node<Index> node_type;
+	enum { small_limit = Children::small_limit, dense_depth = Children::dense_depth };
+	// a table is 256 children by byte and their count
+	enum { table_width = 257 };
+
+	// small_limit labels and nodes for each block, sorted by label
+	std::vector<unsigned char> small_labels;
+	std::vector<index_type> small_nodes;
+	std::vector<index_type> free_small;
+	std::vector<index_type> tables;
+	std::vector<index_type> free_tables;
+
+	explicit adaptive_arena()
+	{
+		this->reset();
+	}
+
+	static int code(key_type k)
+	{
+		return static_cast<unsigned char>(k);
+	}
+
+	static key_type symbol(int code)
+	{
+		return static_cast<key_type>(code);
+	}
+
+	static size_t width()
+	{
+		return 256;
+	}
+
+	index_type new_small()
+	{
+		if (!free_small.empty())
+		{
+			index_type b = free_small.back();
+			free_small.pop_back();
+			return b;
+		}
+		small_labels.resize(small_labels.size() + small_limit);
+		small_nodes.resize(small_nodes.size() + small_limit);
+		return index_type(small_nodes.size() / small_limit - 1);
+	}
+
+	index_type new_table()
+	{
+		index_type b;
+		if (!free_tables.empty())
+		{
+			b = free_tables.back();
+			free_tables.pop_back();
+		}
+		else {
+			b = index_type(tables.size() / table_width);
+			tables.resize(tables.size() + table_width);
+		}
+		std::fill(tables.begin() + b * table_width, tables.begin() + b * table_width + 256, this->none());
+		tables[b * table_width + 256] = 0;
+		return b;
+	}
+
+	// the block or table of a node that has no children left
+	void release(index_type n)
+	{
+		node_type& x = this->nodes[n];
+		if (x.kind == small_children)
+			free_small.push_back(x.slot);
+		else if (x.kind == dense_children)
+			free_tables.push_back(x.slot);
+		x.kind = no_children;
+		x.slot = this->none();
+		x.count = 0;
+	}
+
+	index_type child(index_type n, int code) const
+	{
+		const node_type& x = this->nodes[n];
+		switch (x.kind)
+		{
+		case single_child:
+			return this->nodes[x.slot].label == code ? x.slot : this->none();
+		case small_children:
+		{
+			const unsigned char *l = &small_labels[x.slot * small_limit];
+			for (int i = 0; i < x.count; ++i)
+			{
+				if (l[i] >= code)
+					return l[i] == code ? small_nodes[x.slot * small_limit + i] : this->none();
+			}
+			return this->none();
+		}
+		case dense_children:
+			return tables[x.slot * table_width + code];
+		default:
+			return this->none();
+		}
+	}
+
+	index_type child_from(index_type n, int from) const
+	{
+		const node_type& x = this->nodes[n];
+		switch (x.kind)
+		{
+		case single_child:
+			return this->nodes[x.slot].label >= from ? x.slot : this->none();
+		case small_children:
+			for (int i = 0; i < x.count; ++i)
+				if (small_labels[x.slot * small_limit + i] >= from)
+					return small_nodes[x.slot * small_limit + i];
+			return this->none();
+		case dense_children:
+			for (int c = from; c < 256; ++c)
+				if (tables[x.slot * table_width + c] != this->none())
+					return tables[x.slot * table_width + c];
+			return this->none();
+		default:
+			return this->none();
+		}
+	}
+
+	index_type child_before(index_type n, int to) const
+	{
+		const node_type& x = this->nodes[n];
+		switch (x.kind)
+		{
+		case single_child:
+			return this->nodes[x.slot].label < to ? x.slot : this->none();
+		case small_children:
+			for (int i = x.count; i-- > 0; )
+				if (small_labels[x.slot * small_limit + i] < to)
+					return small_nodes[x.slot * small_limit + i];
+			return this->none();
+		case dense_children:
+			for (int c = to; c-- > 0; )
+				if (tables[x.slot * table_width + c] != this->none())
+					return tables[x.slot * table_width + c];
+			return this->none();
+		default:
+			return this->none();
+		}
+	}
+
+	int code_of(index_type n) const
+	{
+		return this->nodes[n].label;
+	}
+
+	void set_child(index_type n, int code, index_type c)
+	{
+		if (c == this->none())
+			unlink_child(n, code);
+		else
+			link_child(n, code, c);
+	}
+
+	void link_child(index_type n, int code, index_type c)
+	{
+		this->nodes[c].label = static_cast<unsigned char>(code);
+		node_type& x = this->nodes[n];
+		switch (x.kind)
+		{
+		case no_children:
+			x.kind = single_child;
+			x.slot = c;
+			return;
+		case single_child:
+		{
+			index_type o = x.slot;
+			index_type b = new_small();
+			bool first = this->nodes[o].label < code;
+			small_labels[b * small_limit] = static_cast<unsigned char>(first ? this->nodes[o].label : code);
+			small_nodes[b * small_limit] = first ? o : c;
+			small_labels[b * small_limit + 1] = static_cast<unsigned char>(first ? code : this->nodes[o].label);
+			small_nodes[b * small_limit + 1] = first ? c : o;
+			x.kind = small_children;
+			x.slot = b;
+			x.count = 2;
+			return;
+		}
+		case small_children:
+		{
+			size_t base = size_t(x.slot) * small_limit;
+			if (x.count < small_limit)
+			{
+				int i = x.count;
+				for (; i > 0 && small_labels[base + i - 1] > code; --i)
+				{
+					small_labels[base + i] = small_labels[base + i - 1];
+					small_nodes[base + i] = small_nodes[base + i - 1];
+				}
+				small_labels[base + i] = static_cast<unsigned char>(code);
+				small_nodes[base + i] = c;
+				++x.count;
+				return;
+			}
+			// full, it grows into a table
+			index_type b = new_table();
+			for (int i = 0; i < x.count; ++i)
+				tables[b * table_width + small_labels[base + i]] = small_nodes[base + i];
+			tables[b * table_width + code] = c;
+			tables[b * table_width + 256] = index_type(x.count + 1);
+			free_small.push_back(x.slot);
+			x.kind = dense_children;
+			x.slot = b;
+			x.count = 0;
+			return;
+		}
+		case dense_children:
+			tables[x.slot * table_width + code] = c;
+			++tables[x.slot * table_width + 256];
+			return;
+		}
+	}
+
+	// the child with the code is a leaf going to the free list
+	void unlink_child(index_type n, int code)
+	{
+		release(child(n, code));
+		node_type& x = this->nodes[n];
+		switch (x.kind)
+		{
+		case single_child:
+			x.kind = no_children;
+			x.slot = this->none();
+			return;
+		case small_children:
+		{
+			size_t base = size_t(x.slot) * small_limit;
+			int i = 0;
+			while (small_labels[base + i] != code)
+				++i;
+			for (--x.count; i < x.count; ++i)
+			{
+				small_labels[base + i] = small_labels[base + i + 1];
+				small_nodes[base + i] = small_nodes[base + i + 1];
+			}
+			if (x.count == 1)
+			{
+				free_small.push_back(x.slot);
+				x.kind = single_child;
+				x.slot = small_nodes[base];
+				x.count = 0;
+			}
+			return;
+		}
+		case dense_children:
+		{
+			size_t base = size_t(x.slot) * table_width;
+			tables[base + code] = this->none();
+			index_type left = --tables[base + 256];
+			if (x.depth < dense_depth || left > index_type(small_limit / 2))
+				return;
+			// shrink to what the children left fit in
+			index_type b = x.slot;
+			x.kind = no_children;
+			x.slot = this->none();
+			for (int c = 0; c < 256; ++c)
+				if (tables[base + c] != this->none())
+					link_child(n, c, tables[base + c]);
+			free_tables.push_back(b);
+			return;
+		}
+		}
+	}
+
+	void push_children()
+	{
+	}
+
+	// after new_node() set the parent
+	void clear_children(index_type n)
+	{
+		node_type& x = this->nodes[n];
+		index_type p = x.parent;
+		x.depth = (p == this->none()) ? 0 : static_cast<unsigned char>(std::min(int(this->nodes[p].depth) + 1, 255));
+		x.kind = no_children;
+		x.slot = this->none();
+		x.count = 0;
+		if (x.depth < dense_depth)
+		{
+			x.kind = dense_children;
+			x.slot = new_table();
+		}
+	}
+
+	void drop_children()
+	{
+		small_labels.clear();
+		small_nodes.clear();
+		free_small.clear();
+		tables.clear();
+		free_tables.clear();
+	}
+
+	void swap_children(adaptive_arena& other)
+	{
+		small_labels.swap(other.small_labels);
+		small_nodes.swap(other.small_nodes);
+		free_small.swap(other.free_small);
+		tables.swap(other.tables);
+		free_tables.swap(other.free_tables);
+	}
+};
+
+} // namespace detail
+
+
+template <typename Value, class Children = adaptive_children<>, typename Index = boost::uint32_t>
+class adaptive_trie_map : public detail::dense_trie_map<detail::adaptive_arena<Value, Index, Children> > {
+public:
+	typedef detail::dense_trie_map<detail::adaptive_arena<Value, Index, Children> > base_type;
+	typedef adaptive_trie_map<Value, Children, Index> adaptive_trie_map_type;
+	typedef Children children_policy;
+	typedef typename base_type::size_type size_type;
+	typedef typename base_type::arena_type arena_type;
+
+	explicit adaptive_trie_map()
+	{
+	}
+
+	// the nodes, root included, whose children are kept that way
+	size_type count_kind(adaptive_child_kind k) const
+	{
+		size_type ret = 0;
+		for (size_type n = 0; n < this->a.nodes.size(); ++n)
+			if (this->a.nodes[n].kind == k)
+				++ret;
+		// the free nodes have none
+		return k == no_children ? ret - this->a.free_node_count : ret;
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_ADAPTIVE_TRIE_MAP_HPP
@@ -0,0 +1,1226 @@
+#ifndef BOOST_TRIE_BURST_TRIE_HPP
+#define BOOST_TRIE_BURST_TRIE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "trie.hpp"
+#include <map>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <boost/utility.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_same.hpp>
+
+//
+// burst_trie is a burst trie (HAT-trie style): the dense top of the trie is
+// made of ordinary nodes, one per key element, while a sparse sub-trie is a
+// bucket, an array of the key suffixes below a node.  The suffixes of a bucket
+// are packed end to end in one vector, so a lookup scans contiguous memory
+// instead of chasing a node for every element.  A bucket that grows past the
+// burst threshold bursts: its suffixes are moved, one element shorter, into
+// new buckets below new nodes.
+//
+// Inserting appends the suffix to a bucket and puts it into the index that
+// keeps the bucket in key order, so iteration and the ordered queries never
+// change the trie and const members may be called from several threads.
+// Iterators point to (node, entry) and stay valid when other keys are
+// inserted, unless their bucket bursts; erase() invalidates the iterators
+// into the same bucket.
+//
+// With a burst threshold of 1 (tail_threshold) every bucket holds one key, so
+// the nodes stop where a key becomes unique and the rest of it is kept as a
+// packed tail.  A tail is split when another key diverges inside it.  Erasing
+// merges a sub-trie left with few keys back into one bucket, a single tail in
+// this mode.
+//
+
+namespace boost { namespace tries {
+
+namespace detail {
+
+// element-wise equality of two suffixes, memcmp for integral keys in the default order
+template <typename Key, class Compare,
+		bool Raw = (boost::is_integral<Key>::value && boost::is_same<Compare, std::less<Key> >::value)>
+struct suffix_equal {
+	static bool apply(const Key *a, const Key *b, size_t n, const Compare& comp)
+	{
+		for (size_t i = 0; i < n; ++i)
+			if (comp(a[i], b[i]) || comp(b[i], a[i]))
+				return false;
+		return true;
+	}
+};
+
+template <typename Key, class Compare>
+struct suffix_equal<Key, Compare, true> {
+	static bool apply(const Key *a, const Key *b, size_t n, const Compare&)
+	{
+		return n == 0 || std::memcmp(a, b, n * sizeof(Key)) == 0;
+	}
+};
+
+template <typename Key, typename Value>
+struct burst_bucket {
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef size_t size_type;
+	static const size_type npos = size_type(-1);
+
+	struct entry {
+		size_type offset;
+		size_type length;
+		value_type value;
+	};
+
+	// the suffixes, packed end to end
+	std::vector<key_type> keys;
+	// in insertion order
+	std::vector<entry> entries;
+	// the entries in key order, and the position of each entry in it, kept
+	// up to date except between append() and sort()
+	std::vector<size_type> order;
+	std::vector<size_type> rank;
+	// elements of keys left behind by erase()
+	size_type garbage;
+
+	explicit burst_bucket() : garbage(0)
+	{
+	}
+
+	size_type size() const
+	{
+		return entries.size();
+	}
+
+	const key_type * key_of(size_type i) const
+	{
+		return keys.empty() ? NULL : &keys[0] + entries[i].offset;
+	}
+
+	template <class Compare>
+	static int compare(const key_type *a, size_type na, const key_type *b, size_type nb, const Compare& comp)
+	{
+		size_type n = std::min(na, nb);
+		for (size_type i = 0; i < n; ++i)
+		{
+			if (comp(a[i], b[i]))
+				return -1;
+			if (comp(b[i], a[i]))
+				return 1;
+		}
+		return na < nb ? -1 : (na > nb ? 1 : 0);
+	}
+
+	template <class Compare>
+	static bool equal(const key_type *a, const key_type *b, size_type n, const Compare& comp)
+	{
+		return suffix_equal<key_type, Compare>::apply(a, b, n, comp);
+	}
+
+	// is [k, k + n) a prefix of the suffix of entry i
+	template <class Compare>
+	bool has_prefix(size_type i, const key_type *k, size_type n, const Compare& comp) const
+	{
+		return entries[i].length >= n && equal(key_of(i), k, n, comp);
+	}
+
+	template <class Compare>
+	size_type find(const key_type *k, size_type n, const Compare& comp) const
+	{
+		for (size_type i = 0; i < entries.size(); ++i)
+			if (entries[i].length == n && equal(key_of(i), k, n, comp))
+				return i;
+		return npos;
+	}
+
+	// add an entry without ordering it, sort() has to follow
+	size_type append(const key_type *k, size_type n, const value_type& v)
+	{
+		entry e = { keys.size(), n, v };
+		keys.insert(keys.end(), k, k + n);
+		entries.push_back(e);
+		return entries.size() - 1;
+	}
+
+	// add an entry at its place in the order
+	template <class Compare>
+	size_type insert(const key_type *k, size_type n, const value_type& v, const Compare& comp)
+	{
+		size_type r = bound(k, n, false, comp);
+		size_type i = append(k, n, v);
+		order.insert(order.begin() + r, i);
+		rank.resize(order.size());
+		for (size_type j = r; j < order.size(); ++j)
+			rank[order[j]] = j;
+		return i;
+	}
+
+	template <class Compare>
+	struct entry_less {
+		const burst_bucket *b;
+		Compare comp;
+
+		bool operator()(size_type x, size_type y) const
+		{
+			return compare(b->key_of(x), b->entries[x].length, b->key_of(y), b->entries[y].length, comp) < 0;
+		}
+	};
+
+	template <class Compare>
+	void sort(const Compare& comp)
+	{
+		order.resize(entries.size());
+		for (size_type i = 0; i < order.size(); ++i)
+			order[i] = i;
+		entry_less<Compare> less = { this, comp };
+		std::sort(order.begin(), order.end(), less);
+		rank.resize(order.size());
+		for (size_type i = 0; i < order.size(); ++i)
+			rank[order[i]] = i;
+	}
+
+	// the first position in order whose suffix is not before (or, with upper, after) [k, k + n)
+	template <class Compare>
+	size_type bound(const key_type *k, size_type n, bool upper, const Compare& comp) const
+	{
+		size_type lo = 0, hi = order.size();
+		while (lo < hi)
+		{
+			size_type mid = (lo + hi) / 2;
+			int c = compare(key_of(order[mid]), entries[order[mid]].length, k, n, comp);
+			if (c < 0 || (upper && c == 0))
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	// entries after i move down by one, the order is kept
+	void erase(size_type i)
+	{
+		garbage += entries[i].length;
+		entries.erase(entries.begin() + i);
+		order.erase(order.begin() + rank[i]);
+		for (size_type j = 0; j < order.size(); ++j)
+		{
+			if (order[j] > i)
+				--order[j];
+			rank[order[j]] = j;
+		}
+		rank.resize(order.size());
+		if (garbage * 2 > keys.size())
+			compact();
+	}
+
+	void compact()
+	{
+		std::vector<key_type> tmp;
+		tmp.reserve(keys.size() - garbage);
+		for (size_type i = 0; i < entries.size(); ++i)
+		{
+			const key_type *k = key_of(i);
+			entries[i].offset = tmp.size();
+			tmp.insert(tmp.end(), k, k + entries[i].length);
+		}
+		keys.swap(tmp);
+		garbage = 0;
+	}
+};
+
+template <typename Key, typename Value>
+const typename burst_bucket<Key, Value>::size_type burst_bucket<Key, Value>::npos;
+
+template <typename Key, typename Value, class Compare>
+struct burst_node : private boost::noncopyable {
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef size_t size_type;
+	typedef burst_node<key_type, value_type, Compare> node_type;
+	typedef node_type * node_ptr;
+	typedef burst_bucket<key_type, value_type> bucket_type;
+	typedef std::map<key_type, node_ptr, Compare> children_type;
+	typedef typename children_type::iterator child_iter;
+
+	children_type child;
+	node_ptr parent;
+	child_iter child_iter_of_parent;
+	// values in the sub-trie, the bucket included
+	size_type value_count;
+	// a node with a bucket has no children and keeps the key ending here in the bucket
+	bucket_type *bucket;
+	bool has_value;
+	value_type value;
+
+	explicit burst_node() : parent(0), value_count(0), bucket(0), has_value(false), value()
+	{
+	}
+
+	~burst_node()
+	{
+		delete bucket;
+	}
+};
+
+// moving between the values in key order
+template <typename Key, typename Value, class Compare>
+struct burst_walk {
+	typedef burst_node<Key, Value, Compare> node_type;
+	typedef node_type * node_ptr;
+	typedef size_t size_type;
+	// (node, entry of its bucket or self_pos), node is NULL past the end
+	typedef std::pair<node_ptr, size_type> position;
+	static const size_type self_pos = size_type(-1);
+
+	static position none()
+	{
+		return position(static_cast<node_ptr>(0), 0);
+	}
+
+	static position leftmost(node_ptr n)
+	{
+		for (;;)
+		{
+			if (n->bucket != NULL)
+			{
+				if (n->bucket->size() == 0)
+					return none();
+				return position(n, n->bucket->order.front());
+			}
+			if (n->has_value)
+				return position(n, self_pos);
+			if (n->child.empty())
+				return none();
+			n = n->child.begin()->second;
+		}
+	}
+
+	static position rightmost(node_ptr n)
+	{
+		for (;;)
+		{
+			if (n->bucket != NULL)
+			{
+				if (n->bucket->size() == 0)
+					return none();
+				return position(n, n->bucket->order.back());
+			}
+			if (!n->child.empty())
+			{
+				n = n->child.rbegin()->second;
+				continue;
+			}
+			if (n->has_value)
+				return position(n, self_pos);
+			return none();
+		}
+	}
+
+	// the first value after the whole sub-trie of n
+	static position after(node_ptr n)
+	{
+		for (; n->parent != NULL; n = n->parent)
+		{
+			typename node_type::child_iter ci = n->child_iter_of_parent;
+			if (++ci != n->parent->child.end())
+				return leftmost(ci->second);
+		}
+		return none();
+	}
+
+	// the last value before the whole sub-trie of n
+	static position before(node_ptr n)
+	{
+		for (; n->parent != NULL; n = n->parent)
+		{
+			node_ptr p = n->parent;
+			typename node_type::child_iter ci = n->child_iter_of_parent;
+			if (ci != p->child.begin())
+				return rightmost((--ci)->second);
+			if (p->has_value)
+				return position(p, self_pos);
+		}
+		return none();
+	}
+
+	static position next(position x)
+	{
+		node_ptr n = x.first;
+		if (x.second != self_pos)
+		{
+			size_type r = n->bucket->rank[x.second] + 1;
+			if (r < n->bucket->size())
+				return position(n, n->bucket->order[r]);
+			return after(n);
+		}
+		if (!n->child.empty())
+			return leftmost(n->child.begin()->second);
+		return after(n);
+	}
+
+	static position prev(position x)
+	{
+		node_ptr n = x.first;
+		if (x.second != self_pos)
+		{
+			size_type r = n->bucket->rank[x.second];
+			if (r > 0)
+				return position(n, n->bucket->order[r - 1]);
+		}
+		return before(n);
+	}
+};
+
+template <typename Key, typename Value, class Compare>
+const typename burst_walk<Key, Value, Compare>::size_type burst_walk<Key, Value, Compare>::self_pos;
+
+template <typename Key, typename Value, typename Reference, typename Pointer, class Compare>
+struct burst_trie_iterator
+{
+	typedef std::bidirectional_iterator_tag iterator_category;
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef Reference reference;
+	typedef Pointer pointer;
+	typedef ptrdiff_t difference_type;
+	typedef burst_trie_iterator<Key, Value, Value&, Value*, Compare> iterator;
+	typedef burst_trie_iterator<Key, Value, Reference, Pointer, Compare> self;
+	typedef burst_walk<Key, Value, Compare> walk;
+	typedef typename walk::node_type node_type;
+	typedef typename walk::node_ptr node_ptr;
+	typedef typename walk::position position;
+	typedef size_t size_type;
+
+	// the root, to step back from end()
+	node_ptr root;
+	// NULL at end()
+	node_ptr node;
+	// the entry in the bucket of node, or walk::self_pos for the value on node
+	size_type pos;
+
+	explicit burst_trie_iterator() : root(0), node(0), pos(0)
+	{
+	}
+
+	explicit burst_trie_iterator(node_ptr r, position x) : root(r), node(x.first), pos(x.second)
+	{
+	}
+
+	burst_trie_iterator(const iterator& it) : root(it.root), node(it.node), pos(it.pos)
+	{
+	}
+
+	self& operator=(const iterator& it)
+	{
+		root = it.root;
+		node = it.node;
+		pos = it.pos;
+		return *this;
+	}
+
+	std::vector<key_type> get_key() const
+	{
+		std::vector<key_type> ret;
+		for (node_ptr cur = node; cur->parent != NULL; cur = cur->parent)
+			ret.push_back(cur->child_iter_of_parent->first);
+		std::reverse(ret.begin(), ret.end());
+		if (pos != walk::self_pos)
+		{
+			const key_type *k = node->bucket->key_of(pos);
+			ret.insert(ret.end(), k, k + node->bucket->entries[pos].length);
+		}
+		return ret;
+	}
+
+	reference operator*() const
+	{
+		if (pos == walk::self_pos)
+			return node->value;
+		return node->bucket->entries[pos].value;
+	}
+
+	pointer operator->() const
+	{
+		return &(operator*());
+	}
+
+	bool operator==(const self& other) const
+	{
+		return node == other.node && (node == NULL || pos == other.pos);
+	}
+
+	bool operator!=(const self& other) const
+	{
+		return !(*this == other);
+	}
+
+	self& operator++()
+	{
+		position x = walk::next(position(node, pos));
+		node = x.first;
+		pos = x.second;
+		return *this;
+	}
+
+	self operator++(int)
+	{
+		self tmp = *this;
+		++*this;
+		return tmp;
+	}
+
+	// the decrement of begin() stays at begin()
+	self& operator--()
+	{
+		position x = node == NULL ? walk::rightmost(root) : walk::prev(position(node, pos));
+		if (x.first != NULL)
+		{
+			node = x.first;
+			pos = x.second;
+		}
+		return *this;
+	}
+
+	self operator--(int)
+	{
+		self tmp = *this;
+		--*this;
+		return tmp;
+	}
+};
+
+} // namespace detail
+
+
+template <typename Key, typename Value, class Compare = std::less<Key> >
+class burst_trie {
+public:
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef size_t size_type;
+	typedef burst_trie<key_type, value_type, Compare> burst_trie_type;
+	typedef detail::burst_node<key_type, value_type, Compare> node_type;
+	typedef node_type * node_ptr;
+	typedef typename node_type::bucket_type bucket_type;
+	typedef detail::burst_walk<key_type, value_type, Compare> walk;
+	typedef typename walk::position position;
+	typedef detail::burst_trie_iterator<key_type, value_type, value_type&, value_type*, Compare> iterator;
+	typedef detail::burst_trie_iterator<key_type, value_type, const value_type&, const value_type*, Compare> const_iterator;
+	typedef detail::trie_reverse_iterator<iterator> reverse_iterator;
+	typedef detail::trie_reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef std::pair<iterator, bool> pair_iterator_bool;
+	typedef std::pair<iterator, iterator> iterator_range;
+	typedef std::pair<const_iterator, const_iterator> const_iterator_range;
+
+private:
+	node_ptr root;
+	size_type threshold;
+	size_type node_count;
+	size_type bucket_count;
+	Compare comp;
+
+	static const key_type * data_of(const std::vector<key_type>& key)
+	{
+		return key.empty() ? NULL : &key[0];
+	}
+
+	node_ptr new_node(node_ptr parent, const key_type& k, bool with_bucket)
+	{
+		node_ptr n = new node_type();
+		n->parent = parent;
+		n->child_iter_of_parent = parent->child.insert(std::make_pair(k, n)).first;
+		if (with_bucket)
+		{
+			n->bucket = new bucket_type();
+			++bucket_count;
+		}
+		++node_count;
+		return n;
+	}
+
+	void delete_node(node_ptr n)
+	{
+		if (n->bucket != NULL)
+			--bucket_count;
+		delete n;
+		--node_count;
+	}
+
+	void destroy_subtree(node_ptr n)
+	{
+		std::vector<node_ptr> stk;
+		stk.push_back(n);
+		while (!stk.empty())
+		{
+			node_ptr cur = stk.back();
+			stk.pop_back();
+			for (typename node_type::child_iter ci = cur->child.begin(); ci != cur->child.end(); ++ci)
+				stk.push_back(ci->second);
+			if (cur != root)
+				delete_node(cur);
+		}
+	}
+
+	void add_count(node_ptr n, int delta)
+	{
+		for (; n != NULL; n = n->parent)
+			n->value_count += delta;
+	}
+
+	// move the suffixes of a bucket one level down
+	void burst(node_ptr n)
+	{
+		std::vector<node_ptr> stk;
+		stk.push_back(n);
+		while (!stk.empty())
+		{
+			node_ptr cur = stk.back();
+			stk.pop_back();
+			bucket_type *b = cur->bucket;
+			cur->bucket = NULL;
+			--bucket_count;
+			for (size_type i = 0; i < b->size(); ++i)
+			{
+				const key_type *k = b->key_of(i);
+				size_type len = b->entries[i].length;
+				if (len == 0)
+				{
+					cur->has_value = true;
+					cur->value = b->entries[i].value;
+					continue;
+				}
+				typename node_type::child_iter ci = cur->child.find(k[0]);
+				node_ptr c = ci == cur->child.end() ? new_node(cur, k[0], true) : ci->second;
+				c->bucket->append(k + 1, len - 1, b->entries[i].value);
+				++c->value_count;
+			}
+			delete b;
+			for (typename node_type::child_iter ci = cur->child.begin(); ci != cur->child.end(); ++ci)
+			{
+				if (ci->second->bucket->size() > threshold)
+					stk.push_back(ci->second);
+				else
+					ci->second->bucket->sort(comp);
+			}
+		}
+	}
+
+	// the value with the key, or none()
+	position locate(const std::vector<key_type>& key) const
+	{
+		const key_type *k = data_of(key);
+		node_ptr cur = root;
+		for (size_type d = 0; ; ++d)
+		{
+			if (cur->bucket != NULL)
+			{
+				size_type i = cur->bucket->find(k + d, key.size() - d, comp);
+				return i == bucket_type::npos ? walk::none() : position(cur, i);
+			}
+			if (d == key.size())
+				return cur->has_value ? position(cur, walk::self_pos) : walk::none();
+			typename node_type::child_iter ci = cur->child.find(k[d]);
+			if (ci == cur->child.end())
+				return walk::none();
+			cur = ci->second;
+		}
+	}
+
+	// drop the nodes left without values, up from n, returns the first node kept
+	node_ptr prune(node_ptr n)
+	{
+		while (n != root && n->value_count == 0)
+		{
+			node_ptr p = n->parent;
+			p->child.erase(n->child_iter_of_parent);
+			destroy_subtree(n);
+			n = p;
+		}
+		return n;
+	}
+
+	// a sub-trie with this many values or less goes back into one bucket
+	size_type merge_limit() const
+	{
+		return threshold / 2 > 1 ? threshold / 2 : 1;
+	}
+
+	// the highest node from n up that should become a bucket, or NULL
+	node_ptr merge_top(node_ptr n) const
+	{
+		node_ptr top = NULL;
+		for (; n != NULL && n->value_count <= merge_limit(); n = n->parent)
+			top = n;
+		return top != NULL && top->bucket == NULL ? top : NULL;
+	}
+
+	// move every value below n into a new bucket on n
+	void merge(node_ptr n)
+	{
+		bucket_type *b = new bucket_type();
+		std::vector<key_type> path;
+		std::vector<std::pair<node_ptr, size_type> > stk;
+		stk.push_back(std::make_pair(n, size_type(0)));
+		while (!stk.empty())
+		{
+			node_ptr cur = stk.back().first;
+			path.resize(stk.back().second);
+			stk.pop_back();
+			if (cur != n)
+				path.push_back(cur->child_iter_of_parent->first);
+			if (cur->has_value)
+				b->append(data_of(path), path.size(), cur->value);
+			if (cur->bucket != NULL)
+			{
+				for (size_type i = 0; i < cur->bucket->size(); ++i)
+				{
+					std::vector<key_type> k(path);
+					k.insert(k.end(), cur->bucket->key_of(i), cur->bucket->key_of(i) + cur->bucket->entries[i].length);
+					b->append(data_of(k), k.size(), cur->bucket->entries[i].value);
+				}
+			}
+			for (typename node_type::child_iter ci = cur->child.begin(); ci != cur->child.end(); ++ci)
+				stk.push_back(std::make_pair(ci->second, path.size()));
+		}
+		for (typename node_type::child_iter ci = n->child.begin(); ci != n->child.end(); ++ci)
+			destroy_subtree(ci->second);
+		n->child.clear();
+		n->has_value = false;
+		n->value = value_type();
+		b->sort(comp);
+		n->bucket = b;
+		++bucket_count;
+	}
+
+	// the first value not before the key, after it with upper
+	position bound(const std::vector<key_type>& key, bool upper) const
+	{
+		const key_type *k = data_of(key);
+		node_ptr cur = root;
+		for (size_type d = 0; ; ++d)
+		{
+			if (cur->bucket != NULL)
+			{
+				bucket_type *b = cur->bucket;
+				size_type r = b->bound(k + d, key.size() - d, upper, comp);
+				return r < b->size() ? position(cur, b->order[r]) : walk::after(cur);
+			}
+			if (d == key.size())
+			{
+				if (!upper && cur->has_value)
+					return position(cur, walk::self_pos);
+				if (!cur->child.empty())
+					return walk::leftmost(cur->child.begin()->second);
+				return walk::after(cur);
+			}
+			typename node_type::child_iter ci = cur->child.lower_bound(k[d]);
+			if (ci == cur->child.end())
+				return walk::after(cur);
+			if (comp(k[d], ci->first))
+				return walk::leftmost(ci->second);
+			cur = ci->second;
+		}
+	}
+
+	// the values with the prefix, [first, second)
+	std::pair<position, position> prefix_range(const std::vector<key_type>& key) const
+	{
+		const key_type *k = data_of(key);
+		node_ptr cur = root;
+		for (size_type d = 0; ; ++d)
+		{
+			if (cur->bucket != NULL)
+			{
+				bucket_type *b = cur->bucket;
+				size_type n = key.size() - d;
+				size_type lo = b->bound(k + d, n, false, comp), hi = lo;
+				while (hi < b->size() && b->has_prefix(b->order[hi], k + d, n, comp))
+					++hi;
+				if (lo == hi)
+					return std::make_pair(walk::none(), walk::none());
+				position last_pos = hi < b->size() ? position(cur, b->order[hi]) : walk::after(cur);
+				return std::make_pair(position(cur, b->order[lo]), last_pos);
+			}
+			if (d == key.size())
+				break;
+			typename node_type::child_iter ci = cur->child.find(k[d]);
+			if (ci == cur->child.end())
+				return std::make_pair(walk::none(), walk::none());
+			cur = ci->second;
+		}
+		if (cur->value_count == 0)
+			return std::make_pair(walk::none(), walk::none());
+		return std::make_pair(walk::leftmost(cur), walk::after(cur));
+	}
+
+	// the value of the longest key that is a prefix of the key, or none()
+	position longest_prefix(const std::vector<key_type>& key) const
+	{
+		const key_type *k = data_of(key);
+		position ret = walk::none();
+		node_ptr cur = root;
+		for (size_type d = 0; ; ++d)
+		{
+			if (cur->bucket != NULL)
+			{
+				bucket_type *b = cur->bucket;
+				size_type best = 0, n = key.size() - d;
+				for (size_type i = 0; i < b->size(); ++i)
+				{
+					size_type len = b->entries[i].length;
+					if (len <= n && (ret.first != cur || len > best) &&
+							bucket_type::equal(b->key_of(i), k + d, len, comp))
+					{
+						ret = position(cur, i);
+						best = len;
+					}
+				}
+				break;
+			}
+			if (cur->has_value)
+				ret = position(cur, walk::self_pos);
+			if (d == key.size())
+				break;
+			typename node_type::child_iter ci = cur->child.find(k[d]);
+			if (ci == cur->child.end())
+				break;
+			cur = ci->second;
+		}
+		return ret;
+	}
+
+	void copy_tree(node_ptr other_root)
+	{
+		std::vector<std::pair<node_ptr, node_ptr> > stk;
+		stk.push_back(std::make_pair(other_root, root));
+		while (!stk.empty())
+		{
+			node_ptr src = stk.back().first, dst = stk.back().second;
+			stk.pop_back();
+			dst->value_count = src->value_count;
+			dst->has_value = src->has_value;
+			dst->value = src->value;
+			if (src->bucket != NULL)
+			{
+				if (dst->bucket == NULL)
+					++bucket_count;
+				else
+					delete dst->bucket;
+				dst->bucket = new bucket_type(*src->bucket);
+			}
+			for (typename node_type::child_iter ci = src->child.begin(); ci != src->child.end(); ++ci)
+				stk.push_back(std::make_pair(ci->second, new_node(dst, ci->first, false)));
+		}
+	}
+
+	void reset_root()
+	{
+		root->child.clear();
+		root->value_count = 0;
+		root->has_value = false;
+		if (root->bucket == NULL)
+		{
+			root->bucket = new bucket_type();
+			++bucket_count;
+		}
+		else {
+			*root->bucket = bucket_type();
+		}
+	}
+
+public:
+	// the burst threshold that keeps every unique key remainder as one tail
+	enum { tail_threshold = 1 };
+
+	// a bucket bursts when it holds more than burst_threshold keys
+	explicit burst_trie(size_type burst_threshold = 64) : root(new node_type()), threshold(burst_threshold),
+		node_count(0), bucket_count(0), comp()
+	{
+		reset_root();
+	}
+
+	explicit burst_trie(const burst_trie_type& other) : root(new node_type()), threshold(other.threshold),
+		node_count(0), bucket_count(0), comp()
+	{
+		copy_tree(other.root);
+	}
+
+	burst_trie_type& operator=(const burst_trie_type& other)
+	{
+		if (this == &other)
+			return *this;
+		clear();
+		threshold = other.threshold;
+		if (other.root->bucket == NULL)
+		{
+			delete root->bucket;
+			root->bucket = NULL;
+			--bucket_count;
+		}
+		copy_tree(other.root);
+		return *this;
+	}
+
+	iterator begin()
+	{
+		return iterator(root, walk::leftmost(root));
+	}
+
+	const_iterator begin() const
+	{
+		return const_iterator(root, walk::leftmost(root));
+	}
+
+	const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	iterator end()
+	{
+		return iterator(root, walk::none());
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(root, walk::none());
+	}
+
+	const_iterator cend() const
+	{
+		return end();
+	}
+
+	reverse_iterator rbegin()
+	{
+		return reverse_iterator(end());
+	}
+
+	const_reverse_iterator rbegin() const
+	{
+		return const_reverse_iterator(end());
+	}
+
+	reverse_iterator rend()
+	{
+		return reverse_iterator(begin());
+	}
+
+	const_reverse_iterator rend() const
+	{
+		return const_reverse_iterator(begin());
+	}
+
+	template<typename Iter>
+	pair_iterator_bool insert_unique(Iter first, Iter last, const value_type& value)
+	{
+		std::vector<key_type> key(first, last);
+		const key_type *k = data_of(key);
+		node_ptr cur = root;
+		for (size_type d = 0; ; ++d)
+		{
+			if (cur->bucket != NULL)
+			{
+				size_type i = cur->bucket->find(k + d, key.size() - d, comp);
+				if (i != bucket_type::npos)
+					return std::make_pair(iterator(root, position(cur, i)), false);
+				i = cur->bucket->insert(k + d, key.size() - d, value, comp);
+				add_count(cur, 1);
+				if (cur->bucket->size() <= threshold)
+					return std::make_pair(iterator(root, position(cur, i)), true);
+				burst(cur);
+				return std::make_pair(iterator(root, locate(key)), true);
+			}
+			if (d == key.size())
+			{
+				if (cur->has_value)
+					return std::make_pair(iterator(root, position(cur, walk::self_pos)), false);
+				cur->has_value = true;
+				cur->value = value;
+				add_count(cur, 1);
+				return std::make_pair(iterator(root, position(cur, walk::self_pos)), true);
+			}
+			typename node_type::child_iter ci = cur->child.find(k[d]);
+			cur = ci == cur->child.end() ? new_node(cur, k[d], true) : ci->second;
+		}
+	}
+
+	template<typename Container>
+	pair_iterator_bool insert_unique(const Container& container, const value_type& value)
+	{
+		return insert_unique(container.begin(), container.end(), value);
+	}
+
+	template<typename Iter>
+	iterator find(Iter first, Iter last)
+	{
+		return iterator(root, locate(std::vector<key_type>(first, last)));
+	}
+
+	template<typename Iter>
+	const_iterator find(Iter first, Iter last) const
+	{
+		return const_iterator(root, locate(std::vector<key_type>(first, last)));
+	}
+
+	template<typename Container>
+	iterator find(const Container& container)
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template<typename Container>
+	const_iterator find(const Container& container) const
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		return locate(std::vector<key_type>(first, last)).first == NULL ? 0 : 1;
+	}
+
+	template<typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type count_prefix(Iter first, Iter last) const
+	{
+		std::vector<key_type> key(first, last);
+		const key_type *k = data_of(key);
+		node_ptr cur = root;
+		for (size_type d = 0; ; ++d)
+		{
+			if (cur->bucket != NULL)
+			{
+				// the order is not needed for counting
+				bucket_type *b = cur->bucket;
+				size_type ret = 0, n = key.size() - d;
+				for (size_type i = 0; i < b->size(); ++i)
+					if (b->has_prefix(i, k + d, n, comp))
+						++ret;
+				return ret;
+			}
+			if (d == key.size())
+				return cur->value_count;
+			typename node_type::child_iter ci = cur->child.find(k[d]);
+			if (ci == cur->child.end())
+				return 0;
+			cur = ci->second;
+		}
+	}
+
+	template<typename Container>
+	size_type count_prefix(const Container& container) const
+	{
+		return count_prefix(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	iterator_range find_prefix(Iter first, Iter last)
+	{
+		std::pair<position, position> r = prefix_range(std::vector<key_type>(first, last));
+		return std::make_pair(iterator(root, r.first), iterator(root, r.second));
+	}
+
+	template<typename Iter>
+	const_iterator_range find_prefix(Iter first, Iter last) const
+	{
+		std::pair<position, position> r = prefix_range(std::vector<key_type>(first, last));
+		return std::make_pair(const_iterator(root, r.first), const_iterator(root, r.second));
+	}
+
+	template<typename Container>
+	iterator_range find_prefix(const Container& container)
+	{
+		return find_prefix(container.begin(), container.end());
+	}
+
+	template<typename Container>
+	const_iterator_range find_prefix(const Container& container) const
+	{
+		return find_prefix(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	iterator lower_bound(Iter first, Iter last)
+	{
+		return iterator(root, bound(std::vector<key_type>(first, last), false));
+	}
+
+	template<typename Iter>
+	const_iterator lower_bound(Iter first, Iter last) const
+	{
+		return const_iterator(root, bound(std::vector<key_type>(first, last), false));
+	}
+
+	template<typename Container>
+	iterator lower_bound(const Container& container)
+	{
+		return lower_bound(container.begin(), container.end());
+	}
+
+	template<typename Container>
+	const_iterator lower_bound(const Container& container) const
+	{
+		return lower_bound(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	iterator upper_bound(Iter first, Iter last)
+	{
+		return iterator(root, bound(std::vector<key_type>(first, last), true));
+	}
+
+	template<typename Iter>
+	const_iterator upper_bound(Iter first, Iter last) const
+	{
+		return const_iterator(root, bound(std::vector<key_type>(first, last), true));
+	}
+
+	template<typename Container>
+	iterator upper_bound(const Container& container)
+	{
+		return upper_bound(container.begin(), container.end());
+	}
+
+	template<typename Container>
+	const_iterator upper_bound(const Container& container) const
+	{
+		return upper_bound(container.begin(), container.end());
+	}
+
+	// the longest key that is a prefix of [first, last)
+	template<typename Iter>
+	iterator findLongestPrefixOfKey(Iter first, Iter last)
+	{
+		return iterator(root, longest_prefix(std::vector<key_type>(first, last)));
+	}
+
+	template<typename Iter>
+	const_iterator findLongestPrefixOfKey(Iter first, Iter last) const
+	{
+		return const_iterator(root, longest_prefix(std::vector<key_type>(first, last)));
+	}
+
+	template<typename Container>
+	iterator findLongestPrefixOfKey(const Container& container)
+	{
+		return findLongestPrefixOfKey(container.begin(), container.end());
+	}
+
+	template<typename Container>
+	const_iterator findLongestPrefixOfKey(const Container& container) const
+	{
+		return findLongestPrefixOfKey(container.begin(), container.end());
+	}
+
+	// erase the value at it, returns the iterator to the next value
+	iterator erase(const_iterator it)
+	{
+		if (it.node == NULL)
+			return end();
+		const_iterator next = it;
+		++next;
+		node_ptr n = it.node;
+		if (it.pos == walk::self_pos)
+		{
+			n->has_value = false;
+		}
+		else {
+			n->bucket->erase(it.pos);
+			if (next.node == n && next.pos > it.pos)
+				--next.pos;
+		}
+		add_count(n, -1);
+		node_ptr top = merge_top(prune(n));
+		if (top == NULL)
+			return iterator(root, position(next.node, next.pos));
+		// the entries move, find the next value again by its key
+		std::vector<key_type> key;
+		if (next.node != NULL)
+			key = next.get_key();
+		merge(top);
+		return next.node == NULL ? end() : iterator(root, locate(key));
+	}
+
+	iterator erase(iterator it)
+	{
+		return erase(const_iterator(it));
+	}
+
+	template<typename Iter>
+	size_type erase(Iter first, Iter last)
+	{
+		position x = locate(std::vector<key_type>(first, last));
+		if (x.first == NULL)
+			return 0;
+		erase(const_iterator(root, x));
+		return 1;
+	}
+
+	template<typename Container>
+	size_type erase(const Container& container)
+	{
+		return erase(container.begin(), container.end());
+	}
+
+	void clear()
+	{
+		destroy_subtree(root);
+		reset_root();
+	}
+
+	void swap(burst_trie_type& other)
+	{
+		std::swap(root, other.root);
+		std::swap(threshold, other.threshold);
+		std::swap(node_count, other.node_count);
+		std::swap(bucket_count, other.bucket_count);
+	}
+
+	size_type size() const
+	{
+		return root->value_count;
+	}
+
+	bool empty() const
+	{
+		return root->value_count == 0;
+	}
+
+	// the root is not counted, the same as trie::count_node()
+	size_type count_node() const
+	{
+		return node_count;
+	}
+
+	size_type count_bucket() const
+	{
+		return bucket_count;
+	}
+
+	size_type burst_threshold() const
+	{
+		return threshold;
+	}
+
+	~burst_trie()
+	{
+		destroy_subtree(root);
+		delete root;
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_BURST_TRIE_HPP
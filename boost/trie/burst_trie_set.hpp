@@ -0,0 +1,247 @@
+#ifndef BOOST_TRIE_BURST_TRIE_SET
+#define BOOST_TRIE_BURST_TRIE_SET
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "burst_trie.hpp"
+#include <boost/blank.hpp>
+
+namespace boost { namespace tries {
+
+// trie_set on a burst trie, see boost/trie/burst_trie.hpp
+template<typename Key, class Compare = std::less<Key> >
+class burst_trie_set
+{
+public:
+	typedef Key key_type;
+	typedef boost::blank value_type;
+	typedef burst_trie<key_type, value_type, Compare> trie_type;
+	typedef burst_trie_set<Key, Compare> burst_trie_set_type;
+	typedef typename trie_type::const_iterator iterator;
+	typedef typename trie_type::const_iterator const_iterator;
+	typedef typename trie_type::const_reverse_iterator reverse_iterator;
+	typedef typename trie_type::const_reverse_iterator const_reverse_iterator;
+	typedef typename trie_type::const_iterator_range iterator_range;
+	typedef typename trie_type::const_iterator_range const_iterator_range;
+	typedef size_t size_type;
+
+protected:
+	trie_type t;
+
+public:
+	// see burst_trie::burst_trie()
+	explicit burst_trie_set(size_type burst_threshold = 64) : t(burst_threshold)
+	{
+	}
+
+	explicit burst_trie_set(const burst_trie_set_type& other) : t(other.t)
+	{
+	}
+
+	burst_trie_set_type& operator=(const burst_trie_set_type& other)
+	{
+		t = other.t;
+		return *this;
+	}
+
+	iterator begin()
+	{
+		return t.begin();
+	}
+
+	const_iterator begin() const
+	{
+		return t.begin();
+	}
+
+	iterator end()
+	{
+		return t.end();
+	}
+
+	const_iterator end() const
+	{
+		return t.end();
+	}
+
+	reverse_iterator rbegin()
+	{
+		return t.rbegin();
+	}
+
+	const_reverse_iterator rbegin() const
+	{
+		return t.rbegin();
+	}
+
+	reverse_iterator rend()
+	{
+		return t.rend();
+	}
+
+	const_reverse_iterator rend() const
+	{
+		return t.rend();
+	}
+
+	// modifying functions
+	template<typename Iter>
+	std::pair<iterator, bool> insert(Iter first, Iter last)
+	{
+		return t.insert_unique(first, last, value_type());
+	}
+
+	template<typename Container>
+	std::pair<iterator, bool> insert(const Container& container)
+	{
+		return t.insert_unique(container, value_type());
+	}
+
+	// find
+	template<typename Iter>
+	iterator find(Iter first, Iter last) const
+	{
+		return t.find(first, last);
+	}
+
+	template<typename Container>
+	iterator find(const Container& container) const
+	{
+		return t.find(container);
+	}
+
+	// count
+	template<typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		return t.count(first, last);
+	}
+
+	template<typename Container>
+	size_type count(const Container& container) const
+	{
+		return t.count(container);
+	}
+
+	template<typename Iter>
+	size_type count_prefix(Iter first, Iter last) const
+	{
+		return t.count_prefix(first, last);
+	}
+
+	template<typename Container>
+	size_type count_prefix(const Container& container) const
+	{
+		return t.count_prefix(container);
+	}
+
+	// find_with_prefix
+	template<typename Iter>
+	iterator_range find_prefix(Iter first, Iter last) const
+	{
+		return t.find_prefix(first, last);
+	}
+
+	template<typename Container>
+	iterator_range find_prefix(const Container& container) const
+	{
+		return t.find_prefix(container);
+	}
+
+	// findLongestPrefixOfKey
+	template<typename Iter>
+	iterator findLongestPrefixOfKey(Iter first, Iter last) const
+	{
+		return t.findLongestPrefixOfKey(first, last);
+	}
+
+	template<typename Container>
+	iterator findLongestPrefixOfKey(const Container& container) const
+	{
+		return t.findLongestPrefixOfKey(container);
+	}
+
+	// upper and lower bound
+	template<typename Iter>
+	iterator upper_bound(Iter first, Iter last) const
+	{
+		return t.upper_bound(first, last);
+	}
+
+	template<typename Container>
+	iterator upper_bound(const Container& container) const
+	{
+		return t.upper_bound(container);
+	}
+
+	template<typename Iter>
+	iterator lower_bound(Iter first, Iter last) const
+	{
+		return t.lower_bound(first, last);
+	}
+
+	template<typename Container>
+	iterator lower_bound(const Container& container) const
+	{
+		return t.lower_bound(container);
+	}
+
+	// erase
+	iterator erase(const_iterator it)
+	{
+		return t.erase(it);
+	}
+
+	template<typename Container>
+	size_type erase(const Container &container)
+	{
+		return t.erase(container);
+	}
+
+	template<typename Iter>
+	size_type erase(Iter first, Iter last)
+	{
+		return t.erase(first, last);
+	}
+
+	size_type count_node() const
+	{
+		return t.count_node();
+	}
+
+	size_type count_bucket() const
+	{
+		return t.count_bucket();
+	}
+
+	size_type size() const
+	{
+		return t.size();
+	}
+
+	bool empty() const
+	{
+		return t.empty();
+	}
+
+	void swap(burst_trie_set_type& other)
+	{
+		t.swap(other.t);
+	}
+
+	void clear()
+	{
+		t.clear();
+	}
+
+	~burst_trie_set()
+	{
+	}
+
+};
+
+}	// namespace tries
+}	// namespace boost
+#endif
@@ -0,0 +1,843 @@
+#ifndef BOOST_TRIE_COMPACT_TRIE_MAP_HPP
+#define BOOST_TRIE_COMPACT_TRIE_MAP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "trie.hpp"
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+
+//
+// compact_trie_map is a trie_map whose nodes live in one arena and refer to
+// each other by Index, 32-bit by default, instead of pointers.  A node is its
+// edge label, its child block, its child count, its value slot and the number
+// of values below it, each Index wide; there is no std::map per node and no
+// ordered list threaded through the nodes.  The children of a node are one
+// block of labels and node indices, sorted by label, so a lookup is a binary
+// search over the labels of one block and one step to the child.  A block
+// holds a power of two children and comes from the pool of its size, so a
+// node that gains or loses a child only moves its block when the count
+// crosses a power of two.  The parent links, only needed to walk back up in
+// iterators and erase(), are a cold side table, and the values are a table
+// of their own.
+//
+// Iterators are the arena and a node index, so insert() does not invalidate
+// them.  The arena holds at most Index(-1) - 1 nodes; insert() returns
+// end() and false when a key does not fit.  The value of the empty key is
+// iterated first.
+//
+
+namespace boost { namespace tries {
+
+namespace detail {
+
+template <typename Key, typename Index>
+struct compact_node {
+	Key label;
+	// the block in the pool of the size of child_count, or none
+	Index children;
+	Index child_count;
+	// the slot in the value table, or none
+	Index value;
+	// values in the sub-trie
+	Index value_count;
+};
+
+template <typename Key, typename Value, typename Index, class Compare>
+struct compact_arena {
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef Index index_type;
+	typedef size_t size_type;
+	typedef compact_node<key_type, index_type> node_type;
+
+	// the blocks of 2^k children, labels and nodes side by side
+	struct child_pool {
+		std::vector<key_type> labels;
+		std::vector<index_type> nodes;
+		std::vector<index_type> free_blocks;
+	};
+
+	std::vector<node_type> nodes;
+	// cold, the parent of each node
+	std::vector<index_type> parents;
+	std::vector<value_type> values;
+	std::vector<child_pool> pools;
+	// the free nodes are chained by children
+	index_type free_node;
+	size_type free_node_count;
+	std::vector<index_type> free_values;
+	Compare comp;
+
+	static index_type none()
+	{
+		return index_type(-1);
+	}
+
+	static size_type max_node_count()
+	{
+		return size_type(index_type(-1)) - 1;
+	}
+
+	explicit compact_arena() : free_node(none()), free_node_count(0), comp()
+	{
+		node_type r = { key_type(), none(), 0, none(), 0 };
+		nodes.push_back(r);
+		parents.push_back(none());
+	}
+
+	bool has_value(index_type n) const
+	{
+		return nodes[n].value != none();
+	}
+
+	// the pool whose blocks fit count children, count > 0
+	static size_type size_class(size_type count)
+	{
+		size_type k = 0;
+		while ((size_type(1) << k) < count)
+			++k;
+		return k;
+	}
+
+	const key_type * labels_of(index_type n) const
+	{
+		const node_type& x = nodes[n];
+		size_type k = size_class(x.child_count);
+		return &pools[k].labels[size_type(x.children) << k];
+	}
+
+	const index_type * children_of(index_type n) const
+	{
+		const node_type& x = nodes[n];
+		size_type k = size_class(x.child_count);
+		return &pools[k].nodes[size_type(x.children) << k];
+	}
+
+	key_type * labels_of(index_type n)
+	{
+		const compact_arena& self = *this;
+		return const_cast<key_type *>(self.labels_of(n));
+	}
+
+	index_type * children_of(index_type n)
+	{
+		const compact_arena& self = *this;
+		return const_cast<index_type *>(self.children_of(n));
+	}
+
+	// the place of the label k in the block of n
+	size_type lower_child(index_type n, const key_type& k) const
+	{
+		const key_type *l = labels_of(n);
+		return std::lower_bound(l, l + nodes[n].child_count, k, comp) - l;
+	}
+
+	// the child with label k, or none
+	index_type child(index_type n, const key_type& k) const
+	{
+		size_type count = nodes[n].child_count;
+		if (count == 0)
+			return none();
+		size_type i = lower_child(n, k);
+		if (i == count || comp(k, labels_of(n)[i]))
+			return none();
+		return children_of(n)[i];
+	}
+
+	// the step arena_trie_map takes down the edge k
+	index_type step(index_type n, const key_type& k) const
+	{
+		return child(n, k);
+	}
+
+	index_type parent_of(index_type n) const
+	{
+		return parents[n];
+	}
+
+	bool has_children(index_type n) const
+	{
+		return nodes[n].child_count != 0;
+	}
+
+	// the place of n in the block of its parent
+	size_type position_of(index_type n) const
+	{
+		return lower_child(parents[n], nodes[n].label);
+	}
+
+	index_type new_block(size_type k)
+	{
+		child_pool& pool = pools[k];
+		if (!pool.free_blocks.empty())
+		{
+			index_type b = pool.free_blocks.back();
+			pool.free_blocks.pop_back();
+			return b;
+		}
+		pool.labels.resize(pool.labels.size() + (size_type(1) << k));
+		pool.nodes.resize(pool.nodes.size() + (size_type(1) << k));
+		return index_type((pool.nodes.size() >> k) - 1);
+	}
+
+	// give n a block for count children, the first ones kept
+	void resize_children(index_type n, size_type count)
+	{
+		size_type old = nodes[n].child_count;
+		size_type from = old == 0 ? 0 : size_class(old), to = count == 0 ? 0 : size_class(count);
+		if (old != 0 && count != 0 && from == to)
+		{
+			nodes[n].child_count = index_type(count);
+			return;
+		}
+		index_type b = none();
+		if (count != 0)
+		{
+			if (pools.size() <= to)
+				pools.resize(to + 1);
+			b = new_block(to);
+			size_type keep = old < count ? old : count;
+			if (keep != 0)
+			{
+				std::copy(labels_of(n), labels_of(n) + keep, &pools[to].labels[size_type(b) << to]);
+				std::copy(children_of(n), children_of(n) + keep, &pools[to].nodes[size_type(b) << to]);
+			}
+		}
+		if (old != 0)
+			pools[from].free_blocks.push_back(nodes[n].children);
+		nodes[n].children = b;
+		nodes[n].child_count = index_type(count);
+	}
+
+	index_type new_node(index_type parent, const key_type& k)
+	{
+		node_type x = { k, none(), 0, none(), 0 };
+		index_type n = free_node;
+		if (n != none())
+		{
+			free_node = nodes[n].children;
+			--free_node_count;
+			nodes[n] = x;
+			parents[n] = parent;
+		}
+		else {
+			n = index_type(nodes.size());
+			nodes.push_back(x);
+			parents.push_back(parent);
+		}
+		return n;
+	}
+
+	// the child with label k, made if it is missing
+	index_type add_child(index_type n, const key_type& k)
+	{
+		size_type count = nodes[n].child_count, i = 0;
+		if (count != 0)
+		{
+			i = lower_child(n, k);
+			if (i < count && !comp(k, labels_of(n)[i]))
+				return children_of(n)[i];
+		}
+		index_type m = new_node(n, k);
+		resize_children(n, count + 1);
+		key_type *l = labels_of(n);
+		index_type *c = children_of(n);
+		std::copy_backward(l + i, l + count, l + count + 1);
+		std::copy_backward(c + i, c + count, c + count + 1);
+		l[i] = k;
+		c[i] = m;
+		return m;
+	}
+
+	// take a childless node out of the block of its parent
+	void free_leaf(index_type n)
+	{
+		index_type p = parents[n];
+		size_type count = nodes[p].child_count, i = position_of(n);
+		key_type *l = labels_of(p);
+		index_type *c = children_of(p);
+		std::copy(l + i + 1, l + count, l + i);
+		std::copy(c + i + 1, c + count, c + i);
+		resize_children(p, count - 1);
+		nodes[n].children = free_node;
+		parents[n] = none();
+		free_node = n;
+		++free_node_count;
+	}
+
+	index_type new_value(const value_type& v)
+	{
+		if (free_values.empty())
+		{
+			values.push_back(v);
+			return index_type(values.size() - 1);
+		}
+		index_type s = free_values.back();
+		free_values.pop_back();
+		values[s] = v;
+		return s;
+	}
+
+	// every leaf has a value, so going down first children finds one
+	index_type first_value_from(index_type n) const
+	{
+		while (!has_value(n))
+			n = children_of(n)[0];
+		return n;
+	}
+
+	// the first node with a value after the sub-trie of n, or none
+	index_type after(index_type n) const
+	{
+		for (; n != 0; n = parents[n])
+		{
+			index_type p = parents[n];
+			size_type i = position_of(n) + 1;
+			if (i < nodes[p].child_count)
+				return first_value_from(children_of(p)[i]);
+		}
+		return none();
+	}
+
+	index_type next(index_type n) const
+	{
+		if (nodes[n].child_count != 0)
+			return first_value_from(children_of(n)[0]);
+		return after(n);
+	}
+
+	// the last node of the sub-trie in key order
+	index_type last_below(index_type n) const
+	{
+		while (nodes[n].child_count != 0)
+			n = children_of(n)[nodes[n].child_count - 1];
+		return n;
+	}
+
+	// the node with a value before n, none() for the one before the first
+	index_type prev(index_type n) const
+	{
+		if (n == none())
+		{
+			n = last_below(0);
+			return has_value(n) ? n : none();
+		}
+		while (n != 0)
+		{
+			index_type p = parents[n];
+			size_type i = position_of(n);
+			if (i != 0)
+				return last_below(children_of(p)[i - 1]);
+			if (has_value(p))
+				return p;
+			n = p;
+		}
+		return none();
+	}
+
+	index_type first() const
+	{
+		if (nodes[0].value_count == 0)
+			return none();
+		return first_value_from(0);
+	}
+
+	std::vector<key_type> key_of(index_type n) const
+	{
+		std::vector<key_type> ret;
+		for (; n != 0; n = parents[n])
+			ret.push_back(nodes[n].label);
+		return std::vector<key_type>(ret.rbegin(), ret.rend());
+	}
+
+	void swap(compact_arena& other)
+	{
+		nodes.swap(other.nodes);
+		parents.swap(other.parents);
+		values.swap(other.values);
+		pools.swap(other.pools);
+		std::swap(free_node, other.free_node);
+		std::swap(free_node_count, other.free_node_count);
+		free_values.swap(other.free_values);
+	}
+};
+
+template <class Arena, typename Reference, typename Pointer>
+struct compact_trie_iterator
+{
+	typedef std::bidirectional_iterator_tag iterator_category;
+	typedef typename Arena::key_type key_type;
+	typedef typename Arena::value_type value_type;
+	typedef typename Arena::index_type index_type;
+	typedef Reference reference;
+	typedef Pointer pointer;
+	typedef ptrdiff_t difference_type;
+	typedef compact_trie_iterator<Arena, value_type&, value_type*> iterator;
+	typedef compact_trie_iterator<Arena, Reference, Pointer> self;
+
+	const Arena *arena;
+	// Arena::none() at end()
+	index_type node;
+
+	explicit compact_trie_iterator() : arena(0), node(Arena::none())
+	{
+	}
+
+	explicit compact_trie_iterator(const Arena *a, index_type n) : arena(a), node(n)
+	{
+	}
+
+	compact_trie_iterator(const iterator& it) : arena(it.arena), node(it.node)
+	{
+	}
+
+	self& operator=(const iterator& it)
+	{
+		arena = it.arena;
+		node = it.node;
+		return *this;
+	}
+
+	std::vector<key_type> get_key() const
+	{
+		return arena->key_of(node);
+	}
+
+	reference operator*() const
+	{
+		return const_cast<reference>(arena->values[arena->nodes[node].value]);
+	}
+
+	pointer operator->() const
+	{
+		return &(operator*());
+	}
+
+	bool operator==(const self& other) const
+	{
+		return node == other.node;
+	}
+
+	bool operator!=(const self& other) const
+	{
+		return node != other.node;
+	}
+
+	self& operator++()
+	{
+		if (node != Arena::none())
+			node = arena->next(node);
+		return *this;
+	}
+
+	self operator++(int)
+	{
+		self tmp = *this;
+		++*this;
+		return tmp;
+	}
+
+	// the decrement of begin() stays at begin()
+	self& operator--()
+	{
+		index_type p = arena->prev(node);
+		if (p != Arena::none())
+			node = p;
+		return *this;
+	}
+
+	self operator--(int)
+	{
+		self tmp = *this;
+		--*this;
+		return tmp;
+	}
+};
+
+// the lookups, prefix ranges and erase of a map over an arena of nodes
+// linked by index; Arena has step(), parent_of(), has_children(),
+// free_leaf() and the walks compact_trie_iterator needs, and the map on top
+// adds insert(), clear() and swap()
+template <class Arena>
+class arena_trie_map {
+public:
+	typedef typename Arena::key_type key_type;
+	typedef typename Arena::value_type value_type;
+	typedef typename Arena::index_type index_type;
+	typedef size_t size_type;
+	typedef Arena arena_type;
+	typedef typename arena_type::node_type node_type;
+	typedef compact_trie_iterator<arena_type, value_type&, value_type*> iterator;
+	typedef compact_trie_iterator<arena_type, const value_type&, const value_type*> const_iterator;
+	typedef trie_reverse_iterator<iterator> reverse_iterator;
+	typedef trie_reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef std::pair<iterator, bool> pair_iterator_bool;
+	typedef std::pair<iterator, iterator> iterator_range;
+	typedef std::pair<const_iterator, const_iterator> const_iterator_range;
+
+protected:
+	arena_type a;
+
+	explicit arena_trie_map() : a()
+	{
+	}
+
+	explicit arena_trie_map(const arena_type& x) : a(x)
+	{
+	}
+
+	iterator make_iterator(index_type n) const
+	{
+		return iterator(&a, n);
+	}
+
+	template<typename Iter>
+	index_type find_node(Iter first, Iter last) const
+	{
+		index_type n = 0;
+		for (; first != last && n != arena_type::none(); ++first)
+			n = a.step(n, *first);
+		return n;
+	}
+
+	// the node of the key if it has a value, or none
+	template<typename Iter>
+	index_type find_value(Iter first, Iter last) const
+	{
+		index_type n = find_node(first, last);
+		if (n == arena_type::none() || !a.has_value(n))
+			return arena_type::none();
+		return n;
+	}
+
+	// the first value under the prefix and the one after them, both none if
+	// there is none
+	template<typename Iter>
+	std::pair<index_type, index_type> prefix_bounds(Iter first, Iter last) const
+	{
+		index_type n = find_node(first, last);
+		if (n == arena_type::none() || a.nodes[n].value_count == 0)
+			return std::make_pair(arena_type::none(), arena_type::none());
+		return std::make_pair(a.first_value_from(n), a.after(n));
+	}
+
+	template<typename Iter>
+	index_type longest_prefix(Iter first, Iter last) const
+	{
+		index_type n = 0, ret = a.has_value(0) ? 0 : arena_type::none();
+		for (; first != last; ++first)
+		{
+			n = a.step(n, *first);
+			if (n == arena_type::none())
+				break;
+			if (a.has_value(n))
+				ret = n;
+		}
+		return ret;
+	}
+
+	// give n, a node without a value, the value and count it up to the root
+	void add_value(index_type n, const value_type& value)
+	{
+		a.nodes[n].value = a.new_value(value);
+		for (index_type p = n; p != arena_type::none(); p = a.parent_of(p))
+			++a.nodes[p].value_count;
+	}
+
+	// drop the value of n, then the nodes left with neither a value nor a child
+	void erase_node(index_type n)
+	{
+		a.free_values.push_back(a.nodes[n].value);
+		a.values[a.nodes[n].value] = value_type();
+		a.nodes[n].value = arena_type::none();
+		for (index_type p = n; p != arena_type::none(); p = a.parent_of(p))
+			--a.nodes[p].value_count;
+		while (n != 0 && !a.has_children(n) && !a.has_value(n))
+		{
+			index_type p = a.parent_of(n);
+			a.free_leaf(n);
+			n = p;
+		}
+	}
+
+public:
+	iterator begin()
+	{
+		return make_iterator(a.first());
+	}
+
+	const_iterator begin() const
+	{
+		return make_iterator(a.first());
+	}
+
+	const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	iterator end()
+	{
+		return make_iterator(arena_type::none());
+	}
+
+	const_iterator end() const
+	{
+		return make_iterator(arena_type::none());
+	}
+
+	const_iterator cend() const
+	{
+		return end();
+	}
+
+	reverse_iterator rbegin()
+	{
+		return reverse_iterator(end());
+	}
+
+	const_reverse_iterator rbegin() const
+	{
+		return const_reverse_iterator(end());
+	}
+
+	reverse_iterator rend()
+	{
+		return reverse_iterator(begin());
+	}
+
+	const_reverse_iterator rend() const
+	{
+		return const_reverse_iterator(begin());
+	}
+
+	template<typename Iter>
+	iterator find(Iter first, Iter last)
+	{
+		return make_iterator(find_value(first, last));
+	}
+
+	template<typename Iter>
+	const_iterator find(Iter first, Iter last) const
+	{
+		return make_iterator(find_value(first, last));
+	}
+
+	template<typename Container>
+	iterator find(const Container& container)
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template<typename Container>
+	const_iterator find(const Container& container) const
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		return find_value(first, last) == arena_type::none() ? 0 : 1;
+	}
+
+	template<typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type count_prefix(Iter first, Iter last) const
+	{
+		index_type n = find_node(first, last);
+		return n == arena_type::none() ? 0 : a.nodes[n].value_count;
+	}
+
+	template<typename Container>
+	size_type count_prefix(const Container& container) const
+	{
+		return count_prefix(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	iterator_range find_prefix(Iter first, Iter last)
+	{
+		std::pair<index_type, index_type> r = prefix_bounds(first, last);
+		return std::make_pair(make_iterator(r.first), make_iterator(r.second));
+	}
+
+	template<typename Iter>
+	const_iterator_range find_prefix(Iter first, Iter last) const
+	{
+		std::pair<index_type, index_type> r = prefix_bounds(first, last);
+		return std::make_pair(const_iterator(make_iterator(r.first)), const_iterator(make_iterator(r.second)));
+	}
+
+	template<typename Container>
+	iterator_range find_prefix(const Container& container)
+	{
+		return find_prefix(container.begin(), container.end());
+	}
+
+	template<typename Container>
+	const_iterator_range find_prefix(const Container& container) const
+	{
+		return find_prefix(container.begin(), container.end());
+	}
+
+	// the longest key that is a prefix of [first, last)
+	template<typename Iter>
+	iterator findLongestPrefixOfKey(Iter first, Iter last)
+	{
+		return make_iterator(longest_prefix(first, last));
+	}
+
+	template<typename Iter>
+	const_iterator findLongestPrefixOfKey(Iter first, Iter last) const
+	{
+		return make_iterator(longest_prefix(first, last));
+	}
+
+	template<typename Container>
+	iterator findLongestPrefixOfKey(const Container& container)
+	{
+		return findLongestPrefixOfKey(container.begin(), container.end());
+	}
+
+	template<typename Container>
+	const_iterator findLongestPrefixOfKey(const Container& container) const
+	{
+		return findLongestPrefixOfKey(container.begin(), container.end());
+	}
+
+	iterator erase(const_iterator it)
+	{
+		if (it.node == arena_type::none())
+			return end();
+		index_type next = a.next(it.node);
+		erase_node(it.node);
+		return make_iterator(next);
+	}
+
+	iterator erase(iterator it)
+	{
+		return erase(const_iterator(it));
+	}
+
+	template<typename Iter>
+	size_type erase(Iter first, Iter last)
+	{
+		index_type n = find_value(first, last);
+		if (n == arena_type::none())
+			return 0;
+		erase_node(n);
+		return 1;
+	}
+
+	template<typename Container>
+	size_type erase(const Container& container)
+	{
+		return erase(container.begin(), container.end());
+	}
+
+	size_type size() const
+	{
+		return a.nodes[0].value_count;
+	}
+
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	// the root is not counted, the same as trie::count_node()
+	size_type count_node() const
+	{
+		return a.nodes.size() - a.free_node_count - 1;
+	}
+
+	// the most nodes the arena can hold with this Index
+	static size_type max_node_count()
+	{
+		return arena_type::max_node_count();
+	}
+};
+
+} // namespace detail
+
+
+template <typename Key, typename Value, class Compare = std::less<Key>,
+		 typename Index = boost::uint32_t>
+class compact_trie_map : public detail::arena_trie_map<detail::compact_arena<Key, Value, Index, Compare> > {
+public:
+	typedef detail::arena_trie_map<detail::compact_arena<Key, Value, Index, Compare> > base_type;
+	typedef compact_trie_map<Key, Value, Compare, Index> compact_trie_map_type;
+	typedef typename base_type::value_type value_type;
+	typedef typename base_type::index_type index_type;
+	typedef typename base_type::size_type size_type;
+	typedef typename base_type::arena_type arena_type;
+	typedef typename base_type::pair_iterator_bool pair_iterator_bool;
+
+	explicit compact_trie_map()
+	{
+	}
+
+	// (end(), false) when the arena can not take the new nodes
+	template<typename Iter>
+	pair_iterator_bool insert(Iter first, Iter last, const value_type& value)
+	{
+		arena_type& a = this->a;
+		index_type n = 0;
+		for (; first != last; ++first)
+		{
+			index_type c = a.child(n, *first);
+			if (c == arena_type::none())
+				break;
+			n = c;
+		}
+		if (first == last && a.has_value(n))
+			return std::make_pair(this->make_iterator(n), false);
+		size_type used = a.nodes.size() - a.free_node_count;
+		if (size_type(std::distance(first, last)) > arena_type::max_node_count() - used)
+			return std::make_pair(this->end(), false);
+		for (; first != last; ++first)
+			n = a.add_child(n, *first);
+		this->add_value(n, value);
+		return std::make_pair(this->make_iterator(n), true);
+	}
+
+	template<typename Container>
+	pair_iterator_bool insert(const Container& container, const value_type& value)
+	{
+		return insert(container.begin(), container.end(), value);
+	}
+
+	template<typename Container>
+	value_type& operator [] (const Container& container)
+	{
+		return *insert(container, value_type()).first;
+	}
+
+	void clear()
+	{
+		arena_type tmp;
+		this->a.swap(tmp);
+	}
+
+	void swap(compact_trie_map_type& other)
+	{
+		this->a.swap(other.a);
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_COMPACT_TRIE_MAP_HPP
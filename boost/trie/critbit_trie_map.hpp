@@ -0,0 +1,636 @@
+#ifndef BOOST_TRIE_CRITBIT_TRIE_MAP_HPP
+#define BOOST_TRIE_CRITBIT_TRIE_MAP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "compact_trie_map.hpp"
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstring>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+
+//
+// critbit_trie_map is a char-keyed map stored as a crit-bit tree: the leaves
+// hold whole keys, and an inner node only records the first bit where the
+// keys on its two sides differ, so a map of n keys has 2n - 1 nodes however
+// long the keys are.  A lookup follows the bits of the key to one leaf and
+// compares the key there once.  Long sparse keys such as paths and URLs,
+// where trie_map has a node per byte, are what it is for.
+//
+// A key is read as a string of 9-bit symbols, each byte plus 256 and then 0
+// past its end, so a key that is a prefix of another comes first and the
+// bytes, '\0' included, compare unsigned, the order of std::string.  The
+// nodes and the keys and values are in arenas addressed by Index as in
+// compact_trie_map; the value of the empty key is a leaf like any other.
+//
+
+namespace boost { namespace tries {
+
+namespace detail {
+
+template <typename Index>
+struct critbit_node {
+	// of an inner node, the keys with the bit clear go left
+	Index child[2];
+	// chains the free nodes too
+	Index parent;
+	// of a leaf, the slot of its key and value; none for an inner node
+	Index value;
+	// leaves in the sub-tree, 1 for a leaf
+	Index value_count;
+	// the symbol and the bit in it where the two sides differ
+	boost::uint32_t byte;
+	boost::uint16_t bit;
+};
+
+template <typename Value, typename Index>
+struct critbit_arena {
+	typedef char key_type;
+	typedef Value value_type;
+	typedef Index index_type;
+	typedef size_t size_type;
+	typedef critbit_node<index_type> node_type;
+
+	std::vector<node_type> nodes;
+	std::vector<value_type> values;
+	// the key of each leaf, by value slot
+	std::vector<std::string> keys;
+	index_type root;
+	index_type free_node;
+	size_type free_node_count;
+	std::vector<index_type> free_values;
+
+	static index_type none()
+	{
+		return index_type(-1);
+	}
+
+	static size_type max_node_count()
+	{
+		return size_type(index_type(-1)) - 1;
+	}
+
+	explicit critbit_arena() : root(none()), free_node(none()), free_node_count(0)
+	{
+	}
+
+	void reset()
+	{
+		nodes.clear();
+		values.clear();
+		keys.clear();
+		free_values.clear();
+		root = free_node = none();
+		free_node_count = 0;
+	}
+
+	bool is_leaf(index_type n) const
+	{
+		return nodes[n].value != none();
+	}
+
+	// the byte at i plus 256, 0 past the end
+	static unsigned symbol(const char *k, size_type len, size_type i)
+	{
+		return i < len ? 256u | static_cast<unsigned char>(k[i]) : 0u;
+	}
+
+	int direction(index_type n, const char *k, size_type len) const
+	{
+		return (symbol(k, len, nodes[n].byte) & nodes[n].bit) ? 1 : 0;
+	}
+
+	// the leaf the bits of k lead to, k or not
+	index_type best_leaf(const char *k, size_type len) const
+	{
+		index_type n = root;
+		while (!is_leaf(n))
+			n = nodes[n].child[direction(n, k, len)];
+		return n;
+	}
+
+	// the key of leaf n is a prefix of k
+	bool is_prefix(index_type n, const char *k, size_type len) const
+	{
+		const std::string& s = keys[nodes[n].value];
+		return s.size() <= len && std::memcmp(s.data(), k, s.size()) == 0;
+	}
+
+	index_type new_node()
+	{
+		index_type n = free_node;
+		if (n != none())
+		{
+			free_node = nodes[n].parent;
+			--free_node_count;
+		}
+		else {
+			n = index_type(nodes.size());
+			nodes.push_back(node_type());
+		}
+		node_type& x = nodes[n];
+		x.child[0] = x.child[1] = x.parent = x.value = none();
+		x.value_count = 0;
+		x.byte = 0;
+		x.bit = 0;
+		return n;
+	}
+
+	index_type new_leaf(const char *k, size_type len, const value_type& v)
+	{
+		index_type n = new_node();
+		index_type s;
+		if (free_values.empty())
+		{
+			s = index_type(values.size());
+			values.push_back(v);
+			keys.push_back(std::string(k, len));
+		}
+		else {
+			s = free_values.back();
+			free_values.pop_back();
+			values[s] = v;
+			keys[s].assign(k, len);
+		}
+		nodes[n].value = s;
+		nodes[n].value_count = 1;
+		return n;
+	}
+
+	void delete_node(index_type n)
+	{
+		if (is_leaf(n))
+		{
+			index_type s = nodes[n].value;
+			free_values.push_back(s);
+			values[s] = value_type();
+			std::string().swap(keys[s]);
+			nodes[n].value = none();
+		}
+		nodes[n].parent = free_node;
+		free_node = n;
+		++free_node_count;
+	}
+
+	index_type leftmost(index_type n) const
+	{
+		while (!is_leaf(n))
+			n = nodes[n].child[0];
+		return n;
+	}
+
+	index_type rightmost(index_type n) const
+	{
+		while (!is_leaf(n))
+			n = nodes[n].child[1];
+		return n;
+	}
+
+	// the first leaf after the sub-tree of n, or none
+	index_type next(index_type n) const
+	{
+		for (index_type p = nodes[n].parent; p != none(); n = p, p = nodes[p].parent)
+			if (nodes[p].child[0] == n)
+				return leftmost(nodes[p].child[1]);
+		return none();
+	}
+
+	// the leaf before n, none() for the one before the first
+	index_type prev(index_type n) const
+	{
+		if (n == none())
+			return root == none() ? none() : rightmost(root);
+		for (index_type p = nodes[n].parent; p != none(); n = p, p = nodes[p].parent)
+			if (nodes[p].child[1] == n)
+				return rightmost(nodes[p].child[0]);
+		return none();
+	}
+
+	index_type first() const
+	{
+		return root == none() ? none() : leftmost(root);
+	}
+
+	std::vector<key_type> key_of(index_type n) const
+	{
+		const std::string& k = keys[nodes[n].value];
+		return std::vector<key_type>(k.begin(), k.end());
+	}
+
+	void swap(critbit_arena& other)
+	{
+		nodes.swap(other.nodes);
+		values.swap(other.values);
+		keys.swap(other.keys);
+		std::swap(root, other.root);
+		std::swap(free_node, other.free_node);
+		std::swap(free_node_count, other.free_node_count);
+		free_values.swap(other.free_values);
+	}
+};
+
+} // namespace detail
+
+
+template <typename Value, typename Index = boost::uint32_t>
+class critbit_trie_map {
+public:
+	typedef char key_type;
+	typedef Value value_type;
+	typedef Index index_type;
+	typedef size_t size_type;
+	typedef critbit_trie_map<Value, Index> critbit_trie_map_type;
+	typedef detail::critbit_arena<value_type, index_type> arena_type;
+	typedef typename arena_type::node_type node_type;
+	typedef detail::compact_trie_iterator<arena_type, value_type&, value_type*> iterator;
+	typedef detail::compact_trie_iterator<arena_type, const value_type&, const value_type*> const_iterator;
+	typedef detail::trie_reverse_iterator<iterator> reverse_iterator;
+	typedef detail::trie_reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef std::pair<iterator, bool> pair_iterator_bool;
+	typedef std::pair<iterator, iterator> iterator_range;
+
+private:
+	arena_type a;
+
+	iterator make_iterator(index_type n) const
+	{
+		return iterator(&a, n);
+	}
+
+	index_type find_leaf(const char *k, size_type len) const
+	{
+		if (a.root == arena_type::none())
+			return arena_type::none();
+		index_type n = a.best_leaf(k, len);
+		const std::string& s = a.keys[a.nodes[n].value];
+		if (s.size() != len || std::memcmp(s.data(), k, len) != 0)
+			return arena_type::none();
+		return n;
+	}
+
+	std::pair<index_type, bool> insert_key(const char *k, size_type len, const value_type& value)
+	{
+		if (a.root == arena_type::none())
+		{
+			a.root = a.new_leaf(k, len, value);
+			return std::make_pair(a.root, true);
+		}
+		// the first bit where k and the leaf it leads to differ
+		index_type b = a.best_leaf(k, len);
+		const std::string& s = a.keys[a.nodes[b].value];
+		size_type i = 0, end = std::max(len, s.size());
+		while (i < end && arena_type::symbol(k, len, i) == arena_type::symbol(s.data(), s.size(), i))
+			++i;
+		if (i == end)
+			return std::make_pair(b, false);
+		unsigned bit = arena_type::symbol(k, len, i) ^ arena_type::symbol(s.data(), s.size(), i);
+		while (bit & (bit - 1))
+			bit &= bit - 1;
+		int dir = (arena_type::symbol(k, len, i) & bit) ? 1 : 0;
+		if (count_node() + 2 > arena_type::max_node_count() || i > size_type(boost::uint32_t(-1)))
+			return std::make_pair(arena_type::none(), false);
+
+		// the new inner node goes above the first node that splits later
+		index_type p = arena_type::none(), n = a.root;
+		while (!a.is_leaf(n) && (a.nodes[n].byte < i || (a.nodes[n].byte == i && a.nodes[n].bit > bit)))
+		{
+			p = n;
+			n = a.nodes[n].child[a.direction(n, k, len)];
+		}
+		index_type leaf = a.new_leaf(k, len, value);
+		index_type in = a.new_node();
+		node_type& x = a.nodes[in];
+		x.byte = boost::uint32_t(i);
+		x.bit = boost::uint16_t(bit);
+		x.child[dir] = leaf;
+		x.child[1 - dir] = n;
+		x.parent = p;
+		x.value_count = a.nodes[n].value_count + 1;
+		a.nodes[leaf].parent = in;
+		a.nodes[n].parent = in;
+		if (p == arena_type::none())
+			a.root = in;
+		else
+			a.nodes[p].child[a.nodes[p].child[1] == n ? 1 : 0] = in;
+		for (; p != arena_type::none(); p = a.nodes[p].parent)
+			++a.nodes[p].value_count;
+		return std::make_pair(leaf, true);
+	}
+
+	// the leaf goes and its sibling takes the place of the parent
+	void erase_leaf(index_type n)
+	{
+		index_type p = a.nodes[n].parent;
+		a.delete_node(n);
+		if (p == arena_type::none())
+		{
+			a.root = arena_type::none();
+			return;
+		}
+		index_type s = a.nodes[p].child[a.nodes[p].child[0] == n ? 1 : 0];
+		index_type g = a.nodes[p].parent;
+		a.nodes[s].parent = g;
+		if (g == arena_type::none())
+			a.root = s;
+		else
+			a.nodes[g].child[a.nodes[g].child[1] == p ? 1 : 0] = s;
+		a.delete_node(p);
+		for (; g != arena_type::none(); g = a.nodes[g].parent)
+			--a.nodes[g].value_count;
+	}
+
+	// the top of the sub-tree with the keys starting with k, or none
+	index_type prefix_top(const char *k, size_type len) const
+	{
+		if (a.root == arena_type::none())
+			return arena_type::none();
+		index_type n = a.root;
+		while (!a.is_leaf(n) && a.nodes[n].byte < len)
+			n = a.nodes[n].child[a.direction(n, k, len)];
+		// the keys below n agree on the first len bytes, so one of them tells
+		const std::string& s = a.keys[a.nodes[a.leftmost(n)].value];
+		if (s.size() < len || std::memcmp(s.data(), k, len) != 0)
+			return arena_type::none();
+		return n;
+	}
+
+	index_type longest_prefix(const char *k, size_type len) const
+	{
+		index_type ret = arena_type::none(), n = a.root;
+		if (n == arena_type::none())
+			return n;
+		while (!a.is_leaf(n))
+		{
+			const node_type& x = a.nodes[n];
+			// a key ending at x.byte is alone on the left of the end-of-key bit
+			if (x.bit == 0x100 && x.byte <= len && a.is_prefix(x.child[0], k, len))
+				ret = x.child[0];
+			n = x.child[a.direction(n, k, len)];
+		}
+		if (a.is_prefix(n, k, len))
+			ret = n;
+		return ret;
+	}
+
+public:
+	explicit critbit_trie_map() : a()
+	{
+	}
+
+	iterator begin()
+	{
+		return make_iterator(a.first());
+	}
+
+	const_iterator begin() const
+	{
+		return make_iterator(a.first());
+	}
+
+	const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	iterator end()
+	{
+		return make_iterator(arena_type::none());
+	}
+
+	const_iterator end() const
+	{
+		return make_iterator(arena_type::none());
+	}
+
+	const_iterator cend() const
+	{
+		return end();
+	}
+
+	reverse_iterator rbegin()
+	{
+		return reverse_iterator(end());
+	}
+
+	const_reverse_iterator rbegin() const
+	{
+		return const_reverse_iterator(end());
+	}
+
+	reverse_iterator rend()
+	{
+		return reverse_iterator(begin());
+	}
+
+	const_reverse_iterator rend() const
+	{
+		return const_reverse_iterator(begin());
+	}
+
+	// (end(), false) when the arena can not take the new nodes
+	pair_iterator_bool insert(const std::string& key, const value_type& value)
+	{
+		std::pair<index_type, bool> p = insert_key(key.data(), key.size(), value);
+		return std::make_pair(make_iterator(p.first), p.second);
+	}
+
+	template<typename Iter>
+	pair_iterator_bool insert(Iter first, Iter last, const value_type& value)
+	{
+		return insert(std::string(first, last), value);
+	}
+
+	template<typename Container>
+	pair_iterator_bool insert(const Container& container, const value_type& value)
+	{
+		return insert(container.begin(), container.end(), value);
+	}
+
+	template<typename Container>
+	value_type& operator [] (const Container& container)
+	{
+		return *insert(container, value_type()).first;
+	}
+
+	iterator find(const std::string& key)
+	{
+		return make_iterator(find_leaf(key.data(), key.size()));
+	}
+
+	const_iterator find(const std::string& key) const
+	{
+		return make_iterator(find_leaf(key.data(), key.size()));
+	}
+
+	template<typename Iter>
+	iterator find(Iter first, Iter last)
+	{
+		return find(std::string(first, last));
+	}
+
+	template<typename Iter>
+	const_iterator find(Iter first, Iter last) const
+	{
+		return find(std::string(first, last));
+	}
+
+	template<typename Container>
+	iterator find(const Container& container)
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template<typename Container>
+	const_iterator find(const Container& container) const
+	{
+		return find(container.begin(), container.end());
+	}
+
+	size_type count(const std::string& key) const
+	{
+		return find_leaf(key.data(), key.size()) == arena_type::none() ? 0 : 1;
+	}
+
+	template<typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		return count(std::string(first, last));
+	}
+
+	template<typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	size_type count_prefix(const std::string& prefix) const
+	{
+		index_type n = prefix_top(prefix.data(), prefix.size());
+		return n == arena_type::none() ? 0 : a.nodes[n].value_count;
+	}
+
+	template<typename Iter>
+	size_type count_prefix(Iter first, Iter last) const
+	{
+		return count_prefix(std::string(first, last));
+	}
+
+	template<typename Container>
+	size_type count_prefix(const Container& container) const
+	{
+		return count_prefix(container.begin(), container.end());
+	}
+
+	iterator_range find_prefix(const std::string& prefix)
+	{
+		index_type n = prefix_top(prefix.data(), prefix.size());
+		if (n == arena_type::none())
+			return std::make_pair(end(), end());
+		return std::make_pair(make_iterator(a.leftmost(n)), make_iterator(a.next(n)));
+	}
+
+	template<typename Iter>
+	iterator_range find_prefix(Iter first, Iter last)
+	{
+		return find_prefix(std::string(first, last));
+	}
+
+	template<typename Container>
+	iterator_range find_prefix(const Container& container)
+	{
+		return find_prefix(container.begin(), container.end());
+	}
+
+	// the longest key that is a prefix of the key, the empty key included
+	iterator findLongestPrefixOfKey(const std::string& key)
+	{
+		return make_iterator(longest_prefix(key.data(), key.size()));
+	}
+
+	template<typename Iter>
+	iterator findLongestPrefixOfKey(Iter first, Iter last)
+	{
+		return findLongestPrefixOfKey(std::string(first, last));
+	}
+
+	template<typename Container>
+	iterator findLongestPrefixOfKey(const Container& container)
+	{
+		return findLongestPrefixOfKey(container.begin(), container.end());
+	}
+
+	iterator erase(const_iterator it)
+	{
+		if (it.node == arena_type::none())
+			return end();
+		index_type next = a.next(it.node);
+		erase_leaf(it.node);
+		return make_iterator(next);
+	}
+
+	iterator erase(iterator it)
+	{
+		return erase(const_iterator(it));
+	}
+
+	size_type erase(const std::string& key)
+	{
+		index_type n = find_leaf(key.data(), key.size());
+		if (n == arena_type::none())
+			return 0;
+		erase_leaf(n);
+		return 1;
+	}
+
+	template<typename Iter>
+	size_type erase(Iter first, Iter last)
+	{
+		return erase(std::string(first, last));
+	}
+
+	template<typename Container>
+	size_type erase(const Container& container)
+	{
+		return erase(container.begin(), container.end());
+	}
+
+	void clear()
+	{
+		a.reset();
+	}
+
+	void swap(critbit_trie_map_type& other)
+	{
+		a.swap(other.a);
+	}
+
+	size_type size() const
+	{
+		return a.root == arena_type::none() ? 0 : a.nodes[a.root].value_count;
+	}
+
+	bool empty() const
+	{
+		return a.root == arena_type::none();
+	}
+
+	// the leaves and the inner nodes, 2 * size() - 1
+	size_type count_node() const
+	{
+		return a.nodes.size() - a.free_node_count;
+	}
+
+	// the most nodes the arena can hold with this Index
+	static size_type max_node_count()
+	{
+		return arena_type::max_node_count();
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_CRITBIT_TRIE_MAP_HPP
@@ -0,0 +1,1363 @@
+#ifndef BOOST_TRIE_CTRIE_MAP_HPP
+#define BOOST_TRIE_CTRIE_MAP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <functional>
+#include <boost/atomic.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/utility.hpp>
+
+//
+// ctrie_map is a lock-free concurrent trie after Prokopec et al., "Concurrent
+// Tries with Efficient Non-Blocking Snapshots".  Keys are sequences of Key
+// elements, as in trie_map, but they are dispatched on a hash of the whole
+// sequence, so iteration order is unspecified.
+//
+// Every update is a CAS on an indirection node (inode).  Snapshots are taken in
+// constant time by swapping the root for a copy tagged with a new generation;
+// nodes of an older generation are copied lazily when a writer walks into them.
+//
+// A map and its snapshots share nodes, so every node counts the references to
+// it from other nodes and from the roots, and is freed with the last one.
+// A node taken out of a trie may still be read by other threads, so its
+// reference is dropped through epoch-based reclamation: each operation pins
+// the current epoch, and a retired reference is dropped once no operation
+// pinned at or before the epoch of the retirement is left.
+//
+
+namespace boost { namespace tries {
+
+namespace detail { namespace ctrie {
+
+enum node_kind {
+	inode_kind, cnode_kind, tnode_kind, lnode_kind,
+	snode_kind, failed_kind, desc_kind, gen_kind
+};
+
+struct object : private boost::noncopyable {
+	node_kind kind;
+	// references from other objects and from the roots
+	boost::atomic<long> refs;
+
+	explicit object(node_kind k) : kind(k), refs(0)
+	{
+	}
+
+	virtual ~object()
+	{
+	}
+};
+
+template <typename T>
+T * hold(T *p)
+{
+	p->refs.fetch_add(1, boost::memory_order_relaxed);
+	return p;
+}
+
+struct gen : public object {
+	explicit gen() : object(gen_kind)
+	{
+	}
+};
+
+struct main_node : public object {
+	// the main node replaced by a gcas still in progress, or the failed_node
+	// of one that is rolled back, which the main node owns
+	boost::atomic<main_node *> prev;
+
+	explicit main_node(node_kind k) : object(k), prev(0)
+	{
+	}
+};
+
+// marks a gcas that has to be rolled back to prev
+struct failed_node : public main_node {
+	explicit failed_node(main_node *p) : main_node(failed_kind)
+	{
+		prev.store(p);
+	}
+};
+
+struct inode : public object {
+	boost::atomic<main_node *> main;
+	gen *g;
+
+	explicit inode(main_node *m, gen *gn) : object(inode_kind), main(m), g(gn)
+	{
+	}
+};
+
+// array holds inodes and snodes
+struct cnode : public main_node {
+	boost::uint32_t bitmap;
+	std::vector<object *> array;
+	gen *g;
+
+	explicit cnode(gen *gn) : main_node(cnode_kind), bitmap(0), g(gn)
+	{
+	}
+};
+
+// tomb node: a single snode that has to be pulled up into the parent
+struct tnode : public main_node {
+	object *sn;
+
+	explicit tnode(object *s) : main_node(tnode_kind), sn(s)
+	{
+	}
+};
+
+// list of snodes whose hash codes collide completely
+struct lnode : public main_node {
+	std::vector<object *> entries;
+
+	explicit lnode() : main_node(lnode_kind)
+	{
+	}
+};
+
+enum rdcss_state { rdcss_undecided, rdcss_committed, rdcss_aborted };
+
+struct rdcss_descriptor : public object {
+	inode *ov;
+	main_node *expected_main;
+	// held by the descriptor until the root takes it
+	inode *nv;
+	boost::atomic<int> state;
+
+	explicit rdcss_descriptor(inode *o, main_node *e, inode *n) :
+		object(desc_kind), ov(o), expected_main(e), nv(n), state(rdcss_undecided)
+	{
+	}
+};
+
+template <typename Key, typename Value>
+struct snode : public object {
+	typedef std::vector<Key> key_type;
+	key_type key;
+	boost::uint32_t hc;
+	Value value;
+
+	explicit snode(const key_type& k, boost::uint32_t h, const Value& v) :
+		object(snode_kind), key(k), hc(h), value(v)
+	{
+	}
+};
+
+// the epochs and retired references shared by a map and all of its snapshots
+struct reclaimer : private boost::noncopyable {
+	struct limbo_entry {
+		object *obj;
+		limbo_entry *next;
+	};
+
+	boost::atomic<boost::uint64_t> epoch;
+	// operations pinned at each epoch, by epoch % 3
+	boost::atomic<size_t> active[3];
+	// references retired at each epoch, by epoch % 3
+	boost::atomic<limbo_entry *> limbo[3];
+	boost::atomic<bool> advancing;
+	// objects not freed yet
+	boost::atomic<size_t> live;
+
+	explicit reclaimer() : epoch(0), advancing(false), live(0)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			active[i].store(0);
+			limbo[i].store(0);
+		}
+	}
+
+	template <typename T>
+	T * track(T *p)
+	{
+		live.fetch_add(1, boost::memory_order_relaxed);
+		return p;
+	}
+
+	// drop a reference of an object no thread can reach any more through it
+	void release(object *p)
+	{
+		if (p->refs.fetch_sub(1, boost::memory_order_acq_rel) == 1)
+			destroy(p);
+	}
+
+	// free an object without references, and what is left without them
+	void destroy(object *p)
+	{
+		std::vector<object *> stk(1, p);
+		while (!stk.empty())
+		{
+			object *cur = stk.back();
+			stk.pop_back();
+			switch (cur->kind)
+			{
+			case inode_kind:
+				drop(static_cast<inode *>(cur)->main.load(), stk);
+				drop(static_cast<inode *>(cur)->g, stk);
+				break;
+			case cnode_kind:
+			{
+				cnode *cn = static_cast<cnode *>(cur);
+				for (size_t i = 0; i < cn->array.size(); ++i)
+					drop(cn->array[i], stk);
+				drop(cn->g, stk);
+				break;
+			}
+			case tnode_kind:
+				drop(static_cast<tnode *>(cur)->sn, stk);
+				break;
+			case lnode_kind:
+			{
+				lnode *ln = static_cast<lnode *>(cur);
+				for (size_t i = 0; i < ln->entries.size(); ++i)
+					drop(ln->entries[i], stk);
+				break;
+			}
+			default:
+				break;
+			}
+			if (cur->kind == cnode_kind || cur->kind == tnode_kind || cur->kind == lnode_kind)
+			{
+				main_node *prev = static_cast<main_node *>(cur)->prev.load();
+				if (prev != 0 && prev->kind == failed_kind)
+					drop(prev, stk);
+			}
+			delete cur;
+			live.fetch_sub(1, boost::memory_order_relaxed);
+		}
+	}
+
+	static void drop(object *p, std::vector<object *>& stk)
+	{
+		if (p->refs.fetch_sub(1, boost::memory_order_acq_rel) == 1)
+			stk.push_back(p);
+	}
+
+	boost::uint64_t pin()
+	{
+		for (;;)
+		{
+			boost::uint64_t e = epoch.load();
+			active[e % 3].fetch_add(1);
+			if (epoch.load() == e)
+				return e;
+			active[e % 3].fetch_sub(1);
+		}
+	}
+
+	void unpin(boost::uint64_t e)
+	{
+		active[e % 3].fetch_sub(1);
+		if (limbo[0].load() != 0 || limbo[1].load() != 0 || limbo[2].load() != 0)
+			try_advance();
+	}
+
+	// a reference taken out of a trie, dropped when the pins of now are gone
+	void retire(object *p)
+	{
+		limbo_entry *x = new limbo_entry();
+		x->obj = p;
+		boost::atomic<limbo_entry *>& head = limbo[epoch.load() % 3];
+		limbo_entry *h = head.load();
+		do {
+			x->next = h;
+		} while (!head.compare_exchange_weak(h, x));
+	}
+
+	// when nothing is pinned before epoch e, what was retired before e goes
+	// and the epoch moves to e + 1; skipped while another thread does it
+	void try_advance()
+	{
+		if (advancing.exchange(true))
+			return;
+		limbo_entry *l = 0;
+		boost::uint64_t e = epoch.load();
+		if (active[(e + 2) % 3].load() == 0)
+		{
+			l = limbo[(e + 2) % 3].exchange(0);
+			epoch.store(e + 1);
+		}
+		advancing.store(false);
+		drain(l);
+	}
+
+	void drain(limbo_entry *l)
+	{
+		while (l != 0)
+		{
+			limbo_entry *next = l->next;
+			release(l->obj);
+			delete l;
+			l = next;
+		}
+	}
+
+	~reclaimer()
+	{
+		for (int i = 0; i < 3; ++i)
+			drain(limbo[i].exchange(0));
+	}
+};
+
+// pins the epoch for the duration of an operation
+class epoch_guard : private boost::noncopyable {
+	reclaimer& r;
+	boost::uint64_t e;
+
+public:
+	explicit epoch_guard(reclaimer& x) : r(x), e(x.pin())
+	{
+	}
+
+	~epoch_guard()
+	{
+		r.unpin(e);
+	}
+};
+
+inline unsigned popcount(boost::uint32_t x)
+{
+	x = x - ((x >> 1) & 0x55555555u);
+	x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+	x = (x + (x >> 4)) & 0x0f0f0f0fu;
+	return (x * 0x01010101u) >> 24;
+}
+
+template <typename Key, typename Value, class Hash, class Pred>
+class ctrie_impl : private boost::noncopyable {
+public:
+	typedef Key key_elem_type;
+	typedef std::vector<key_elem_type> key_type;
+	typedef Value value_type;
+	typedef snode<key_elem_type, value_type> snode_type;
+	typedef snode_type * snode_ptr;
+	typedef boost::shared_ptr<reclaimer> reclaimer_ptr;
+
+	enum op_result { op_ok, op_not_found, op_restart };
+	enum insert_cond { insert_always, insert_if_absent };
+
+private:
+	// holds a reference to the root inode
+	boost::atomic<object *> root;
+	bool read_only;
+	reclaimer_ptr rec;
+	Hash hasher;
+	Pred pred;
+
+	static const int level_bits = 5;
+	static const int max_level = 35;
+
+	static boost::uint32_t index_of(boost::uint32_t hc, int lev)
+	{
+		return (hc >> lev) & 0x1f;
+	}
+
+	bool key_equal(const key_type& a, const key_type& b) const
+	{
+		if (a.size() != b.size())
+			return false;
+		for (size_t i = 0; i < a.size(); ++i)
+			if (!pred(a[i], b[i]))
+				return false;
+		return true;
+	}
+
+	// the new objects have no references yet, the ones they point to are held
+
+	gen * new_gen()
+	{
+		return rec->track(new gen());
+	}
+
+	inode * new_inode(main_node *m, gen *g)
+	{
+		return rec->track(new inode(hold(m), hold(g)));
+	}
+
+	snode_ptr new_snode(const key_type& k, boost::uint32_t hc, const value_type& v)
+	{
+		return rec->track(new snode_type(k, hc, v));
+	}
+
+	cnode * new_cnode(gen *g)
+	{
+		return rec->track(new cnode(hold(g)));
+	}
+
+	inode * new_root()
+	{
+		gen *g = new_gen();
+		return new_inode(new_cnode(g), g);
+	}
+
+	explicit ctrie_impl(inode *r, bool ro, const reclaimer_ptr& p) :
+		root(hold(r)), read_only(ro), rec(p), hasher(), pred()
+	{
+	}
+
+public:
+	explicit ctrie_impl() : root(0), read_only(false), rec(new reclaimer()), hasher(), pred()
+	{
+		root.store(hold(new_root()));
+	}
+
+	bool is_read_only() const
+	{
+		return read_only;
+	}
+
+	reclaimer& reclamation() const
+	{
+		return *rec;
+	}
+
+	// the objects of the map and its snapshots not freed yet
+	size_t count_node() const
+	{
+		return rec->live.load();
+	}
+
+	template <typename Iter>
+	boost::uint32_t hash_key(Iter first, Iter last) const
+	{
+		size_t seed = 0;
+		for (; first != last; ++first)
+			boost::hash_combine(seed, hasher(*first));
+		boost::uint64_t h = seed;
+		return static_cast<boost::uint32_t>(h ^ (h >> 32));
+	}
+
+	// root handling: a restricted double-compare single-swap on the root
+	inode * read_root(bool abort = false)
+	{
+		object *r = root.load();
+		if (r->kind == inode_kind)
+			return static_cast<inode *>(r);
+		return rdcss_complete(abort);
+	}
+
+	// the first thread to decide commits or aborts the descriptor, the one
+	// that swings the root retires what the root no longer holds
+	inode * rdcss_complete(bool abort)
+	{
+		for (;;)
+		{
+			object *v = root.load();
+			if (v->kind == inode_kind)
+				return static_cast<inode *>(v);
+			rdcss_descriptor *desc = static_cast<rdcss_descriptor *>(v);
+			int s = desc->state.load();
+			if (s == rdcss_undecided)
+			{
+				int decided = !abort && gcas_read(desc->ov) == desc->expected_main ? rdcss_committed : rdcss_aborted;
+				desc->state.compare_exchange_strong(s, decided);
+				s = desc->state.load();
+			}
+			inode *next = s == rdcss_committed ? desc->nv : desc->ov;
+			object *expected = desc;
+			if (root.compare_exchange_strong(expected, next))
+			{
+				rec->retire(s == rdcss_committed ? desc->ov : desc->nv);
+				rec->retire(desc);
+				return next;
+			}
+		}
+	}
+
+	bool rdcss_root(inode *ov, main_node *expected_main, inode *nv)
+	{
+		rdcss_descriptor *desc = hold(rec->track(new rdcss_descriptor(ov, expected_main, hold(nv))));
+		object *expected = ov;
+		if (root.compare_exchange_strong(expected, desc))
+		{
+			rdcss_complete(false);
+			return desc->state.load() == rdcss_committed;
+		}
+		rec->release(desc);
+		rec->release(nv);
+		return false;
+	}
+
+	// generation-compare-and-swap on the main node of an inode; while it is
+	// in progress the inode holds both the old and the new main node, and the
+	// thread that commits or rolls it back retires the one that is left
+	main_node * gcas_complete(inode *in, main_node *m)
+	{
+		for (;;)
+		{
+			if (m == 0)
+				return 0;
+			main_node *prev = m->prev.load();
+			inode *ctr = read_root(true);
+			if (prev == 0)
+				return m;
+			if (prev->kind == failed_kind)
+			{
+				main_node *expected = m;
+				main_node *restored = prev->prev.load();
+				if (in->main.compare_exchange_strong(expected, restored))
+				{
+					rec->retire(m);
+					return restored;
+				}
+				m = in->main.load();
+				continue;
+			}
+			if (ctr->g == in->g && !read_only)
+			{
+				if (m->prev.compare_exchange_strong(prev, 0))
+				{
+					rec->retire(prev);
+					return m;
+				}
+				continue;
+			}
+			failed_node *f = hold(rec->track(new failed_node(prev)));
+			if (!m->prev.compare_exchange_strong(prev, f))
+				rec->release(f);
+			m = in->main.load();
+		}
+	}
+
+	// new_main is freed if it does not get in
+	bool gcas(inode *in, main_node *old_main, main_node *new_main)
+	{
+		new_main->prev.store(old_main);
+		hold(new_main);
+		main_node *expected = old_main;
+		if (in->main.compare_exchange_strong(expected, new_main))
+		{
+			gcas_complete(in, new_main);
+			return new_main->prev.load() == 0;
+		}
+		rec->release(new_main);
+		return false;
+	}
+
+	main_node * gcas_read(inode *in)
+	{
+		main_node *m = in->main.load();
+		if (m->prev.load() == 0)
+			return m;
+		return gcas_complete(in, m);
+	}
+
+	inode * copy_to_gen(inode *in, gen *g)
+	{
+		return new_inode(gcas_read(in), g);
+	}
+
+private:
+	cnode * renewed(cnode *cn, gen *g)
+	{
+		cnode *ncn = new_cnode(g);
+		ncn->bitmap = cn->bitmap;
+		ncn->array.reserve(cn->array.size());
+		for (size_t i = 0; i < cn->array.size(); ++i)
+		{
+			object *sub = cn->array[i];
+			if (sub->kind == inode_kind)
+				ncn->array.push_back(hold(copy_to_gen(static_cast<inode *>(sub), g)));
+			else
+				ncn->array.push_back(hold(sub));
+		}
+		return ncn;
+	}
+
+	// the array of cn without the entry at skip, each entry held again
+	static void copy_array(cnode *cn, std::vector<object *>& array, size_t skip)
+	{
+		array.reserve(cn->array.size() + 1);
+		for (size_t i = 0; i < cn->array.size(); ++i)
+			if (i != skip)
+				array.push_back(hold(cn->array[i]));
+	}
+
+	cnode * updated_at(cnode *cn, size_t pos, object *sub, gen *g)
+	{
+		cnode *ncn = new_cnode(g);
+		ncn->bitmap = cn->bitmap;
+		copy_array(cn, ncn->array, pos);
+		ncn->array.insert(ncn->array.begin() + pos, hold(sub));
+		return ncn;
+	}
+
+	cnode * inserted_at(cnode *cn, size_t pos, boost::uint32_t flag, object *sub, gen *g)
+	{
+		cnode *ncn = new_cnode(g);
+		ncn->bitmap = cn->bitmap | flag;
+		copy_array(cn, ncn->array, size_t(-1));
+		ncn->array.insert(ncn->array.begin() + pos, hold(sub));
+		return ncn;
+	}
+
+	cnode * removed_at(cnode *cn, size_t pos, boost::uint32_t flag, gen *g)
+	{
+		cnode *ncn = new_cnode(g);
+		ncn->bitmap = cn->bitmap ^ flag;
+		copy_array(cn, ncn->array, pos);
+		return ncn;
+	}
+
+	// cn is new, it is freed when a tnode takes its place
+	main_node * to_contracted(cnode *cn, int lev)
+	{
+		if (lev > 0 && cn->array.size() == 1 && cn->array[0]->kind == snode_kind)
+		{
+			tnode *tn = rec->track(new tnode(hold(cn->array[0])));
+			rec->destroy(cn);
+			return tn;
+		}
+		return cn;
+	}
+
+	object * resurrect(object *sub)
+	{
+		if (sub->kind != inode_kind)
+			return sub;
+		main_node *m = gcas_read(static_cast<inode *>(sub));
+		if (m->kind == tnode_kind)
+			return static_cast<tnode *>(m)->sn;
+		return sub;
+	}
+
+	main_node * to_compressed(cnode *cn, int lev, gen *g)
+	{
+		cnode *ncn = new_cnode(g);
+		ncn->bitmap = cn->bitmap;
+		ncn->array.reserve(cn->array.size());
+		for (size_t i = 0; i < cn->array.size(); ++i)
+			ncn->array.push_back(hold(resurrect(cn->array[i])));
+		return to_contracted(ncn, lev);
+	}
+
+	void clean(inode *in, int lev)
+	{
+		main_node *m = gcas_read(in);
+		if (m->kind == cnode_kind)
+			gcas(in, m, to_compressed(static_cast<cnode *>(m), lev, in->g));
+	}
+
+	void clean_parent(main_node *non_live, inode *in, inode *parent,
+			boost::uint32_t hc, int lev, gen *startgen)
+	{
+		for (;;)
+		{
+			main_node *pm = gcas_read(parent);
+			if (pm->kind != cnode_kind)
+				return;
+			cnode *cn = static_cast<cnode *>(pm);
+			boost::uint32_t flag = 1u << index_of(hc, lev - level_bits);
+			if ((cn->bitmap & flag) == 0)
+				return;
+			size_t pos = popcount(cn->bitmap & (flag - 1));
+			if (cn->array[pos] != in || non_live->kind != tnode_kind)
+				return;
+			object *sn = static_cast<tnode *>(non_live)->sn;
+			main_node *ncn = to_contracted(updated_at(cn, pos, sn, in->g), lev - level_bits);
+			if (gcas(parent, cn, ncn))
+				return;
+			if (read_root()->g != startgen)
+				return;
+		}
+	}
+
+	main_node * dual(snode_ptr x, snode_ptr y, int lev, gen *g)
+	{
+		if (lev < max_level)
+		{
+			boost::uint32_t xidx = index_of(x->hc, lev);
+			boost::uint32_t yidx = index_of(y->hc, lev);
+			cnode *cn = new_cnode(g);
+			cn->bitmap = (1u << xidx) | (1u << yidx);
+			if (xidx == yidx)
+			{
+				cn->array.push_back(hold(new_inode(dual(x, y, lev + level_bits, g), g)));
+			}
+			else if (xidx < yidx) {
+				cn->array.push_back(hold(x));
+				cn->array.push_back(hold(y));
+			}
+			else {
+				cn->array.push_back(hold(y));
+				cn->array.push_back(hold(x));
+			}
+			return cn;
+		}
+		lnode *ln = rec->track(new lnode());
+		ln->entries.push_back(hold(x));
+		ln->entries.push_back(hold(y));
+		return ln;
+	}
+
+	op_result rec_lookup(inode *in, const key_type& key, boost::uint32_t hc, int lev,
+			inode *parent, gen *startgen, snode_ptr& found)
+	{
+		for (;;)
+		{
+			main_node *m = gcas_read(in);
+			if (m->kind == cnode_kind)
+			{
+				cnode *cn = static_cast<cnode *>(m);
+				boost::uint32_t flag = 1u << index_of(hc, lev);
+				if ((cn->bitmap & flag) == 0)
+					return op_not_found;
+				size_t pos = popcount(cn->bitmap & (flag - 1));
+				object *sub = cn->array[pos];
+				if (sub->kind == inode_kind)
+				{
+					inode *sin = static_cast<inode *>(sub);
+					if (read_only || sin->g == startgen)
+						return rec_lookup(sin, key, hc, lev + level_bits, in, startgen, found);
+					if (gcas(in, cn, renewed(cn, startgen)))
+						continue;
+					return op_restart;
+				}
+				snode_ptr sn = static_cast<snode_ptr>(sub);
+				if (sn->hc == hc && key_equal(sn->key, key))
+				{
+					found = sn;
+					return op_ok;
+				}
+				return op_not_found;
+			}
+			if (m->kind == tnode_kind)
+			{
+				if (!read_only)
+				{
+					clean(parent, lev - level_bits);
+					return op_restart;
+				}
+				snode_ptr sn = static_cast<snode_ptr>(static_cast<tnode *>(m)->sn);
+				if (sn->hc == hc && key_equal(sn->key, key))
+				{
+					found = sn;
+					return op_ok;
+				}
+				return op_not_found;
+			}
+			lnode *ln = static_cast<lnode *>(m);
+			for (size_t i = 0; i < ln->entries.size(); ++i)
+			{
+				snode_ptr sn = static_cast<snode_ptr>(ln->entries[i]);
+				if (key_equal(sn->key, key))
+				{
+					found = sn;
+					return op_ok;
+				}
+			}
+			return op_not_found;
+		}
+	}
+
+	op_result rec_insert(inode *in, const key_type& key, boost::uint32_t hc, const value_type& value,
+			int lev, inode *parent, gen *startgen, insert_cond cond, bool& existed)
+	{
+		for (;;)
+		{
+			main_node *m = gcas_read(in);
+			if (m->kind == cnode_kind)
+			{
+				cnode *cn = static_cast<cnode *>(m);
+				boost::uint32_t flag = 1u << index_of(hc, lev);
+				size_t pos = popcount(cn->bitmap & (flag - 1));
+				if ((cn->bitmap & flag) == 0)
+				{
+					cnode *rn = cn->g == in->g ? cn : renewed(cn, in->g);
+					cnode *ncn = inserted_at(rn, pos, flag, new_snode(key, hc, value), in->g);
+					if (rn != cn)
+						rec->destroy(rn);
+					return gcas(in, cn, ncn) ? op_ok : op_restart;
+				}
+				object *sub = cn->array[pos];
+				if (sub->kind == inode_kind)
+				{
+					inode *sin = static_cast<inode *>(sub);
+					if (sin->g == startgen)
+						return rec_insert(sin, key, hc, value, lev + level_bits, in, startgen, cond, existed);
+					if (gcas(in, cn, renewed(cn, startgen)))
+						continue;
+					return op_restart;
+				}
+				snode_ptr sn = static_cast<snode_ptr>(sub);
+				if (sn->hc == hc && key_equal(sn->key, key))
+				{
+					existed = true;
+					if (cond == insert_if_absent)
+						return op_ok;
+					cnode *ncn = updated_at(cn, pos, new_snode(key, hc, value), in->g);
+					return gcas(in, cn, ncn) ? op_ok : op_restart;
+				}
+				cnode *rn = cn->g == in->g ? cn : renewed(cn, in->g);
+				inode *nin = new_inode(dual(sn, new_snode(key, hc, value), lev + level_bits, in->g), in->g);
+				cnode *ncn = updated_at(rn, pos, nin, in->g);
+				if (rn != cn)
+					rec->destroy(rn);
+				return gcas(in, cn, ncn) ? op_ok : op_restart;
+			}
+			if (m->kind == tnode_kind)
+			{
+				clean(parent, lev - level_bits);
+				return op_restart;
+			}
+			lnode *ln = static_cast<lnode *>(m);
+			size_t i = 0;
+			for (; i < ln->entries.size(); ++i)
+				if (key_equal(static_cast<snode_ptr>(ln->entries[i])->key, key))
+					break;
+			if (i < ln->entries.size())
+			{
+				existed = true;
+				if (cond == insert_if_absent)
+					return op_ok;
+			}
+			lnode *nln = rec->track(new lnode());
+			for (size_t j = 0; j < ln->entries.size(); ++j)
+				nln->entries.push_back(hold(j == i ? new_snode(key, hc, value) : ln->entries[j]));
+			if (i == ln->entries.size())
+				nln->entries.push_back(hold(new_snode(key, hc, value)));
+			return gcas(in, ln, nln) ? op_ok : op_restart;
+		}
+	}
+
+	op_result rec_remove(inode *in, const key_type& key, boost::uint32_t hc, int lev,
+			inode *parent, gen *startgen)
+	{
+		for (;;)
+		{
+			main_node *m = gcas_read(in);
+			if (m->kind == cnode_kind)
+			{
+				cnode *cn = static_cast<cnode *>(m);
+				boost::uint32_t flag = 1u << index_of(hc, lev);
+				if ((cn->bitmap & flag) == 0)
+					return op_not_found;
+				size_t pos = popcount(cn->bitmap & (flag - 1));
+				object *sub = cn->array[pos];
+				op_result res;
+				if (sub->kind == inode_kind)
+				{
+					inode *sin = static_cast<inode *>(sub);
+					if (sin->g != startgen)
+					{
+						if (gcas(in, cn, renewed(cn, startgen)))
+							continue;
+						return op_restart;
+					}
+					res = rec_remove(sin, key, hc, lev + level_bits, in, startgen);
+				}
+				else {
+					snode_ptr sn = static_cast<snode_ptr>(sub);
+					if (sn->hc != hc || !key_equal(sn->key, key))
+						return op_not_found;
+					main_node *ncn = to_contracted(removed_at(cn, pos, flag, in->g), lev);
+					res = gcas(in, cn, ncn) ? op_ok : op_restart;
+				}
+				if (res == op_ok && parent != 0)
+				{
+					// never tomb at root
+					main_node *n = gcas_read(in);
+					if (n->kind == tnode_kind)
+						clean_parent(n, in, parent, hc, lev, startgen);
+				}
+				return res;
+			}
+			if (m->kind == tnode_kind)
+			{
+				clean(parent, lev - level_bits);
+				return op_restart;
+			}
+			lnode *ln = static_cast<lnode *>(m);
+			size_t i = 0;
+			for (; i < ln->entries.size(); ++i)
+				if (key_equal(static_cast<snode_ptr>(ln->entries[i])->key, key))
+					break;
+			if (i == ln->entries.size())
+				return op_not_found;
+			main_node *nm;
+			if (ln->entries.size() == 2)
+			{
+				nm = rec->track(new tnode(hold(ln->entries[1 - i])));
+			}
+			else {
+				lnode *nln = rec->track(new lnode());
+				for (size_t j = 0; j < ln->entries.size(); ++j)
+					if (j != i)
+						nln->entries.push_back(hold(ln->entries[j]));
+				nm = nln;
+			}
+			return gcas(in, ln, nm) ? op_ok : op_restart;
+		}
+	}
+
+public:
+	// copies the value out while the snode can not be freed
+	template <typename Iter>
+	bool lookup(Iter first, Iter last, value_type *value)
+	{
+		key_type key(first, last);
+		boost::uint32_t hc = hash_key(key.begin(), key.end());
+		epoch_guard guard(*rec);
+		for (;;)
+		{
+			inode *r = read_root();
+			snode_ptr found = 0;
+			op_result res = rec_lookup(r, key, hc, 0, 0, r->g, found);
+			if (res == op_restart)
+				continue;
+			if (found != 0 && value != 0)
+				*value = found->value;
+			return found != 0;
+		}
+	}
+
+	// returns false on a read-only snapshot, otherwise sets existed when the key was there
+	template <typename Iter>
+	bool insert(Iter first, Iter last, const value_type& value, insert_cond cond, bool& existed)
+	{
+		if (read_only)
+			return false;
+		key_type key(first, last);
+		boost::uint32_t hc = hash_key(key.begin(), key.end());
+		epoch_guard guard(*rec);
+		for (;;)
+		{
+			inode *r = read_root();
+			existed = false;
+			if (rec_insert(r, key, hc, value, 0, 0, r->g, cond, existed) != op_restart)
+				return true;
+		}
+	}
+
+	template <typename Iter>
+	bool remove(Iter first, Iter last)
+	{
+		if (read_only)
+			return false;
+		key_type key(first, last);
+		boost::uint32_t hc = hash_key(key.begin(), key.end());
+		epoch_guard guard(*rec);
+		for (;;)
+		{
+			inode *r = read_root();
+			op_result res = rec_remove(r, key, hc, 0, 0, r->g);
+			if (res != op_restart)
+				return res == op_ok;
+		}
+	}
+
+	// whether a key is reachable from the root now, no snapshot is taken
+	bool has_entries()
+	{
+		epoch_guard guard(*rec);
+		std::vector<main_node *> stk(1, gcas_read(read_root()));
+		while (!stk.empty())
+		{
+			main_node *m = stk.back();
+			stk.pop_back();
+			if (m->kind == tnode_kind)
+				return true;
+			if (m->kind == lnode_kind)
+			{
+				if (!static_cast<lnode *>(m)->entries.empty())
+					return true;
+				continue;
+			}
+			cnode *cn = static_cast<cnode *>(m);
+			for (size_t i = 0; i < cn->array.size(); ++i)
+			{
+				if (cn->array[i]->kind == snode_kind)
+					return true;
+				stk.push_back(gcas_read(static_cast<inode *>(cn->array[i])));
+			}
+		}
+		return false;
+	}
+
+	void clear()
+	{
+		if (read_only)
+			return;
+		epoch_guard guard(*rec);
+		for (;;)
+		{
+			inode *r = read_root();
+			if (rdcss_root(r, gcas_read(r), new_root()))
+				return;
+		}
+	}
+
+	ctrie_impl * snapshot()
+	{
+		epoch_guard guard(*rec);
+		if (read_only)
+		{
+			inode *r = read_root();
+			return new ctrie_impl(copy_to_gen(r, new_gen()), false, rec);
+		}
+		for (;;)
+		{
+			inode *r = read_root();
+			main_node *expected_main = gcas_read(r);
+			if (rdcss_root(r, expected_main, copy_to_gen(r, new_gen())))
+				return new ctrie_impl(copy_to_gen(r, new_gen()), false, rec);
+		}
+	}
+
+	ctrie_impl * read_only_snapshot()
+	{
+		epoch_guard guard(*rec);
+		if (read_only)
+			return new ctrie_impl(read_root(), true, rec);
+		for (;;)
+		{
+			inode *r = read_root();
+			main_node *expected_main = gcas_read(r);
+			if (rdcss_root(r, expected_main, copy_to_gen(r, new_gen())))
+				return new ctrie_impl(r, true, rec);
+		}
+	}
+
+	// no operation runs on a map being destroyed, so the root is an inode
+	~ctrie_impl()
+	{
+		rec->release(root.load());
+	}
+};
+
+// iterates a read-only snapshot, which is never modified; the nodes it
+// stands on are held, since it keeps them between operations
+template <typename Key, typename Value, class Hash, class Pred>
+class ctrie_iterator {
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef const Value& reference;
+	typedef const Value * pointer;
+	typedef ptrdiff_t difference_type;
+	typedef ctrie_impl<Key, Value, Hash, Pred> impl_type;
+	typedef boost::shared_ptr<impl_type> impl_ptr;
+	typedef typename impl_type::snode_ptr snode_ptr;
+	typedef ctrie_iterator<Key, Value, Hash, Pred> self;
+
+private:
+	impl_ptr impl;
+	std::vector<std::pair<main_node *, size_t> > stk;
+	snode_ptr cur;
+
+	static const std::vector<object *>& elements(main_node *m)
+	{
+		if (m->kind == cnode_kind)
+			return static_cast<cnode *>(m)->array;
+		return static_cast<lnode *>(m)->entries;
+	}
+
+	void set_current(snode_ptr sn)
+	{
+		if (sn != 0)
+			hold(sn);
+		if (cur != 0)
+			impl->reclamation().release(cur);
+		cur = sn;
+	}
+
+	void release_all()
+	{
+		set_current(0);
+		for (size_t i = 0; i < stk.size(); ++i)
+			impl->reclamation().release(stk[i].first);
+		stk.clear();
+	}
+
+	void advance()
+	{
+		epoch_guard guard(impl->reclamation());
+		set_current(0);
+		while (!stk.empty())
+		{
+			const std::vector<object *>& elems = elements(stk.back().first);
+			if (stk.back().second == elems.size())
+			{
+				impl->reclamation().release(stk.back().first);
+				stk.pop_back();
+				continue;
+			}
+			object *sub = elems[stk.back().second++];
+			if (sub->kind == snode_kind)
+			{
+				set_current(static_cast<snode_ptr>(sub));
+				return;
+			}
+			main_node *m = impl->gcas_read(static_cast<inode *>(sub));
+			if (m->kind == tnode_kind)
+			{
+				set_current(static_cast<snode_ptr>(static_cast<tnode *>(m)->sn));
+				return;
+			}
+			stk.push_back(std::make_pair(hold(m), size_t(0)));
+		}
+	}
+
+public:
+	explicit ctrie_iterator() : cur(0)
+	{
+	}
+
+	explicit ctrie_iterator(const impl_ptr& ro) : impl(ro), cur(0)
+	{
+		{
+			epoch_guard guard(impl->reclamation());
+			stk.push_back(std::make_pair(hold(impl->gcas_read(impl->read_root())), size_t(0)));
+		}
+		advance();
+	}
+
+	ctrie_iterator(const self& other) : impl(other.impl), stk(other.stk), cur(other.cur)
+	{
+		if (cur != 0)
+			hold(cur);
+		for (size_t i = 0; i < stk.size(); ++i)
+			hold(stk[i].first);
+	}
+
+	self& operator=(const self& other)
+	{
+		self tmp(other);
+		impl.swap(tmp.impl);
+		stk.swap(tmp.stk);
+		std::swap(cur, tmp.cur);
+		return *this;
+	}
+
+	~ctrie_iterator()
+	{
+		if (impl)
+			release_all();
+	}
+
+	std::vector<key_type> get_key() const
+	{
+		return cur->key;
+	}
+
+	reference operator*() const
+	{
+		return cur->value;
+	}
+
+	pointer operator->() const
+	{
+		return &(operator*());
+	}
+
+	bool operator==(const self& other) const
+	{
+		return cur == other.cur;
+	}
+
+	bool operator!=(const self& other) const
+	{
+		return cur != other.cur;
+	}
+
+	self& operator++()
+	{
+		advance();
+		return *this;
+	}
+
+	self operator++(int)
+	{
+		self tmp = *this;
+		advance();
+		return tmp;
+	}
+};
+
+} // namespace ctrie
+} // namespace detail
+
+
+template <typename Key, typename Value,
+		 class Hash = boost::hash<Key>, class Pred = std::equal_to<Key> >
+class ctrie_map
+{
+public:
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef ctrie_map<Key, Value, Hash, Pred> ctrie_map_type;
+	typedef detail::ctrie::ctrie_impl<Key, Value, Hash, Pred> impl_type;
+	typedef detail::ctrie::ctrie_iterator<Key, Value, Hash, Pred> const_iterator;
+	typedef const_iterator iterator;
+	typedef size_t size_type;
+
+private:
+	boost::shared_ptr<impl_type> impl;
+
+	explicit ctrie_map(impl_type *p) : impl(p)
+	{
+	}
+
+public:
+	explicit ctrie_map() : impl(new impl_type())
+	{
+	}
+
+	// copying is a constant time snapshot, a read-only map stays read-only
+	ctrie_map(const ctrie_map_type& other) :
+		impl(other.impl->is_read_only() ? other.impl : boost::shared_ptr<impl_type>(other.impl->snapshot()))
+	{
+	}
+
+	ctrie_map_type& operator=(const ctrie_map_type& other)
+	{
+		if (this != &other)
+			impl = ctrie_map_type(other).impl;
+		return *this;
+	}
+
+	ctrie_map_type snapshot() const
+	{
+		return ctrie_map_type(impl->snapshot());
+	}
+
+	ctrie_map_type read_only_snapshot() const
+	{
+		return ctrie_map_type(impl->read_only_snapshot());
+	}
+
+	bool is_read_only() const
+	{
+		return impl->is_read_only();
+	}
+
+	// iteration always walks a read-only snapshot, concurrent writes are not seen
+	const_iterator begin() const
+	{
+		if (impl->is_read_only())
+			return const_iterator(impl);
+		return const_iterator(boost::shared_ptr<impl_type>(impl->read_only_snapshot()));
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator();
+	}
+
+	// insert, the value is not replaced if the key exists
+	template<typename Iter>
+	bool insert(Iter first, Iter last, const value_type& value)
+	{
+		bool existed = false;
+		return impl->insert(first, last, value, impl_type::insert_if_absent, existed) && !existed;
+	}
+
+	template<typename Container>
+	bool insert(const Container& container, const value_type& value)
+	{
+		return insert(container.begin(), container.end(), value);
+	}
+
+	// insert or replace, returns true if the key was not there before
+	template<typename Iter>
+	bool insert_or_assign(Iter first, Iter last, const value_type& value)
+	{
+		bool existed = false;
+		return impl->insert(first, last, value, impl_type::insert_always, existed) && !existed;
+	}
+
+	template<typename Container>
+	bool insert_or_assign(const Container& container, const value_type& value)
+	{
+		return insert_or_assign(container.begin(), container.end(), value);
+	}
+
+	// find copies the value out, since the entry may be replaced at any time
+	template<typename Iter>
+	bool find(Iter first, Iter last, value_type& value) const
+	{
+		return impl->lookup(first, last, &value);
+	}
+
+	template<typename Container>
+	bool find(const Container& container, value_type& value) const
+	{
+		return find(container.begin(), container.end(), value);
+	}
+
+	template<typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		return impl->lookup(first, last, 0) ? 1 : 0;
+	}
+
+	template<typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type erase(Iter first, Iter last)
+	{
+		return impl->remove(first, last) ? 1 : 0;
+	}
+
+	template<typename Container>
+	size_type erase(const Container& container)
+	{
+		return erase(container.begin(), container.end());
+	}
+
+	// size() is linear, it counts a read-only snapshot
+	size_type size() const
+	{
+		size_type ret = 0;
+		for (const_iterator i = begin(); i != end(); ++i)
+			++ret;
+		return ret;
+	}
+
+	// looks at the live trie, no snapshot is taken
+	bool empty() const
+	{
+		return !impl->has_entries();
+	}
+
+	// the nodes allocated by the map and its snapshots that are not freed
+	// yet, retired ones included
+	size_type count_node() const
+	{
+		return impl->count_node();
+	}
+
+	void clear()
+	{
+		impl->clear();
+	}
+
+	void swap(ctrie_map_type& other)
+	{
+		impl.swap(other.impl);
+	}
+
+	~ctrie_map()
+	{
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_CTRIE_MAP_HPP
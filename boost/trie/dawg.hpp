@@ -0,0 +1,650 @@
+#ifndef BOOST_TRIE_DAWG_HPP
+#define BOOST_TRIE_DAWG_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <map>
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <boost/cstdint.hpp>
+
+//
+// dawg is a read-only set of keys stored as a minimal acyclic automaton
+// (a directed acyclic word graph).  A trie shares the prefixes of its keys;
+// the dawg also shares their suffixes, since equivalent sub-tries (same
+// finality, same labels into equivalent sub-tries) are merged into one state.
+//
+// dawg_builder makes one from keys added in sorted order (Daciuk et al.,
+// "Incremental construction of minimal acyclic finite-state automata"): when
+// a key leaves the path of the previous key, the states on that path can not
+// change any more and are looked up in a register of the states built so far,
+// keyed by their signature.  A state equal to a registered one is dropped and
+// its parent edge redirected, so memory stays proportional to the result.
+//
+// The built dawg is three arrays: the first edge of each state, and the label
+// and target of each edge, sorted by label.  With counts, each state also
+// keeps the number of keys below it, which makes the position of a key in
+// sorted order (index_of) and its inverse (key_at) a walk down one path: a
+// minimal perfect hash of the set.
+//
+// States, edges and counts are 32-bit: add() and build() throw
+// std::length_error instead of wrapping when a set needs more.
+//
+
+namespace boost { namespace tries {
+
+template <typename Key, class Compare>
+class dawg;
+
+template <typename Key, class Compare>
+class dawg_builder;
+
+namespace detail {
+
+// a key of a dawg in sorted order, the stack is the path to it
+template <typename Key, class Compare>
+struct dawg_iterator {
+	typedef std::forward_iterator_tag iterator_category;
+	typedef Key key_type;
+	typedef std::vector<key_type> value_type;
+	typedef const value_type& reference;
+	typedef const value_type* pointer;
+	typedef ptrdiff_t difference_type;
+	typedef dawg<Key, Compare> dawg_type;
+	typedef boost::uint32_t index_type;
+	typedef dawg_iterator<Key, Compare> self;
+
+	struct frame {
+		index_type state;
+		// the next edge to follow
+		index_type edge;
+	};
+
+	const dawg_type *d;
+	std::vector<frame> stk;
+	value_type key;
+
+	explicit dawg_iterator() : d(0)
+	{
+	}
+
+	// the first key at or below state, whose path is prefix; end() if there is none
+	explicit dawg_iterator(const dawg_type *owner, index_type state, const value_type& prefix) : d(owner), key(prefix)
+	{
+		frame f = { state, d->first_edge[state] };
+		stk.push_back(f);
+		if (!d->is_final(state))
+			advance();
+	}
+
+	// depth first to the next final state
+	void advance()
+	{
+		while (!stk.empty())
+		{
+			frame& top = stk.back();
+			if (top.edge == d->first_edge[top.state + 1])
+			{
+				stk.pop_back();
+				if (!stk.empty())
+					key.pop_back();
+				continue;
+			}
+			index_type e = top.edge++;
+			index_type t = d->targets[e];
+			frame f = { t, d->first_edge[t] };
+			stk.push_back(f);
+			key.push_back(d->labels[e]);
+			if (d->is_final(t))
+				return;
+		}
+		key.clear();
+	}
+
+	const value_type& get_key() const
+	{
+		return key;
+	}
+
+	reference operator*() const
+	{
+		return key;
+	}
+
+	pointer operator->() const
+	{
+		return &key;
+	}
+
+	self& operator++()
+	{
+		advance();
+		return *this;
+	}
+
+	self operator++(int)
+	{
+		self tmp = *this;
+		advance();
+		return tmp;
+	}
+
+	bool operator==(const self& other) const
+	{
+		if (stk.empty() || other.stk.empty())
+			return stk.empty() == other.stk.empty();
+		return stk.size() == other.stk.size() && stk.back().state == other.stk.back().state &&
+			key == other.key;
+	}
+
+	bool operator!=(const self& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+} // namespace detail
+
+template <typename Key, class Compare = std::less<Key> >
+class dawg {
+public:
+	typedef Key key_type;
+	typedef size_t size_type;
+	typedef boost::uint32_t index_type;
+	typedef dawg<Key, Compare> dawg_type;
+	typedef detail::dawg_iterator<Key, Compare> iterator;
+	typedef iterator const_iterator;
+	typedef std::pair<iterator, iterator> iterator_range;
+	static const size_type npos = size_type(-1);
+
+	friend struct detail::dawg_iterator<Key, Compare>;
+	friend class dawg_builder<Key, Compare>;
+
+private:
+	// state 0 is the root, edges of state s are [first_edge[s], first_edge[s + 1])
+	std::vector<index_type> first_edge;
+	std::vector<key_type> labels;
+	std::vector<index_type> targets;
+	std::vector<unsigned char> finals;
+	// keys at or below each state, empty if built without counts
+	std::vector<index_type> counts;
+	size_type key_count;
+	Compare comp;
+
+	bool is_final(index_type s) const
+	{
+		return finals[s] != 0;
+	}
+
+	// the target of the edge of s labelled k, or npos
+	index_type child(index_type s, const key_type& k) const
+	{
+		index_type lo = first_edge[s], hi = first_edge[s + 1];
+		while (lo < hi)
+		{
+			index_type mid = lo + (hi - lo) / 2;
+			if (comp(labels[mid], k))
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		if (lo == first_edge[s + 1] || comp(k, labels[lo]))
+			return index_type(-1);
+		return targets[lo];
+	}
+
+	template <typename Iter>
+	index_type walk(Iter first, Iter last) const
+	{
+		index_type s = 0;
+		for (; first != last && s != index_type(-1); ++first)
+			s = child(s, *first);
+		return s;
+	}
+
+	// keys at or below s, without counts by a walk over the sub-graph
+	size_type count_below(index_type s) const
+	{
+		if (!counts.empty())
+			return counts[s];
+		size_type ret = 0;
+		std::vector<index_type> stk(1, s);
+		while (!stk.empty())
+		{
+			index_type cur = stk.back();
+			stk.pop_back();
+			ret += finals[cur];
+			for (index_type e = first_edge[cur]; e != first_edge[cur + 1]; ++e)
+				stk.push_back(targets[e]);
+		}
+		return ret;
+	}
+
+	void reset()
+	{
+		first_edge.assign(2, 0);
+		labels.clear();
+		targets.clear();
+		finals.assign(1, 0);
+		counts.clear();
+		key_count = 0;
+	}
+
+public:
+	explicit dawg() : key_count(0), comp()
+	{
+		reset();
+	}
+
+	// a dawg with the keys of a trie_set, or any container whose
+	// iterators have get_key() and come in key order
+	template <typename TrieSet>
+	explicit dawg(const TrieSet& s, bool with_counts = true) : key_count(0), comp()
+	{
+		reset();
+		dawg_builder<Key, Compare> b;
+		for (typename TrieSet::const_iterator i = s.begin(); i != s.end(); ++i)
+		{
+			std::vector<key_type> k = i.get_key();
+			b.add(k.begin(), k.end());
+		}
+		b.build(*this, with_counts);
+	}
+
+	iterator begin() const
+	{
+		return iterator(this, 0, std::vector<key_type>());
+	}
+
+	iterator end() const
+	{
+		return iterator();
+	}
+
+	template <typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		index_type s = walk(first, last);
+		return s != index_type(-1) && is_final(s) ? 1 : 0;
+	}
+
+	template <typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	template <typename Iter>
+	bool contains(Iter first, Iter last) const
+	{
+		return count(first, last) != 0;
+	}
+
+	template <typename Container>
+	bool contains(const Container& container) const
+	{
+		return count(container) != 0;
+	}
+
+	template <typename Iter>
+	size_type count_prefix(Iter first, Iter last) const
+	{
+		index_type s = walk(first, last);
+		return s == index_type(-1) ? 0 : count_below(s);
+	}
+
+	template <typename Container>
+	size_type count_prefix(const Container& container) const
+	{
+		return count_prefix(container.begin(), container.end());
+	}
+
+	// the keys starting with [first, last), in order
+	template <typename Iter>
+	iterator_range find_prefix(Iter first, Iter last) const
+	{
+		std::vector<key_type> prefix(first, last);
+		index_type s = walk(prefix.begin(), prefix.end());
+		if (s == index_type(-1))
+			return std::make_pair(end(), end());
+		return std::make_pair(iterator(this, s, prefix), end());
+	}
+
+	template <typename Container>
+	iterator_range find_prefix(const Container& container) const
+	{
+		return find_prefix(container.begin(), container.end());
+	}
+
+	// the position of the key in sorted order, npos if it is not in the set
+	// or the dawg was built without counts
+	template <typename Iter>
+	size_type index_of(Iter first, Iter last) const
+	{
+		if (counts.empty())
+			return npos;
+		size_type ret = 0;
+		index_type s = 0;
+		for (; first != last; ++first)
+		{
+			index_type t = child(s, *first);
+			if (t == index_type(-1))
+				return npos;
+			ret += finals[s];
+			for (index_type e = first_edge[s]; comp(labels[e], *first); ++e)
+				ret += counts[targets[e]];
+			s = t;
+		}
+		return is_final(s) ? ret : npos;
+	}
+
+	template <typename Container>
+	size_type index_of(const Container& container) const
+	{
+		return index_of(container.begin(), container.end());
+	}
+
+	// the key at a position in sorted order, false if there is none
+	bool key_at(size_type index, std::vector<key_type>& key) const
+	{
+		key.clear();
+		if (counts.empty() || index >= key_count)
+			return false;
+		index_type s = 0;
+		for (;;)
+		{
+			if (is_final(s))
+			{
+				if (index == 0)
+					return true;
+				--index;
+			}
+			index_type e = first_edge[s];
+			for (; e != first_edge[s + 1] && index >= counts[targets[e]]; ++e)
+				index -= counts[targets[e]];
+			key.push_back(labels[e]);
+			s = targets[e];
+		}
+	}
+
+	bool has_counts() const
+	{
+		return !counts.empty();
+	}
+
+	size_type size() const
+	{
+		return key_count;
+	}
+
+	bool empty() const
+	{
+		return key_count == 0;
+	}
+
+	// the root is not counted, the same as trie::count_node()
+	size_type count_node() const
+	{
+		return finals.size() - 1;
+	}
+
+	size_type count_edge() const
+	{
+		return labels.size();
+	}
+
+	void clear()
+	{
+		reset();
+	}
+
+	void swap(dawg_type& other)
+	{
+		first_edge.swap(other.first_edge);
+		labels.swap(other.labels);
+		targets.swap(other.targets);
+		finals.swap(other.finals);
+		counts.swap(other.counts);
+		std::swap(key_count, other.key_count);
+	}
+};
+
+template <typename Key, class Compare>
+const typename dawg<Key, Compare>::size_type dawg<Key, Compare>::npos;
+
+template <typename Key, class Compare = std::less<Key> >
+class dawg_builder {
+public:
+	typedef Key key_type;
+	typedef size_t size_type;
+	typedef boost::uint32_t index_type;
+	typedef dawg<Key, Compare> dawg_type;
+
+private:
+	typedef std::pair<key_type, index_type> edge;
+
+	struct state {
+		bool final;
+		// sorted by label, the last one is the only one that may still change
+		std::vector<edge> edges;
+	};
+
+	// states are equivalent if they have the same finality and edges
+	struct state_less {
+		Compare comp;
+
+		bool operator()(const state& a, const state& b) const
+		{
+			if (a.final != b.final)
+				return a.final < b.final;
+			if (a.edges.size() != b.edges.size())
+				return a.edges.size() < b.edges.size();
+			for (size_type i = 0; i < a.edges.size(); ++i)
+			{
+				if (comp(a.edges[i].first, b.edges[i].first))
+					return true;
+				if (comp(b.edges[i].first, a.edges[i].first))
+					return false;
+				if (a.edges[i].second != b.edges[i].second)
+					return a.edges[i].second < b.edges[i].second;
+			}
+			return false;
+		}
+	};
+
+	typedef std::map<state, index_type, state_less> register_type;
+
+	std::vector<state> states;
+	// states dropped as equivalent to a registered one, reused
+	std::vector<index_type> free_states;
+	register_type reg;
+	// the states on the path of the last key, not registered yet
+	std::vector<index_type> path;
+	std::vector<key_type> last_key;
+	size_type key_count;
+	Compare comp;
+
+	index_type new_state()
+	{
+		if (!free_states.empty())
+		{
+			index_type s = free_states.back();
+			free_states.pop_back();
+			return s;
+		}
+		states.push_back(state());
+		states.back().final = false;
+		return index_type(states.size() - 1);
+	}
+
+	// register the states of the path below depth, deepest first
+	void minimize(size_type depth)
+	{
+		while (path.size() > depth + 1)
+		{
+			index_type s = path.back();
+			path.pop_back();
+			typename register_type::iterator it = reg.find(states[s]);
+			if (it == reg.end())
+			{
+				reg.insert(std::make_pair(states[s], s));
+				continue;
+			}
+			states[path.back()].edges.back().second = it->second;
+			std::vector<edge>().swap(states[s].edges);
+			states[s].final = false;
+			free_states.push_back(s);
+		}
+	}
+
+	void reset()
+	{
+		states.clear();
+		free_states.clear();
+		reg.clear();
+		last_key.clear();
+		key_count = 0;
+		path.assign(1, new_state());
+	}
+
+public:
+	explicit dawg_builder() : key_count(0), comp()
+	{
+		reset();
+	}
+
+	// keys have to come in sorted order, a key equal to the last one is
+	// ignored and a smaller one makes add() return false
+	template <typename Iter>
+	bool add(Iter first, Iter last)
+	{
+		std::vector<key_type> key(first, last);
+		size_type p = 0;
+		while (p < key.size() && p < last_key.size() &&
+				!comp(key[p], last_key[p]) && !comp(last_key[p], key[p]))
+			++p;
+		if (p == key.size() && p == last_key.size() && key_count > 0)
+			return true;
+		if (p < last_key.size() && (p == key.size() || comp(key[p], last_key[p])))
+			return false;
+		if (key_count >= size_type(index_type(-1)))
+			throw std::length_error("dawg_builder: too many keys for index_type");
+		minimize(p);
+		// index_type(-1) is no state
+		if (key.size() - p > free_states.size() + (size_type(index_type(-1)) - states.size()))
+			throw std::length_error("dawg_builder: too many states for index_type");
+		for (size_type i = p; i < key.size(); ++i)
+		{
+			index_type s = new_state();
+			states[path.back()].edges.push_back(std::make_pair(key[i], s));
+			path.push_back(s);
+		}
+		states[path.back()].final = true;
+		last_key.swap(key);
+		++key_count;
+		return true;
+	}
+
+	template <typename Container>
+	bool add(const Container& container)
+	{
+		return add(container.begin(), container.end());
+	}
+
+	size_type size() const
+	{
+		return key_count;
+	}
+
+	// move the keys added so far into d, minimized; the builder starts over
+	void build(dawg_type& d, bool with_counts = true)
+	{
+		minimize(0);
+		// number the states depth first from the root
+		index_type root = path[0];
+		std::vector<index_type> id(states.size(), index_type(-1));
+		std::vector<index_type> order;
+		std::vector<index_type> stk(1, root);
+		size_type edge_count = 0;
+		id[root] = 0;
+		order.push_back(root);
+		while (!stk.empty())
+		{
+			index_type s = stk.back();
+			stk.pop_back();
+			const std::vector<edge>& es = states[s].edges;
+			edge_count += es.size();
+			for (size_type i = es.size(); i-- > 0; )
+			{
+				index_type t = es[i].second;
+				if (id[t] != index_type(-1))
+					continue;
+				id[t] = index_type(order.size());
+				order.push_back(t);
+				stk.push_back(t);
+			}
+		}
+
+		// the edges are numbered by index_type too; d and the keys are kept
+		if (edge_count > size_type(index_type(-1)))
+			throw std::length_error("dawg_builder: too many edges for index_type");
+
+		d.reset();
+		d.first_edge.assign(order.size() + 1, 0);
+		d.finals.assign(order.size(), 0);
+		for (size_type i = 0; i < order.size(); ++i)
+		{
+			const state& st = states[order[i]];
+			d.first_edge[i] = index_type(d.labels.size());
+			d.finals[i] = st.final ? 1 : 0;
+			for (size_type j = 0; j < st.edges.size(); ++j)
+			{
+				d.labels.push_back(st.edges[j].first);
+				d.targets.push_back(id[st.edges[j].second]);
+			}
+		}
+		d.first_edge[order.size()] = index_type(d.labels.size());
+		d.key_count = key_count;
+
+		if (with_counts)
+		{
+			// children first: a state is done once every target is
+			d.counts.assign(order.size(), 0);
+			std::vector<unsigned char> done(order.size(), 0);
+			std::vector<index_type> todo(1, 0);
+			while (!todo.empty())
+			{
+				index_type s = todo.back();
+				bool ready = true;
+				for (index_type e = d.first_edge[s]; e != d.first_edge[s + 1]; ++e)
+				{
+					if (!done[d.targets[e]])
+					{
+						ready = false;
+						todo.push_back(d.targets[e]);
+					}
+				}
+				if (!ready)
+					continue;
+				todo.pop_back();
+				if (done[s])
+					continue;
+				index_type c = d.finals[s];
+				for (index_type e = d.first_edge[s]; e != d.first_edge[s + 1]; ++e)
+					c += d.counts[d.targets[e]];
+				d.counts[s] = c;
+				done[s] = 1;
+			}
+		}
+		reset();
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_DAWG_HPP
@@ -0,0 +1,401 @@
+#ifndef BOOST_TRIE_DOUBLE_ARRAY_TRIE_HPP
+#define BOOST_TRIE_DOUBLE_ARRAY_TRIE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "frozen_trie.hpp"
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+
+//
+// double_array_trie is a char-keyed map compiled to a double array (Aoe): a
+// state s goes to t = base[s] + code on a character, and the step is valid if
+// check[t] == s, so a transition is two array reads and no search.  The code
+// of a character is its unsigned value plus one; code 0 leads from the state
+// of a key to a leaf cell, whose base holds -(value index + 1).
+//
+// It is built from a trie_map (or anything with freeze()) with the bases
+// found depth first, each the lowest one whose cells are all free.  insert()
+// adds keys later: when a cell needed by a state is taken, the children of
+// the state are moved to a new base (relocation).
+//
+
+namespace boost { namespace tries {
+
+template <typename Value>
+class double_array_trie {
+public:
+	typedef char key_type;
+	typedef Value value_type;
+	typedef size_t size_type;
+	typedef boost::int32_t index_type;
+	typedef double_array_trie<Value> double_array_type;
+	// the length of a key that is a prefix of the input, and its value
+	typedef std::pair<size_type, const value_type *> prefix_match;
+
+private:
+	enum { free_cell = -1, root_check = -2, code_count = 257 };
+
+	std::vector<index_type> base;
+	std::vector<index_type> check;
+	std::vector<value_type> values;
+	// no free cell below it
+	index_type first_free;
+
+	static int code_of(char c)
+	{
+		return int(static_cast<unsigned char>(c)) + 1;
+	}
+
+	bool has_child(index_type s, int code) const
+	{
+		if (base[s] <= 0)
+			return false;
+		index_type t = base[s] + code;
+		return t < index_type(check.size()) && check[t] == s;
+	}
+
+	// the state after c from s, or -1
+	index_type step(index_type s, int code) const
+	{
+		return has_child(s, code) ? base[s] + code : index_type(-1);
+	}
+
+	// the value index of the key ending at s, or -1
+	index_type value_of(index_type s) const
+	{
+		index_type t = step(s, 0);
+		return t < 0 ? index_type(-1) : -base[t] - 1;
+	}
+
+	void grow(index_type n)
+	{
+		if (n <= index_type(check.size()))
+			return;
+		size_type size = check.size() * 2 > size_type(n) ? check.size() * 2 : size_type(n);
+		base.resize(size, 0);
+		check.resize(size, free_cell);
+	}
+
+	// the lowest base whose cells for the codes are all free, codes sorted
+	index_type find_base(const std::vector<int>& codes)
+	{
+		for (index_type b = first_free - codes[0] > 1 ? first_free - codes[0] : 1; ; ++b)
+		{
+			grow(b + codes.back() + 1);
+			if (check[b + codes[0]] != free_cell)
+				continue;
+			size_type i = 1;
+			while (i < codes.size() && check[b + codes[i]] == free_cell)
+				++i;
+			if (i == codes.size())
+				return b;
+		}
+	}
+
+	void occupy(index_type t, index_type parent)
+	{
+		check[t] = parent;
+		base[t] = 0;
+		while (first_free < index_type(check.size()) && check[first_free] != free_cell)
+			++first_free;
+	}
+
+	void release(index_type t)
+	{
+		check[t] = free_cell;
+		base[t] = 0;
+		if (t < first_free)
+			first_free = t;
+	}
+
+	// the codes of the children of s
+	std::vector<int> child_codes(index_type s) const
+	{
+		std::vector<int> codes;
+		for (int c = 0; c < code_count; ++c)
+			if (has_child(s, c))
+				codes.push_back(c);
+		return codes;
+	}
+
+	// move the children of s so that code fits too, returns the new base
+	index_type relocate(index_type s, int code)
+	{
+		std::vector<int> codes = child_codes(s);
+		std::vector<int> all(codes);
+		all.insert(std::lower_bound(all.begin(), all.end(), code), code);
+		index_type nb = find_base(all);
+		index_type ob = base[s];
+		for (size_type i = 0; i < codes.size(); ++i)
+		{
+			index_type from = ob + codes[i], to = nb + codes[i];
+			occupy(to, s);
+			base[to] = base[from];
+			// the grandchildren point back to the new cell
+			if (base[from] > 0)
+			{
+				for (int c = 0; c < code_count; ++c)
+				{
+					index_type g = base[from] + c;
+					if (g < index_type(check.size()) && check[g] == from)
+						check[g] = to;
+				}
+			}
+			release(from);
+		}
+		base[s] = nb;
+		return nb;
+	}
+
+	// the state after code from s, made if it is missing
+	index_type add_child(index_type s, int code)
+	{
+		if (has_child(s, code))
+			return base[s] + code;
+		if (base[s] <= 0)
+		{
+			std::vector<int> codes(1, code);
+			base[s] = find_base(codes);
+		}
+		else {
+			index_type t = base[s] + code;
+			grow(t + 1);
+			if (check[t] != free_cell)
+				relocate(s, code);
+		}
+		index_type t = base[s] + code;
+		occupy(t, s);
+		return t;
+	}
+
+	void reset()
+	{
+		base.assign(code_count + 1, 0);
+		check.assign(code_count + 1, free_cell);
+		values.clear();
+		check[0] = root_check;
+		first_free = 1;
+	}
+
+public:
+	explicit double_array_trie()
+	{
+		reset();
+	}
+
+	// compile the keys of a trie_map, or anything with freeze(); of more
+	// values for a key the first one is kept
+	template <typename Map>
+	explicit double_array_trie(const Map& m)
+	{
+		reset();
+		typename Map::frozen_type f = m.freeze();
+		typename Map::frozen_type::layout_type l = f.layout();
+		typedef typename Map::frozen_type::index_type frozen_index;
+		// (node of the frozen trie, its state)
+		std::vector<std::pair<frozen_index, index_type> > stk(1, std::make_pair(frozen_index(0), index_type(0)));
+		while (!stk.empty())
+		{
+			frozen_index n = stk.back().first;
+			index_type s = stk.back().second;
+			stk.pop_back();
+			// (code, child) in code order: the frozen layout keeps the
+			// children in char order, which is signed, and find_base()
+			// needs the codes sorted
+			std::vector<std::pair<int, frozen_index> > children;
+			for (frozen_index c = l.child_begin(n); c != l.child_end(n); ++c)
+				children.push_back(std::make_pair(code_of(l.labels[c - 1]), c));
+			std::sort(children.begin(), children.end());
+			std::vector<int> codes;
+			if (l.has_value(n))
+				codes.push_back(0);
+			for (size_type i = 0; i < children.size(); ++i)
+				codes.push_back(children[i].first);
+			if (codes.empty())
+				continue;
+			index_type b = find_base(codes);
+			base[s] = b;
+			if (l.has_value(n))
+			{
+				occupy(b, s);
+				base[b] = -index_type(values.size()) - 1;
+				values.push_back(f.value_at(l.nodes[n].value_begin));
+			}
+			for (size_type i = 0; i < children.size(); ++i)
+			{
+				index_type t = b + children[i].first;
+				occupy(t, s);
+				stk.push_back(std::make_pair(children[i].second, t));
+			}
+		}
+	}
+
+	// add a key, false and no change if it is there already
+	template <typename Iter>
+	bool insert(Iter first, Iter last, const value_type& value)
+	{
+		index_type s = 0;
+		for (; first != last; ++first)
+			s = add_child(s, code_of(*first));
+		if (has_child(s, 0))
+			return false;
+		index_type t = add_child(s, 0);
+		base[t] = -index_type(values.size()) - 1;
+		values.push_back(value);
+		return true;
+	}
+
+	template <typename Container>
+	bool insert(const Container& container, const value_type& value)
+	{
+		return insert(container.begin(), container.end(), value);
+	}
+
+	// the value of the key, NULL if it is not there
+	template <typename Iter>
+	const value_type * find(Iter first, Iter last) const
+	{
+		index_type s = 0;
+		for (; first != last && s >= 0; ++first)
+			s = step(s, code_of(*first));
+		if (s < 0)
+			return NULL;
+		index_type v = value_of(s);
+		return v < 0 ? NULL : &values[v];
+	}
+
+	template <typename Container>
+	const value_type * find(const Container& container) const
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template <typename Iter>
+	value_type * find(Iter first, Iter last)
+	{
+		const double_array_type& self = *this;
+		return const_cast<value_type *>(self.find(first, last));
+	}
+
+	template <typename Container>
+	value_type * find(const Container& container)
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template <typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		return find(first, last) == NULL ? 0 : 1;
+	}
+
+	template <typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	// every key that is a prefix of [first, last), shortest first; returns
+	// how many were written to out
+	template <typename Iter, typename OutputIter>
+	size_type common_prefix_search(Iter first, Iter last, OutputIter out) const
+	{
+		size_type ret = 0, len = 0;
+		index_type s = 0;
+		for (;;)
+		{
+			index_type v = value_of(s);
+			if (v >= 0)
+			{
+				*out++ = prefix_match(len, &values[v]);
+				++ret;
+			}
+			if (first == last)
+				break;
+			s = step(s, code_of(*first));
+			if (s < 0)
+				break;
+			++first;
+			++len;
+		}
+		return ret;
+	}
+
+	template <typename Container, typename OutputIter>
+	size_type common_prefix_search(const Container& container, OutputIter out) const
+	{
+		return common_prefix_search(container.begin(), container.end(), out);
+	}
+
+	// the longest key that is a prefix of [first, last), (0, NULL) if none
+	template <typename Iter>
+	prefix_match findLongestPrefixOfKey(Iter first, Iter last) const
+	{
+		prefix_match ret(0, static_cast<const value_type *>(NULL));
+		size_type len = 0;
+		for (index_type s = 0; s >= 0; ++len)
+		{
+			index_type v = value_of(s);
+			if (v >= 0)
+				ret = prefix_match(len, &values[v]);
+			if (first == last)
+				break;
+			s = step(s, code_of(*first++));
+		}
+		return ret;
+	}
+
+	template <typename Container>
+	prefix_match findLongestPrefixOfKey(const Container& container) const
+	{
+		return findLongestPrefixOfKey(container.begin(), container.end());
+	}
+
+	size_type size() const
+	{
+		return values.size();
+	}
+
+	bool empty() const
+	{
+		return values.empty();
+	}
+
+	// the cells in the arrays, used or not
+	size_type array_size() const
+	{
+		return check.size();
+	}
+
+	// the cells in use, the root included
+	size_type count_cell() const
+	{
+		size_type ret = 0;
+		for (size_type i = 0; i < check.size(); ++i)
+			if (check[i] != free_cell)
+				++ret;
+		return ret;
+	}
+
+	void clear()
+	{
+		reset();
+	}
+
+	void swap(double_array_type& other)
+	{
+		base.swap(other.base);
+		check.swap(other.check);
+		values.swap(other.values);
+		std::swap(first_free, other.first_free);
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_DOUBLE_ARRAY_TRIE_HPP
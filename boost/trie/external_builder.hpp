@@ -0,0 +1,501 @@
+#ifndef BOOST_TRIE_EXTERNAL_BUILDER_HPP
+#define BOOST_TRIE_EXTERNAL_BUILDER_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "trie.hpp"
+#include "frozen_trie.hpp"
+#include <string>
+#include <vector>
+#include <list>
+#include <queue>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
+//
+// external_builder builds a trie from more keys than fit in memory.
+//
+// add() collects (key, value) pairs in any order.  Whenever the pairs take
+// more than a share of the memory budget they are handed to a worker thread
+// that sorts them and writes a sorted run to "<prefix>.run<n>".  build() merges
+// the runs k ways and inserts the pairs in order into a trie container inside a
+// bulk update; build_image() streams the merged pairs into the image format of
+// frozen_trie::save(), so mapped_trie_map can open it, without holding the trie
+// in memory.  Pairs with equal keys come out in the order they were added.
+//
+// Keys and values are written with the same codecs as trie::save(), so they
+// have to be POD or std::string; images need POD keys.
+//
+
+namespace boost { namespace tries {
+
+namespace detail {
+
+template <typename Key, typename Value>
+struct external_record {
+	std::vector<Key> key;
+	Value value;
+	// the order of add(), keeps equal keys stable
+	boost::uint64_t seq;
+};
+
+template <typename Key, typename Value>
+bool write_external_record(std::ostream& os, const external_record<Key, Value>& r)
+{
+	typedef trie_stream_codec<boost::uint64_t> size_codec;
+	size_codec::write(os, r.seq);
+	size_codec::write(os, r.key.size());
+	for (size_t i = 0; i < r.key.size(); ++i)
+		trie_stream_codec<Key>::write(os, r.key[i]);
+	trie_stream_codec<Value>::write(os, r.value);
+	return bool(os);
+}
+
+template <typename Key, typename Value>
+bool read_external_record(std::istream& is, external_record<Key, Value>& r)
+{
+	typedef trie_stream_codec<boost::uint64_t> size_codec;
+	boost::uint64_t n;
+	if (!size_codec::read(is, r.seq) || !size_codec::read(is, n))
+		return false;
+	r.key.resize(size_t(n));
+	for (size_t i = 0; i < r.key.size(); ++i)
+		if (!trie_stream_codec<Key>::read(is, r.key[i]))
+			return false;
+	return trie_stream_codec<Value>::read(is, r.value);
+}
+
+// lexicographic by Compare, then by seq
+template <typename Key, typename Value, class Compare>
+struct external_record_less {
+	Compare comp;
+
+	bool operator()(const external_record<Key, Value>& a, const external_record<Key, Value>& b) const
+	{
+		if (std::lexicographical_compare(a.key.begin(), a.key.end(), b.key.begin(), b.key.end(), comp))
+			return true;
+		if (std::lexicographical_compare(b.key.begin(), b.key.end(), a.key.begin(), a.key.end(), comp))
+			return false;
+		return a.seq < b.seq;
+	}
+};
+
+// sorts one buffer of records and writes it as a run
+template <typename Key, typename Value, class Compare>
+struct external_run_job {
+	typedef external_record<Key, Value> record;
+	boost::shared_ptr<std::vector<record> > records;
+	std::string path;
+	boost::shared_ptr<bool> ok;
+
+	void operator()() const
+	{
+		std::sort(records->begin(), records->end(), external_record_less<Key, Value, Compare>());
+		std::ofstream os(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		for (size_t i = 0; i < records->size() && os; ++i)
+			write_external_record(os, (*records)[i]);
+		os.flush();
+		*ok = bool(os);
+		std::vector<record>().swap(*records);
+	}
+};
+
+} // namespace detail
+
+
+template <typename Key, typename Value, class Compare = std::less<Key> >
+class external_builder : private boost::noncopyable
+{
+public:
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef size_t size_type;
+	typedef detail::external_record<key_type, value_type> record;
+
+private:
+	typedef detail::external_run_job<key_type, value_type, Compare> job_type;
+	typedef detail::external_record_less<key_type, value_type, Compare> record_less;
+
+	struct running {
+		job_type job;
+		boost::shared_ptr<boost::thread> thread;
+	};
+
+	std::string prefix;
+	size_type budget;
+	size_type threads;
+	boost::shared_ptr<std::vector<record> > buffer;
+	size_type buffer_bytes;
+	std::list<running> jobs;
+	std::vector<std::string> runs;
+	boost::uint64_t seq;
+	bool failed;
+
+	// one buffer is filled while each worker holds one
+	size_type buffer_budget() const
+	{
+		return budget / (threads + 1);
+	}
+
+	void join_one()
+	{
+		running& r = jobs.front();
+		r.thread->join();
+		if (!*r.job.ok)
+			failed = true;
+		jobs.pop_front();
+	}
+
+	void spill()
+	{
+		if (buffer->empty())
+			return;
+		job_type job;
+		job.records = buffer;
+		job.ok.reset(new bool(false));
+		char name[32];
+		std::sprintf(name, ".run%u", unsigned(runs.size()));
+		job.path = prefix + name;
+		runs.push_back(job.path);
+		buffer.reset(new std::vector<record>());
+		buffer_bytes = 0;
+		if (threads == 0)
+		{
+			job();
+			if (!*job.ok)
+				failed = true;
+			return;
+		}
+		while (jobs.size() >= threads)
+			join_one();
+		running r;
+		r.job = job;
+		r.thread.reset(new boost::thread(job));
+		jobs.push_back(r);
+	}
+
+	void finish_runs()
+	{
+		spill();
+		while (!jobs.empty())
+			join_one();
+	}
+
+	void remove_runs()
+	{
+		for (size_t i = 0; i < runs.size(); ++i)
+			std::remove(runs[i].c_str());
+		runs.clear();
+	}
+
+	struct run_reader {
+		std::ifstream is;
+		record cur;
+		bool valid;
+
+		bool next()
+		{
+			valid = detail::read_external_record(is, cur);
+			return valid;
+		}
+	};
+
+	struct reader_greater {
+		const std::vector<run_reader *> *readers;
+
+		bool operator()(size_t a, size_t b) const
+		{
+			return record_less()((*readers)[b]->cur, (*readers)[a]->cur);
+		}
+	};
+
+	// feed the records of all runs to sink in order
+	template <class Sink>
+	bool merge(Sink& sink)
+	{
+		finish_runs();
+		std::vector<run_reader *> readers;
+		reader_greater greater = { &readers };
+		std::priority_queue<size_t, std::vector<size_t>, reader_greater> heap(greater);
+		bool ok = !failed;
+		for (size_t i = 0; i < runs.size() && ok; ++i)
+		{
+			readers.push_back(new run_reader());
+			readers.back()->is.open(runs[i].c_str(), std::ios::in | std::ios::binary);
+			ok = bool(readers.back()->is);
+			if (ok && readers.back()->next())
+				heap.push(i);
+		}
+		while (ok && !heap.empty())
+		{
+			size_t i = heap.top();
+			heap.pop();
+			ok = sink(readers[i]->cur);
+			if (readers[i]->next())
+				heap.push(i);
+			else if (!readers[i]->is.eof())
+				ok = false;
+		}
+		for (size_t i = 0; i < readers.size(); ++i)
+			delete readers[i];
+		remove_runs();
+		seq = 0;
+		failed = false;
+		return ok;
+	}
+
+	template <class Container>
+	struct insert_sink {
+		Container *c;
+
+		bool operator()(const record& r) const
+		{
+			c->insert(r.key.begin(), r.key.end(), r.value);
+			return true;
+		}
+	};
+
+	// writes the merged records to a file and counts the nodes of each depth
+	struct count_sink {
+		std::ofstream *os;
+		std::vector<key_type> last;
+		std::vector<boost::uint64_t> level_count;
+		boost::uint64_t value_count;
+		boost::uint64_t blob_size;
+		Compare comp;
+
+		bool operator()(const record& r)
+		{
+			size_t l = common_prefix(last, r.key, comp);
+			if (value_count == 0)
+				l = 0;
+			if (level_count.size() < r.key.size() + 1)
+				level_count.resize(r.key.size() + 1, 0);
+			for (size_t d = l + 1; d <= r.key.size(); ++d)
+				++level_count[d];
+			last = r.key;
+			++value_count;
+			blob_size += detail::trie_image_value<value_type>::blob_bytes(r.value);
+			return detail::write_external_record(*os, r);
+		}
+	};
+
+	static size_t common_prefix(const std::vector<key_type>& a, const std::vector<key_type>& b, const Compare& comp)
+	{
+		size_t n = std::min(a.size(), b.size()), i = 0;
+		while (i < n && !comp(a[i], b[i]) && !comp(b[i], a[i]))
+			++i;
+		return i;
+	}
+
+	static bool append_file(std::ostream& os, const std::string& path)
+	{
+		std::ifstream is(path.c_str(), std::ios::in | std::ios::binary);
+		if (!is)
+			return false;
+		if (is.peek() != std::ifstream::traits_type::eof())
+			os << is.rdbuf();
+		return bool(os);
+	}
+
+	// the nodes and labels of depth d, in the breadth first order of frozen_trie
+	bool write_level(const std::string& sorted, size_t d, const std::vector<boost::uint64_t>& level_offset,
+			std::ostream& nodes, std::ostream& labels)
+	{
+		Compare comp;
+		std::ifstream is(sorted.c_str(), std::ios::in | std::ios::binary);
+		record r;
+		std::vector<key_type> last;
+		detail::frozen_node open = { 0, 0, 0 };
+		bool is_open = false;
+		// nodes of depth d + 1 seen so far
+		boost::uint64_t below = 0;
+		boost::uint64_t i = 0;
+		for (; detail::read_external_record(is, r); ++i)
+		{
+			size_t l = i == 0 ? 0 : common_prefix(last, r.key, comp);
+			if (is_open && (r.key.size() < d || l < d))
+			{
+				open.value_end = detail::frozen_node::index_type(i);
+				nodes.write(reinterpret_cast<const char *>(&open), sizeof(open));
+				is_open = false;
+			}
+			if (!is_open && r.key.size() >= d)
+			{
+				open.first_child = detail::frozen_node::index_type(level_offset[d + 1] + below);
+				open.value_begin = detail::frozen_node::index_type(i);
+				is_open = true;
+				if (d > 0)
+					labels.write(reinterpret_cast<const char *>(&r.key[d - 1]), sizeof(key_type));
+			}
+			if (r.key.size() >= d + 1 && (i == 0 || l < d + 1))
+				++below;
+			last.swap(r.key);
+		}
+		if (!is.eof())
+			return false;
+		if (is_open || d == 0)
+		{
+			if (!is_open)
+				open.first_child = detail::frozen_node::index_type(level_offset[1]);
+			open.value_end = detail::frozen_node::index_type(i);
+			nodes.write(reinterpret_cast<const char *>(&open), sizeof(open));
+		}
+		return bool(nodes) && bool(labels);
+	}
+
+public:
+	// temporary files are named after prefix; memory_budget is in bytes and
+	// threads is the number of sorting threads, 0 sorts on the caller's thread
+	explicit external_builder(const std::string& temp_prefix, size_type memory_budget = size_type(64) << 20,
+			size_type sort_threads = boost::thread::hardware_concurrency()) :
+		prefix(temp_prefix), budget(memory_budget), threads(sort_threads),
+		buffer(new std::vector<record>()), buffer_bytes(0), seq(0), failed(false)
+	{
+	}
+
+	template<typename Iter>
+	void add(Iter first, Iter last, const value_type& value)
+	{
+		buffer->push_back(record());
+		record& r = buffer->back();
+		r.key.assign(first, last);
+		r.value = value;
+		r.seq = seq++;
+		buffer_bytes += sizeof(record) + r.key.size() * sizeof(key_type) +
+			size_type(detail::trie_image_value<value_type>::blob_bytes(value));
+		if (buffer_bytes >= buffer_budget())
+			spill();
+	}
+
+	template<typename Container>
+	void add(const Container& container, const value_type& value)
+	{
+		add(container.begin(), container.end(), value);
+	}
+
+	// pairs added since the last build
+	size_type size() const
+	{
+		return size_type(seq);
+	}
+
+	// sorted runs written so far
+	size_type count_run() const
+	{
+		return runs.size();
+	}
+
+	// insert everything in key order into a trie container, which is cleared first;
+	// the builder is empty afterwards
+	template<class Container>
+	bool build(Container& c)
+	{
+		c.clear();
+		bulk_update<Container> scope(c);
+		insert_sink<Container> sink = { &c };
+		return merge(sink);
+	}
+
+	// write everything as an image for mapped_trie_map; the merged pairs are
+	// kept in a file and read once for each depth of the trie
+	bool build_image(const std::string& path)
+	{
+		typedef detail::trie_image_value<value_type> value_traits;
+		std::string sorted = prefix + ".sorted", node_file = prefix + ".nodes", label_file = prefix + ".labels",
+			value_file = prefix + ".values", blob_file = prefix + ".blob";
+		count_sink counter;
+		std::ofstream sorted_os(sorted.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		counter.os = &sorted_os;
+		counter.level_count.assign(1, 1);
+		counter.value_count = counter.blob_size = 0;
+		bool ok = merge(counter);
+		sorted_os.close();
+
+		std::vector<boost::uint64_t> level_offset(counter.level_count.size() + 2, 0);
+		for (size_t d = 0; d < counter.level_count.size(); ++d)
+			level_offset[d + 1] = level_offset[d] + counter.level_count[d];
+		level_offset.back() = level_offset[counter.level_count.size()];
+		boost::uint64_t node_count = level_offset[counter.level_count.size()];
+		ok = ok && node_count < detail::frozen_node::index_type(-1) &&
+			counter.value_count < detail::frozen_node::index_type(-1);
+
+		{
+			std::ofstream nodes(node_file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			std::ofstream labels(label_file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			for (size_t d = 0; d < counter.level_count.size() && ok; ++d)
+				ok = write_level(sorted, d, level_offset, nodes, labels);
+			detail::frozen_node sentinel = { detail::frozen_node::index_type(node_count), 0, 0 };
+			nodes.write(reinterpret_cast<const char *>(&sentinel), sizeof(sentinel));
+			ok = ok && nodes && labels;
+		}
+		if (ok)
+		{
+			// values, and the offsets into the blob for std::string
+			std::ifstream is(sorted.c_str(), std::ios::in | std::ios::binary);
+			std::ofstream values(value_file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			std::ofstream blob(blob_file.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			record r;
+			boost::uint64_t off = 0;
+			while (detail::read_external_record(is, r))
+			{
+				if (value_traits::kind == detail::image_pod_value)
+				{
+					value_traits::write_one(values, r.value);
+					continue;
+				}
+				values.write(reinterpret_cast<const char *>(&off), sizeof(off));
+				value_traits::write_one(blob, r.value);
+				off += value_traits::blob_bytes(r.value);
+			}
+			if (value_traits::kind != detail::image_pod_value)
+				values.write(reinterpret_cast<const char *>(&off), sizeof(off));
+			ok = is.eof() && values && blob;
+		}
+		if (ok)
+		{
+			detail::trie_image_header h = detail::make_image_header<key_type, value_type>(node_count,
+					counter.value_count, counter.blob_size);
+			std::ofstream os(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+			os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+			detail::write_padding(os, sizeof(h), h.node_offset);
+			ok = append_file(os, node_file);
+			detail::write_padding(os, h.node_offset + (node_count + 1) * sizeof(detail::frozen_node), h.label_offset);
+			ok = ok && append_file(os, label_file);
+			detail::write_padding(os, h.label_offset + (node_count - 1) * sizeof(key_type), h.value_offset);
+			ok = ok && append_file(os, value_file);
+			if (value_traits::kind != detail::image_pod_value)
+			{
+				detail::write_padding(os, h.value_offset + (counter.value_count + 1) * sizeof(boost::uint64_t), h.blob_offset);
+				ok = ok && append_file(os, blob_file);
+			}
+			os.flush();
+			ok = ok && bool(os);
+		}
+		std::remove(sorted.c_str());
+		std::remove(node_file.c_str());
+		std::remove(label_file.c_str());
+		std::remove(value_file.c_str());
+		std::remove(blob_file.c_str());
+		return ok;
+	}
+
+	~external_builder()
+	{
+		while (!jobs.empty())
+			join_one();
+		remove_runs();
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_EXTERNAL_BUILDER_HPP
@@ -0,0 +1,534 @@
+#ifndef BOOST_TRIE_FIXED_ALPHABET_TRIE_HPP
+#define BOOST_TRIE_FIXED_ALPHABET_TRIE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "compact_trie_map.hpp"
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+
+//
+// fixed_alphabet_trie is a map for keys over a small alphabet known at
+// compile time, such as DNA bases, hex digits or decimal digits.  Alphabet
+// maps a key element to a dense code in [0, Alphabet::size) and back, and
+// the children of a node are an array indexed by the code, so a step down is
+// one load with no comparison and no search.  The codes follow the order of
+// the elements, so iteration is in key order.
+//
+// The nodes are in one arena and refer to each other by Index, as in
+// compact_trie_map, and the iterators are the same.  A key with an element
+// outside the alphabet is never in the map: insert() returns end() and
+// false for it, and for a full arena.  The lookups are in
+// detail::arena_trie_map, shared with compact_trie_map, and insert() is in
+// detail::dense_trie_map, which remapped_trie_map.hpp shares for an alphabet
+// chosen at run time.
+//
+// An Alphabet has
+//   typedef ... symbol_type;
+//   enum { size = ..., bits = ... };   // bits: enough for a code
+//   static int code(symbol_type c);    // -1 if c is not in the alphabet
+//   static symbol_type symbol(int code);
+//
+
+namespace boost { namespace tries {
+
+// A < C < G < T
+struct dna_alphabet {
+	typedef char symbol_type;
+	enum { size = 4, bits = 2 };
+
+	static int code(symbol_type c)
+	{
+		switch (c)
+		{
+			case 'A': return 0;
+			case 'C': return 1;
+			case 'G': return 2;
+			case 'T': return 3;
+			default: return -1;
+		}
+	}
+
+	static symbol_type symbol(int code)
+	{
+		return "ACGT"[code];
+	}
+};
+
+// 0-9 then a-f, lower case only so the codes keep the order of the chars
+struct hex_alphabet {
+	typedef char symbol_type;
+	enum { size = 16, bits = 4 };
+
+	static int code(symbol_type c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		return -1;
+	}
+
+	static symbol_type symbol(int code)
+	{
+		return "0123456789abcdef"[code];
+	}
+};
+
+struct decimal_alphabet {
+	typedef char symbol_type;
+	enum { size = 10, bits = 4 };
+
+	static int code(symbol_type c)
+	{
+		return (c >= '0' && c <= '9') ? c - '0' : -1;
+	}
+
+	static symbol_type symbol(int code)
+	{
+		return symbol_type('0' + code);
+	}
+};
+
+// pack the codes of [first, last) into one word, the first element in the
+// highest bits; false if a symbol is not in the alphabet or the key does not
+// fit, which for DNA is more than 32 bases
+template <class Alphabet, typename Iter>
+bool pack_symbols(Iter first, Iter last, boost::uint64_t& word)
+{
+	word = 0;
+	for (unsigned used = 0; first != last; ++first, used += Alphabet::bits)
+	{
+		int c = Alphabet::code(*first);
+		if (c < 0 || used + Alphabet::bits > 64)
+			return false;
+		word = (word << Alphabet::bits) | boost::uint64_t(c);
+	}
+	return true;
+}
+
+template <class Alphabet>
+std::vector<typename Alphabet::symbol_type> unpack_symbols(boost::uint64_t word, size_t length)
+{
+	std::vector<typename Alphabet::symbol_type> ret(length);
+	for (size_t i = length; i-- > 0; word >>= Alphabet::bits)
+		ret[i] = Alphabet::symbol(int(word & ((boost::uint64_t(1) << Alphabet::bits) - 1)));
+	return ret;
+}
+
+namespace detail {
+
+template <typename Index, size_t N>
+struct fixed_alphabet_node {
+	// by code, none for a missing child
+	boost::array<Index, N> child;
+	// chains the free nodes too
+	Index parent;
+	// the slot in the value table, or none
+	Index value;
+	// values in the sub-trie
+	Index value_count;
+};
+
+// the nodes and values of a trie whose children are an array indexed by
+// code, and the walks compact_trie_iterator and arena_trie_map need; Derived
+// keeps the child arrays and has code(), symbol(), width(), child(),
+// set_child(), push_children(), clear_children(), drop_children() and
+// swap_children(), and may hide child_from(), child_before() and code_of()
+// with faster ones
+template <class Derived, typename Key, typename Value, typename Index, class Node>
+struct dense_arena {
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef Index index_type;
+	typedef size_t size_type;
+	typedef Node node_type;
+
+	std::vector<node_type> nodes;
+	std::vector<value_type> values;
+	index_type free_node;
+	size_type free_node_count;
+	std::vector<index_type> free_values;
+
+	static index_type none()
+	{
+		return index_type(-1);
+	}
+
+	static size_type max_node_count()
+	{
+		return size_type(index_type(-1)) - 1;
+	}
+
+	explicit dense_arena() : free_node(none()), free_node_count(0)
+	{
+	}
+
+	Derived& derived()
+	{
+		return static_cast<Derived&>(*this);
+	}
+
+	const Derived& derived() const
+	{
+		return static_cast<const Derived&>(*this);
+	}
+
+	// drop everything but the root, Derived has to be constructed
+	void reset()
+	{
+		nodes.clear();
+		values.clear();
+		free_values.clear();
+		free_node = none();
+		free_node_count = 0;
+		derived().drop_children();
+		new_node(none());
+	}
+
+	bool has_value(index_type n) const
+	{
+		return nodes[n].value != none();
+	}
+
+	// the first child with a code not less than from, or none
+	index_type child_from(index_type n, int from) const
+	{
+		for (int c = from; c < int(derived().width()); ++c)
+			if (derived().child(n, c) != none())
+				return derived().child(n, c);
+		return none();
+	}
+
+	// the last child with a code less than to, or none
+	index_type child_before(index_type n, int to) const
+	{
+		for (int c = to; c-- > 0; )
+			if (derived().child(n, c) != none())
+				return derived().child(n, c);
+		return none();
+	}
+
+	// the step arena_trie_map takes down the edge k, none for a k outside
+	// the alphabet
+	index_type step(index_type n, const key_type& k) const
+	{
+		int c = derived().code(k);
+		return c < 0 ? none() : derived().child(n, c);
+	}
+
+	index_type parent_of(index_type n) const
+	{
+		return nodes[n].parent;
+	}
+
+	bool has_children(index_type n) const
+	{
+		return derived().child_from(n, 0) != none();
+	}
+
+	// the code of the edge from the parent to n
+	int code_of(index_type n) const
+	{
+		index_type p = nodes[n].parent;
+		int c = 0;
+		while (derived().child(p, c) != n)
+			++c;
+		return c;
+	}
+
+	index_type new_node(index_type parent)
+	{
+		index_type n = free_node;
+		if (n != none())
+		{
+			free_node = nodes[n].parent;
+			--free_node_count;
+		}
+		else {
+			n = index_type(nodes.size());
+			nodes.push_back(node_type());
+			derived().push_children();
+		}
+		nodes[n].parent = parent;
+		nodes[n].value = none();
+		nodes[n].value_count = 0;
+		derived().clear_children(n);
+		return n;
+	}
+
+	// the child with the code, made if it is missing
+	index_type add_child(index_type n, int code)
+	{
+		index_type c = derived().child(n, code);
+		if (c != none())
+			return c;
+		c = new_node(n);
+		derived().set_child(n, code, c);
+		return c;
+	}
+
+	// take a childless node off its parent
+	void free_leaf(index_type n)
+	{
+		derived().set_child(nodes[n].parent, derived().code_of(n), none());
+		nodes[n].parent = free_node;
+		free_node = n;
+		++free_node_count;
+	}
+
+	index_type new_value(const value_type& v)
+	{
+		if (free_values.empty())
+		{
+			values.push_back(v);
+			return index_type(values.size() - 1);
+		}
+		index_type s = free_values.back();
+		free_values.pop_back();
+		values[s] = v;
+		return s;
+	}
+
+	// every leaf has a value, so going down first children finds one
+	index_type first_value_from(index_type n) const
+	{
+		while (!has_value(n))
+			n = derived().child_from(n, 0);
+		return n;
+	}
+
+	// the first node with a value after the sub-trie of n, or none
+	index_type after(index_type n) const
+	{
+		for (; n != 0; n = nodes[n].parent)
+		{
+			index_type s = derived().child_from(nodes[n].parent, derived().code_of(n) + 1);
+			if (s != none())
+				return first_value_from(s);
+		}
+		return none();
+	}
+
+	index_type next(index_type n) const
+	{
+		index_type c = derived().child_from(n, 0);
+		if (c != none())
+			return first_value_from(c);
+		return after(n);
+	}
+
+	// the last child of n, or none
+	index_type last_child(index_type n) const
+	{
+		return derived().child_before(n, int(derived().width()));
+	}
+
+	// the last node of the sub-trie in key order
+	index_type last_below(index_type n) const
+	{
+		for (index_type c = last_child(n); c != none(); c = last_child(n))
+			n = c;
+		return n;
+	}
+
+	// the node with a value before n, none() for the one before the first
+	index_type prev(index_type n) const
+	{
+		if (n == none())
+		{
+			n = last_below(0);
+			return has_value(n) ? n : none();
+		}
+		while (n != 0)
+		{
+			index_type p = nodes[n].parent;
+			index_type s = derived().child_before(p, derived().code_of(n));
+			if (s != none())
+				return last_below(s);
+			if (has_value(p))
+				return p;
+			n = p;
+		}
+		return none();
+	}
+
+	index_type first() const
+	{
+		if (nodes[0].value_count == 0)
+			return none();
+		return first_value_from(0);
+	}
+
+	std::vector<key_type> key_of(index_type n) const
+	{
+		std::vector<key_type> ret;
+		for (; n != 0; n = nodes[n].parent)
+			ret.push_back(derived().symbol(derived().code_of(n)));
+		return std::vector<key_type>(ret.rbegin(), ret.rend());
+	}
+
+	void swap(Derived& other)
+	{
+		nodes.swap(other.nodes);
+		values.swap(other.values);
+		std::swap(free_node, other.free_node);
+		std::swap(free_node_count, other.free_node_count);
+		free_values.swap(other.free_values);
+		derived().swap_children(other);
+	}
+};
+
+// the child arrays are in the nodes, sized by the alphabet at compile time
+template <class Alphabet, typename Value, typename Index>
+struct fixed_alphabet_arena : public dense_arena<fixed_alphabet_arena<Alphabet, Value, Index>,
+	typename Alphabet::symbol_type, Value, Index, fixed_alphabet_node<Index, Alphabet::size> >
+{
+	typedef typename Alphabet::symbol_type key_type;
+	typedef Index index_type;
+
+	explicit fixed_alphabet_arena()
+	{
+		this->reset();
+	}
+
+	static int code(key_type k)
+	{
+		return Alphabet::code(k);
+	}
+
+	static key_type symbol(int code)
+	{
+		return Alphabet::symbol(code);
+	}
+
+	static size_t width()
+	{
+		return Alphabet::size;
+	}
+
+	index_type child(index_type n, int code) const
+	{
+		return this->nodes[n].child[code];
+	}
+
+	void set_child(index_type n, int code, index_type c)
+	{
+		this->nodes[n].child[code] = c;
+	}
+
+	void push_children()
+	{
+	}
+
+	void clear_children(index_type n)
+	{
+		this->nodes[n].child.assign(this->none());
+	}
+
+	void drop_children()
+	{
+	}
+
+	void swap_children(fixed_alphabet_arena&)
+	{
+	}
+};
+
+// the map over a dense_arena, Arena::code() maps a key element to its code
+template <class Arena>
+class dense_trie_map : public arena_trie_map<Arena> {
+public:
+	typedef arena_trie_map<Arena> base_type;
+	typedef typename base_type::value_type value_type;
+	typedef typename base_type::index_type index_type;
+	typedef typename base_type::size_type size_type;
+	typedef typename base_type::arena_type arena_type;
+	typedef typename base_type::pair_iterator_bool pair_iterator_bool;
+
+	explicit dense_trie_map()
+	{
+	}
+
+	explicit dense_trie_map(const arena_type& x) : base_type(x)
+	{
+	}
+
+	// (end(), false) for a key outside the alphabet or when the arena can
+	// not take the new nodes
+	template<typename Iter>
+	pair_iterator_bool insert(Iter first, Iter last, const value_type& value)
+	{
+		arena_type& a = this->a;
+		index_type n = 0;
+		for (; first != last; ++first)
+		{
+			int c = a.code(*first);
+			if (c < 0)
+				return std::make_pair(this->end(), false);
+			if (a.child(n, c) == arena_type::none())
+				break;
+			n = a.child(n, c);
+		}
+		if (first == last && a.has_value(n))
+			return std::make_pair(this->make_iterator(n), false);
+		// check the rest before a node is made
+		size_type rest = 0;
+		for (Iter i = first; i != last; ++i, ++rest)
+			if (a.code(*i) < 0)
+				return std::make_pair(this->end(), false);
+		size_type used = a.nodes.size() - a.free_node_count;
+		if (rest > arena_type::max_node_count() - used)
+			return std::make_pair(this->end(), false);
+		for (; first != last; ++first)
+			n = a.add_child(n, a.code(*first));
+		this->add_value(n, value);
+		return std::make_pair(this->make_iterator(n), true);
+	}
+
+	template<typename Container>
+	pair_iterator_bool insert(const Container& container, const value_type& value)
+	{
+		return insert(container.begin(), container.end(), value);
+	}
+
+	// the key has to be in the alphabet
+	template<typename Container>
+	value_type& operator [] (const Container& container)
+	{
+		return *insert(container, value_type()).first;
+	}
+
+	void clear()
+	{
+		this->a.reset();
+	}
+
+	void swap(dense_trie_map& other)
+	{
+		this->a.swap(other.a);
+	}
+};
+
+} // namespace detail
+
+
+template <class Alphabet, typename Value, typename Index = boost::uint32_t>
+class fixed_alphabet_trie : public detail::dense_trie_map<detail::fixed_alphabet_arena<Alphabet, Value, Index> > {
+public:
+	typedef Alphabet alphabet_type;
+	typedef fixed_alphabet_trie<Alphabet, Value, Index> fixed_alphabet_trie_type;
+
+	explicit fixed_alphabet_trie()
+	{
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_FIXED_ALPHABET_TRIE_HPP
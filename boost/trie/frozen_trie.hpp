@@ -0,0 +1,838 @@
+#ifndef BOOST_TRIE_FROZEN_TRIE_HPP
+#define BOOST_TRIE_FROZEN_TRIE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "trie.hpp"
+#include <vector>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <stdexcept>
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/is_pod.hpp>
+#include <boost/utility/string_view.hpp>
+
+//
+// frozen_trie is the read-only form of a trie, made by trie::freeze().
+//
+// Nodes are numbered breadth first, so the children of a node are a run of
+// consecutive nodes and their edge labels a sorted run of labels[].  Values are
+// stored depth first, so all the values under a node are one run of values[],
+// which makes find_prefix() a pair of indices and count_prefix() a subtraction.
+// A node is three 32-bit indices; parents, sibling links and the cached
+// leftmost/rightmost pointers are not needed, but a trie of more than
+// 2^32 - 2 values or nodes does not fit and freeze() throws length_error.
+//
+// Unlike trie::iterator, which never visits the values of the root, the
+// iterators here go over every value, so the values of the empty key come
+// first and std::distance(begin(), end()) is size() for any trie.
+//
+// save() writes the same arrays to a file that mapped_trie_map can use in
+// place, see the image layout below.
+//
+
+namespace boost { namespace tries {
+
+template <typename Key, class Compare>
+class static_trie_index;
+
+namespace detail {
+
+struct frozen_node {
+	typedef boost::uint32_t index_type;
+	index_type first_child;
+	// values of the whole sub-trie are [value_begin, value_end)
+	index_type value_begin;
+	index_type value_end;
+};
+
+// the navigation shared by frozen_trie and mapped_trie_map, over plain arrays
+template <typename Key, class Compare>
+struct frozen_layout {
+	typedef Key key_type;
+	typedef boost::uint32_t index_type;
+	static const index_type npos = index_type(-1);
+
+	// nodes[0] is the root, the last node is a sentinel that ends the child runs
+	const frozen_node *nodes;
+	// labels[i - 1] is the label of the edge into node i
+	const key_type *labels;
+	Compare comp;
+
+	explicit frozen_layout(const frozen_node *n, const key_type *l) : nodes(n), labels(l), comp()
+	{
+	}
+
+	index_type child_begin(index_type n) const
+	{
+		return nodes[n].first_child;
+	}
+
+	index_type child_end(index_type n) const
+	{
+		return nodes[n + 1].first_child;
+	}
+
+	index_type self_value_end(index_type n) const
+	{
+		if (child_begin(n) != child_end(n))
+			return nodes[child_begin(n)].value_begin;
+		return nodes[n].value_end;
+	}
+
+	bool has_value(index_type n) const
+	{
+		return nodes[n].value_begin != self_value_end(n);
+	}
+
+	// the child of n labeled k, or npos
+	index_type find_child(index_type n, const key_type& k) const
+	{
+		const key_type *first = labels + (child_begin(n) - 1);
+		const key_type *last = labels + (child_end(n) - 1);
+		const key_type *i = std::lower_bound(first, last, k, comp);
+		if (i == last || comp(k, *i))
+			return npos;
+		return index_type(i - labels) + 1;
+	}
+
+	template<typename Iter>
+	index_type find_node(Iter first, Iter last) const
+	{
+		index_type cur = 0;
+		for (; first != last && cur != npos; ++first)
+			cur = find_child(cur, *first);
+		return cur;
+	}
+
+	// the deepest node with values on the path of [first, last), or npos
+	template<typename Iter>
+	index_type longest_prefix_node(Iter first, Iter last) const
+	{
+		index_type cur = 0, ret = npos;
+		for (; first != last; ++first)
+		{
+			cur = find_child(cur, *first);
+			if (cur == npos)
+				break;
+			if (has_value(cur))
+				ret = cur;
+		}
+		return ret;
+	}
+
+	struct value_begin_less {
+		bool operator()(const frozen_node& n, index_type v) const
+		{
+			return n.value_begin <= v;
+		}
+	};
+
+	// the child runs and the value runs of nodes [0, n) and the sentinel nest
+	// properly, so arrays read from a file can be walked without leaving them
+	bool well_formed(index_type n, index_type value_count) const
+	{
+		if (n == 0 || nodes[0].value_begin != 0 || nodes[0].value_end != value_count || nodes[n].first_child != n)
+			return false;
+		// every child run lies in the arrays before a run is walked
+		for (index_type i = 0; i < n; ++i)
+			if (nodes[i].first_child <= i || nodes[i].first_child > nodes[i + 1].first_child)
+				return false;
+		for (index_type i = 0; i < n; ++i)
+		{
+			const frozen_node& p = nodes[i];
+			if (p.value_begin > p.value_end)
+				return false;
+			// the runs of the children are not empty and follow each other,
+			// so key_of_value() always finds the child that holds a value
+			index_type v = p.value_begin;
+			for (index_type c = p.first_child; c != nodes[i + 1].first_child; ++c)
+			{
+				if (nodes[c].value_begin < v || nodes[c].value_end <= nodes[c].value_begin ||
+						(c != p.first_child && nodes[c].value_begin != v))
+					return false;
+				v = nodes[c].value_end;
+			}
+			if (v > p.value_end || (p.first_child != nodes[i + 1].first_child && v != p.value_end))
+				return false;
+		}
+		return true;
+	}
+
+	std::vector<key_type> key_of_value(index_type v) const
+	{
+		std::vector<key_type> key;
+		index_type cur = 0;
+		while (v >= self_value_end(cur))
+		{
+			// the last child whose values start at or before v
+			const frozen_node *i = std::lower_bound(nodes + child_begin(cur), nodes + child_end(cur),
+					v, value_begin_less());
+			cur = index_type(i - nodes) - 1;
+			key.push_back(labels[cur - 1]);
+		}
+		return key;
+	}
+};
+
+// Container provides value_at(), key_of_value(), pointer_of() and the value typedefs
+template <class Container>
+class frozen_trie_iterator
+{
+public:
+	typedef std::random_access_iterator_tag iterator_category;
+	typedef typename Container::key_type key_type;
+	typedef typename Container::value_type value_type;
+	typedef typename Container::const_reference reference;
+	typedef typename Container::const_pointer pointer;
+	typedef ptrdiff_t difference_type;
+	typedef frozen_trie_iterator<Container> self;
+	typedef boost::uint32_t index_type;
+
+	const Container *f;
+	index_type vidx;
+
+	explicit frozen_trie_iterator() : f(0), vidx(0)
+	{
+	}
+
+	explicit frozen_trie_iterator(const Container *x, index_type v) : f(x), vidx(v)
+	{
+	}
+
+	std::vector<key_type> get_key() const
+	{
+		return f->key_of_value(vidx);
+	}
+
+	reference operator*() const
+	{
+		return f->value_at(vidx);
+	}
+
+	pointer operator->() const
+	{
+		return Container::pointer_of(operator*());
+	}
+
+	reference operator[](difference_type n) const
+	{
+		return f->value_at(vidx + n);
+	}
+
+	bool operator==(const self& other) const
+	{
+		return vidx == other.vidx;
+	}
+
+	bool operator!=(const self& other) const
+	{
+		return vidx != other.vidx;
+	}
+
+	bool operator<(const self& other) const
+	{
+		return vidx < other.vidx;
+	}
+
+	difference_type operator-(const self& other) const
+	{
+		return difference_type(vidx) - difference_type(other.vidx);
+	}
+
+	self& operator+=(difference_type n)
+	{
+		vidx += n;
+		return *this;
+	}
+
+	self operator+(difference_type n) const
+	{
+		return self(f, vidx + n);
+	}
+
+	self operator-(difference_type n) const
+	{
+		return self(f, vidx - n);
+	}
+
+	self& operator++()
+	{
+		++vidx;
+		return *this;
+	}
+
+	self operator++(int)
+	{
+		self tmp = *this;
+		++vidx;
+		return tmp;
+	}
+
+	self& operator--()
+	{
+		--vidx;
+		return *this;
+	}
+
+	self operator--(int)
+	{
+		self tmp = *this;
+		--vidx;
+		return tmp;
+	}
+};
+
+// the read-only interface of frozen_trie and mapped_trie_map,
+// Derived provides layout(), value_count() and node_total()
+template <class Derived, typename Key, class Compare>
+class frozen_trie_base
+{
+public:
+	typedef frozen_layout<Key, Compare> layout_type;
+	typedef typename layout_type::index_type index_type;
+	typedef frozen_trie_iterator<Derived> const_iterator;
+	typedef const_iterator iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+	typedef const_reverse_iterator reverse_iterator;
+	typedef std::pair<const_iterator, const_iterator> iterator_range;
+	typedef size_t size_type;
+
+private:
+	const Derived& derived() const
+	{
+		return static_cast<const Derived&>(*this);
+	}
+
+	const_iterator at(index_type v) const
+	{
+		return const_iterator(&derived(), v);
+	}
+
+public:
+	std::vector<Key> key_of_value(index_type v) const
+	{
+		return derived().layout().key_of_value(v);
+	}
+
+	const_iterator begin() const
+	{
+		return at(0);
+	}
+
+	const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	const_iterator end() const
+	{
+		return at(index_type(derived().value_count()));
+	}
+
+	const_iterator cend() const
+	{
+		return end();
+	}
+
+	const_reverse_iterator rbegin() const
+	{
+		return const_reverse_iterator(end());
+	}
+
+	const_reverse_iterator rend() const
+	{
+		return const_reverse_iterator(begin());
+	}
+
+	template<typename Iter>
+	const_iterator find(Iter first, Iter last) const
+	{
+		layout_type l = derived().layout();
+		index_type n = l.find_node(first, last);
+		if (n == layout_type::npos || !l.has_value(n))
+			return end();
+		return at(l.nodes[n].value_begin);
+	}
+
+	template<typename Container>
+	const_iterator find(const Container& container) const
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		layout_type l = derived().layout();
+		index_type n = l.find_node(first, last);
+		if (n == layout_type::npos)
+			return 0;
+		return l.self_value_end(n) - l.nodes[n].value_begin;
+	}
+
+	template<typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	// all values with the prefix, one contiguous run
+	template<typename Iter>
+	iterator_range find_prefix(Iter first, Iter last) const
+	{
+		layout_type l = derived().layout();
+		index_type n = l.find_node(first, last);
+		if (n == layout_type::npos)
+			return std::make_pair(end(), end());
+		return std::make_pair(at(l.nodes[n].value_begin), at(l.nodes[n].value_end));
+	}
+
+	template<typename Container>
+	iterator_range find_prefix(const Container& container) const
+	{
+		return find_prefix(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type count_prefix(Iter first, Iter last) const
+	{
+		layout_type l = derived().layout();
+		index_type n = l.find_node(first, last);
+		if (n == layout_type::npos)
+			return 0;
+		return l.nodes[n].value_end - l.nodes[n].value_begin;
+	}
+
+	template<typename Container>
+	size_type count_prefix(const Container& container) const
+	{
+		return count_prefix(container.begin(), container.end());
+	}
+
+	// the longest key that is a prefix of [first, last)
+	template<typename Iter>
+	const_iterator findLongestPrefixOfKey(Iter first, Iter last) const
+	{
+		layout_type l = derived().layout();
+		index_type n = l.longest_prefix_node(first, last);
+		if (n == layout_type::npos)
+			return end();
+		return at(l.nodes[n].value_begin);
+	}
+
+	template<typename Container>
+	const_iterator findLongestPrefixOfKey(const Container& container) const
+	{
+		return findLongestPrefixOfKey(container.begin(), container.end());
+	}
+
+	size_type size() const
+	{
+		return derived().value_count();
+	}
+
+	bool empty() const
+	{
+		return derived().value_count() == 0;
+	}
+
+	// the root is not counted, the same as trie::count_node()
+	size_type count_node() const
+	{
+		return derived().node_total() - 1;
+	}
+};
+
+//
+// image layout, all in native byte order, every section 8 byte aligned:
+//   trie_image_header
+//   frozen_node[node_count + 1]  (the last one is the sentinel)
+//   Key[node_count - 1]          edge labels
+//   values: Value[value_count] for POD values, or for strings
+//           uint64[value_count + 1] offsets into the blob, then the blob
+//
+struct trie_image_header {
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t byte_order;
+	boost::uint32_t key_size;
+	boost::uint32_t value_kind;
+	boost::uint32_t value_size;
+	boost::uint32_t reserved;
+	boost::uint64_t node_count;
+	boost::uint64_t value_count;
+	boost::uint64_t node_offset;
+	boost::uint64_t label_offset;
+	boost::uint64_t value_offset;
+	boost::uint64_t blob_offset;
+	boost::uint64_t blob_size;
+	boost::uint64_t file_size;
+
+	static const boost::uint32_t current_version = 1;
+	static const boost::uint32_t byte_order_mark = 0x01020304;
+
+	static const char * magic_string()
+	{
+		return "BTRIEIMG";
+	}
+
+	static boost::uint64_t align(boost::uint64_t x)
+	{
+		return (x + 7) & ~boost::uint64_t(7);
+	}
+};
+
+// operator-> for values that are returned by value
+template <typename T>
+struct arrow_proxy {
+	T value;
+
+	explicit arrow_proxy(const T& v) : value(v)
+	{
+	}
+
+	const T * operator->() const
+	{
+		return &value;
+	}
+};
+
+enum trie_image_value_kind { image_pod_value = 0, image_blob_value = 1 };
+
+// how the values are stored in an image, only POD values and std::string are supported
+template <typename Value, bool IsPod = boost::is_pod<Value>::value>
+struct trie_image_value;
+
+template <typename Value>
+struct trie_image_value<Value, true> {
+	typedef const Value& reference;
+	typedef const Value * pointer;
+	static const boost::uint32_t kind = image_pod_value;
+	static const boost::uint32_t size = sizeof(Value);
+
+	static boost::uint64_t blob_size(const Value *, size_t)
+	{
+		return 0;
+	}
+
+	static void write(std::ostream& os, const Value *values, size_t n)
+	{
+		if (n > 0)
+			os.write(reinterpret_cast<const char *>(values), n * sizeof(Value));
+	}
+
+	// for writing values one at a time: the bytes taken in the blob, and
+	// the value itself for the value section
+	static boost::uint64_t blob_bytes(const Value&)
+	{
+		return 0;
+	}
+
+	static void write_one(std::ostream& os, const Value& x)
+	{
+		os.write(reinterpret_cast<const char *>(&x), sizeof(Value));
+	}
+
+	static reference get(const char *values, const char *, size_t i)
+	{
+		return reinterpret_cast<const Value *>(values)[i];
+	}
+
+	static pointer pointer_of(reference r)
+	{
+		return &r;
+	}
+};
+
+template <>
+struct trie_image_value<std::string, false> {
+	typedef boost::string_view reference;
+	typedef arrow_proxy<reference> pointer;
+	static const boost::uint32_t kind = image_blob_value;
+	static const boost::uint32_t size = 0;
+
+	static boost::uint64_t blob_size(const std::string *values, size_t n)
+	{
+		boost::uint64_t ret = 0;
+		for (size_t i = 0; i < n; ++i)
+			ret += values[i].size();
+		return ret;
+	}
+
+	static boost::uint64_t blob_bytes(const std::string& x)
+	{
+		return x.size();
+	}
+
+	// the characters, for the blob
+	static void write_one(std::ostream& os, const std::string& x)
+	{
+		os.write(x.data(), x.size());
+	}
+
+	static void write(std::ostream& os, const std::string *values, size_t n)
+	{
+		boost::uint64_t off = 0;
+		for (size_t i = 0; i <= n; ++i)
+		{
+			os.write(reinterpret_cast<const char *>(&off), sizeof(off));
+			if (i < n)
+				off += values[i].size();
+		}
+		for (size_t i = 0; i < n; ++i)
+			os.write(values[i].data(), values[i].size());
+	}
+
+	static reference get(const char *values, const char *blob, size_t i)
+	{
+		const boost::uint64_t *off = reinterpret_cast<const boost::uint64_t *>(values);
+		return reference(blob + off[i], size_t(off[i + 1] - off[i]));
+	}
+
+	static pointer pointer_of(reference r)
+	{
+		return pointer(r);
+	}
+};
+
+// the header of an image with node_count nodes (the sentinel not counted)
+template <typename Key, typename Value>
+trie_image_header make_image_header(boost::uint64_t node_count, boost::uint64_t value_count, boost::uint64_t blob_size)
+{
+	typedef trie_image_value<Value> value_traits;
+	trie_image_header h;
+	std::memset(&h, 0, sizeof(h));
+	std::memcpy(h.magic, h.magic_string(), sizeof(h.magic));
+	h.version = h.current_version;
+	h.byte_order = h.byte_order_mark;
+	h.key_size = sizeof(Key);
+	h.value_kind = value_traits::kind;
+	h.value_size = value_traits::size;
+	h.node_count = node_count;
+	h.value_count = value_count;
+	h.node_offset = h.align(sizeof(h));
+	h.label_offset = h.align(h.node_offset + (node_count + 1) * sizeof(frozen_node));
+	h.value_offset = h.align(h.label_offset + (node_count - 1) * sizeof(Key));
+	if (value_traits::kind == image_pod_value)
+	{
+		h.blob_offset = h.align(h.value_offset + value_count * sizeof(Value));
+		h.file_size = h.value_offset + value_count * sizeof(Value);
+	}
+	else {
+		h.blob_offset = h.align(h.value_offset + (value_count + 1) * sizeof(boost::uint64_t));
+		h.blob_size = blob_size;
+		h.file_size = h.blob_offset + blob_size;
+	}
+	return h;
+}
+
+inline void write_padding(std::ostream& os, boost::uint64_t from, boost::uint64_t to)
+{
+	for (; from < to; ++from)
+		os.put(0);
+}
+
+} // namespace detail
+
+
+template <typename Key, typename Value, class Compare>
+class frozen_trie : public detail::frozen_trie_base<frozen_trie<Key, Value, Compare>, Key, Compare>
+{
+public:
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef const value_type& const_reference;
+	typedef const value_type * const_pointer;
+	typedef trie<Key, Value, Compare> trie_type;
+	typedef frozen_trie<Key, Value, Compare> frozen_type;
+	typedef detail::frozen_trie_base<frozen_type, Key, Compare> base_type;
+	typedef detail::frozen_node frozen_node;
+	typedef typename base_type::layout_type layout_type;
+	typedef typename base_type::index_type index_type;
+	typedef typename base_type::const_iterator const_iterator;
+	typedef typename base_type::iterator iterator;
+	typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+	typedef typename base_type::reverse_iterator reverse_iterator;
+	typedef typename base_type::iterator_range iterator_range;
+	typedef size_t size_type;
+
+private:
+	template <typename K, class C>
+	friend class static_trie_index;
+
+	std::vector<frozen_node> nodes;
+	std::vector<key_type> labels;
+	std::vector<value_type> values;
+
+	// the values of a trie node, in the order of its store
+	template <class Node>
+	void push_values(const Node *n)
+	{
+		if (n->no_value())
+			return;
+		typename Node::value_store_type::cursor pos = n->values.first();
+		do {
+			values.push_back(n->values.value(pos));
+		} while (n->values.next(pos));
+	}
+
+public:
+	explicit frozen_trie()
+	{
+		frozen_node r = { 1, 0, 0 };
+		frozen_node sentinel = { 1, 0, 0 };
+		nodes.push_back(r);
+		nodes.push_back(sentinel);
+	}
+
+	// from a trie with any value store and features; length_error if its
+	// values or its nodes, with the root and the sentinel, do not fit index_type
+	template <class Store, class Features>
+	explicit frozen_trie(const trie<Key, Value, Compare, Store, Features>& t)
+	{
+		typedef trie<Key, Value, Compare, Store, Features> source_type;
+		typedef typename source_type::node_type node_type;
+		typedef typename source_type::node_ptr node_ptr;
+
+		// npos is kept out of the indices
+		if (t.size() >= size_type(layout_type::npos) || t.count_node() >= size_type(layout_type::npos) - 1)
+			throw std::length_error("frozen_trie: too many values or nodes for index_type");
+
+		// number the nodes breadth first
+		std::vector<node_ptr> order;
+		order.push_back(t.root_node());
+		for (size_type i = 0; i < order.size(); ++i)
+		{
+			frozen_node n = { index_type(order.size()), 0, 0 };
+			nodes.push_back(n);
+			node_ptr cur = order[i];
+			for (typename node_type::child_iter ci = cur->child.begin(); ci != cur->child.end(); ++ci)
+			{
+				labels.push_back(ci->first);
+				order.push_back(ci->second);
+			}
+		}
+		frozen_node sentinel = { index_type(order.size()), 0, 0 };
+		nodes.push_back(sentinel);
+
+		// lay out the values depth first
+		layout_type l = layout();
+		values.reserve(t.size());
+		std::vector<std::pair<index_type, index_type> > stk;
+		stk.push_back(std::make_pair(index_type(0), l.child_begin(0)));
+		nodes[0].value_begin = 0;
+		push_values(order[0]);
+		while (!stk.empty())
+		{
+			index_type cur = stk.back().first;
+			if (stk.back().second == l.child_end(cur))
+			{
+				nodes[cur].value_end = index_type(values.size());
+				stk.pop_back();
+				continue;
+			}
+			index_type c = stk.back().second++;
+			nodes[c].value_begin = index_type(values.size());
+			push_values(order[c]);
+			stk.push_back(std::make_pair(c, l.child_begin(c)));
+		}
+	}
+
+	layout_type layout() const
+	{
+		return layout_type(&nodes[0], labels.empty() ? NULL : &labels[0]);
+	}
+
+	size_type value_count() const
+	{
+		return values.size();
+	}
+
+	size_type node_total() const
+	{
+		return nodes.size() - 1;
+	}
+
+	const_reference value_at(index_type v) const
+	{
+		return values[v];
+	}
+
+	static const_pointer pointer_of(const_reference r)
+	{
+		return &r;
+	}
+
+	// rebuild a mutable trie with the same content
+	template <class Store, class Features>
+	void thaw(trie<Key, Value, Compare, Store, Features>& t) const
+	{
+		layout_type l = layout();
+		t.clear();
+		bulk_update<trie<Key, Value, Compare, Store, Features> > scope(t);
+		std::vector<key_type> key;
+		std::vector<std::pair<index_type, index_type> > stk;
+		stk.push_back(std::make_pair(index_type(0), l.child_begin(0)));
+		for (index_type v = l.self_value_end(0); v-- > nodes[0].value_begin; )
+			t.insert_equal(key, values[v]);
+		while (!stk.empty())
+		{
+			index_type cur = stk.back().first;
+			if (stk.back().second == l.child_end(cur))
+			{
+				if (cur != 0)
+					key.pop_back();
+				stk.pop_back();
+				continue;
+			}
+			index_type c = stk.back().second++;
+			key.push_back(labels[c - 1]);
+			// insert_equal() puts a value in front of the others with the same key
+			for (index_type v = l.self_value_end(c); v-- > nodes[c].value_begin; )
+				t.insert_equal(key, values[v]);
+			stk.push_back(std::make_pair(c, l.child_begin(c)));
+		}
+	}
+
+	// write an image that mapped_trie_map can open, Key has to be POD and
+	// Value POD or std::string
+	bool save(const std::string& path) const
+	{
+		typedef detail::trie_image_value<value_type> value_traits;
+		const value_type *vp = values.empty() ? NULL : &values[0];
+		detail::trie_image_header h = detail::make_image_header<key_type, value_type>(nodes.size() - 1,
+				values.size(), value_traits::blob_size(vp, values.size()));
+
+		std::ofstream os(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!os)
+			return false;
+		os.write(reinterpret_cast<const char *>(&h), sizeof(h));
+		detail::write_padding(os, sizeof(h), h.node_offset);
+		os.write(reinterpret_cast<const char *>(&nodes[0]), nodes.size() * sizeof(frozen_node));
+		detail::write_padding(os, h.node_offset + nodes.size() * sizeof(frozen_node), h.label_offset);
+		if (!labels.empty())
+			os.write(reinterpret_cast<const char *>(&labels[0]), labels.size() * sizeof(key_type));
+		detail::write_padding(os, h.label_offset + labels.size() * sizeof(key_type), h.value_offset);
+		value_traits::write(os, vp, values.size());
+		os.flush();
+		return bool(os);
+	}
+
+	void swap(frozen_type& other)
+	{
+		nodes.swap(other.nodes);
+		labels.swap(other.labels);
+		values.swap(other.values);
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_FROZEN_TRIE_HPP
@@ -0,0 +1,823 @@
+#ifndef BOOST_TRIE_LOUDS_TRIE_HPP
+#define BOOST_TRIE_LOUDS_TRIE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "frozen_trie.hpp"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+//
+// louds_trie is a succinct read-only set of keys, in the level-order unary
+// degree sequence (LOUDS) encoding.  The nodes are numbered breadth first, the
+// same as in frozen_trie, and the shape of the trie is one bit vector: "10"
+// for a super root, then for every node a 1 per child and a 0.  That is
+// 2n + 1 bits for n nodes; with a rank directory every 512 bits, which also
+// drives select, the shape takes about 2.1 bits a node.  One more bit a node
+// marks the nodes where a key ends, and the edge labels are one array in node
+// order, so the children of a node have consecutive labels.
+//
+//   first_child(x) = select0(x + 1) - x
+//   child count    = select0(x + 2) - select0(x + 1) - 1
+//   parent(c)      = rank0(select1(c + 1)) - 1
+//
+// The id of a key is the rank of its node among the nodes where keys end, in
+// [0, size()); key_of() climbs back from the node.  The keys under a node are
+// a run of nodes on every level below it, so count_prefix() is a couple of
+// ranks per level.
+//
+// Everything lives in one image of 8 byte aligned sections, which is what
+// save() writes, and open() maps a saved image read-only and uses it in place
+// once a pass over the bit vectors has checked them.
+//
+
+namespace boost { namespace tries {
+
+namespace detail {
+
+inline unsigned popcount64(boost::uint64_t x)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountll(x);
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return unsigned((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+// a read-only bit vector with a rank directory
+struct louds_bits {
+	typedef boost::uint64_t word_type;
+	enum { block_words = 8, block_bits = 512 };
+
+	const word_type *words;
+	// ones before each block, and the total at the end
+	const boost::uint32_t *ranks;
+	boost::uint64_t size;
+
+	static boost::uint64_t word_count(boost::uint64_t bits)
+	{
+		return (bits + 63) / 64;
+	}
+
+	static boost::uint64_t block_count(boost::uint64_t bits)
+	{
+		return (word_count(bits) + block_words - 1) / block_words;
+	}
+
+	bool get(boost::uint64_t i) const
+	{
+		return (words[i / 64] >> (i % 64)) & 1;
+	}
+
+	// ones in [0, i)
+	boost::uint64_t rank1(boost::uint64_t i) const
+	{
+		boost::uint64_t b = i / block_bits;
+		boost::uint64_t r = ranks[b];
+		for (boost::uint64_t w = b * block_words; w < i / 64; ++w)
+			r += popcount64(words[w]);
+		if (i % 64 != 0)
+			r += popcount64(words[i / 64] & ((word_type(1) << (i % 64)) - 1));
+		return r;
+	}
+
+	boost::uint64_t rank0(boost::uint64_t i) const
+	{
+		return i - rank1(i);
+	}
+
+	// the position of the k-th one (or zero), k from 1
+	boost::uint64_t select(boost::uint64_t k, bool one) const
+	{
+		// the last block with less than k before it
+		boost::uint64_t lo = 0, hi = block_count(size);
+		while (lo + 1 < hi)
+		{
+			boost::uint64_t mid = (lo + hi) / 2;
+			if (before(mid, one) < k)
+				lo = mid;
+			else
+				hi = mid;
+		}
+		k -= before(lo, one);
+		for (boost::uint64_t w = lo * block_words; w < word_count(size); ++w)
+		{
+			word_type x = one ? words[w] : ~words[w];
+			unsigned c = popcount64(x);
+			if (c >= k)
+			{
+				for (unsigned bit = 0; ; ++bit)
+					if (((x >> bit) & 1) && --k == 0)
+						return w * 64 + bit;
+			}
+			k -= c;
+		}
+		// there are less than k
+		return size;
+	}
+
+	boost::uint64_t select1(boost::uint64_t k) const
+	{
+		return select(k, true);
+	}
+
+	boost::uint64_t select0(boost::uint64_t k) const
+	{
+		return select(k, false);
+	}
+
+	// the rank directory counts the ones, which are as many as expected, and
+	// the bits past the end are clear
+	bool valid(boost::uint64_t ones) const
+	{
+		boost::uint64_t r = 0;
+		for (boost::uint64_t w = 0; w < word_count(size); ++w)
+		{
+			if (w % block_words == 0 && ranks[w / block_words] != r)
+				return false;
+			r += popcount64(words[w]);
+		}
+		if (size % 64 != 0 && (words[size / 64] >> (size % 64)) != 0)
+			return false;
+		return ranks[block_count(size)] == r && r == ones;
+	}
+
+private:
+	boost::uint64_t before(boost::uint64_t block, bool one) const
+	{
+		return one ? ranks[block] : block * block_bits - ranks[block];
+	}
+};
+
+// collects the bits of a louds_bits
+struct louds_bits_builder {
+	std::vector<boost::uint64_t> words;
+	boost::uint64_t size;
+
+	explicit louds_bits_builder() : size(0)
+	{
+	}
+
+	void push_back(bool bit)
+	{
+		if (size % 64 == 0)
+			words.push_back(0);
+		if (bit)
+			words.back() |= boost::uint64_t(1) << (size % 64);
+		++size;
+	}
+
+	std::vector<boost::uint32_t> rank_directory() const
+	{
+		boost::uint64_t blocks = louds_bits::block_count(size);
+		std::vector<boost::uint32_t> ret(blocks + 1, 0);
+		boost::uint32_t r = 0;
+		for (boost::uint64_t i = 0; i < words.size(); ++i)
+		{
+			if (i % louds_bits::block_words == 0)
+				ret[i / louds_bits::block_words] = r;
+			r += popcount64(words[i]);
+		}
+		ret[blocks] = r;
+		return ret;
+	}
+};
+
+struct louds_image_header {
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t byte_order;
+	boost::uint32_t key_size;
+	boost::uint32_t reserved;
+	// the root included
+	boost::uint64_t node_count;
+	boost::uint64_t key_count;
+	boost::uint64_t tree_offset;
+	boost::uint64_t tree_rank_offset;
+	boost::uint64_t terminal_offset;
+	boost::uint64_t terminal_rank_offset;
+	boost::uint64_t label_offset;
+	boost::uint64_t file_size;
+
+	static const boost::uint32_t current_version = 1;
+	static const boost::uint32_t byte_order_mark = 0x01020304;
+
+	static const char * magic_string()
+	{
+		return "BTRIELDS";
+	}
+
+	static boost::uint64_t align(boost::uint64_t x)
+	{
+		return (x + 7) & ~boost::uint64_t(7);
+	}
+
+	boost::uint64_t tree_bits() const
+	{
+		return 2 * node_count + 1;
+	}
+
+	// the section offsets and the file size for the counts
+	void lay_out(boost::uint64_t label_size)
+	{
+		tree_offset = align(sizeof(*this));
+		tree_rank_offset = tree_offset + louds_bits::word_count(tree_bits()) * 8;
+		terminal_offset = align(tree_rank_offset + (louds_bits::block_count(tree_bits()) + 1) * 4);
+		terminal_rank_offset = terminal_offset + louds_bits::word_count(node_count) * 8;
+		label_offset = align(terminal_rank_offset + (louds_bits::block_count(node_count) + 1) * 4);
+		file_size = align(label_offset + (node_count - 1) * label_size);
+	}
+};
+
+} // namespace detail
+
+template <typename Key, class Compare>
+class louds_trie;
+
+namespace detail {
+
+// a key of a louds_trie in key order, the stack holds the path to it
+template <typename Key, class Compare>
+struct louds_trie_iterator {
+	typedef std::forward_iterator_tag iterator_category;
+	typedef Key key_type;
+	typedef std::vector<key_type> value_type;
+	typedef const value_type& reference;
+	typedef const value_type* pointer;
+	typedef ptrdiff_t difference_type;
+	typedef louds_trie<Key, Compare> trie_type;
+	typedef boost::uint64_t node_type;
+	typedef louds_trie_iterator<Key, Compare> self;
+
+	struct frame {
+		node_type node;
+		// the children still to visit
+		node_type next;
+		node_type end;
+	};
+
+	const trie_type *t;
+	std::vector<frame> stk;
+	value_type key;
+
+	explicit louds_trie_iterator() : t(0)
+	{
+	}
+
+	// at node, which has the key; the frames above it come from path
+	explicit louds_trie_iterator(const trie_type *owner, const std::vector<node_type>& path, const value_type& k,
+			bool subtree_only) : t(owner), key(k)
+	{
+		for (size_t i = subtree_only ? path.size() - 1 : 0; i < path.size(); ++i)
+		{
+			frame f;
+			f.node = path[i];
+			t->children(f.node, f.next, f.end);
+			if (i + 1 < path.size())
+				f.next = path[i + 1] + 1;
+			stk.push_back(f);
+		}
+		if (!t->is_terminal(path.back()))
+			advance();
+	}
+
+	void advance()
+	{
+		while (!stk.empty())
+		{
+			frame& top = stk.back();
+			if (top.next == top.end)
+			{
+				stk.pop_back();
+				if (!stk.empty())
+					key.pop_back();
+				continue;
+			}
+			frame f;
+			f.node = top.next++;
+			t->children(f.node, f.next, f.end);
+			stk.push_back(f);
+			key.push_back(t->label_of(f.node));
+			if (t->is_terminal(f.node))
+				return;
+		}
+		key.clear();
+	}
+
+	const value_type& get_key() const
+	{
+		return key;
+	}
+
+	// the id of the key, see louds_trie::id_of()
+	size_t id() const
+	{
+		return t->id_of_node(stk.back().node);
+	}
+
+	reference operator*() const
+	{
+		return key;
+	}
+
+	pointer operator->() const
+	{
+		return &key;
+	}
+
+	self& operator++()
+	{
+		advance();
+		return *this;
+	}
+
+	self operator++(int)
+	{
+		self tmp = *this;
+		advance();
+		return tmp;
+	}
+
+	bool operator==(const self& other) const
+	{
+		if (stk.empty() || other.stk.empty())
+			return stk.empty() == other.stk.empty();
+		return stk.back().node == other.stk.back().node;
+	}
+
+	bool operator!=(const self& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+} // namespace detail
+
+template <typename Key, class Compare = std::less<Key> >
+class louds_trie {
+public:
+	typedef Key key_type;
+	typedef size_t size_type;
+	typedef boost::uint64_t node_type;
+	typedef louds_trie<Key, Compare> louds_trie_type;
+	typedef detail::louds_trie_iterator<Key, Compare> iterator;
+	typedef iterator const_iterator;
+	typedef std::pair<iterator, iterator> iterator_range;
+	typedef detail::louds_image_header header_type;
+	static const size_type npos = size_type(-1);
+
+	friend struct detail::louds_trie_iterator<Key, Compare>;
+
+private:
+	// the image when built in memory, or the mapping of an opened one
+	std::vector<boost::uint64_t> buffer;
+	boost::interprocess::mapped_region region;
+	const header_type *header;
+	detail::louds_bits tree;
+	detail::louds_bits terminal;
+	const key_type *labels;
+	Compare comp;
+
+	louds_trie(const louds_trie_type&);
+	louds_trie_type& operator=(const louds_trie_type&);
+
+	// point the views into the image at base
+	void bind(const char *base)
+	{
+		header = reinterpret_cast<const header_type *>(base);
+		tree.words = reinterpret_cast<const boost::uint64_t *>(base + header->tree_offset);
+		tree.ranks = reinterpret_cast<const boost::uint32_t *>(base + header->tree_rank_offset);
+		tree.size = header->tree_bits();
+		terminal.words = reinterpret_cast<const boost::uint64_t *>(base + header->terminal_offset);
+		terminal.ranks = reinterpret_cast<const boost::uint32_t *>(base + header->terminal_rank_offset);
+		terminal.size = header->node_count;
+		labels = reinterpret_cast<const key_type *>(base + header->label_offset);
+	}
+
+	// the image of a trie given breadth first
+	void assemble(const std::vector<node_type>& degree, const std::vector<key_type>& label_list,
+			const detail::louds_bits_builder& term)
+	{
+		detail::louds_bits_builder shape;
+		shape.push_back(true);
+		shape.push_back(false);
+		for (size_type i = 0; i < degree.size(); ++i)
+		{
+			for (node_type c = 0; c < degree[i]; ++c)
+				shape.push_back(true);
+			shape.push_back(false);
+		}
+		header_type h;
+		std::memset(&h, 0, sizeof(h));
+		std::memcpy(h.magic, h.magic_string(), sizeof(h.magic));
+		h.version = h.current_version;
+		h.byte_order = h.byte_order_mark;
+		h.key_size = sizeof(key_type);
+		h.node_count = degree.size();
+		h.key_count = term.rank_directory().back();
+		h.lay_out(sizeof(key_type));
+
+		std::vector<boost::uint64_t> img(h.file_size / 8, 0);
+		char *base = reinterpret_cast<char *>(&img[0]);
+		std::memcpy(base, &h, sizeof(h));
+		std::vector<boost::uint32_t> r = shape.rank_directory();
+		std::memcpy(base + h.tree_offset, &shape.words[0], shape.words.size() * 8);
+		std::memcpy(base + h.tree_rank_offset, &r[0], r.size() * 4);
+		r = term.rank_directory();
+		if (!term.words.empty())
+			std::memcpy(base + h.terminal_offset, &term.words[0], term.words.size() * 8);
+		std::memcpy(base + h.terminal_rank_offset, &r[0], r.size() * 4);
+		if (!label_list.empty())
+			std::memcpy(base + h.label_offset, &label_list[0], label_list.size() * sizeof(key_type));
+		boost::interprocess::mapped_region().swap(region);
+		buffer.swap(img);
+		bind(reinterpret_cast<const char *>(&buffer[0]));
+	}
+
+	void assemble_empty()
+	{
+		detail::louds_bits_builder term;
+		term.push_back(false);
+		assemble(std::vector<node_type>(1, 0), std::vector<key_type>(), term);
+	}
+
+	static bool valid_header(const header_type& h, boost::uint64_t file_size)
+	{
+		if (std::memcmp(h.magic, h.magic_string(), sizeof(h.magic)) != 0)
+			return false;
+		if (h.version != h.current_version || h.byte_order != h.byte_order_mark || h.key_size != sizeof(key_type))
+			return false;
+		if (h.node_count == 0 || h.node_count >= boost::uint32_t(-1) / 4 || h.key_count > h.node_count)
+			return false;
+		header_type x = h;
+		x.lay_out(sizeof(key_type));
+		return x.tree_offset == h.tree_offset && x.tree_rank_offset == h.tree_rank_offset &&
+			x.terminal_offset == h.terminal_offset && x.terminal_rank_offset == h.terminal_rank_offset &&
+			x.label_offset == h.label_offset && x.file_size == h.file_size && h.file_size <= file_size;
+	}
+
+	// the bit vectors agree with their directories and the header, and every
+	// node comes after its parent, so no walk leaves the image or goes round
+	bool well_formed() const
+	{
+		if (!tree.valid(header->node_count) || !terminal.valid(header->key_count))
+			return false;
+		// the one of node k has the zeros of nodes [0, parent(k)] before it
+		boost::uint64_t ones = 0, zeros = 0;
+		for (boost::uint64_t i = 0; i < tree.size; ++i)
+		{
+			if (!tree.get(i))
+			{
+				++zeros;
+				continue;
+			}
+			if (ones == 0 ? zeros != 0 : (zeros == 0 || zeros > ones))
+				return false;
+			++ones;
+		}
+		return true;
+	}
+
+	void children(node_type x, node_type& first, node_type& last) const
+	{
+		node_type p = tree.select0(x + 1);
+		first = p - x;
+		last = tree.select0(x + 2) - x - 1;
+	}
+
+	node_type first_child(node_type x) const
+	{
+		return tree.select0(x + 1) - x;
+	}
+
+	node_type parent(node_type c) const
+	{
+		return tree.rank0(tree.select1(c + 1)) - 1;
+	}
+
+	key_type label_of(node_type c) const
+	{
+		return labels[c - 1];
+	}
+
+	bool is_terminal(node_type x) const
+	{
+		return terminal.get(x);
+	}
+
+	size_type id_of_node(node_type x) const
+	{
+		return size_type(terminal.rank1(x));
+	}
+
+	// the child of x labelled k, or npos
+	node_type find_child(node_type x, const key_type& k) const
+	{
+		node_type first, last;
+		children(x, first, last);
+		const key_type *b = labels + (first - 1), *e = labels + (last - 1);
+		const key_type *i = std::lower_bound(b, e, k, comp);
+		if (i == e || comp(k, *i))
+			return node_type(npos);
+		return node_type(i - labels) + 1;
+	}
+
+	// the nodes on the path of the key, shorter if the key leaves the trie
+	template <typename Iter>
+	void walk(Iter first, Iter last, std::vector<node_type>& path) const
+	{
+		path.assign(1, 0);
+		for (; first != last; ++first)
+		{
+			node_type c = find_child(path.back(), *first);
+			if (c == node_type(npos))
+				return;
+			path.push_back(c);
+		}
+	}
+
+public:
+	explicit louds_trie() : header(NULL), labels(NULL), comp()
+	{
+		assemble_empty();
+	}
+
+	// the keys of a trie; the values are not kept
+	template <typename Value, class Store, class Features>
+	explicit louds_trie(const trie<Key, Value, Compare, Store, Features>& t) : header(NULL), labels(NULL), comp()
+	{
+		typedef trie<Key, Value, Compare, Store, Features> trie_type;
+		typedef typename trie_type::node_type trie_node;
+		typedef typename trie_type::node_ptr node_ptr;
+		std::vector<node_type> degree;
+		std::vector<key_type> label_list;
+		detail::louds_bits_builder term;
+		std::vector<node_ptr> order(1, t.root_node());
+		for (size_type i = 0; i < order.size(); ++i)
+		{
+			node_ptr cur = order[i];
+			degree.push_back(cur->child.size());
+			term.push_back(!cur->no_value());
+			for (typename trie_node::child_iter ci = cur->child.begin(); ci != cur->child.end(); ++ci)
+			{
+				label_list.push_back(ci->first);
+				order.push_back(ci->second);
+			}
+		}
+		assemble(degree, label_list, term);
+	}
+
+	// the keys of a frozen_trie, numbered the same way
+	template <typename Value>
+	explicit louds_trie(const frozen_trie<Key, Value, Compare>& f) : header(NULL), labels(NULL), comp()
+	{
+		typename frozen_trie<Key, Value, Compare>::layout_type l = f.layout();
+		std::vector<node_type> degree;
+		detail::louds_bits_builder term;
+		for (size_type i = 0; i <= f.count_node(); ++i)
+		{
+			degree.push_back(l.child_end(i) - l.child_begin(i));
+			term.push_back(l.has_value(i));
+		}
+		assemble(degree, std::vector<key_type>(l.labels, l.labels + f.count_node()), term);
+	}
+
+	// write the image, Key has to be POD
+	bool save(const std::string& path) const
+	{
+		std::ofstream os(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!os)
+			return false;
+		os.write(reinterpret_cast<const char *>(header), header->file_size);
+		os.flush();
+		return bool(os);
+	}
+
+	// map an image from save() read-only and use it in place; returns false
+	// and keeps the content if the file is missing, was written for another
+	// key type or byte order, or is corrupt.  The image is checked in one pass
+	bool open(const std::string& path)
+	{
+		namespace ip = boost::interprocess;
+		ip::mapped_region r;
+		try {
+			ip::file_mapping file(path.c_str(), ip::read_only);
+			ip::mapped_region(file, ip::read_only).swap(r);
+		} catch (const ip::interprocess_exception&) {
+			return false;
+		}
+		if (r.get_size() < sizeof(header_type))
+			return false;
+		const char *base = static_cast<const char *>(r.get_address());
+		if (!valid_header(*reinterpret_cast<const header_type *>(base), r.get_size()))
+			return false;
+		louds_trie_type tmp;
+		std::vector<boost::uint64_t>().swap(tmp.buffer);
+		tmp.region.swap(r);
+		tmp.bind(base);
+		if (!tmp.well_formed())
+			return false;
+		swap(tmp);
+		return true;
+	}
+
+	// drop the content, and the mapping if there is one
+	void close()
+	{
+		assemble_empty();
+	}
+
+	void clear()
+	{
+		assemble_empty();
+	}
+
+	bool is_mapped() const
+	{
+		return region.get_address() != NULL;
+	}
+
+	iterator begin() const
+	{
+		return iterator(this, std::vector<node_type>(1, 0), std::vector<key_type>(), false);
+	}
+
+	iterator end() const
+	{
+		return iterator();
+	}
+
+	template <typename Iter>
+	iterator find(Iter first, Iter last) const
+	{
+		std::vector<key_type> key(first, last);
+		std::vector<node_type> path;
+		walk(key.begin(), key.end(), path);
+		if (path.size() != key.size() + 1 || !is_terminal(path.back()))
+			return end();
+		return iterator(this, path, key, false);
+	}
+
+	template <typename Container>
+	iterator find(const Container& container) const
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template <typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		return id_of(first, last) == npos ? 0 : 1;
+	}
+
+	template <typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	// the rank of the node of the key among the nodes where keys end, npos if
+	// the key is not in the trie; ids follow node order, not key order
+	template <typename Iter>
+	size_type id_of(Iter first, Iter last) const
+	{
+		node_type x = 0;
+		for (; first != last; ++first)
+		{
+			x = find_child(x, *first);
+			if (x == node_type(npos))
+				return npos;
+		}
+		return is_terminal(x) ? id_of_node(x) : npos;
+	}
+
+	template <typename Container>
+	size_type id_of(const Container& container) const
+	{
+		return id_of(container.begin(), container.end());
+	}
+
+	// the key with the id, which has to be less than size()
+	std::vector<key_type> key_of(size_type id) const
+	{
+		std::vector<key_type> key;
+		for (node_type x = terminal.select1(id + 1); x != 0; x = parent(x))
+			key.push_back(label_of(x));
+		std::reverse(key.begin(), key.end());
+		return key;
+	}
+
+	template <typename Iter>
+	size_type count_prefix(Iter first, Iter last) const
+	{
+		node_type x = 0;
+		for (; first != last; ++first)
+		{
+			x = find_child(x, *first);
+			if (x == node_type(npos))
+				return 0;
+		}
+		// the descendants on each level are the nodes [lo, hi)
+		size_type ret = 0;
+		for (node_type lo = x, hi = x + 1; lo < hi; lo = first_child(lo), hi = first_child(hi))
+			ret += size_type(terminal.rank1(hi) - terminal.rank1(lo));
+		return ret;
+	}
+
+	template <typename Container>
+	size_type count_prefix(const Container& container) const
+	{
+		return count_prefix(container.begin(), container.end());
+	}
+
+	// the keys starting with [first, last), in key order
+	template <typename Iter>
+	iterator_range find_prefix(Iter first, Iter last) const
+	{
+		std::vector<key_type> key(first, last);
+		std::vector<node_type> path;
+		walk(key.begin(), key.end(), path);
+		if (path.size() != key.size() + 1)
+			return std::make_pair(end(), end());
+		return std::make_pair(iterator(this, path, key, true), end());
+	}
+
+	template <typename Container>
+	iterator_range find_prefix(const Container& container) const
+	{
+		return find_prefix(container.begin(), container.end());
+	}
+
+	// the longest key that is a prefix of [first, last)
+	template <typename Iter>
+	iterator findLongestPrefixOfKey(Iter first, Iter last) const
+	{
+		std::vector<key_type> key(first, last);
+		std::vector<node_type> path;
+		walk(key.begin(), key.end(), path);
+		while (!path.empty() && !is_terminal(path.back()))
+			path.pop_back();
+		if (path.empty())
+			return end();
+		key.resize(path.size() - 1);
+		return iterator(this, path, key, false);
+	}
+
+	template <typename Container>
+	iterator findLongestPrefixOfKey(const Container& container) const
+	{
+		return findLongestPrefixOfKey(container.begin(), container.end());
+	}
+
+	size_type size() const
+	{
+		return size_type(header->key_count);
+	}
+
+	bool empty() const
+	{
+		return header->key_count == 0;
+	}
+
+	// the root is not counted, the same as trie::count_node()
+	size_type count_node() const
+	{
+		return size_type(header->node_count - 1);
+	}
+
+	// bytes in the image, what save() writes
+	size_type image_size() const
+	{
+		return size_type(header->file_size);
+	}
+
+	void swap(louds_trie_type& other)
+	{
+		buffer.swap(other.buffer);
+		region.swap(other.region);
+		std::swap(header, other.header);
+		std::swap(tree, other.tree);
+		std::swap(terminal, other.terminal);
+		std::swap(labels, other.labels);
+	}
+};
+
+template <typename Key, class Compare>
+const typename louds_trie<Key, Compare>::size_type louds_trie<Key, Compare>::npos;
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_LOUDS_TRIE_HPP
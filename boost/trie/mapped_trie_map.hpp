@@ -0,0 +1,198 @@
+#ifndef BOOST_TRIE_MAPPED_TRIE_MAP_HPP
+#define BOOST_TRIE_MAPPED_TRIE_MAP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "frozen_trie.hpp"
+#include <string>
+#include <cstring>
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+//
+// mapped_trie_map answers queries straight from an image written by
+// frozen_trie::save().  open() maps the file read-only and nothing is copied,
+// so the pages are shared by every process that maps the same file.  Before
+// the image is used, one pass over the nodes and the string offsets checks
+// that no query can read outside of the mapping.
+//
+
+namespace boost { namespace tries {
+
+template <typename Key, typename Value, class Compare = std::less<Key> >
+class mapped_trie_map : public detail::frozen_trie_base<mapped_trie_map<Key, Value, Compare>, Key, Compare>
+{
+public:
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef detail::trie_image_value<value_type> value_traits;
+	// a boost::string_view into the mapping for std::string values
+	typedef typename value_traits::reference const_reference;
+	typedef typename value_traits::pointer const_pointer;
+	typedef mapped_trie_map<Key, Value, Compare> mapped_type;
+	typedef detail::frozen_trie_base<mapped_type, Key, Compare> base_type;
+	typedef detail::frozen_node frozen_node;
+	typedef detail::trie_image_header header_type;
+	typedef typename base_type::layout_type layout_type;
+	typedef typename base_type::index_type index_type;
+	typedef typename base_type::const_iterator const_iterator;
+	typedef typename base_type::iterator iterator;
+	typedef typename base_type::const_reverse_iterator const_reverse_iterator;
+	typedef typename base_type::reverse_iterator reverse_iterator;
+	typedef typename base_type::iterator_range iterator_range;
+	typedef size_t size_type;
+
+private:
+	boost::interprocess::mapped_region region;
+	const header_type *header;
+	const frozen_node *nodes;
+	const key_type *labels;
+	const char *values;
+	const char *blob;
+	// stands in for the image while nothing is open
+	frozen_node empty_nodes[2];
+
+	mapped_trie_map(const mapped_type&);
+	mapped_type& operator=(const mapped_type&);
+
+	void reset()
+	{
+		header = NULL;
+		frozen_node r = { 1, 0, 0 };
+		empty_nodes[0] = empty_nodes[1] = r;
+		nodes = empty_nodes;
+		labels = NULL;
+		values = blob = NULL;
+	}
+
+	// [offset, offset + count * size) ends at or before limit, with no sum
+	// that can wrap around
+	static bool section_fits(boost::uint64_t offset, boost::uint64_t count, boost::uint64_t size, boost::uint64_t limit)
+	{
+		return offset <= limit && (size == 0 || count <= (limit - offset) / size);
+	}
+
+	static bool valid_header(const header_type& h, boost::uint64_t file_size)
+	{
+		if (std::memcmp(h.magic, h.magic_string(), sizeof(h.magic)) != 0)
+			return false;
+		if (h.version != h.current_version || h.byte_order != h.byte_order_mark)
+			return false;
+		if (h.key_size != sizeof(key_type) || h.value_kind != value_traits::kind ||
+				h.value_size != value_traits::size)
+			return false;
+		if (h.node_count == 0 || h.node_count >= index_type(-1) || h.value_count >= index_type(-1))
+			return false;
+		if (h.file_size > file_size || h.node_offset < sizeof(h) ||
+				h.node_offset % 8 != 0 || h.label_offset % 8 != 0 || h.value_offset % 8 != 0)
+			return false;
+		if (!section_fits(h.node_offset, h.node_count + 1, sizeof(frozen_node), h.label_offset) ||
+				!section_fits(h.label_offset, h.node_count - 1, sizeof(key_type), h.value_offset))
+			return false;
+		if (value_traits::kind == detail::image_pod_value)
+			return section_fits(h.value_offset, h.value_count, h.value_size, h.file_size);
+		return section_fits(h.value_offset, h.value_count + 1, sizeof(boost::uint64_t), h.blob_offset) &&
+			section_fits(h.blob_offset, h.blob_size, 1, h.file_size);
+	}
+
+	// the offsets of string values go up and stay in the blob
+	static bool valid_blob(const header_type& h, const char *values)
+	{
+		if (value_traits::kind == detail::image_pod_value)
+			return true;
+		const boost::uint64_t *off = reinterpret_cast<const boost::uint64_t *>(values);
+		for (boost::uint64_t i = 0; i < h.value_count; ++i)
+			if (off[i] > off[i + 1])
+				return false;
+		return off[h.value_count] <= h.blob_size;
+	}
+
+public:
+	explicit mapped_trie_map()
+	{
+		reset();
+	}
+
+	explicit mapped_trie_map(const std::string& path)
+	{
+		reset();
+		open(path);
+	}
+
+	// maps the image read-only, returns false and stays closed if the file is
+	// missing, was written for another key, value or byte order, or does not
+	// hold a well formed trie
+	bool open(const std::string& path)
+	{
+		close();
+		namespace ip = boost::interprocess;
+		ip::mapped_region r;
+		try {
+			ip::file_mapping file(path.c_str(), ip::read_only);
+			ip::mapped_region(file, ip::read_only).swap(r);
+		} catch (const ip::interprocess_exception&) {
+			return false;
+		}
+		if (r.get_size() < sizeof(header_type))
+			return false;
+		const char *base = static_cast<const char *>(r.get_address());
+		const header_type *h = reinterpret_cast<const header_type *>(base);
+		if (!valid_header(*h, r.get_size()))
+			return false;
+		const frozen_node *n = reinterpret_cast<const frozen_node *>(base + h->node_offset);
+		const key_type *l = reinterpret_cast<const key_type *>(base + h->label_offset);
+		if (!layout_type(n, l).well_formed(index_type(h->node_count), index_type(h->value_count)) ||
+				!valid_blob(*h, base + h->value_offset))
+			return false;
+		region.swap(r);
+		header = h;
+		nodes = n;
+		labels = l;
+		values = base + h->value_offset;
+		blob = base + h->blob_offset;
+		return true;
+	}
+
+	void close()
+	{
+		boost::interprocess::mapped_region().swap(region);
+		reset();
+	}
+
+	bool is_open() const
+	{
+		return header != NULL;
+	}
+
+	layout_type layout() const
+	{
+		return layout_type(nodes, labels);
+	}
+
+	size_type value_count() const
+	{
+		return header == NULL ? 0 : size_type(header->value_count);
+	}
+
+	size_type node_total() const
+	{
+		return header == NULL ? 1 : size_type(header->node_count);
+	}
+
+	const_reference value_at(index_type v) const
+	{
+		return value_traits::get(values, blob, v);
+	}
+
+	static const_pointer pointer_of(const_reference r)
+	{
+		return value_traits::pointer_of(r);
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_MAPPED_TRIE_MAP_HPP
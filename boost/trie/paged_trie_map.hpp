@@ -0,0 +1,1631 @@
+#ifndef BOOST_TRIE_PAGED_TRIE_MAP_HPP
+#define BOOST_TRIE_PAGED_TRIE_MAP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <list>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <boost/cstdint.hpp>
+#include <boost/utility.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_pod.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#include <sys/types.h>
+#endif
+
+//
+// paged_trie_map keeps a trie that does not fit in memory in a file.
+//
+// It is a burst trie: the top of the trie is made of trie pages, one node per
+// page, whose children are a sorted run of (label, page) entries; below them
+// the keys are kept as sorted suffixes in bucket pages.  A bucket that gets
+// full bursts into a trie page with one new bucket per first element, so the
+// page keeps its id and its parent is not touched.  A trie page whose
+// children do not fit continues in a chain of pages.
+//
+// Pages go through a buffer pool of a fixed number of frames with LRU
+// eviction.  Every change is logged as whole page images to "<path>.wal" when
+// the operation ends (or when a bulk update ends) and the pages stay in
+// memory until then, so the data file only ever sees committed pages.
+// checkpoint() writes the dirty pages back and empties the log; open()
+// replays the committed part of a log left by a crash.
+//
+// Keys and values have to be POD.  Iterators hold a copy of their key and
+// value and move by looking up the next key, so they stream the pages in
+// order and stay usable across changes.
+//
+
+namespace boost { namespace tries {
+
+namespace detail {
+
+// a file read and written at 64-bit offsets
+class paged_file : private boost::noncopyable {
+	std::FILE *f;
+
+	bool seek(boost::uint64_t off)
+	{
+#if defined(_WIN32)
+		return _fseeki64(f, (__int64)off, SEEK_SET) == 0;
+#else
+		return fseeko(f, (off_t)off, SEEK_SET) == 0;
+#endif
+	}
+
+public:
+	explicit paged_file() : f(NULL)
+	{
+	}
+
+	~paged_file()
+	{
+		close();
+	}
+
+	// the file is created when it is missing or truncate is set
+	bool open(const std::string& path, bool truncate)
+	{
+		close();
+		if (!truncate)
+			f = std::fopen(path.c_str(), "r+b");
+		if (f == NULL)
+			f = std::fopen(path.c_str(), "w+b");
+		return f != NULL;
+	}
+
+	void close()
+	{
+		if (f != NULL)
+		{
+			std::fclose(f);
+			f = NULL;
+		}
+	}
+
+	bool is_open() const
+	{
+		return f != NULL;
+	}
+
+	boost::uint64_t size()
+	{
+#if defined(_WIN32)
+		if (_fseeki64(f, 0, SEEK_END) != 0)
+			return 0;
+		return boost::uint64_t(_ftelli64(f));
+#else
+		if (fseeko(f, 0, SEEK_END) != 0)
+			return 0;
+		return boost::uint64_t(ftello(f));
+#endif
+	}
+
+	bool read(boost::uint64_t off, void *buf, size_t n)
+	{
+		return seek(off) && std::fread(buf, 1, n, f) == n;
+	}
+
+	bool write(boost::uint64_t off, const void *buf, size_t n)
+	{
+		return seek(off) && std::fwrite(buf, 1, n, f) == n;
+	}
+
+	bool flush()
+	{
+		return std::fflush(f) == 0;
+	}
+
+	// flush and wait until the data is on the disk
+	bool sync()
+	{
+		if (!flush())
+			return false;
+#if defined(_WIN32)
+		return _commit(_fileno(f)) == 0;
+#else
+		return fsync(fileno(f)) == 0;
+#endif
+	}
+};
+
+struct page_frame {
+	typedef boost::uint32_t page_id;
+	page_id id;
+	// 8 byte aligned page content
+	std::vector<boost::uint64_t> data;
+	unsigned pins;
+	bool dirty;
+	// changed since the last commit, so it must not reach the data file yet
+	bool in_txn;
+	std::list<page_frame *>::iterator lru_pos;
+
+	char * bytes()
+	{
+		return reinterpret_cast<char *>(&data[0]);
+	}
+};
+
+struct page_log_header {
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t page_size;
+};
+
+struct page_log_record {
+	boost::uint32_t magic;
+	boost::uint32_t page;
+	boost::uint64_t checksum;
+};
+
+// the buffer pool and the write-ahead log of a paged file
+class page_cache : private boost::noncopyable {
+public:
+	typedef page_frame frame;
+	typedef frame::page_id page_id;
+	static const page_id no_page = page_id(-1);
+
+private:
+	enum { log_version = 1, log_page = 0x45474150, log_commit = 0x54494d43 };
+
+	paged_file data_file;
+	paged_file log_file;
+	std::string log_path;
+	size_t page_size;
+	size_t capacity;
+	std::vector<frame *> frames;
+	boost::unordered_map<page_id, frame *> table;
+	// front is the most recently used
+	std::list<frame *> lru;
+	std::vector<frame *> txn;
+	boost::uint64_t log_size;
+	boost::uint64_t checkpoint_size;
+	bool log_synced;
+	bool synchronous;
+	bool failed;
+
+	static const char * log_magic()
+	{
+		return "BTRIEWAL";
+	}
+
+	static boost::uint64_t checksum(page_id id, const char *p, size_t n)
+	{
+		// FNV-1a
+		boost::uint64_t h = 14695981039346656037ULL ^ id;
+		for (size_t i = 0; i < n; ++i)
+		{
+			h ^= (unsigned char)p[i];
+			h *= 1099511628211ULL;
+		}
+		return h;
+	}
+
+	bool write_back(frame *f)
+	{
+		if (!f->dirty)
+			return true;
+		// the log has to be on the disk before any page it covers
+		if (!log_synced)
+		{
+			if (!log_file.sync())
+				return false;
+			log_synced = true;
+		}
+		if (!data_file.write(boost::uint64_t(f->id) * page_size, f->bytes(), page_size))
+			return false;
+		f->dirty = false;
+		return true;
+	}
+
+	// a frame for a new page, evicting the least recently used page that is not in use
+	frame * victim()
+	{
+		if (frames.size() < capacity)
+			return new_frame();
+		for (std::list<frame *>::reverse_iterator i = lru.rbegin(); i != lru.rend(); ++i)
+		{
+			frame *f = *i;
+			if (f->pins > 0 || f->in_txn)
+				continue;
+			if (!write_back(f))
+				failed = true;
+			if (f->id != no_page)
+				table.erase(f->id);
+			lru.erase(f->lru_pos);
+			return f;
+		}
+		// everything is in use, go over the capacity for a while
+		return new_frame();
+	}
+
+	frame * new_frame()
+	{
+		frame *f = new frame();
+		f->data.resize(page_size / sizeof(boost::uint64_t));
+		frames.push_back(f);
+		return f;
+	}
+
+	bool reset_log()
+	{
+		page_log_header h;
+		std::memset(&h, 0, sizeof(h));
+		std::memcpy(h.magic, log_magic(), sizeof(h.magic));
+		h.version = log_version;
+		h.page_size = boost::uint32_t(page_size);
+		log_size = sizeof(h);
+		log_synced = true;
+		return log_file.open(log_path, true) && log_file.write(0, &h, sizeof(h)) && log_file.sync();
+	}
+
+	// write the pages of the open transaction to the log
+	bool log_txn()
+	{
+		if (txn.empty())
+			return true;
+		bool ok = true;
+		for (size_t i = 0; i < txn.size() && ok; ++i)
+		{
+			frame *f = txn[i];
+			page_log_record r = { log_page, f->id, checksum(f->id, f->bytes(), page_size) };
+			ok = log_file.write(log_size, &r, sizeof(r)) &&
+				log_file.write(log_size + sizeof(r), f->bytes(), page_size);
+			log_size += sizeof(r) + page_size;
+		}
+		page_log_record c = { log_commit, boost::uint32_t(txn.size()), 0 };
+		ok = ok && log_file.write(log_size, &c, sizeof(c));
+		log_size += sizeof(c);
+		ok = ok && (synchronous ? log_file.sync() : log_file.flush());
+		log_synced = synchronous;
+		for (size_t i = 0; i < txn.size(); ++i)
+			txn[i]->in_txn = false;
+		txn.clear();
+		if (!ok)
+			failed = true;
+		return ok;
+	}
+
+	// apply the committed page images of a log left by a crash
+	bool recover()
+	{
+		page_log_header h;
+		if (log_file.size() < sizeof(h) || !log_file.read(0, &h, sizeof(h)) ||
+				std::memcmp(h.magic, log_magic(), sizeof(h.magic)) != 0 || h.version != log_version ||
+				h.page_size == 0 || h.page_size % sizeof(boost::uint64_t) != 0)
+			return true;
+		std::vector<std::pair<page_id, std::vector<char> > > pending;
+		std::vector<char> buf(h.page_size);
+		boost::uint64_t off = sizeof(h);
+		bool applied = false;
+		for (;;)
+		{
+			page_log_record r;
+			if (!log_file.read(off, &r, sizeof(r)))
+				break;
+			off += sizeof(r);
+			if (r.magic == log_commit && r.page == pending.size())
+			{
+				for (size_t i = 0; i < pending.size(); ++i)
+					if (!data_file.write(boost::uint64_t(pending[i].first) * h.page_size, &pending[i].second[0], h.page_size))
+						return false;
+				pending.clear();
+				applied = true;
+				continue;
+			}
+			if (r.magic != log_page || !log_file.read(off, &buf[0], h.page_size) ||
+					checksum(r.page, &buf[0], h.page_size) != r.checksum)
+				break;
+			off += h.page_size;
+			pending.push_back(std::make_pair(r.page, buf));
+		}
+		return !applied || data_file.sync();
+	}
+
+public:
+	explicit page_cache() : page_size(0), capacity(0), log_size(0), checkpoint_size(0),
+	log_synced(true), synchronous(false), failed(false)
+	{
+	}
+
+	~page_cache()
+	{
+		close();
+	}
+
+	// open the data file and its log and replay what the log holds
+	bool open(const std::string& path)
+	{
+		close();
+		log_path = path + ".wal";
+		failed = false;
+		if (!data_file.open(path, false) || !log_file.open(log_path, false) || !recover())
+		{
+			data_file.close();
+			log_file.close();
+			return false;
+		}
+		return true;
+	}
+
+	// the page size is known once the first page is read, start a new log with it
+	bool start(size_t psize, size_t cap)
+	{
+		page_size = psize;
+		capacity = cap < 4 ? 4 : cap;
+		checkpoint_size = boost::uint64_t(capacity < 1024 ? 1024 : capacity) * page_size;
+		return reset_log();
+	}
+
+	bool read_raw(boost::uint64_t off, void *buf, size_t n)
+	{
+		return data_file.read(off, buf, n);
+	}
+
+	boost::uint64_t file_size()
+	{
+		return data_file.size();
+	}
+
+	bool is_open() const
+	{
+		return data_file.is_open();
+	}
+
+	bool good() const
+	{
+		return !failed;
+	}
+
+	size_t get_page_size() const
+	{
+		return page_size;
+	}
+
+	size_t txn_size() const
+	{
+		return txn.size();
+	}
+
+	size_t get_capacity() const
+	{
+		return capacity;
+	}
+
+	// fsync the log at every commit instead of only at checkpoints
+	void set_synchronous(bool s)
+	{
+		synchronous = s;
+	}
+
+	// the page pinned in a frame, fresh pages are zeroed instead of read
+	frame * fetch(page_id id, bool fresh)
+	{
+		boost::unordered_map<page_id, frame *>::iterator it = table.find(id);
+		frame *f;
+		if (it != table.end())
+		{
+			f = it->second;
+			lru.erase(f->lru_pos);
+		}
+		else {
+			f = victim();
+			f->id = id;
+			f->pins = 0;
+			f->dirty = f->in_txn = false;
+			// pages past the end of the file read as zero
+			if (fresh || !data_file.read(boost::uint64_t(id) * page_size, f->bytes(), page_size))
+				std::memset(f->bytes(), 0, page_size);
+			table[id] = f;
+		}
+		if (fresh)
+			std::memset(f->bytes(), 0, page_size);
+		lru.push_front(f);
+		f->lru_pos = lru.begin();
+		++f->pins;
+		return f;
+	}
+
+	void pin(frame *f)
+	{
+		++f->pins;
+	}
+
+	void unpin(frame *f)
+	{
+		--f->pins;
+	}
+
+	// the page was changed
+	void touch(frame *f)
+	{
+		f->dirty = true;
+		if (!f->in_txn)
+		{
+			f->in_txn = true;
+			txn.push_back(f);
+		}
+	}
+
+	// make the changes so far durable as one unit
+	bool commit()
+	{
+		if (!log_txn())
+			return false;
+		if (log_size > checkpoint_size)
+			return checkpoint();
+		return true;
+	}
+
+	// write all dirty pages to the data file and empty the log
+	bool checkpoint()
+	{
+		if (!data_file.is_open())
+			return true;
+		bool ok = log_txn();
+		for (size_t i = 0; i < frames.size() && ok; ++i)
+			if (frames[i]->id != no_page)
+				ok = write_back(frames[i]);
+		ok = ok && data_file.sync() && reset_log();
+		if (!ok)
+			failed = true;
+		return ok;
+	}
+
+	// forget the cached pages from id on, they are not used any more
+	void discard_from(page_id id)
+	{
+		for (size_t i = 0; i < frames.size(); ++i)
+		{
+			frame *f = frames[i];
+			if (f->id == no_page || f->id < id || f->pins > 0)
+				continue;
+			table.erase(f->id);
+			if (f->in_txn)
+				txn.erase(std::find(txn.begin(), txn.end(), f));
+			f->id = no_page;
+			f->dirty = f->in_txn = false;
+			lru.erase(f->lru_pos);
+			lru.push_back(f);
+			f->lru_pos = --lru.end();
+		}
+	}
+
+	void close()
+	{
+		if (data_file.is_open() && page_size > 0)
+			checkpoint();
+		data_file.close();
+		log_file.close();
+		for (size_t i = 0; i < frames.size(); ++i)
+			delete frames[i];
+		frames.clear();
+		table.clear();
+		lru.clear();
+		txn.clear();
+		page_size = 0;
+	}
+};
+
+// a pinned page, unpinned when the last copy goes away
+class page_ref {
+	page_cache *c;
+	page_frame *f;
+
+public:
+	typedef page_frame::page_id page_id;
+
+	explicit page_ref() : c(0), f(0)
+	{
+	}
+
+	explicit page_ref(page_cache *x, page_frame *y) : c(x), f(y)
+	{
+	}
+
+	page_ref(const page_ref& other) : c(other.c), f(other.f)
+	{
+		if (f != NULL)
+			c->pin(f);
+	}
+
+	page_ref& operator=(const page_ref& other)
+	{
+		if (other.f != NULL)
+			other.c->pin(other.f);
+		if (f != NULL)
+			c->unpin(f);
+		c = other.c;
+		f = other.f;
+		return *this;
+	}
+
+	~page_ref()
+	{
+		if (f != NULL)
+			c->unpin(f);
+	}
+
+	page_id id() const
+	{
+		return f->id;
+	}
+
+	char * bytes() const
+	{
+		return f->bytes();
+	}
+
+	void touch() const
+	{
+		c->touch(f);
+	}
+};
+
+struct paged_trie_meta {
+	char magic[8];
+	boost::uint32_t version;
+	boost::uint32_t page_size;
+	boost::uint32_t key_size;
+	boost::uint32_t value_size;
+	boost::uint32_t page_count;
+	boost::uint32_t free_list;
+	boost::uint32_t free_count;
+	boost::uint32_t reserved;
+	boost::uint64_t size;
+};
+
+struct paged_trie_page_header {
+	boost::uint32_t type;
+	// children on this page of a trie page, or records of a bucket page
+	boost::uint32_t count;
+	// next page of a trie page chain, or of the free list
+	boost::uint32_t next;
+	// bytes used by the records of a bucket page
+	boost::uint32_t used;
+	boost::uint32_t has_value;
+	boost::uint32_t reserved;
+	// values in the sub-trie of a trie page
+	boost::uint64_t value_count;
+};
+
+template <class Container>
+class paged_trie_iterator
+{
+public:
+	typedef std::forward_iterator_tag iterator_category;
+	typedef typename Container::key_type key_type;
+	typedef typename Container::value_type value_type;
+	typedef const value_type& reference;
+	typedef const value_type * pointer;
+	typedef ptrdiff_t difference_type;
+	typedef paged_trie_iterator<Container> self;
+
+	// NULL at the end
+	const Container *c;
+	std::vector<key_type> key;
+	value_type value;
+
+	explicit paged_trie_iterator() : c(0), key(), value()
+	{
+	}
+
+	explicit paged_trie_iterator(const Container *x, const std::vector<key_type>& k, const value_type& v) :
+		c(x), key(k), value(v)
+	{
+	}
+
+	std::vector<key_type> get_key() const
+	{
+		return key;
+	}
+
+	reference operator*() const
+	{
+		return value;
+	}
+
+	pointer operator->() const
+	{
+		return &value;
+	}
+
+	bool operator==(const self& other) const
+	{
+		if (c == NULL || other.c == NULL)
+			return c == other.c;
+		return c->same_key(key, other.key);
+	}
+
+	bool operator!=(const self& other) const
+	{
+		return !(*this == other);
+	}
+
+	self& operator++()
+	{
+		if (c != NULL)
+			*this = c->upper_bound(key);
+		return *this;
+	}
+
+	self operator++(int)
+	{
+		self tmp = *this;
+		++*this;
+		return tmp;
+	}
+};
+
+} // namespace detail
+
+
+template <typename Key, typename Value, class Compare = std::less<Key> >
+class paged_trie_map : private boost::noncopyable
+{
+public:
+	typedef Key key_type;
+	typedef Value value_type;
+	typedef paged_trie_map<Key, Value, Compare> paged_type;
+	typedef detail::paged_trie_iterator<paged_type> const_iterator;
+	typedef const_iterator iterator;
+	typedef std::pair<iterator, bool> pair_iterator_bool;
+	typedef std::pair<iterator, iterator> iterator_range;
+	typedef size_t size_type;
+	typedef detail::page_ref page_ref;
+	typedef detail::page_cache::page_id page_id;
+
+	BOOST_STATIC_ASSERT(boost::is_pod<key_type>::value && boost::is_pod<value_type>::value);
+	BOOST_STATIC_ASSERT(boost::alignment_of<key_type>::value <= 8 && boost::alignment_of<value_type>::value <= 8);
+
+private:
+	typedef detail::paged_trie_meta meta_type;
+	typedef detail::paged_trie_page_header page_header;
+
+	enum { free_page = 0, trie_page = 1, bucket_page = 2 };
+	enum { seek_lower, seek_upper, seek_past_prefix };
+	enum { meta_id = 0, root_id = 1, format_version = 1 };
+
+	struct child_entry {
+		key_type label;
+		boost::uint32_t child;
+	};
+
+	struct label_less {
+		Compare comp;
+		bool operator()(const child_entry& e, const key_type& k) const
+		{
+			return comp(e.label, k);
+		}
+	};
+
+	mutable detail::page_cache cache;
+	Compare comp;
+	size_type bulk_depth;
+
+	static const char * magic()
+	{
+		return "BTRIEPAG";
+	}
+
+	static size_t align8(size_t n)
+	{
+		return (n + 7) & ~size_t(7);
+	}
+
+	static size_t entry_offset()
+	{
+		return align8(sizeof(page_header) + sizeof(value_type));
+	}
+
+	static size_t record_size(size_t len)
+	{
+		return 8 + align8(len * sizeof(key_type)) + align8(sizeof(value_type));
+	}
+
+	size_t page_size() const
+	{
+		return cache.get_page_size();
+	}
+
+	size_t trie_capacity() const
+	{
+		return (page_size() - entry_offset()) / sizeof(child_entry);
+	}
+
+	static bool valid_page_size(size_t n)
+	{
+		return n >= 256 && n % 8 == 0 && n < (size_t(1) << 30) &&
+			(n - entry_offset()) / sizeof(child_entry) >= 2 &&
+			sizeof(page_header) + record_size(1) <= n;
+	}
+
+	page_ref fetch(page_id id) const
+	{
+		return page_ref(&cache, cache.fetch(id, false));
+	}
+
+	static page_header * header(const page_ref& p)
+	{
+		return reinterpret_cast<page_header *>(p.bytes());
+	}
+
+	static meta_type * meta(const page_ref& p)
+	{
+		return reinterpret_cast<meta_type *>(p.bytes());
+	}
+
+	static value_type * trie_value(const page_ref& p)
+	{
+		return reinterpret_cast<value_type *>(p.bytes() + sizeof(page_header));
+	}
+
+	static child_entry * entries(const page_ref& p)
+	{
+		return reinterpret_cast<child_entry *>(p.bytes() + entry_offset());
+	}
+
+	static char * records_begin(const page_ref& p)
+	{
+		return p.bytes() + sizeof(page_header);
+	}
+
+	static char * records_end(const page_ref& p)
+	{
+		return records_begin(p) + header(p)->used;
+	}
+
+	static boost::uint32_t record_len(const char *r)
+	{
+		return *reinterpret_cast<const boost::uint32_t *>(r);
+	}
+
+	static key_type * record_key(char *r)
+	{
+		return reinterpret_cast<key_type *>(r + 8);
+	}
+
+	static value_type * record_value(char *r)
+	{
+		return reinterpret_cast<value_type *>(r + 8 + align8(record_len(r) * sizeof(key_type)));
+	}
+
+	static char * next_record(char *r)
+	{
+		return r + record_size(record_len(r));
+	}
+
+	// <0, 0 or >0 as [a, a + na) is before, equal to or after [b, b + nb)
+	int compare(const key_type *a, size_t na, const key_type *b, size_t nb) const
+	{
+		size_t n = std::min(na, nb);
+		for (size_t i = 0; i < n; ++i)
+		{
+			if (comp(a[i], b[i]))
+				return -1;
+			if (comp(b[i], a[i]))
+				return 1;
+		}
+		return na < nb ? -1 : (na > nb ? 1 : 0);
+	}
+
+	bool starts_with(const key_type *s, size_t ns, const key_type *p, size_t np) const
+	{
+		return ns >= np && compare(s, np, p, np) == 0;
+	}
+
+	static const key_type * data_of(const std::vector<key_type>& key)
+	{
+		return key.empty() ? NULL : &key[0];
+	}
+
+	// a zeroed page from the free list or the end of the file
+	page_ref new_page(boost::uint32_t type)
+	{
+		page_ref m = fetch(meta_id);
+		meta_type *mp = meta(m);
+		page_id id = mp->free_list;
+		if (id != 0)
+		{
+			page_ref f = fetch(id);
+			mp->free_list = header(f)->next;
+			--mp->free_count;
+		}
+		else {
+			id = mp->page_count++;
+		}
+		m.touch();
+		page_ref p(&cache, cache.fetch(id, true));
+		header(p)->type = type;
+		p.touch();
+		return p;
+	}
+
+	void release_page(const page_ref& p)
+	{
+		page_ref m = fetch(meta_id);
+		std::memset(p.bytes(), 0, page_size());
+		header(p)->type = free_page;
+		header(p)->next = meta(m)->free_list;
+		meta(m)->free_list = p.id();
+		++meta(m)->free_count;
+		p.touch();
+		m.touch();
+	}
+
+	// release a trie page and the rest of its chain
+	void release_chain(page_ref p)
+	{
+		for (;;)
+		{
+			page_id next = header(p)->next;
+			release_page(p);
+			if (next == 0)
+				break;
+			p = fetch(next);
+		}
+	}
+
+	// the child page of a trie page labeled k, or 0
+	page_id find_child(page_ref p, const key_type& k) const
+	{
+		label_less less = { comp };
+		for (;;)
+		{
+			child_entry *e = entries(p), *last = e + header(p)->count;
+			child_entry *i = std::lower_bound(e, last, k, less);
+			if (i != last)
+				return comp(k, i->label) ? 0 : i->child;
+			if (header(p)->next == 0)
+				return 0;
+			p = fetch(header(p)->next);
+		}
+	}
+
+	// the pages of a chain hold ascending runs of labels; a full page is split in two
+	void insert_child(page_ref p, const key_type& k, page_id child)
+	{
+		while (header(p)->next != 0 &&
+				(header(p)->count == 0 || comp(entries(p)[header(p)->count - 1].label, k)))
+			p = fetch(header(p)->next);
+		if (header(p)->count == trie_capacity())
+		{
+			page_ref q = new_page(trie_page);
+			size_t n = header(p)->count, keep = n / 2;
+			std::memcpy(entries(q), entries(p) + keep, (n - keep) * sizeof(child_entry));
+			header(q)->count = boost::uint32_t(n - keep);
+			header(q)->next = header(p)->next;
+			header(p)->count = boost::uint32_t(keep);
+			header(p)->next = q.id();
+			p.touch();
+			if (comp(entries(p)[keep - 1].label, k))
+				p = q;
+		}
+		label_less less = { comp };
+		child_entry *e = entries(p), *last = e + header(p)->count;
+		child_entry *i = std::lower_bound(e, last, k, less);
+		std::memmove(i + 1, i, (last - i) * sizeof(child_entry));
+		i->label = k;
+		i->child = child;
+		++header(p)->count;
+		p.touch();
+	}
+
+	void erase_child(page_ref p, const key_type& k)
+	{
+		label_less less = { comp };
+		for (;;)
+		{
+			child_entry *e = entries(p), *last = e + header(p)->count;
+			child_entry *i = std::lower_bound(e, last, k, less);
+			if (i != last)
+			{
+				if (!comp(k, i->label))
+				{
+					std::memmove(i, i + 1, (last - i - 1) * sizeof(child_entry));
+					--header(p)->count;
+					p.touch();
+				}
+				return;
+			}
+			if (header(p)->next == 0)
+				return;
+			p = fetch(header(p)->next);
+		}
+	}
+
+	// the first record of a bucket not before [t, t + nt)
+	char * bucket_lower(const page_ref& p, const key_type *t, size_t nt, bool& exact) const
+	{
+		char *r = records_begin(p), *last = records_end(p);
+		exact = false;
+		for (; r != last; r = next_record(r))
+		{
+			int c = compare(record_key(r), record_len(r), t, nt);
+			if (c >= 0)
+			{
+				exact = c == 0;
+				break;
+			}
+		}
+		return r;
+	}
+
+	bool bucket_insert(const page_ref& p, char *r, const key_type *t, size_t nt, const value_type& value)
+	{
+		size_t n = record_size(nt);
+		char *last = records_end(p);
+		if (size_t(last - p.bytes()) + n > page_size())
+			return false;
+		std::memmove(r + n, r, last - r);
+		std::memset(r, 0, n);
+		*reinterpret_cast<boost::uint32_t *>(r) = boost::uint32_t(nt);
+		if (nt > 0)
+			std::memcpy(record_key(r), t, nt * sizeof(key_type));
+		*record_value(r) = value;
+		++header(p)->count;
+		header(p)->used += boost::uint32_t(n);
+		p.touch();
+		return true;
+	}
+
+	void bucket_erase(const page_ref& p, char *r)
+	{
+		size_t n = record_size(record_len(r));
+		char *last = records_end(p);
+		std::memmove(r, r + n, last - r - n);
+		std::memset(last - n, 0, n);
+		--header(p)->count;
+		header(p)->used -= boost::uint32_t(n);
+		p.touch();
+	}
+
+	// turn a full bucket into a trie page with one bucket for each first element
+	void burst(const page_ref& p)
+	{
+		std::vector<std::pair<std::vector<key_type>, value_type> > recs;
+		for (char *r = records_begin(p); r != records_end(p); r = next_record(r))
+			recs.push_back(std::make_pair(std::vector<key_type>(record_key(r), record_key(r) + record_len(r)), *record_value(r)));
+		std::memset(p.bytes(), 0, page_size());
+		header(p)->type = trie_page;
+		header(p)->value_count = recs.size();
+		p.touch();
+		for (size_t i = 0; i < recs.size(); )
+		{
+			if (recs[i].first.empty())
+			{
+				header(p)->has_value = 1;
+				*trie_value(p) = recs[i++].second;
+				continue;
+			}
+			page_ref b = new_page(bucket_page);
+			const key_type label = recs[i].first[0];
+			for (; i < recs.size() && !recs[i].first.empty() &&
+					!comp(label, recs[i].first[0]) && !comp(recs[i].first[0], label); ++i)
+				bucket_insert(b, records_end(b), &recs[i].first[0] + 1, recs[i].first.size() - 1, recs[i].second);
+			insert_child(p, label, b.id());
+		}
+	}
+
+	// commit unless a bulk update holds the changes back
+	void end_op()
+	{
+		if (bulk_depth == 0 || cache.txn_size() * 2 > cache.get_capacity())
+			cache.commit();
+	}
+
+	// 1 if inserted, 0 if the key was there, -1 on failure; stored is the
+	// value the key has afterwards, so insert() needs no second descent
+	int put(const std::vector<key_type>& key, const value_type& value, bool assign, value_type& stored)
+	{
+		if (!is_open())
+			return -1;
+		const key_type *k = data_of(key);
+		std::vector<page_ref> path;
+		page_id cur = root_id;
+		size_t depth = 0;
+		for (;;)
+		{
+			page_ref p = fetch(cur);
+			if (header(p)->type == trie_page)
+			{
+				path.push_back(p);
+				if (depth == key.size())
+				{
+					if (header(p)->has_value)
+					{
+						if (assign)
+						{
+							*trie_value(p) = value;
+							p.touch();
+							end_op();
+						}
+						stored = *trie_value(p);
+						return 0;
+					}
+					header(p)->has_value = 1;
+					*trie_value(p) = value;
+					p.touch();
+					break;
+				}
+				page_id c = find_child(p, k[depth]);
+				if (c == 0)
+				{
+					page_ref b = new_page(bucket_page);
+					c = b.id();
+					insert_child(p, k[depth], c);
+				}
+				cur = c;
+				++depth;
+				continue;
+			}
+			bool exact;
+			char *r = bucket_lower(p, k + depth, key.size() - depth, exact);
+			if (exact)
+			{
+				if (assign)
+				{
+					*record_value(r) = value;
+					p.touch();
+					end_op();
+				}
+				stored = *record_value(r);
+				return 0;
+			}
+			if (bucket_insert(p, r, k + depth, key.size() - depth, value))
+				break;
+			// look at the same page again as a trie page
+			burst(p);
+		}
+		for (size_t i = 0; i < path.size(); ++i)
+		{
+			++header(path[i])->value_count;
+			path[i].touch();
+		}
+		page_ref m = fetch(meta_id);
+		++meta(m)->size;
+		m.touch();
+		end_op();
+		stored = value;
+		return 1;
+	}
+
+	size_type remove(const std::vector<key_type>& key)
+	{
+		if (!is_open())
+			return 0;
+		const key_type *k = data_of(key);
+		std::vector<page_ref> path;
+		page_id cur = root_id;
+		size_t depth = 0;
+		for (;;)
+		{
+			page_ref p = fetch(cur);
+			if (header(p)->type == trie_page)
+			{
+				path.push_back(p);
+				if (depth == key.size())
+				{
+					if (!header(p)->has_value)
+						return 0;
+					header(p)->has_value = 0;
+					p.touch();
+					break;
+				}
+				cur = find_child(p, k[depth]);
+				if (cur == 0)
+					return 0;
+				++depth;
+				continue;
+			}
+			bool exact;
+			char *r = bucket_lower(p, k + depth, key.size() - depth, exact);
+			if (!exact)
+				return 0;
+			bucket_erase(p, r);
+			if (header(p)->count == 0 && !path.empty())
+			{
+				erase_child(path.back(), k[depth - 1]);
+				release_page(p);
+			}
+			break;
+		}
+		// the trie pages on the path at depth i, drop the ones left without values
+		for (size_t i = path.size(); i-- > 0; )
+		{
+			--header(path[i])->value_count;
+			path[i].touch();
+			if (header(path[i])->value_count == 0 && i > 0)
+			{
+				erase_child(path[i - 1], k[i - 1]);
+				release_chain(path[i]);
+			}
+		}
+		page_ref m = fetch(meta_id);
+		--meta(m)->size;
+		m.touch();
+		end_op();
+		return 1;
+	}
+
+	// the first value of the sub-trie at id, its key is appended to out
+	bool leftmost(page_id id, std::vector<key_type>& out, value_type& v) const
+	{
+		page_ref p = fetch(id);
+		if (header(p)->type == bucket_page)
+		{
+			if (header(p)->count == 0)
+				return false;
+			char *r = records_begin(p);
+			out.insert(out.end(), record_key(r), record_key(r) + record_len(r));
+			v = *record_value(r);
+			return true;
+		}
+		if (header(p)->has_value)
+		{
+			v = *trie_value(p);
+			return true;
+		}
+		return leftmost_child(p, NULL, out, v);
+	}
+
+	// the first value below the children of a trie page, after the label if there is one
+	bool leftmost_child(page_ref p, const key_type *after, std::vector<key_type>& out, value_type& v) const
+	{
+		for (;;)
+		{
+			child_entry *e = entries(p), *last = e + header(p)->count;
+			if (after != NULL)
+			{
+				label_less less = { comp };
+				e = std::lower_bound(e, last, *after, less);
+				if (e != last && !comp(*after, e->label))
+					++e;
+			}
+			for (; e != last; ++e)
+			{
+				out.push_back(e->label);
+				if (leftmost(e->child, out, v))
+					return true;
+				out.pop_back();
+			}
+			if (header(p)->next == 0)
+				return false;
+			p = fetch(header(p)->next);
+		}
+	}
+
+	// the first value after key (seek_upper), not before it (seek_lower) or after all
+	// the keys it is a prefix of (seek_past_prefix), in the sub-trie at id and depth
+	bool seek(page_id id, const std::vector<key_type>& key, size_t depth, int mode,
+			std::vector<key_type>& out, value_type& v) const
+	{
+		page_ref p = fetch(id);
+		const key_type *k = data_of(key);
+		out.assign(key.begin(), key.begin() + depth);
+		if (header(p)->type == bucket_page)
+		{
+			const key_type *t = k + depth;
+			size_t nt = key.size() - depth;
+			for (char *r = records_begin(p); r != records_end(p); r = next_record(r))
+			{
+				int c = compare(record_key(r), record_len(r), t, nt);
+				if (c < 0 || (c == 0 && mode != seek_lower))
+					continue;
+				if (mode == seek_past_prefix && starts_with(record_key(r), record_len(r), t, nt))
+					continue;
+				out.insert(out.end(), record_key(r), record_key(r) + record_len(r));
+				v = *record_value(r);
+				return true;
+			}
+			return false;
+		}
+		if (depth == key.size())
+		{
+			if (mode == seek_past_prefix)
+				return false;
+			if (mode == seek_lower && header(p)->has_value)
+			{
+				v = *trie_value(p);
+				return true;
+			}
+			return leftmost_child(p, NULL, out, v);
+		}
+		page_id c = find_child(p, k[depth]);
+		if (c != 0 && seek(c, key, depth + 1, mode, out, v))
+			return true;
+		out.assign(key.begin(), key.begin() + depth);
+		return leftmost_child(p, k + depth, out, v);
+	}
+
+	iterator seek_iterator(const std::vector<key_type>& key, int mode) const
+	{
+		if (!is_open())
+			return end();
+		std::vector<key_type> out;
+		value_type v = value_type();
+		if (!seek(root_id, key, 0, mode, out, v))
+			return end();
+		return iterator(this, out, v);
+	}
+
+	bool init_file(size_t psize, size_t cache_pages)
+	{
+		if (!valid_page_size(psize) || !cache.start(psize, cache_pages))
+			return false;
+		page_ref m(&cache, cache.fetch(meta_id, true));
+		meta_type *mp = meta(m);
+		std::memcpy(mp->magic, magic(), sizeof(mp->magic));
+		mp->version = format_version;
+		mp->page_size = boost::uint32_t(psize);
+		mp->key_size = sizeof(key_type);
+		mp->value_size = sizeof(value_type);
+		mp->page_count = root_id + 1;
+		m.touch();
+		page_ref r(&cache, cache.fetch(root_id, true));
+		header(r)->type = bucket_page;
+		r.touch();
+		return cache.checkpoint();
+	}
+
+public:
+	explicit paged_trie_map() : cache(), comp(), bulk_depth(0)
+	{
+	}
+
+	explicit paged_trie_map(const std::string& path, size_type cache_pages = 1024, size_type page_size = 4096) :
+		cache(), comp(), bulk_depth(0)
+	{
+		open(path, cache_pages, page_size);
+	}
+
+	// open or create the file, cache_pages frames are kept in memory; page_size
+	// is only used for a new file. Returns false if the file is not a paged
+	// trie of this key and value type
+	bool open(const std::string& path, size_type cache_pages = 1024, size_type page_size = 4096)
+	{
+		close();
+		if (!cache.open(path))
+			return false;
+		meta_type m;
+		bool ok;
+		if (cache.file_size() == 0)
+			ok = init_file(page_size, cache_pages);
+		else
+			ok = cache.read_raw(0, &m, sizeof(m)) &&
+				std::memcmp(m.magic, magic(), sizeof(m.magic)) == 0 && m.version == format_version &&
+				m.key_size == sizeof(key_type) && m.value_size == sizeof(value_type) &&
+				valid_page_size(m.page_size) && cache.start(m.page_size, cache_pages);
+		if (!ok)
+			cache.close();
+		return ok;
+	}
+
+	// write everything back and close the files
+	void close()
+	{
+		bulk_depth = 0;
+		cache.close();
+	}
+
+	bool is_open() const
+	{
+		return cache.is_open();
+	}
+
+	// false after an I/O error
+	bool good() const
+	{
+		return cache.good();
+	}
+
+	// fsync the log after every operation, otherwise only at checkpoints
+	void set_synchronous(bool s)
+	{
+		cache.set_synchronous(s);
+	}
+
+	// write the dirty pages to the file and empty the log
+	bool checkpoint()
+	{
+		return cache.checkpoint();
+	}
+
+	// operations between begin_bulk_update() and end_bulk_update() are logged
+	// together, pages are only logged once however often they change
+	void begin_bulk_update()
+	{
+		++bulk_depth;
+	}
+
+	void end_bulk_update()
+	{
+		if (bulk_depth > 0 && --bulk_depth == 0)
+			cache.commit();
+	}
+
+	const_iterator begin() const
+	{
+		return seek_iterator(std::vector<key_type>(), seek_lower);
+	}
+
+	const_iterator cbegin() const
+	{
+		return begin();
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator();
+	}
+
+	const_iterator cend() const
+	{
+		return end();
+	}
+
+	template<typename Iter>
+	pair_iterator_bool insert(Iter first, Iter last, const value_type& value)
+	{
+		std::vector<key_type> key(first, last);
+		value_type stored;
+		int r = put(key, value, false, stored);
+		if (r < 0)
+			return std::make_pair(end(), false);
+		return std::make_pair(const_iterator(this, key, stored), r > 0);
+	}
+
+	template<typename Container>
+	pair_iterator_bool insert(const Container& container, const value_type& value)
+	{
+		return insert(container.begin(), container.end(), value);
+	}
+
+	// true if the key is new
+	template<typename Iter>
+	bool insert_or_assign(Iter first, Iter last, const value_type& value)
+	{
+		value_type stored;
+		return put(std::vector<key_type>(first, last), value, true, stored) > 0;
+	}
+
+	template<typename Container>
+	bool insert_or_assign(const Container& container, const value_type& value)
+	{
+		return insert_or_assign(container.begin(), container.end(), value);
+	}
+
+	template<typename Iter>
+	const_iterator find(Iter first, Iter last) const
+	{
+		std::vector<key_type> key(first, last);
+		const_iterator it = lower_bound(key);
+		if (it != end() && same_key(it.key, key))
+			return it;
+		return end();
+	}
+
+	template<typename Container>
+	const_iterator find(const Container& container) const
+	{
+		return find(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		return find(first, last) == end() ? 0 : 1;
+	}
+
+	template<typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type count_prefix(Iter first, Iter last) const
+	{
+		if (!is_open())
+			return 0;
+		std::vector<key_type> key(first, last);
+		const key_type *k = data_of(key);
+		page_id cur = root_id;
+		for (size_t depth = 0; ; ++depth)
+		{
+			page_ref p = fetch(cur);
+			if (header(p)->type == bucket_page)
+			{
+				size_type ret = 0;
+				bool exact;
+				for (char *r = bucket_lower(p, k + depth, key.size() - depth, exact);
+						r != records_end(p) && starts_with(record_key(r), record_len(r), k + depth, key.size() - depth);
+						r = next_record(r))
+					++ret;
+				return ret;
+			}
+			if (depth == key.size())
+				return size_type(header(p)->value_count);
+			cur = find_child(p, k[depth]);
+			if (cur == 0)
+				return 0;
+		}
+	}
+
+	template<typename Container>
+	size_type count_prefix(const Container& container) const
+	{
+		return count_prefix(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	iterator_range find_prefix(Iter first, Iter last) const
+	{
+		std::vector<key_type> key(first, last);
+		return std::make_pair(seek_iterator(key, seek_lower), seek_iterator(key, seek_past_prefix));
+	}
+
+	template<typename Container>
+	iterator_range find_prefix(const Container& container) const
+	{
+		return find_prefix(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	const_iterator lower_bound(Iter first, Iter last) const
+	{
+		return seek_iterator(std::vector<key_type>(first, last), seek_lower);
+	}
+
+	template<typename Container>
+	const_iterator lower_bound(const Container& container) const
+	{
+		return lower_bound(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	const_iterator upper_bound(Iter first, Iter last) const
+	{
+		return seek_iterator(std::vector<key_type>(first, last), seek_upper);
+	}
+
+	template<typename Container>
+	const_iterator upper_bound(const Container& container) const
+	{
+		return upper_bound(container.begin(), container.end());
+	}
+
+	// the longest key that is a prefix of [first, last)
+	template<typename Iter>
+	const_iterator findLongestPrefixOfKey(Iter first, Iter last) const
+	{
+		if (!is_open())
+			return end();
+		std::vector<key_type> key(first, last);
+		const key_type *k = data_of(key);
+		size_t best = 0;
+		bool found = false;
+		value_type v = value_type();
+		page_id cur = root_id;
+		for (size_t depth = 0; cur != 0; ++depth)
+		{
+			page_ref p = fetch(cur);
+			if (header(p)->type == bucket_page)
+			{
+				for (char *r = records_begin(p); r != records_end(p); r = next_record(r))
+					if (starts_with(k + depth, key.size() - depth, record_key(r), record_len(r)) &&
+							(!found || depth + record_len(r) >= best))
+					{
+						best = depth + record_len(r);
+						v = *record_value(r);
+						found = true;
+					}
+				break;
+			}
+			if (header(p)->has_value)
+			{
+				best = depth;
+				v = *trie_value(p);
+				found = true;
+			}
+			if (depth == key.size())
+				break;
+			cur = find_child(p, k[depth]);
+		}
+		if (!found)
+			return end();
+		return const_iterator(this, std::vector<key_type>(key.begin(), key.begin() + best), v);
+	}
+
+	template<typename Container>
+	const_iterator findLongestPrefixOfKey(const Container& container) const
+	{
+		return findLongestPrefixOfKey(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type erase(Iter first, Iter last)
+	{
+		return remove(std::vector<key_type>(first, last));
+	}
+
+	template<typename Container>
+	size_type erase(const Container& container)
+	{
+		return erase(container.begin(), container.end());
+	}
+
+	iterator erase(const_iterator it)
+	{
+		const_iterator next = it;
+		++next;
+		remove(it.key);
+		return next;
+	}
+
+	void clear()
+	{
+		if (!is_open())
+			return;
+		cache.discard_from(root_id + 1);
+		page_ref m = fetch(meta_id);
+		meta(m)->page_count = root_id + 1;
+		meta(m)->free_list = meta(m)->free_count = 0;
+		meta(m)->size = 0;
+		m.touch();
+		page_ref r = fetch(root_id);
+		std::memset(r.bytes(), 0, page_size());
+		header(r)->type = bucket_page;
+		r.touch();
+		end_op();
+	}
+
+	bool same_key(const std::vector<key_type>& a, const std::vector<key_type>& b) const
+	{
+		return compare(data_of(a), a.size(), data_of(b), b.size()) == 0;
+	}
+
+	size_type size() const
+	{
+		if (!is_open())
+			return 0;
+		return size_type(meta(fetch(meta_id))->size);
+	}
+
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	// pages in use, the meta page included
+	size_type count_page() const
+	{
+		if (!is_open())
+			return 0;
+		page_ref m = fetch(meta_id);
+		return meta(m)->page_count - meta(m)->free_count;
+	}
+
+	~paged_trie_map()
+	{
+		close();
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_PAGED_TRIE_MAP_HPP
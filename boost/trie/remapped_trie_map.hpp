@@ -0,0 +1,372 @@
+#ifndef BOOST_TRIE_REMAPPED_TRIE_MAP_HPP
+#define BOOST_TRIE_REMAPPED_TRIE_MAP_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "fixed_alphabet_trie.hpp"
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstring>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <boost/array.hpp>
+#include <boost/cstdint.hpp>
+
+//
+// remapped_trie_map is a char-keyed map for keys that use a few of the 256
+// byte values.  A byte_alphabet, given or scanned from sample keys, maps each
+// byte in use to a dense code through a 256-entry table, and every node has
+// an array of children with one slot per code, so a step down is a table
+// lookup and a load while a node costs only the real alphabet.  The codes
+// follow the unsigned byte order, the order of std::string, so iteration is
+// in key order.
+//
+// It is fixed_alphabet_trie with the alphabet chosen at run time: the nodes
+// are in one arena, the child arrays in a table of their own.  A key with a
+// byte outside the alphabet is never in the map, insert() returns end() and
+// false for it.  save() writes the alphabet ahead of the nodes, and load()
+// takes it from the stream.
+//
+
+namespace boost { namespace tries {
+
+class byte_alphabet {
+public:
+	typedef size_t size_type;
+
+private:
+	// the code of each byte plus one, 0 for a byte not in the alphabet
+	boost::array<boost::uint16_t, 256> table;
+	// the bytes by code
+	std::vector<unsigned char> symbols;
+
+	void build()
+	{
+		table.assign(0);
+		for (size_type i = 0; i < symbols.size(); ++i)
+			table[symbols[i]] = boost::uint16_t(i + 1);
+	}
+
+public:
+	explicit byte_alphabet()
+	{
+		table.assign(0);
+	}
+
+	// the bytes in a string, in any order and with repeats
+	explicit byte_alphabet(const std::string& s)
+	{
+		table.assign(0);
+		add(s.begin(), s.end());
+	}
+
+	// add the bytes of [first, last); the codes of the others may change
+	template <typename Iter>
+	void add(Iter first, Iter last)
+	{
+		for (; first != last; ++first)
+			if (table[static_cast<unsigned char>(*first)] == 0)
+				table[static_cast<unsigned char>(*first)] = 1;
+		symbols.clear();
+		for (int b = 0; b < 256; ++b)
+			if (table[b] != 0)
+				symbols.push_back(static_cast<unsigned char>(b));
+		build();
+	}
+
+	// add every byte of the keys in [first, last)
+	template <typename KeyIter>
+	void scan(KeyIter first, KeyIter last)
+	{
+		for (; first != last; ++first)
+			add(first->begin(), first->end());
+	}
+
+	int code(char c) const
+	{
+		return int(table[static_cast<unsigned char>(c)]) - 1;
+	}
+
+	char symbol(int code) const
+	{
+		return static_cast<char>(symbols[code]);
+	}
+
+	bool contains(char c) const
+	{
+		return code(c) >= 0;
+	}
+
+	size_type size() const
+	{
+		return symbols.size();
+	}
+
+	bool operator==(const byte_alphabet& other) const
+	{
+		return symbols == other.symbols;
+	}
+
+	bool operator!=(const byte_alphabet& other) const
+	{
+		return symbols != other.symbols;
+	}
+
+	void swap(byte_alphabet& other)
+	{
+		table.swap(other.table);
+		symbols.swap(other.symbols);
+	}
+
+	// the count and the bytes in order
+	void save(std::ostream& os) const
+	{
+		detail::trie_stream_codec<boost::uint64_t>::write(os, symbols.size());
+		if (!symbols.empty())
+			os.write(reinterpret_cast<const char *>(&symbols[0]), symbols.size());
+	}
+
+	// false on a bad stream or bytes out of order, the alphabet is then empty
+	bool load(std::istream& is)
+	{
+		boost::uint64_t n;
+		symbols.clear();
+		build();
+		if (!detail::trie_stream_codec<boost::uint64_t>::read(is, n) || n > 256)
+			return false;
+		std::vector<unsigned char> tmp(static_cast<size_type>(n));
+		if (n > 0 && !is.read(reinterpret_cast<char *>(&tmp[0]), std::streamsize(n)))
+			return false;
+		for (size_type i = 1; i < tmp.size(); ++i)
+			if (tmp[i - 1] >= tmp[i])
+				return false;
+		symbols.swap(tmp);
+		build();
+		return true;
+	}
+};
+
+namespace detail {
+
+template <typename Index>
+struct remapped_node {
+	// chains the free nodes too
+	Index parent;
+	// the slot in the value table, or none
+	Index value;
+	// values in the sub-trie
+	Index value_count;
+};
+
+// the child arrays are rows of one table, as wide as the alphabet
+template <typename Value, typename Index>
+struct remapped_arena : public dense_arena<remapped_arena<Value, Index>, char, Value, Index, remapped_node<Index> >
+{
+	typedef char key_type;
+	typedef Index index_type;
+
+	byte_alphabet alphabet;
+	// width() entries for each node, by code
+	std::vector<index_type> children;
+
+	explicit remapped_arena()
+	{
+		this->reset();
+	}
+
+	explicit remapped_arena(const byte_alphabet& x) : alphabet(x)
+	{
+		this->reset();
+	}
+
+	int code(key_type k) const
+	{
+		return alphabet.code(k);
+	}
+
+	key_type symbol(int code) const
+	{
+		return alphabet.symbol(code);
+	}
+
+	size_t width() const
+	{
+		return alphabet.size();
+	}
+
+	index_type child(index_type n, int code) const
+	{
+		return children[n * width() + code];
+	}
+
+	void set_child(index_type n, int code, index_type c)
+	{
+		children[n * width() + code] = c;
+	}
+
+	void push_children()
+	{
+		children.resize(children.size() + width());
+	}
+
+	void clear_children(index_type n)
+	{
+		std::fill(children.begin() + n * width(), children.begin() + (n + 1) * width(), this->none());
+	}
+
+	void drop_children()
+	{
+		children.clear();
+	}
+
+	void swap_children(remapped_arena& other)
+	{
+		alphabet.swap(other.alphabet);
+		children.swap(other.children);
+	}
+};
+
+} // namespace detail
+
+
+template <typename Value, typename Index = boost::uint32_t>
+class remapped_trie_map : public detail::dense_trie_map<detail::remapped_arena<Value, Index> > {
+public:
+	typedef detail::dense_trie_map<detail::remapped_arena<Value, Index> > base_type;
+	typedef remapped_trie_map<Value, Index> remapped_trie_map_type;
+	typedef typename base_type::value_type value_type;
+	typedef typename base_type::index_type index_type;
+	typedef typename base_type::size_type size_type;
+	typedef typename base_type::arena_type arena_type;
+
+private:
+	static const char * stream_magic()
+	{
+		return "BTRIEREM";
+	}
+
+	enum { stream_version = 1 };
+
+public:
+	// an empty alphabet, only the empty key fits until load()
+	explicit remapped_trie_map()
+	{
+	}
+
+	explicit remapped_trie_map(const byte_alphabet& x) : base_type(arena_type(x))
+	{
+	}
+
+	const byte_alphabet& alphabet() const
+	{
+		return this->a.alphabet;
+	}
+
+	// the alphabet, then the nodes in pre-order: value flag, value, child
+	// count, and the code of each child ahead of it
+	bool save(std::ostream& os) const
+	{
+		typedef detail::trie_stream_codec<value_type> value_codec;
+		typedef detail::trie_stream_codec<boost::uint64_t> size_codec;
+		typedef detail::trie_stream_codec<boost::uint8_t> code_codec;
+		const arena_type& a = this->a;
+		os.write(stream_magic(), 8);
+		size_codec::write(os, stream_version);
+		a.alphabet.save(os);
+		// node and the next code to look at
+		std::vector<std::pair<index_type, int> > stk;
+		index_type cur = 0;
+		for (;;)
+		{
+			size_codec::write(os, a.has_value(cur) ? 1 : 0);
+			if (a.has_value(cur))
+				value_codec::write(os, a.values[a.nodes[cur].value]);
+			boost::uint64_t n = 0;
+			for (int c = 0; c < int(a.width()); ++c)
+				if (a.child(cur, c) != arena_type::none())
+					++n;
+			size_codec::write(os, n);
+			stk.push_back(std::make_pair(cur, 0));
+			cur = arena_type::none();
+			while (!stk.empty() && cur == arena_type::none())
+			{
+				int& c = stk.back().second;
+				while (c < int(a.width()) && a.child(stk.back().first, c) == arena_type::none())
+					++c;
+				if (c == int(a.width()))
+				{
+					stk.pop_back();
+					continue;
+				}
+				code_codec::write(os, boost::uint8_t(c));
+				cur = a.child(stk.back().first, c++);
+			}
+			if (stk.empty())
+				break;
+		}
+		return bool(os);
+	}
+
+	// replace the content and the alphabet with a stream from save(); on a
+	// bad stream the map is left empty with its old alphabet and false returned
+	bool load(std::istream& is)
+	{
+		typedef detail::trie_stream_codec<value_type> value_codec;
+		typedef detail::trie_stream_codec<boost::uint64_t> size_codec;
+		typedef detail::trie_stream_codec<boost::uint8_t> code_codec;
+		this->a.reset();
+		char magic[8];
+		boost::uint64_t version;
+		byte_alphabet x;
+		if (!is.read(magic, 8) || std::memcmp(magic, stream_magic(), 8) != 0 ||
+				!size_codec::read(is, version) || version != stream_version || !x.load(is))
+			return false;
+		arena_type tmp(x);
+		// node, children still to read and the code of the last one
+		std::vector<std::pair<index_type, std::pair<boost::uint64_t, int> > > stk;
+		index_type cur = 0;
+		for (;;)
+		{
+			boost::uint64_t has_value, children;
+			if (!size_codec::read(is, has_value) || has_value > 1)
+				return false;
+			if (has_value)
+			{
+				value_type v = value_type();
+				if (!value_codec::read(is, v))
+					return false;
+				tmp.nodes[cur].value = tmp.new_value(v);
+				tmp.nodes[cur].value_count = 1;
+			}
+			// a node without a value has to lead to some
+			if (!size_codec::read(is, children) || children > x.size() ||
+					(cur != 0 && !has_value && children == 0))
+				return false;
+			stk.push_back(std::make_pair(cur, std::make_pair(children, -1)));
+			while (!stk.empty() && stk.back().second.first == 0)
+				stk.pop_back();
+			if (stk.empty())
+				break;
+			boost::uint8_t c;
+			if (!code_codec::read(is, c) || int(c) <= stk.back().second.second || c >= x.size() ||
+					tmp.nodes.size() > arena_type::max_node_count())
+				return false;
+			--stk.back().second.first;
+			stk.back().second.second = c;
+			cur = tmp.add_child(stk.back().first, c);
+		}
+		// a child comes after its parent in the arena
+		for (size_type n = tmp.nodes.size(); n-- > 1; )
+			tmp.nodes[tmp.nodes[n].parent].value_count += tmp.nodes[n].value_count;
+		this->a.swap(tmp);
+		return true;
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_REMAPPED_TRIE_MAP_HPP
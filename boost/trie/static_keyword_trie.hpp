@@ -0,0 +1,337 @@
+#ifndef BOOST_TRIE_STATIC_KEYWORD_TRIE_HPP
+#define BOOST_TRIE_STATIC_KEYWORD_TRIE_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#if !(__cplusplus >= 202002L || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L))
+#error "boost/trie/static_keyword_trie.hpp needs C++20"
+#endif
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+//
+// static_keyword_trie is a trie over a keyword list given as template
+// arguments, static_keyword_trie<"GET", "HEAD", "POST">, built entirely at
+// compile time.  The id of a keyword is its position in the list.  There is
+// no object to construct and nothing on the heap: the nodes are one constexpr
+// table in breadth-first order, the children of a node contiguous and sorted
+// by unsigned byte, and every function is static and constexpr.
+//
+// find() gives the id of a key, findLongestPrefixOfKey() the longest keyword
+// that is a prefix of the input, and match_prefix() the keywords that start
+// with a prefix, in key order.
+//
+
+namespace boost { namespace tries {
+
+namespace detail {
+
+// a string literal as a template argument
+template <std::size_t N>
+struct keyword_literal {
+	char data[N];
+
+	constexpr keyword_literal(const char (&s)[N])
+	{
+		for (std::size_t i = 0; i < N; ++i)
+			data[i] = s[i];
+	}
+
+	constexpr std::size_t size() const
+	{
+		return N - 1;
+	}
+
+	constexpr std::string_view view() const
+	{
+		return std::string_view(data, N - 1);
+	}
+};
+
+struct keyword_node {
+	unsigned char label;
+	// the keyword ending here, or -1
+	int id;
+	std::uint32_t first_child;
+	std::uint32_t child_count;
+	// keywords in the sub-trie
+	std::uint32_t value_count;
+};
+
+} // namespace detail
+
+
+template <detail::keyword_literal... Keywords>
+class static_keyword_trie {
+public:
+	typedef std::size_t size_type;
+	// the length of the keyword that is a prefix of the input, and its id
+	typedef std::pair<size_type, int> prefix_match;
+	static constexpr int npos = -1;
+
+private:
+	typedef detail::keyword_node node_type;
+
+	static constexpr size_type keyword_count = sizeof...(Keywords);
+	static constexpr size_type node_bound = (Keywords.size() + ... + size_type(0)) + 1;
+	static constexpr std::array<std::string_view, keyword_count> keywords = { Keywords.view()... };
+
+	struct node_table {
+		std::array<node_type, node_bound> nodes;
+		size_type count;
+		// the longest keyword, the stack match_prefix() needs
+		size_type depth;
+	};
+
+	static constexpr bool distinct()
+	{
+		for (size_type i = 0; i < keyword_count; ++i)
+			for (size_type j = i + 1; j < keyword_count; ++j)
+				if (keywords[i] == keywords[j])
+					return false;
+		return true;
+	}
+
+	// insert the keywords into a first-child / next-sibling tree with the
+	// siblings sorted, then lay it out breadth first
+	static constexpr node_table build()
+	{
+		std::array<int, node_bound> first{}, next{}, parent{}, id{};
+		std::array<unsigned char, node_bound> label{};
+		first.fill(-1);
+		next.fill(-1);
+		id.fill(-1);
+		parent[0] = -1;
+		int count = 1;
+		size_type depth = 0;
+		for (size_type k = 0; k < keyword_count; ++k)
+		{
+			int cur = 0;
+			for (char ch : keywords[k])
+			{
+				unsigned char c = static_cast<unsigned char>(ch);
+				int prev = -1, n = first[cur];
+				while (n != -1 && label[n] < c)
+				{
+					prev = n;
+					n = next[n];
+				}
+				if (n == -1 || label[n] != c)
+				{
+					int m = count++;
+					label[m] = c;
+					parent[m] = cur;
+					next[m] = n;
+					if (prev == -1)
+						first[cur] = m;
+					else
+						next[prev] = m;
+					n = m;
+				}
+				cur = n;
+			}
+			id[cur] = int(k);
+			if (keywords[k].size() > depth)
+				depth = keywords[k].size();
+		}
+
+		node_table t{};
+		std::array<int, node_bound> order{}, position{};
+		size_type size = 1;
+		order[0] = 0;
+		for (size_type i = 0; i < size; ++i)
+		{
+			int n = order[i];
+			position[n] = int(i);
+			node_type& x = t.nodes[i];
+			x.label = label[n];
+			x.id = id[n];
+			x.first_child = std::uint32_t(size);
+			x.child_count = 0;
+			x.value_count = id[n] >= 0 ? 1 : 0;
+			for (int c = first[n]; c != -1; c = next[c])
+			{
+				order[size++] = c;
+				++x.child_count;
+			}
+		}
+		// a child comes after its parent
+		for (size_type i = size; i-- > 1; )
+			t.nodes[position[parent[order[i]]]].value_count += t.nodes[i].value_count;
+		t.count = size;
+		t.depth = depth;
+		return t;
+	}
+
+	static constexpr node_table table = build();
+
+	static_assert(distinct(), "static_keyword_trie: a keyword is given twice");
+
+	// the child of n with label ch, or 0 (the root is nobody's child)
+	static constexpr std::uint32_t child(std::uint32_t n, char ch)
+	{
+		unsigned char c = static_cast<unsigned char>(ch);
+		const node_type& x = table.nodes[n];
+		for (std::uint32_t i = x.first_child; i < x.first_child + x.child_count; ++i)
+		{
+			if (table.nodes[i].label >= c)
+				return table.nodes[i].label == c ? i : 0;
+		}
+		return 0;
+	}
+
+	// the node of [first, last), or 0 if there is none and the input is not empty
+	template <typename Iter>
+	static constexpr std::uint32_t find_node(Iter first, Iter last, bool& found)
+	{
+		std::uint32_t n = 0;
+		found = true;
+		for (; first != last; ++first)
+		{
+			n = child(n, *first);
+			if (n == 0)
+			{
+				found = false;
+				break;
+			}
+		}
+		return n;
+	}
+
+public:
+	// the number of keywords
+	static constexpr size_type size()
+	{
+		return keyword_count;
+	}
+
+	static constexpr bool empty()
+	{
+		return keyword_count == 0;
+	}
+
+	// the root is not counted, the same as trie::count_node()
+	static constexpr size_type count_node()
+	{
+		return table.count - 1;
+	}
+
+	static constexpr std::string_view keyword(int id)
+	{
+		return keywords[id];
+	}
+
+	// the id of the keyword [first, last), npos if it is not one
+	template <typename Iter>
+	static constexpr int find(Iter first, Iter last)
+	{
+		bool found = false;
+		std::uint32_t n = find_node(first, last, found);
+		return found ? table.nodes[n].id : npos;
+	}
+
+	static constexpr int find(std::string_view s)
+	{
+		return find(s.begin(), s.end());
+	}
+
+	template <typename Iter>
+	static constexpr size_type count(Iter first, Iter last)
+	{
+		return find(first, last) == npos ? 0 : 1;
+	}
+
+	static constexpr size_type count(std::string_view s)
+	{
+		return count(s.begin(), s.end());
+	}
+
+	// the longest keyword that is a prefix of [first, last), (0, npos) if none
+	template <typename Iter>
+	static constexpr prefix_match findLongestPrefixOfKey(Iter first, Iter last)
+	{
+		prefix_match ret(0, npos);
+		std::uint32_t n = 0;
+		for (size_type len = 0; ; ++len, ++first)
+		{
+			if (table.nodes[n].id >= 0)
+				ret = prefix_match(len, table.nodes[n].id);
+			if (first == last || (n = child(n, *first)) == 0)
+				break;
+		}
+		return ret;
+	}
+
+	static constexpr prefix_match findLongestPrefixOfKey(std::string_view s)
+	{
+		return findLongestPrefixOfKey(s.begin(), s.end());
+	}
+
+	template <typename Iter>
+	static constexpr size_type count_prefix(Iter first, Iter last)
+	{
+		bool found = false;
+		std::uint32_t n = find_node(first, last, found);
+		return found ? table.nodes[n].value_count : 0;
+	}
+
+	static constexpr size_type count_prefix(std::string_view s)
+	{
+		return count_prefix(s.begin(), s.end());
+	}
+
+	// write the ids of the keywords starting with [first, last) to out, in
+	// key order; returns how many
+	template <typename Iter, typename OutputIter>
+	static constexpr size_type match_prefix(Iter first, Iter last, OutputIter out)
+	{
+		bool found = false;
+		std::uint32_t n = find_node(first, last, found);
+		if (!found)
+			return 0;
+		size_type ret = 0;
+		// node and next child, the path is never longer than the longest keyword
+		std::array<std::pair<std::uint32_t, std::uint32_t>, table.depth + 1> stk{};
+		size_type top = 0;
+		stk[top++] = std::make_pair(n, table.nodes[n].first_child);
+		if (table.nodes[n].id >= 0)
+		{
+			*out++ = table.nodes[n].id;
+			++ret;
+		}
+		while (top > 0)
+		{
+			std::pair<std::uint32_t, std::uint32_t>& p = stk[top - 1];
+			const node_type& x = table.nodes[p.first];
+			if (p.second == x.first_child + x.child_count)
+			{
+				--top;
+				continue;
+			}
+			std::uint32_t c = p.second++;
+			if (table.nodes[c].id >= 0)
+			{
+				*out++ = table.nodes[c].id;
+				++ret;
+			}
+			stk[top++] = std::make_pair(c, table.nodes[c].first_child);
+		}
+		return ret;
+	}
+
+	template <typename OutputIter>
+	static constexpr size_type match_prefix(std::string_view s, OutputIter out)
+	{
+		return match_prefix(s.begin(), s.end(), out);
+	}
+};
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_STATIC_KEYWORD_TRIE_HPP
@@ -0,0 +1,256 @@
+#ifndef BOOST_TRIE_STATIC_TRIE_INDEX_HPP
+#define BOOST_TRIE_STATIC_TRIE_INDEX_HPP
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1020)
+#pragma once
+#endif
+
+#include "trie_set.hpp"
+#include "frozen_trie.hpp"
+#include <vector>
+#include <utility>
+#include <cstring>
+#include <istream>
+#include <ostream>
+
+//
+// static_trie_index maps the keys of a trie_set to dense ids and back: the id
+// of a key is its rank in key order, in [0, size()).  It is the node and label
+// arrays of a frozen_trie without the values; the values of a set are only
+// counted, and value_begin of a node is the rank of the first key below it.
+//
+// id_of() walks down the key, key_of() walks down the node whose value run
+// holds the id, both in O(length * log(alphabet)) with no table of keys.
+//
+
+namespace boost { namespace tries {
+
+template <typename Key, class Compare = std::less<Key> >
+class static_trie_index {
+public:
+	typedef Key key_type;
+	typedef size_t size_type;
+	typedef static_trie_index<Key, Compare> static_trie_index_type;
+	typedef trie_set<Key, Compare> trie_set_type;
+	typedef detail::frozen_node frozen_node;
+	typedef detail::frozen_layout<Key, Compare> layout_type;
+	typedef typename layout_type::index_type index_type;
+	// ids of the keys with a prefix, [first, second)
+	typedef std::pair<size_type, size_type> id_range;
+	static const size_type npos = size_type(-1);
+
+private:
+	std::vector<frozen_node> nodes;
+	std::vector<key_type> labels;
+	size_type key_count;
+
+	static const char * stream_magic()
+	{
+		return "BTRIEIDX";
+	}
+
+	enum { stream_version = 1 };
+
+	layout_type layout() const
+	{
+		return layout_type(&nodes[0], labels.empty() ? NULL : &labels[0]);
+	}
+
+	void reset()
+	{
+		frozen_node r = { 1, 0, 0 };
+		frozen_node sentinel = { 1, 0, 0 };
+		nodes.assign(1, r);
+		nodes.push_back(sentinel);
+		labels.clear();
+		key_count = 0;
+	}
+
+	// the child runs and value runs of a loaded index nest properly
+	bool well_formed() const
+	{
+		return layout().well_formed(index_type(nodes.size() - 1), index_type(key_count));
+	}
+
+public:
+	explicit static_trie_index() : key_count(0)
+	{
+		reset();
+	}
+
+	explicit static_trie_index(const trie_set_type& s) : key_count(0)
+	{
+		typename trie_set_type::frozen_type f = s.freeze();
+		nodes.swap(f.nodes);
+		labels.swap(f.labels);
+		key_count = f.values.size();
+	}
+
+	// the rank of the key, npos if it is not in the index
+	template<typename Iter>
+	size_type id_of(Iter first, Iter last) const
+	{
+		layout_type l = layout();
+		index_type n = l.find_node(first, last);
+		if (n == layout_type::npos || !l.has_value(n))
+			return npos;
+		return nodes[n].value_begin;
+	}
+
+	template<typename Container>
+	size_type id_of(const Container& container) const
+	{
+		return id_of(container.begin(), container.end());
+	}
+
+	// the key with the id, which has to be less than size()
+	std::vector<key_type> key_of(size_type id) const
+	{
+		return layout().key_of_value(index_type(id));
+	}
+
+	template<typename Iter>
+	size_type count(Iter first, Iter last) const
+	{
+		return id_of(first, last) == npos ? 0 : 1;
+	}
+
+	template<typename Container>
+	size_type count(const Container& container) const
+	{
+		return count(container.begin(), container.end());
+	}
+
+	// the keys with a prefix have consecutive ids
+	template<typename Iter>
+	id_range prefix_range(Iter first, Iter last) const
+	{
+		layout_type l = layout();
+		index_type n = l.find_node(first, last);
+		if (n == layout_type::npos)
+			return id_range(key_count, key_count);
+		return id_range(nodes[n].value_begin, nodes[n].value_end);
+	}
+
+	template<typename Container>
+	id_range prefix_range(const Container& container) const
+	{
+		return prefix_range(container.begin(), container.end());
+	}
+
+	template<typename Iter>
+	size_type count_prefix(Iter first, Iter last) const
+	{
+		id_range r = prefix_range(first, last);
+		return r.second - r.first;
+	}
+
+	template<typename Container>
+	size_type count_prefix(const Container& container) const
+	{
+		return count_prefix(container.begin(), container.end());
+	}
+
+	size_type size() const
+	{
+		return key_count;
+	}
+
+	bool empty() const
+	{
+		return key_count == 0;
+	}
+
+	// the root is not counted, the same as trie::count_node()
+	size_type count_node() const
+	{
+		return nodes.size() - 2;
+	}
+
+	void clear()
+	{
+		reset();
+	}
+
+	void swap(static_trie_index_type& other)
+	{
+		nodes.swap(other.nodes);
+		labels.swap(other.labels);
+		std::swap(key_count, other.key_count);
+	}
+
+	// the nodes and labels in native byte order, the keys are written with
+	// the same codec as trie::save()
+	bool save(std::ostream& os) const
+	{
+		typedef detail::trie_stream_codec<key_type> key_codec;
+		typedef detail::trie_stream_codec<boost::uint64_t> size_codec;
+		typedef detail::trie_stream_codec<index_type> index_codec;
+		os.write(stream_magic(), 8);
+		size_codec::write(os, stream_version);
+		size_codec::write(os, sizeof(key_type));
+		size_codec::write(os, key_count);
+		size_codec::write(os, nodes.size());
+		for (size_type i = 0; i < nodes.size(); ++i)
+		{
+			index_codec::write(os, nodes[i].first_child);
+			index_codec::write(os, nodes[i].value_begin);
+			index_codec::write(os, nodes[i].value_end);
+		}
+		for (size_type i = 0; i < labels.size(); ++i)
+			key_codec::write(os, labels[i]);
+		return bool(os);
+	}
+
+	// replace the content with an index from save(), on a bad stream the
+	// index is left empty and false returned
+	bool load(std::istream& is)
+	{
+		typedef detail::trie_stream_codec<key_type> key_codec;
+		typedef detail::trie_stream_codec<boost::uint64_t> size_codec;
+		typedef detail::trie_stream_codec<index_type> index_codec;
+		reset();
+		char magic[8];
+		boost::uint64_t version, key_size, keys, n;
+		if (!is.read(magic, 8) || std::memcmp(magic, stream_magic(), 8) != 0 ||
+				!size_codec::read(is, version) || version != stream_version ||
+				!size_codec::read(is, key_size) || key_size != sizeof(key_type) ||
+				!size_codec::read(is, keys) || !size_codec::read(is, n) ||
+				n < 2 || n > index_type(-1) || keys > index_type(-1))
+			return false;
+		std::vector<frozen_node> tmp_nodes;
+		std::vector<key_type> tmp_labels;
+		// grow with the data, so a corrupt count fails at the end of the stream
+		for (boost::uint64_t i = 0; i < n; ++i)
+		{
+			frozen_node x;
+			if (!index_codec::read(is, x.first_child) || !index_codec::read(is, x.value_begin) ||
+					!index_codec::read(is, x.value_end))
+				return false;
+			tmp_nodes.push_back(x);
+		}
+		for (boost::uint64_t i = 0; i + 2 < n; ++i)
+		{
+			key_type k;
+			if (!key_codec::read(is, k))
+				return false;
+			tmp_labels.push_back(k);
+		}
+		nodes.swap(tmp_nodes);
+		labels.swap(tmp_labels);
+		key_count = size_type(keys);
+		if (!well_formed())
+		{
+			reset();
+			return false;
+		}
+		return true;
+	}
+};
+
+template <typename Key, class Compare>
+const typename static_trie_index<Key, Compare>::size_type static_trie_index<Key, Compare>::npos;
+
+} // tries
+} // boost
+#endif // BOOST_TRIE_STATIC_TRIE_INDEX_HPP
@@ -15,71 +15,611 @@
 #include <stack>
 #include <vector>
 #include <list>
+#include <algorithm>
+#include <string>
+#include <cstring>
 #include <boost/utility.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/is_pod.hpp>
+#include <boost/type_traits/is_empty.hpp>
+#include <boost/type_traits/aligned_storage.hpp>
+#include <boost/type_traits/alignment_of.hpp>
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/static_assert.hpp>
 
 
 namespace boost { namespace tries {
 
 namespace detail {
 
-template <typename Key, typename Value, class Compare>
+template <typename Key, typename Value, class Compare, class Store, class Features>
 struct trie_node;
 
-struct list_node_base : protected boost::noncopyable {
-	typedef list_node_base *base_ptr;
-	base_ptr pred;
-	base_ptr next;
+// the values with one key, any number of them, in one array that starts
+// inside the node and moves to the heap when it outgrows InlineCount; the
+// layout of trie, trie_multimap and trie_multiset
+//
+// a store has a cursor type for a value in it; first() and last() are the
+// cursors of the ends, next() and prev() step and return false at the ends.
+// A new value goes in front of the others, so the array holds the values
+// oldest first and the cursor i is at the element size() - 1 - i
+template <typename Value, size_t InlineCount = 1, bool IsEmpty = boost::is_empty<Value>::value>
+class multi_value_store : private boost::noncopyable {
+public:
+	typedef Value value_type;
+	typedef size_t size_type;
+	typedef size_t cursor;
+	enum { unique = false };
+
+private:
+	typedef std::allocator<value_type> allocator_type;
+	typename boost::aligned_storage<sizeof(value_type) * InlineCount, boost::alignment_of<value_type>::value>::type inline_data;
+	value_type *data;
+	size_type count;
+	size_type capacity;
+
+	value_type * inline_begin()
+	{
+		return static_cast<value_type *>(static_cast<void *>(&inline_data));
+	}
+
+	bool on_heap() const
+	{
+		return capacity > InlineCount;
+	}
+
+	void grow()
+	{
+		size_type n = capacity * 2;
+		value_type *p = allocator_type().allocate(n);
+		for (size_type i = 0; i < count; ++i)
+		{
+			new(p + i) value_type(data[i]);
+			data[i].~value_type();
+		}
+		if (on_heap())
+			allocator_type().deallocate(data, capacity);
+		data = p;
+		capacity = n;
+	}
+
+public:
+	explicit multi_value_store() : data(inline_begin()), count(0), capacity(InlineCount)
+	{
+	}
+
+	~multi_value_store()
+	{
+		clear();
+	}
+
+	size_type size() const
+	{
+		return count;
+	}
+
+	bool empty() const
+	{
+		return count == 0;
+	}
+
+	cursor first() const
+	{
+		return 0;
+	}
+
+	cursor last() const
+	{
+		return count == 0 ? 0 : count - 1;
+	}
+
+	bool next(cursor& c) const
+	{
+		if (c + 1 >= count)
+			return false;
+		++c;
+		return true;
+	}
+
+	bool prev(cursor& c) const
+	{
+		if (c == 0)
+			return false;
+		--c;
+		return true;
+	}
+
+	value_type& value(cursor c)
+	{
+		return data[count - 1 - c];
+	}
+
+	const value_type& value(cursor c) const
+	{
+		return data[count - 1 - c];
+	}
+
+	// the values oldest first, the reverse of the cursor order
+	const value_type * array_begin() const
+	{
+		return data;
+	}
+
+	const value_type * array_end() const
+	{
+		return data + count;
+	}
+
+	cursor push_front(const value_type& x)
+	{
+		if (count == capacity)
+			grow();
+		new(data + count) value_type(x);
+		++count;
+		return 0;
+	}
+
+	// remove the value at c; true if there is a value after it, and then c is its cursor
+	bool erase(cursor& c)
+	{
+		for (size_type i = count - 1 - c; i + 1 < count; ++i)
+			data[i] = data[i + 1];
+		data[--count].~value_type();
+		return c < count;
+	}
+
+	void clear()
+	{
+		for (size_type i = 0; i < count; ++i)
+			data[i].~value_type();
+		if (on_heap())
+			allocator_type().deallocate(data, capacity);
+		data = inline_begin();
+		count = 0;
+		capacity = InlineCount;
+	}
+
+	void assign(const multi_value_store& other)
+	{
+		clear();
+		while (capacity < other.count)
+			grow();
+		for (; count < other.count; ++count)
+			new(data + count) value_type(other.data[count]);
+	}
+
+	void swap(multi_value_store& other)
+	{
+		if (on_heap() && other.on_heap())
+		{
+			std::swap(data, other.data);
+			std::swap(count, other.count);
+			std::swap(capacity, other.capacity);
+			return;
+		}
+		multi_value_store tmp;
+		tmp.assign(*this);
+		assign(other);
+		other.assign(tmp);
+	}
+};
+
+// the copies of an empty Value, like the boost::blank of trie_multiset, are
+// only counted, so a duplicate costs no allocation
+template <typename Value, size_t InlineCount>
+class multi_value_store<Value, InlineCount, true> : private boost::noncopyable {
+public:
+	typedef Value value_type;
+	typedef size_t size_type;
+	typedef size_t cursor;
+	enum { unique = false };
+
+private:
+	static value_type shared;
+	size_type count;
+
+public:
+	explicit multi_value_store() : count(0)
+	{
+	}
+
+	size_type size() const
+	{
+		return count;
+	}
+
+	bool empty() const
+	{
+		return count == 0;
+	}
+
+	cursor first() const
+	{
+		return 0;
+	}
+
+	cursor last() const
+	{
+		return count == 0 ? 0 : count - 1;
+	}
+
+	bool next(cursor& c) const
+	{
+		if (c + 1 >= count)
+			return false;
+		++c;
+		return true;
+	}
+
+	bool prev(cursor& c) const
+	{
+		if (c == 0)
+			return false;
+		--c;
+		return true;
+	}
+
+	value_type& value(cursor) const
+	{
+		return shared;
+	}
+
+	cursor push_front(const value_type&)
+	{
+		++count;
+		return 0;
+	}
+
+	bool erase(cursor& c)
+	{
+		--count;
+		return c < count;
+	}
+
+	void clear()
+	{
+		count = 0;
+	}
+
+	void assign(const multi_value_store& other)
+	{
+		count = other.count;
+	}
+
+	void swap(multi_value_store& other)
+	{
+		std::swap(count, other.count);
+	}
+};
+
+template <typename Value, size_t InlineCount>
+Value multi_value_store<Value, InlineCount, true>::shared;
+
+// at most one value with a key, kept in the trie node itself with no
+// allocation; the layout of trie_map and trie_set. It has a single cursor,
+// and a second value replaces the first
+template <typename Value, bool IsEmpty = boost::is_empty<Value>::value>
+class unique_value_store : private boost::noncopyable {
+public:
+	typedef Value value_type;
+	typedef size_t size_type;
+	typedef size_t cursor;
+	enum { unique = true };
+
+private:
+	typename boost::aligned_storage<sizeof(value_type), boost::alignment_of<value_type>::value>::type data;
+	bool engaged;
+
+	value_type * get()
+	{
+		return static_cast<value_type *>(static_cast<void *>(&data));
+	}
+
+	const value_type * get() const
+	{
+		return static_cast<const value_type *>(static_cast<const void *>(&data));
+	}
+
+public:
+	explicit unique_value_store() : engaged(false)
+	{
+	}
+
+	~unique_value_store()
+	{
+		clear();
+	}
+
+	size_type size() const
+	{
+		return engaged ? 1 : 0;
+	}
+
+	bool empty() const
+	{
+		return !engaged;
+	}
+
+	cursor first() const
+	{
+		return 0;
+	}
+
+	cursor last() const
+	{
+		return 0;
+	}
+
+	bool next(cursor&) const
+	{
+		return false;
+	}
+
+	bool prev(cursor&) const
+	{
+		return false;
+	}
+
+	value_type& value(cursor)
+	{
+		return *get();
+	}
+
+	const value_type& value(cursor) const
+	{
+		return *get();
+	}
+
+	cursor push_front(const value_type& x)
+	{
+		if (engaged)
+		{
+			*get() = x;
+		}
+		else {
+			new(get()) value_type(x);
+			engaged = true;
+		}
+		return 0;
+	}
+
+	bool erase(cursor&)
+	{
+		clear();
+		return false;
+	}
+
+	void clear()
+	{
+		if (engaged)
+		{
+			get()->~value_type();
+			engaged = false;
+		}
+	}
+
+	void assign(const unique_value_store& other)
+	{
+		clear();
+		if (other.engaged)
+			push_front(*other.get());
+	}
+
+	void swap(unique_value_store& other)
+	{
+		if (engaged && other.engaged)
+		{
+			std::swap(*get(), *other.get());
+		}
+		else if (engaged != other.engaged)
+		{
+			unique_value_store& from = engaged ? *this : other;
+			unique_value_store& to = engaged ? other : *this;
+			to.push_front(*from.get());
+			from.clear();
+		}
+	}
+};
+
+// an empty Value, like the boost::blank of trie_set, is not stored at all,
+// only whether the key is there
+template <typename Value>
+class unique_value_store<Value, true> : private boost::noncopyable {
+public:
+	typedef Value value_type;
+	typedef size_t size_type;
+	typedef size_t cursor;
+	enum { unique = true };
+
+private:
+	static value_type shared;
+	bool engaged;
+
+public:
+	explicit unique_value_store() : engaged(false)
+	{
+	}
+
+	size_type size() const
+	{
+		return engaged ? 1 : 0;
+	}
+
+	bool empty() const
+	{
+		return !engaged;
+	}
+
+	cursor first() const
+	{
+		return 0;
+	}
+
+	cursor last() const
+	{
+		return 0;
+	}
+
+	bool next(cursor&) const
+	{
+		return false;
+	}
+
+	bool prev(cursor&) const
+	{
+		return false;
+	}
+
+	value_type& value(cursor) const
+	{
+		return shared;
+	}
+
+	cursor push_front(const value_type&)
+	{
+		engaged = true;
+		return 0;
+	}
+
+	bool erase(cursor&)
+	{
+		engaged = false;
+		return false;
+	}
+
+	void clear()
+	{
+		engaged = false;
+	}
+
+	void assign(const unique_value_store& other)
+	{
+		engaged = other.engaged;
+	}
+
+	void swap(unique_value_store& other)
+	{
+		std::swap(engaged, other.engaged);
+	}
+};
+
+template <typename Value>
+Value unique_value_store<Value, true>::shared;
+
+
+} // namespace detail
+
+// which of the bookkeeping of trie_node a trie keeps; a feature that is off
+// takes no room in the node and no time on insert() and erase(), and the
+// functions that need it do not compile
+//
+// OrderedList: the pred_node/next_node list that iterators follow
+// ParentLinks: parent and child_iter_of_parent, to walk up from a node
+// ValueCounts: the number of values below each node, for count_prefix()
+// SubtrieBounds: the first and last node with a value below each node
+//
+// the list and the counts are fixed by walking up, so they need ParentLinks,
+// and the bounds are positions in the list, so they need OrderedList
+template <bool OrderedList = true, bool ParentLinks = true, bool ValueCounts = true, bool SubtrieBounds = true>
+struct trie_features {
+	BOOST_STATIC_ASSERT_MSG(!OrderedList || ParentLinks, "OrderedList needs ParentLinks");
+	BOOST_STATIC_ASSERT_MSG(!ValueCounts || ParentLinks, "ValueCounts needs ParentLinks");
+	BOOST_STATIC_ASSERT_MSG(!SubtrieBounds || OrderedList, "SubtrieBounds needs OrderedList");
+	static const bool ordered_list = OrderedList;
+	static const bool parent_links = ParentLinks;
+	static const bool value_counts = ValueCounts;
+	static const bool subtrie_bounds = SubtrieBounds;
+	typedef boost::integral_constant<bool, OrderedList> ordered_list_tag;
+	typedef boost::integral_constant<bool, ParentLinks> parent_links_tag;
+	typedef boost::integral_constant<bool, ValueCounts> value_counts_tag;
+	typedef boost::integral_constant<bool, SubtrieBounds> subtrie_bounds_tag;
+};
+
+// a membership set: no iteration, no count_prefix(), no walking up
+typedef trie_features<false, false, false, false> trie_lookup_only;
+
+namespace detail {
+
+// the fields of trie_node behind each feature, empty when it is off
+template <class NodePtr, class ChildIter, bool On>
+struct trie_node_parent_part {
+	NodePtr parent;
+	// store the iterator to optimize operator++ and operator--
+	// utilize that the iterator in map does not change after insertion
+	ChildIter child_iter_of_parent;
+
+	trie_node_parent_part() : parent(0)
+	{
+	}
+};
+
+template <class NodePtr, class ChildIter>
+struct trie_node_parent_part<NodePtr, ChildIter, false> {
+};
+
+template <class NodePtr, bool On>
+struct trie_node_list_part {
+	NodePtr pred_node;
+	NodePtr next_node;
+
+	trie_node_list_part() : pred_node(0), next_node(0)
+	{
+	}
+};
 
-	list_node_base() : pred(0), next(0)
-	{}
+template <class NodePtr>
+struct trie_node_list_part<NodePtr, false> {
 };
 
-template <typename Key, typename Value, class Compare>
-struct value_list_node : public list_node_base {
-	typedef Key key_type;
-	typedef Value value_type;
-	typedef trie_node<key_type, value_type, Compare> trie_node_type;
-	typedef trie_node_type * trie_node_ptr;
-	typedef value_list_node<key_type, value_type, Compare> node_type;
-	typedef node_type * node_ptr;
-	typedef list_node_base * base_ptr;
-	value_type value;
-	trie_node_ptr node_in_trie;
-	explicit value_list_node() : value(), node_in_trie(0)
-	{	
-	}
+template <class NodePtr, bool On>
+struct trie_node_bounds_part {
+	// the first and the last node with values in the sub-trie
+	NodePtr leftmost_value_node;
+	NodePtr rightmost_value_node;
 
-	explicit value_list_node(const value_type& x) : value(x), node_in_trie(0)
+	trie_node_bounds_part() : leftmost_value_node(0), rightmost_value_node(0)
 	{
 	}
+};
 
-	/*
-private:
-	explicit value_list_node(const node_type&)
-	{
+template <class NodePtr>
+struct trie_node_bounds_part<NodePtr, false> {
+};
 
-	}
+template <bool On>
+struct trie_node_count_part {
+	// it is used for something like count_prefix
+	size_t value_count;
 
-	node_type& operator=(const node_type&)
+	trie_node_count_part() : value_count(0)
 	{
 	}
-	*/
 };
 
+template <>
+struct trie_node_count_part<false> {
+};
 
-
-template <typename Key, typename Value, class Compare>
-struct trie_node : private boost::noncopyable {
+template <typename Key, typename Value, class Compare, class Store, class Features>
+struct trie_node : private boost::noncopyable,
+	public trie_node_parent_part<trie_node<Key, Value, Compare, Store, Features> *,
+		typename std::map<Key, trie_node<Key, Value, Compare, Store, Features> *, Compare>::iterator,
+		Features::parent_links>,
+	public trie_node_list_part<trie_node<Key, Value, Compare, Store, Features> *, Features::ordered_list>,
+	public trie_node_bounds_part<trie_node<Key, Value, Compare, Store, Features> *, Features::subtrie_bounds>,
+	public trie_node_count_part<Features::value_counts>
+{
 //protected:
 	typedef Key key_type;
 	typedef key_type* key_ptr;
 	typedef Value value_type;
 	typedef value_type * value_ptr;
 	typedef size_t size_type;
-	typedef trie_node<key_type, value_type, Compare> node_type;
+	typedef trie_node<key_type, value_type, Compare, Store, Features> node_type;
 	typedef node_type* node_ptr;
-	typedef value_list_node<key_type, value_type, Compare> value_list_type;
-	typedef value_list_type * value_list_ptr;
+	typedef Store value_store_type;
 	// maybe the pointer container of children could be defined by user?!
 	typedef std::map<key_type, node_ptr, Compare> children_type;
 
@@ -87,62 +627,34 @@ struct trie_node : private boost::noncopyable {
 
 	children_type child;
 
-//public:
-	node_ptr parent;
-	// store the iterator to optimize operator++ and operator--
-	// utilize that the iterator in map does not change after insertion
-	child_iter child_iter_of_parent;
-
-	// it is used for something like count_prefix 
-	//size_type node_count;
-	size_type value_count;
-	size_type self_value_count;
-	//value_ptr value;
-	value_list_ptr value_list_header;
-	value_list_ptr value_list_tail;
+	// the values with the key of this node
+	value_store_type values;
 
-	value_list_ptr leftmost_value_node;
-	value_list_ptr rightmost_value_node;
+	// set during a bulk update when the counts, bounds and list need to be recomputed
+	bool dirty;
 
-	node_ptr pred_node;
-	node_ptr next_node;
-
-	explicit trie_node() : parent(0), value_count(0), self_value_count(0), 
-	value_list_header(0), value_list_tail(0), leftmost_value_node(0), rightmost_value_node(0), 
-	pred_node(0), next_node(0)
+	explicit trie_node() : values(), dirty(false)
 	{
 	}
 
 	const key_type& key_elem() const
 	{
-		return child_iter_of_parent->first;
+		return this->child_iter_of_parent->first;
 	}
 
 	size_type count() const
 	{
-		return self_value_count;
+		return values.size();
 	}
 
 	bool no_value() const
 	{
-		return self_value_count == 0;
-	}
-
-	/*
-private:
-	explicit trie_node(const node_type&)
-	{
-	}
-
-	node_type& operator=(const node_type&)
-	{
+		return values.empty();
 	}
-	*/
-
 };
 
 
-template <typename Key, typename Value, typename Reference, typename Pointer, class Compare>
+template <typename Key, typename Value, typename Reference, typename Pointer, class Compare, class Store, class Features>
 struct trie_iterator
 {
 	typedef std::bidirectional_iterator_tag iterator_category;
@@ -151,37 +663,40 @@ struct trie_iterator
 	typedef Reference reference;
 	typedef Pointer pointer;
 	typedef ptrdiff_t difference_type;
-	typedef trie_iterator<Key, Value, Value&, Value*, Compare> iterator;
-	typedef trie_iterator<Key, Value, Reference, Pointer, Compare> iter_type;
+	typedef trie_iterator<Key, Value, Value&, Value*, Compare, Store, Features> iterator;
+	typedef trie_iterator<Key, Value, Reference, Pointer, Compare, Store, Features> iter_type;
 	typedef iter_type self;
-	typedef trie_iterator<Key, Value, const Value&, const Value*, Compare> const_iterator;
-	typedef trie_node<Key, Value, Compare> trie_node_type;
+	typedef trie_iterator<Key, Value, const Value&, const Value*, Compare, Store, Features> const_iterator;
+	typedef trie_node<Key, Value, Compare, Store, Features> trie_node_type;
 	typedef trie_node_type* trie_node_ptr;
-	typedef value_list_node<Key, Value, Compare> value_node_type;
-	typedef value_node_type* value_node_ptr;
+	typedef typename Store::cursor cursor;
 
 	trie_node_ptr tnode;
-	value_node_ptr vnode;
+	// the value in the store of tnode
+	cursor pos;
 
 public:
-	explicit trie_iterator() : tnode(0), vnode(0)
+	explicit trie_iterator() : tnode(0), pos()
 	{
 	}
 
-	trie_iterator(trie_node_ptr x) : tnode(x), vnode(x->value_list_header)
+	trie_iterator(trie_node_ptr x) : tnode(x), pos(x->values.first())
 	{
 	}
 
-	trie_iterator(value_node_ptr x) : tnode(x->node_in_trie), vnode(x)
+	explicit trie_iterator(trie_node_ptr t, cursor c) : tnode(t), pos(c)
 	{
 	}
 
-	explicit trie_iterator(trie_node_ptr t, value_node_ptr v) : tnode(t), vnode(v)
+	trie_iterator(const iterator &it) : tnode(it.tnode), pos(it.pos)
 	{
 	}
 
-	trie_iterator(const iterator &it) : tnode(it.tnode), vnode(it.vnode)
+	self& operator=(const iterator &it)
 	{
+		tnode = it.tnode;
+		pos = it.pos;
+		return *this;
 	}
 
 	/*
@@ -191,6 +706,7 @@ public:
 	 */
 	std::vector<key_type> get_key()
 	{
+		BOOST_STATIC_ASSERT_MSG(Features::parent_links, "get_key() needs the ParentLinks feature");
 		std::vector<key_type> key_path;
 		trie_node_ptr cur = tnode;
 		while (cur->parent != NULL)
@@ -226,7 +742,7 @@ public:
 
 	reference operator*() const 
 	{
-		return vnode->value;
+		return tnode->values.value(pos);
 	}
 
 	pointer operator->() const
@@ -236,12 +752,12 @@ public:
 
 	bool operator==(const trie_iterator& other) const
 	{
-		return tnode == other.tnode && vnode == other.vnode;
+		return tnode == other.tnode && pos == other.pos;
 	}
 
 	bool operator!=(const trie_iterator& other) const
 	{
-		return tnode != other.tnode || vnode != other.vnode;
+		return tnode != other.tnode || pos != other.pos;
 	}
 
 	void trie_node_increment()
@@ -262,24 +778,21 @@ public:
 
 	void increment()
 	{
-		if (vnode != NULL && vnode->next != NULL)
-		{
-			vnode = static_cast<value_node_ptr>(vnode->next);
+		BOOST_STATIC_ASSERT_MSG(Features::ordered_list, "iterating needs the OrderedList feature");
+		// the values on root are not iterated, root is only the end
+		if (tnode->parent != NULL && tnode->values.next(pos))
 			return;
-		}
 		trie_node_increment();
-		vnode = tnode->value_list_header;
+		pos = tnode->values.first();
 	}
 
 	void decrement()
 	{
-		if (vnode != NULL && vnode->pred != NULL)
-		{
-			vnode = static_cast<value_node_ptr>(vnode->pred);
+		BOOST_STATIC_ASSERT_MSG(Features::ordered_list, "iterating needs the OrderedList feature");
+		if (tnode->parent != NULL && tnode->values.prev(pos))
 			return;
-		}
 		trie_node_decrement();
-		vnode = tnode->value_list_tail;
+		pos = tnode->values.last();
 	}
 
 	self& operator++() 
@@ -344,6 +857,12 @@ public:
 	{
 	}
 
+	self& operator=(const self &other)
+	{
+		base_iter = other.base();
+		return *this;
+	}
+
 	iter_type base() const
 	{
 		return base_iter;
@@ -403,128 +922,265 @@ public:
 };
 
 
+// how save() and load() write a key or value, POD types byte for byte and
+// std::string as a 64-bit length followed by the characters
+template <typename T, bool IsPod = boost::is_pod<T>::value>
+struct trie_stream_codec;
+
+template <typename T>
+struct trie_stream_codec<T, true> {
+	static void write(std::ostream& os, const T& x)
+	{
+		os.write(reinterpret_cast<const char *>(&x), sizeof(T));
+	}
+
+	static bool read(std::istream& is, T& x)
+	{
+		return bool(is.read(reinterpret_cast<char *>(&x), sizeof(T)));
+	}
+};
+
+template <>
+struct trie_stream_codec<std::string, false> {
+	static void write(std::ostream& os, const std::string& x)
+	{
+		trie_stream_codec<boost::uint64_t>::write(os, x.size());
+		os.write(x.data(), x.size());
+	}
+
+	static bool read(std::istream& is, std::string& x)
+	{
+		boost::uint64_t n;
+		if (!trie_stream_codec<boost::uint64_t>::read(is, n))
+			return false;
+		x.clear();
+		// grow with the data, so a corrupt length fails at the end of the stream
+		char buf[4096];
+		while (n > 0)
+		{
+			size_t k = n < sizeof(buf) ? size_t(n) : sizeof(buf);
+			if (!is.read(buf, k))
+				return false;
+			x.append(buf, k);
+			n -= k;
+		}
+		return true;
+	}
+};
+
 } // namespace detail
 
 
+template <typename Key, typename Value, class Compare>
+class frozen_trie;
 
+// Store keeps the values with one key in a node, detail::multi_value_store for any
+// number of values and detail::unique_value_store for at most one; Features is a
+// trie_features that says which of the node bookkeeping is kept
 template <typename Key, typename Value,
-		 class Compare>
+		 class Compare, class Store = detail::multi_value_store<Value>,
+		 class Features = trie_features<> >
 class trie {
 public:
 	typedef Key key_type;
 	typedef key_type * key_ptr;
 	typedef Value value_type;
 	typedef value_type* value_ptr;
-	typedef trie<key_type, value_type, Compare> trie_type;
-	typedef typename detail::trie_node<key_type, value_type, Compare> node_type;
+	typedef Store value_store_type;
+	typedef Features features_type;
+	typedef trie<key_type, value_type, Compare, Store, Features> trie_type;
+	typedef typename detail::trie_node<key_type, value_type, Compare, Store, Features> node_type;
 	typedef node_type * node_ptr;
-	typedef typename detail::value_list_node<key_type, value_type, Compare> value_node_type;
-	typedef value_node_type * value_node_ptr;
+	typedef typename value_store_type::cursor cursor;
 
+	typedef frozen_trie<key_type, value_type, Compare> frozen_type;
 	typedef std::allocator< node_type > trie_node_allocator;
-	typedef std::allocator< value_node_type > value_allocator;
 	typedef size_t size_type;
 
 private:
 	trie_node_allocator trie_node_alloc;
-	value_allocator value_alloc;
 
 	node_ptr root;
-	size_type node_count; // node_count is difficult and useless to maintain on each node, so, put it on the tree
+	mutable size_type node_count; // node_count is difficult and useless to maintain on each node, so, put it on the tree
+	mutable bool node_count_valid; // false after whole sub-tries are moved between tries, count_node() recounts
+	size_type bulk_depth; // nesting level of bulk updates
+	size_type value_total; // kept here too, value_count of root is optional
+	// the nodes of the first jump_depth levels by their key elements, level 1 in
+	// the first 256 slots and level 2 in the next 65536, see set_jump_levels()
+	std::vector<node_ptr> jump_table;
+	size_type jump_depth;
 
-	value_node_ptr new_value_node(const value_type& x)
+	typedef typename Features::ordered_list_tag ordered_list_tag;
+	typedef typename Features::parent_links_tag parent_links_tag;
+	typedef typename Features::value_counts_tag value_counts_tag;
+	typedef typename Features::subtrie_bounds_tag subtrie_bounds_tag;
+	// anything that has to be fixed on the path up from a changed node
+	typedef boost::integral_constant<bool, Features::ordered_list ||
+		Features::value_counts || Features::subtrie_bounds> path_tag;
+
+	enum { stream_version = 1 };
+
+	static const char * stream_magic()
 	{
-		value_node_ptr v = value_alloc.allocate(1);
-		if (v == NULL)
-			return v;
-		new(v) value_node_type(x);
-		return v;
+		return "BTRIESTR";
 	}
 
-	bool delete_value_node(value_node_ptr p)
+	// a byte key in the default order indexes the jump table directly
+	typedef boost::integral_constant<bool, boost::is_integral<key_type>::value && sizeof(key_type) == 1 &&
+		boost::is_same<Compare, std::less<key_type> >::value> byte_key_tag;
+
+	static size_type jump_byte(const key_type& k, boost::true_type)
 	{
-		if (!p)
-			return false;
-		--p->node_in_trie->self_value_count;
-		value_alloc.destroy(p);
-		value_alloc.deallocate(p, 1);
-		return true;
+		return static_cast<unsigned char>(k);
+	}
+
+	static size_type jump_byte(const key_type&, boost::false_type)
+	{
+		return 0;
 	}
 
-	void erase_value_list(node_ptr cur)
+	// the slot of the child k of the node in slot parent_slot at level - 1
+	static size_type jump_slot(size_type parent_slot, size_type level, const key_type& k)
 	{
-		value_node_ptr vp = cur->value_list_header;
-		if (!cur->no_value())
+		size_type b = jump_byte(k, byte_key_tag());
+		return level == 1 ? b : 256 + (parent_slot << 8) + b;
+	}
+
+	// the deepest node of the table on the path of [first, last), first is moved
+	// past it; root when the table is off, NULL when the path leaves the trie
+	// there. The slot comes from the key alone, one load reaches the node
+	template<typename Iter>
+		node_ptr jump(Iter& first, Iter last) const
+		{
+			size_type slot = 0, level = 0;
+			Iter it = first;
+			for (; level < jump_depth && it != last; ++it)
+				slot = jump_slot(slot, ++level, *it);
+			if (level == 0)
+				return root;
+			first = it;
+			return jump_table[slot];
+		}
+
+	// set the slots on the path of [first, last) from the trie, after a key
+	// is inserted or erased
+	template<typename Iter>
+		void refresh_jump(Iter first, Iter last)
 		{
-			while (vp != NULL)
+			node_ptr cur = root;
+			size_type slot = 0;
+			for (size_type level = 1; level <= jump_depth && first != last; ++level, ++first)
 			{
-				value_node_ptr tmp = static_cast<value_node_ptr>(vp->next);
-				delete_value_node(vp);
-				vp = tmp;
+				slot = jump_slot(slot, level, *first);
+				if (cur != NULL)
+				{
+					typename node_type::child_iter ci = cur->child.find(*first);
+					cur = (ci == cur->child.end()) ? NULL : ci->second;
+				}
+				jump_table[slot] = cur;
 			}
 		}
-		cur->self_value_count = 0;
-		cur->value_list_header = cur->value_list_tail = NULL;
-	}
 
-	node_ptr get_trie_node() 
+	// cur is about to leave its parent; needs the parent links
+	void forget_jump(node_ptr cur)
 	{
-		node_ptr new_node = trie_node_alloc.allocate(1);
-		if (new_node != NULL)
-			++node_count; 
-		return new_node;
+		if (jump_depth == 0)
+			return;
+		node_ptr p = cur->parent;
+		if (p == root)
+			jump_table[jump_slot(0, 1, cur->child_iter_of_parent->first)] = NULL;
+		else if (jump_depth == 2 && p->parent == root)
+			jump_table[jump_slot(jump_slot(0, 1, p->child_iter_of_parent->first), 2, cur->child_iter_of_parent->first)] = NULL;
 	}
 
-	node_ptr create_trie_node() 
+	// whether clearing the sub-trie of node removes nodes of the table; needs
+	// the parent links
+	bool above_jump(node_ptr node) const
 	{
-		node_ptr tmp = get_trie_node();
-		if (tmp != NULL)
+		return jump_depth > 0 && (node == root || (jump_depth == 2 && node->parent == root));
+	}
+
+	// set from the trie, or clear, the slots of the table nodes below cur that
+	// may hold keys in [lo, hi]; cur is in slot at level. A bound that is no
+	// longer on the path is unbounded, the same as in erase_range_below(), so
+	// only the nodes in the range and on the paths of lo and hi are visited
+	template<typename Iter>
+		void jump_range_below(node_ptr cur, size_type slot, size_type level, Iter lo, Iter lo_end, bool lo_bounded,
+				Iter hi, Iter hi_end, bool hi_bounded, bool clear)
 		{
-			new(tmp) node_type();
+			// every key below cur is greater than hi
+			if (hi_bounded && hi == hi_end)
+				return;
+			typename node_type::children_type::key_compare comp = cur->child.key_comp();
+			typename node_type::child_iter ci = (lo_bounded && lo != lo_end) ? cur->child.lower_bound(*lo) : cur->child.begin();
+			typename node_type::child_iter ce = hi_bounded ? cur->child.upper_bound(*hi) : cur->child.end();
+			for (; ci != ce; ++ci)
+			{
+				size_type s = jump_slot(slot, level + 1, ci->first);
+				jump_table[s] = clear ? NULL : ci->second;
+				if (level + 1 == jump_depth)
+					continue;
+				bool on_lo = lo_bounded && lo != lo_end && !comp(*lo, ci->first);
+				bool on_hi = hi_bounded && !comp(ci->first, *hi);
+				Iter l = lo, h = hi;
+				if (on_lo)
+					++l;
+				if (on_hi)
+					++h;
+				jump_range_below(ci->second, s, level + 1, l, lo_end, on_lo, h, hi_end, on_hi, clear);
+			}
 		}
-		return tmp;
+
+	// set or clear the slots of all the table nodes, in O(their number)
+	void jump_below_root(bool clear)
+	{
+		const key_type *none = NULL;
+		if (jump_depth > 0)
+			jump_range_below(root, 0, 0, none, none, false, none, none, false, clear);
 	}
 
-	node_ptr create_trie_node(const value_type& value) 
+	// the same for the table nodes below node; needs the parent links
+	void jump_below(node_ptr node, bool clear)
 	{
-		node_ptr tmp = get_trie_node();
-		if (tmp != NULL)
-		{
-			new(tmp) node_type();
-			value_node_ptr vn = new_value_node(value); 
-			value_list_push(tmp, vn);
-		}
-		return tmp;
+		const key_type *none = NULL;
+		if (node == root)
+			jump_below_root(clear);
+		else if (above_jump(node))
+			jump_range_below(node, jump_slot(0, 1, node->child_iter_of_parent->first), 1,
+					none, none, false, none, none, false, clear);
 	}
 
-	void value_list_push(node_ptr tmp, value_node_ptr vn)
+	// fill the whole table from the first levels of the trie, when its size changes
+	void rebuild_jump()
 	{
-		vn->node_in_trie = tmp;
-		vn->next = tmp->value_list_header;
-		if (tmp->value_list_header != NULL)
+		if (jump_depth == 0)
+			return;
+		std::fill(jump_table.begin(), jump_table.end(), node_ptr(NULL));
+		for (typename node_type::child_iter ci = root->child.begin(); ci != root->child.end(); ++ci)
 		{
-			tmp->value_list_header->pred = vn;
-		}
-		else {
-			// empty list
-			tmp->value_list_tail = vn;
+			size_type slot = jump_slot(0, 1, ci->first);
+			jump_table[slot] = ci->second;
+			if (jump_depth < 2)
+				continue;
+			for (typename node_type::child_iter cj = ci->second->child.begin(); cj != ci->second->child.end(); ++cj)
+				jump_table[jump_slot(slot, 2, cj->first)] = cj->second;
 		}
-		tmp->value_list_header = vn;
-		++tmp->self_value_count;
 	}
 
-	node_ptr create_trie_node(value_node_ptr vl_header)
+	node_ptr get_trie_node() 
+	{
+		node_ptr new_node = trie_node_alloc.allocate(1);
+		if (new_node != NULL)
+			++node_count; 
+		return new_node;
+	}
+
+	node_ptr create_trie_node() 
 	{
 		node_ptr tmp = get_trie_node();
 		if (tmp != NULL)
 		{
 			new(tmp) node_type();
-			while (vl_header != NULL)
-			{
-				value_node_ptr vn = new_value_node(vl_header->value); 
-				value_list_push(tmp, vn);
-				vl_header = static_cast<value_node_ptr>(vl_header->next);
-			}
 		}
 		return tmp;
 	}
@@ -533,7 +1189,6 @@ private:
 	{
 		if (p == NULL)
 			return false;
-		erase_value_list(p);
 		// actually delete the node
 		trie_node_alloc.destroy(p);
 		trie_node_alloc.deallocate(p, 1);
@@ -541,6 +1196,111 @@ private:
 		return true;
 	}
 
+	// free a detached sub-trie, nothing outside it is touched; returns the
+	// number of values freed
+	size_type destroy_subtree(node_ptr node)
+	{
+		size_type ret = 0;
+		std::vector<node_ptr> stk;
+		stk.push_back(node);
+		while (!stk.empty())
+		{
+			node_ptr cur = stk.back();
+			stk.pop_back();
+			for (typename node_type::child_iter ci = cur->child.begin(); ci != cur->child.end(); ++ci)
+				stk.push_back(ci->second);
+			ret += cur->count();
+			delete_trie_node(cur);
+		}
+		return ret;
+	}
+
+	// remove all the descendants of node at once, the ancestors are left to the caller
+	size_type clear_children(node_ptr node)
+	{
+		size_type ret = 0;
+		if (node->child.empty())
+			return ret;
+		unlink_children(node->child.begin(), node->child.end(), ordered_list_tag());
+		for (typename node_type::child_iter ci = node->child.begin(); ci != node->child.end(); ++ci)
+			ret += destroy_subtree(ci->second);
+		node->child.clear();
+		return ret;
+	}
+
+	// the values of the sub-tries in [first, last) are contiguous in the
+	// pred_node/next_node list, so cut them out in one step
+	void unlink_children(typename node_type::child_iter first, typename node_type::child_iter last, boost::true_type)
+	{
+		node_ptr lo = leftmost_value(first->second);
+		--last;
+		node_ptr hi = rightmost_value(last->second);
+		lo->pred_node->next_node = hi->next_node;
+		hi->next_node->pred_node = lo->pred_node;
+	}
+
+	void unlink_children(typename node_type::child_iter, typename node_type::child_iter, boost::false_type)
+	{
+	}
+
+	void set_parent(node_ptr node, node_ptr parent, typename node_type::child_iter ci, boost::true_type)
+	{
+		node->parent = parent;
+		node->child_iter_of_parent = ci;
+	}
+
+	void set_parent(node_ptr, node_ptr, typename node_type::child_iter, boost::false_type)
+	{
+	}
+
+	void set_parent(node_ptr node, node_ptr parent, typename node_type::child_iter ci)
+	{
+		set_parent(node, parent, ci, parent_links_tag());
+	}
+
+	void set_value_count(node_ptr node, size_type n, boost::true_type)
+	{
+		node->value_count = n;
+	}
+
+	void set_value_count(node_ptr, size_type, boost::false_type)
+	{
+	}
+
+	void set_value_count(node_ptr node, size_type n)
+	{
+		set_value_count(node, n, value_counts_tag());
+	}
+
+	void add_value_count(node_ptr node, size_type inserted, size_type erased, boost::true_type)
+	{
+		node->value_count += inserted;
+		node->value_count -= erased;
+	}
+
+	void add_value_count(node_ptr, size_type, size_type, boost::false_type)
+	{
+	}
+
+	// fix the counts and the bounds from cur up to the root
+	void update_path(node_ptr cur, size_type inserted, size_type erased, boost::true_type)
+	{
+		for (; cur != NULL; cur = cur->parent)
+		{
+			update_left_and_right(cur);
+			add_value_count(cur, inserted, erased, value_counts_tag());
+		}
+	}
+
+	void update_path(node_ptr, size_type, size_type, boost::false_type)
+	{
+	}
+
+	void update_path(node_ptr cur, size_type inserted, size_type erased)
+	{
+		update_path(cur, inserted, erased, path_tag());
+	}
+
 	// need constant time to get leftmost
 	node_ptr leftmost_node(node_ptr node) const
 	{
@@ -552,15 +1312,32 @@ private:
 		return cur;
 	}
 
-	value_node_ptr leftmost_value(node_ptr node) const
+	node_ptr leftmost_value(node_ptr node, boost::true_type) const
 	{
-		/*
-		node = leftmost_node(node);
-		return static_cast<value_node_ptr>(node->value_list_header);
-		*/
 		return node->leftmost_value_node;
 	}
 
+	// without the bounds, walk down; a node that is not the root has values below it
+	node_ptr leftmost_value(node_ptr node, boost::false_type) const
+	{
+		node_ptr cur = leftmost_node(node);
+		return cur->no_value() ? NULL : cur;
+	}
+
+	node_ptr leftmost_value(node_ptr node) const
+	{
+		return leftmost_value(node, subtrie_bounds_tag());
+	}
+
+	// the node of begin(): the values on root are not iterated, so it is the
+	// leftmost value below root, NULL if there is none
+	node_ptr first_value_node() const
+	{
+		if (root->child.empty())
+			return NULL;
+		return leftmost_value(root->child.begin()->second);
+	}
+
 	// need constant time to get rightmost
 	node_ptr rightmost_node(node_ptr node) const
 	{
@@ -572,26 +1349,41 @@ private:
 		return cur;
 	}
 
-	value_node_ptr rightmost_value(node_ptr node) const
+	node_ptr rightmost_value(node_ptr node, boost::true_type) const
 	{
-		/*
-		node = rightmost_node(node);
-		return static_cast<value_node_ptr>(node->value_list_tail);
-		*/
 		return node->rightmost_value_node;
 	}
 
+	node_ptr rightmost_value(node_ptr node, boost::false_type) const
+	{
+		node_ptr cur = rightmost_node(node);
+		return cur->no_value() ? NULL : cur;
+	}
+
+	node_ptr rightmost_value(node_ptr node) const
+	{
+		return rightmost_value(node, subtrie_bounds_tag());
+	}
+
 	void update_left_and_right(node_ptr node)
+	{
+		update_left_and_right(node, subtrie_bounds_tag());
+	}
+
+	void update_left_and_right(node_ptr, boost::false_type)
+	{
+	}
+
+	void update_left_and_right(node_ptr node, boost::true_type)
 	{
 		if (node->child.empty())
 		{
-			node->leftmost_value_node = node->value_list_header;
-			node->rightmost_value_node = node->value_list_tail;
+			node->leftmost_value_node = node->rightmost_value_node = node->no_value() ? NULL : node;
 			return;
 		}
 		if (!node->no_value())
 		{
-			node->leftmost_value_node = node->value_list_header;
+			node->leftmost_value_node = node;
 		}
 		else {
 			node->leftmost_value_node = node->child.begin()->second->leftmost_value_node;
@@ -606,6 +1398,7 @@ private:
 			return;
 
 		clear();
+		value_total = 0;
  		// because of the pred_node and next_node fields, copy() should implement by inserting one by one
 		// but inserting one by one need key, so it is hard to do that
 
@@ -613,7 +1406,6 @@ private:
 		std::stack<typename node_type::child_iter> ci_stk;
 		other_node_stk.push(other_root);
 		self_node_stk.push(root);
-		root->pred_node = root->next_node = root;
 		ci_stk.push(other_root->child.begin());
 		for (; !other_node_stk.empty(); )
 		{
@@ -630,18 +1422,11 @@ private:
 			} else {
 				node_ptr c = ci_stk.top()->second;
 				// create new node
-				node_ptr new_node;
-				if (!c->no_value())
-				{
-					new_node = create_trie_node(c->value_list_header);
-				}
-				else {
-					new_node = create_trie_node();
-				}
-				new_node->self_value_count = c->self_value_count;
-				new_node->value_count = c->value_count;
-				new_node->parent = self_cur;
-				new_node->child_iter_of_parent = self_cur->child.insert(std::make_pair(ci_stk.top()->first, new_node)).first;
+				node_ptr new_node = create_trie_node();
+				new_node->values.assign(c->values);
+				value_total += new_node->count();
+				copy_value_count(new_node, c, value_counts_tag());
+				set_parent(new_node, self_cur, self_cur->child.insert(std::make_pair(ci_stk.top()->first, new_node)).first);
 				if (!new_node->no_value())
 					link_node(new_node);
 				// to next node
@@ -651,8 +1436,18 @@ private:
 				self_node_stk.push(new_node);
 			}
 		}
-		root->value_count = other_root->value_count;
-		root->self_value_count = other_root->self_value_count;
+		copy_value_count(root, other_root, value_counts_tag());
+		root->values.assign(other_root->values);
+		value_total += root->count();
+	}
+
+	void copy_value_count(node_ptr dst, node_ptr src, boost::true_type)
+	{
+		dst->value_count = src->value_count;
+	}
+
+	void copy_value_count(node_ptr, node_ptr, boost::false_type)
+	{
 	}
 
 	node_ptr next_node_with_value(node_ptr tnode)
@@ -735,7 +1530,152 @@ private:
 		return tnode;
 	}
 
+	void mark_dirty(node_ptr cur)
+	{
+		mark_dirty(cur, path_tag());
+	}
+
+	// nothing to rebuild
+	void mark_dirty(node_ptr, boost::false_type)
+	{
+	}
+
+	// mark the path up to the root, stop at the first node that is already marked
+	void mark_dirty(node_ptr cur, boost::true_type)
+	{
+		while (cur != NULL && !cur->dirty)
+		{
+			cur->dirty = true;
+			cur = cur->parent;
+		}
+	}
+
+	// recompute value_count, the leftmost/rightmost caches and the pred_node/next_node list
+	// of all dirty nodes; clean sub-tries are spliced into the list as a whole
+	void rebuild_dirty()
+	{
+		if (root->dirty)
+			rebuild_dirty(path_tag());
+	}
+
+	void rebuild_dirty(boost::false_type)
+	{
+	}
+
+	void rebuild_dirty(boost::true_type)
+	{
+		node_ptr pred = root;
+		std::stack<node_ptr> node_stk;
+		std::stack<typename node_type::child_iter> ci_stk;
+		node_stk.push(root);
+		ci_stk.push(root->child.begin());
+		while (!node_stk.empty())
+		{
+			node_ptr cur = node_stk.top();
+			if (ci_stk.top() == cur->child.end())
+			{
+				recount_values(cur, value_counts_tag());
+				update_left_and_right(cur);
+				cur->dirty = false;
+				node_stk.pop();
+				ci_stk.pop();
+				continue;
+			}
+			node_ptr c = (ci_stk.top()++)->second;
+			if (c->dirty)
+			{
+				if (!c->no_value())
+					pred = thread_after(pred, c, c, ordered_list_tag());
+				node_stk.push(c);
+				ci_stk.push(c->child.begin());
+			}
+			else {
+				pred = thread_subtrie(pred, c, ordered_list_tag());
+			}
+		}
+		thread_after(pred, root, root, ordered_list_tag());
+	}
+
+	void recount_values(node_ptr cur, boost::true_type)
+	{
+		cur->value_count = cur->count();
+		for (typename node_type::child_iter ci = cur->child.begin(); ci != cur->child.end(); ++ci)
+			cur->value_count += ci->second->value_count;
+	}
+
+	void recount_values(node_ptr, boost::false_type)
+	{
+	}
+
+	// put the run [first, last] of the list right after pred, returns the new tail
+	node_ptr thread_after(node_ptr pred, node_ptr first, node_ptr last, boost::true_type)
+	{
+		pred->next_node = first;
+		first->pred_node = pred;
+		return last;
+	}
+
+	node_ptr thread_after(node_ptr pred, node_ptr, node_ptr, boost::false_type)
+	{
+		return pred;
+	}
+
+	// a clean sub-trie is already threaded and goes in as a whole
+	node_ptr thread_subtrie(node_ptr pred, node_ptr c, boost::true_type)
+	{
+		return thread_after(pred, leftmost_value(c), rightmost_value(c), boost::true_type());
+	}
+
+	node_ptr thread_subtrie(node_ptr pred, node_ptr, boost::false_type)
+	{
+		return pred;
+	}
+
+	// free every node and value, including the values on root; unlike clear(),
+	// it does not rely on the counters or the leftmost/rightmost caches
+	void drop_all()
+	{
+		jump_below_root(true);
+		for (typename node_type::child_iter ci = root->child.begin(); ci != root->child.end(); ++ci)
+			destroy_subtree(ci->second);
+		root->child.clear();
+		root->values.clear();
+		set_value_count(root, 0);
+		root->dirty = false;
+		update_left_and_right(root);
+		reset_list(ordered_list_tag());
+		value_total = 0;
+	}
+
+	// the list is a ring through root, the end() sentinel
+	void reset_list(boost::true_type)
+	{
+		root->pred_node = root->next_node = root;
+	}
+
+	void reset_list(boost::false_type)
+	{
+	}
+
 	void link_node(node_ptr cur)
+	{
+		link_node(cur, ordered_list_tag());
+	}
+
+	void link_node(node_ptr, boost::false_type)
+	{
+	}
+
+	void unlink_node(node_ptr cur)
+	{
+		unlink_node(cur, ordered_list_tag());
+	}
+
+	void unlink_node(node_ptr, boost::false_type)
+	{
+	}
+
+	void link_node(node_ptr cur, boost::true_type)
 	{
 		node_ptr next = next_node_with_value(cur);
 		node_ptr pred = next->pred_node;
@@ -745,7 +1685,7 @@ private:
 		pred->next_node = cur;
 	}
 
-	void unlink_node(node_ptr cur)
+	void unlink_node(node_ptr cur, boost::true_type)
 	{
 		node_ptr next_node = cur->next_node;
 		node_ptr pred_node = cur->pred_node;
@@ -757,24 +1697,52 @@ private:
 public:
 	// iterators still unavailable here
 
-	explicit trie() : trie_node_alloc(), value_alloc(), root(create_trie_node()), node_count(0)/*, value_count(0) */
+	explicit trie() : trie_node_alloc(), root(create_trie_node()), node_count(0), node_count_valid(true), bulk_depth(0), value_total(0), jump_depth(0)
 	{
-		root->pred_node = root->next_node = root;
+		reset_list(ordered_list_tag());
 	}
 
-	explicit trie(const trie_type& t) : trie_node_alloc(), value_alloc(), root(create_trie_node()), node_count(0)/* , value_count(0) */
+	explicit trie(const trie_type& t) : trie_node_alloc(), root(create_trie_node()), node_count(0), node_count_valid(true), bulk_depth(0), value_total(0), jump_depth(0)
 	{
+		reset_list(ordered_list_tag());
 		copy_tree(t.root);
+		set_jump_levels(t.jump_depth);
 	}
 
 	trie_type& operator=(const trie_type& t)
 	{
 		copy_tree(t.root);
+		set_jump_levels(t.jump_depth);
 		return *this;
 	}
 
+	// an optional table indexed by the first one or two key elements that points
+	// straight at the nodes of those levels, so a lookup skips the child maps of
+	// root and of its children (256 or 256 + 65536 slots). It is kept up to date
+	// by insertions and erasions; when whole sub-tries go, only the slots of
+	// their nodes in the table and of the nodes on the boundary paths are set.
+	// Only for byte keys in the default order; returns false and leaves the
+	// table alone otherwise or for more than two levels; 0 drops it
+	bool set_jump_levels(size_type levels)
+	{
+		if (levels > 2 || (levels > 0 && !byte_key_tag::value))
+			return false;
+		jump_depth = levels;
+		if (levels == 0)
+			std::vector<node_ptr>().swap(jump_table);
+		else
+			jump_table.resize(levels == 1 ? 256 : 256 + 65536);
+		rebuild_jump();
+		return true;
+	}
+
+	size_type jump_levels() const
+	{
+		return jump_depth;
+	}
+
 
-	typedef detail::trie_iterator<Key, Value, Value&, Value*, Compare> iterator;
+	typedef detail::trie_iterator<Key, Value, Value&, Value*, Compare, Store, Features> iterator;
 	typedef typename iterator::const_iterator const_iterator;
 	typedef detail::trie_reverse_iterator<iterator> reverse_iterator;
 	typedef detail::trie_reverse_iterator<const_iterator> const_reverse_iterator;
@@ -782,29 +1750,31 @@ public:
 	//typedef typename reverse_iterator::const_reverse_iterator const_reverse_iterator;
 	typedef std::pair<iterator, bool> pair_iterator_bool;
 	typedef std::pair<iterator, iterator> iterator_range;
+	// the values with one key as a contiguous array
+	typedef std::pair<const value_type *, const value_type *> value_span_type;
 
 	iterator begin() 
 	{
-		value_node_ptr vp = leftmost_value(root);
-		if (vp == NULL)
+		node_ptr np = first_value_node();
+		if (np == NULL)
 			return root;
-		else return vp;
+		else return np;
 	}
 
 	const_iterator begin() const
 	{
-		value_node_ptr vp = leftmost_value(root);
-		if (vp == NULL)
+		node_ptr np = first_value_node();
+		if (np == NULL)
 			return root;
-		else return vp;
+		else return np;
 	}
 
 	const_iterator cbegin() const
 	{
-		value_node_ptr vp = leftmost_value(root);
-		if (vp == NULL)
+		node_ptr np = first_value_node();
+		if (np == NULL)
 			return root;
-		else return vp;
+		else return np;
 	}
 
 	iterator end() 
@@ -860,35 +1830,57 @@ public:
 			{
 				const key_type& cur_key = *first;
 				node_ptr new_node = create_trie_node();
-				new_node->parent = cur;
 				typename node_type::child_iter ci = cur->child.insert(std::make_pair(cur_key, new_node)).first;
-				new_node->child_iter_of_parent = ci;
+				set_parent(new_node, cur, ci);
 				cur = ci->second;
 			}
-			// insert the new value node into value_list
-			value_node_ptr vn = new_value_node(value);
-			value_list_push(cur, vn);
+			// a node joins the list with its first value; a unique store overwrites
+			bool was_empty = cur->no_value();
+			size_type old_count = cur->count();
+			// a new value goes in front of the others with the key
+			cursor pos = cur->values.push_front(value);
+			value_total += cur->count() - old_count;
+
+			if (bulk_depth > 0)
+			{
+				mark_dirty(cur);
+				return iterator(cur, pos);
+			}
 
-			if (cur->next_node == 0 || cur->pred_node == 0)
+			if (was_empty && cur != root)
 				link_node(cur);
 
-			// update value_count on the path
-			node_ptr tmp = cur;
-			while (tmp != NULL) // until root
+			update_path(cur, cur->count() - old_count, 0);
+
+			return iterator(cur, pos);
+		}
+
+	// the path of the key leaves the trie above the end of the jump table
+	template<typename Iter>
+		iterator insert_below_jump(Iter first, Iter last, const value_type& value)
+		{
+			node_ptr cur = root;
+			Iter it = first;
+			for (; it != last; ++it)
 			{
-				update_left_and_right(tmp);
-				++tmp->value_count;
-				tmp = tmp->parent;
+				typename node_type::child_iter ci = cur->child.find(*it);
+				if (ci == cur->child.end())
+					break;
+				cur = ci->second;
 			}
-
-			return cur->value_list_header;
+			iterator ret = __insert(cur, it, last, value);
+			refresh_jump(first, last);
+			return ret;
 		}
 
 	template<typename Iter>
 		pair_iterator_bool insert_unique(Iter first, Iter last, const value_type& value)
 		{
-			node_ptr cur = root;
-			for (; first != last; ++first)
+			Iter rest = first;
+			node_ptr cur = jump(rest, last);
+			if (cur == NULL)
+				return std::make_pair(insert_below_jump(first, last, value), true);
+			for (first = rest; first != last; ++first)
 			{
 				const key_type& cur_key = *first;
 				typename node_type::child_iter ci = cur->child.find(cur_key);
@@ -916,8 +1908,11 @@ public:
 		iterator insert_equal(Iter first, Iter last,
 				const value_type& value)
 		{
-			node_ptr cur = root;
-			for (; first != last; ++first)
+			Iter rest = first;
+			node_ptr cur = jump(rest, last);
+			if (cur == NULL)
+				return insert_below_jump(first, last, value);
+			for (first = rest; first != last; ++first)
 			{
 				const key_type& cur_key = *first;
 				typename node_type::child_iter ci = cur->child.find(cur_key);
@@ -927,6 +1922,9 @@ public:
 				}
 				cur = ci->second;
 			}
+			// with a unique store it is insert_unique()
+			if (value_store_type::unique && !cur->no_value())
+				return cur;
 			return __insert(cur, first, last, value);
 		}
 
@@ -939,7 +1937,9 @@ public:
 	template<typename Iter>
 		node_ptr find_node(Iter first, Iter last)
 		{
-			node_ptr cur = root;
+			node_ptr cur = jump(first, last);
+			if (cur == NULL)
+				return NULL;
 			for (; first != last; ++first)
 			{
 				const key_type& cur_key = *first;
@@ -958,6 +1958,17 @@ public:
 	{
 		node_ptr cur = root;
 		node_ptr longestPrefixOfKeyNode = NULL;
+		size_type slot = 0;
+		// the slots of the levels do not depend on each other, the loads overlap
+		for (size_type level = 1; level <= jump_depth && first != last; ++level, ++first)
+		{
+			slot = jump_slot(slot, level, *first);
+			cur = jump_table[slot];
+			if (cur == NULL)
+				return longestPrefixOfKeyNode;
+			if (!cur->no_value())
+				longestPrefixOfKeyNode = cur;
+		}
 		for (; first != last; ++first)
 		{
 //			std::cout << "current char: " << *first << std::endl;
@@ -1051,6 +2062,7 @@ public:
 	template<typename Iter>
 		size_type count_prefix(Iter first, Iter last)
 		{
+			BOOST_STATIC_ASSERT_MSG(Features::value_counts, "count_prefix() needs the ValueCounts feature");
 			node_ptr node = find_node(first, last);
 			if (node == NULL)
 			{
@@ -1069,6 +2081,7 @@ public:
 	template<typename Iter>
 		node_ptr upper_bound(Iter first, Iter last)
 		{
+			BOOST_STATIC_ASSERT_MSG(Features::ordered_list, "upper_bound() needs the OrderedList feature");
 			node_ptr cur = root;
 			// use a stack to store iterator in order to avoid the iterator cannot go backward
 			std::stack< Iter > si;
@@ -1118,6 +2131,7 @@ public:
 	template<typename Iter>
 		node_ptr lower_bound(Iter first, Iter last)
 		{
+			BOOST_STATIC_ASSERT_MSG(Features::parent_links, "lower_bound() needs the ParentLinks feature");
 			node_ptr cur = root;
 			// use a stack to store iterator in order to avoid the iterator cannot go backward
 			std::stack< Iter > si;
@@ -1166,11 +2180,11 @@ public:
 			// @that is not right here
 			//return make_pair(lower_bound(first, last), upper_bound(first, last));
 			node_ptr node = find_node(first, last);
-			if (node == NULL || node->value_list_header == NULL)
+			if (node == NULL || node->no_value())
 				return make_pair(iterator(root), iterator(root));
-			iterator it_end = iterator(node->value_list_tail);
+			iterator it_end = iterator(node, node->values.last());
 			++it_end;
-			return make_pair(iterator(node->value_list_header), it_end);
+			return make_pair(iterator(node), it_end);
 		}
 
 	template<typename Container>
@@ -1179,36 +2193,188 @@ public:
 			return equal_range(container.begin(), container.end());
 		}
 
+	// the values with the key in place, oldest first, which is the reverse of
+	// the order of equal_range(); needs a store that keeps its values in an
+	// array, that is not the one of trie_multiset
+	template<typename Iter>
+		value_span_type value_span(Iter first, Iter last)
+		{
+			node_ptr node = find_node(first, last);
+			if (node == NULL)
+				return value_span_type(NULL, NULL);
+			return value_span_type(node->values.array_begin(), node->values.array_end());
+		}
+
+	template<typename Container>
+		value_span_type value_span(const Container &container)
+		{
+			return value_span(container.begin(), container.end());
+		}
+
+	// erase keys in [lo, hi) below cur, a bound that is no longer on the path of cur is unbounded
+	// only the two boundary paths are visited, the sub-tries between them are removed as a whole
+	template<typename Iter>
+		size_type erase_range_below(node_ptr cur, Iter lo, Iter lo_end, bool lo_bounded,
+				Iter hi, Iter hi_end, bool hi_bounded)
+		{
+			// every key below cur is not less than hi
+			if (hi_bounded && hi == hi_end)
+				return 0;
+			size_type ret = 0;
+			if (cur != root && !cur->no_value() && (!lo_bounded || lo == lo_end))
+			{
+				ret += cur->count();
+				cur->values.clear();
+				unlink_node(cur);
+			}
+
+			typename node_type::children_type::key_compare comp = cur->child.key_comp();
+			typename node_type::child_iter ci = cur->child.begin(), ce = cur->child.end();
+			// end() when the bound leaves the trie at cur
+			typename node_type::child_iter lo_child = cur->child.end(), hi_child = cur->child.end();
+			if (lo_bounded && lo != lo_end)
+			{
+				ci = cur->child.lower_bound(*lo);
+				if (ci != cur->child.end() && !comp(*lo, ci->first))
+				{
+					lo_child = ci;
+					++ci;
+				}
+			}
+			if (hi_bounded)
+			{
+				ce = cur->child.lower_bound(*hi);
+				if (ce != cur->child.end() && !comp(*hi, ce->first))
+					hi_child = ce;
+			}
+
+			if (lo_child != cur->child.end() && lo_child == hi_child)
+			{
+				ret += erase_range_child(cur, lo_child, ++lo, lo_end, true, ++hi, hi_end, true);
+			}
+			else {
+				if (ci != ce)
+				{
+					unlink_children(ci, ce, ordered_list_tag());
+					for (typename node_type::child_iter i = ci; i != ce; ++i)
+						ret += destroy_subtree(i->second);
+					cur->child.erase(ci, ce);
+				}
+				if (lo_child != cur->child.end())
+					ret += erase_range_child(cur, lo_child, ++lo, lo_end, true, hi, hi_end, false);
+				if (hi_child != cur->child.end())
+					ret += erase_range_child(cur, hi_child, lo, lo_end, false, ++hi, hi_end, true);
+			}
+			add_value_count(cur, 0, ret, value_counts_tag());
+			update_left_and_right(cur);
+			return ret;
+		}
+
+	template<typename Iter>
+		size_type erase_range_child(node_ptr cur, typename node_type::child_iter ci, Iter lo, Iter lo_end, bool lo_bounded,
+				Iter hi, Iter hi_end, bool hi_bounded)
+		{
+			node_ptr c = ci->second;
+			size_type ret = erase_range_below(c, lo, lo_end, lo_bounded, hi, hi_end, hi_bounded);
+			if (c->child.empty() && c->no_value())
+			{
+				cur->child.erase(ci);
+				delete_trie_node(c);
+			}
+			return ret;
+		}
+
+	size_type recount_nodes() const
+	{
+		size_type ret = 0;
+		std::vector<node_ptr> stk;
+		stk.push_back(root);
+		while (!stk.empty())
+		{
+			node_ptr cur = stk.back();
+			stk.pop_back();
+			++ret;
+			for (typename node_type::child_iter ci = cur->child.begin(); ci != cur->child.end(); ++ci)
+				stk.push_back(ci->second);
+		}
+		// root is not counted
+		return ret - 1;
+	}
+
 	void erase_check_ancestor(node_ptr cur, size_type delta) // delete empty ancestors and update value_count
 	{
+		value_total -= delta;
 		while (cur != root && cur->child.empty() && cur->no_value())
 		{
 			node_ptr parent = cur->parent;
+			forget_jump(cur);
 			parent->child.erase(cur->child_iter_of_parent);
 			delete_trie_node(cur);
 			cur = parent;
 		}
 
-		// update value_count on each ancestral node
-		while (cur != NULL)
+		if (bulk_depth > 0)
 		{
-			update_left_and_right(cur);
-			cur->value_count -= delta;
-			cur = cur->parent;
+			mark_dirty(cur);
+			return;
 		}
+
+		update_path(cur, 0, delta);
 	}
 
+	// erase_node() without parent links: the path down to the node is kept on the way
+	template<typename Iter>
+		size_type erase_node(Iter first, Iter last, boost::false_type)
+		{
+			std::vector<typename node_type::child_iter> path;
+			node_ptr cur = root;
+			Iter key = first;
+			for (; first != last; ++first)
+			{
+				typename node_type::child_iter ci = cur->child.find(*first);
+				if (ci == cur->child.end())
+					return 0;
+				path.push_back(ci);
+				cur = ci->second;
+			}
+			size_type ret = cur->count();
+			cur->values.clear();
+			value_total -= ret;
+			bool pruned = false;
+			for (size_type i = path.size(); i-- > 0 && cur->child.empty() && cur->no_value(); )
+			{
+				node_ptr parent = (i == 0) ? root : path[i - 1]->second;
+				parent->child.erase(path[i]);
+				delete_trie_node(cur);
+				cur = parent;
+				pruned = true;
+			}
+			if (pruned)
+				refresh_jump(key, last);
+			return ret;
+		}
+
+	template<typename Iter>
+		size_type erase_node(Iter first, Iter last, boost::true_type)
+		{
+			return erase_node(find_node(first, last));
+		}
+
 public:
 	//erase one node with value, and erase empty ancestors
 	size_type erase_node(node_ptr node)
 	{
+		BOOST_STATIC_ASSERT_MSG(Features::parent_links, "erase_node(node_ptr) needs the ParentLinks feature");
 		size_type ret = 0;
-		if (node == NULL)
+		// a node on the way to other keys has nothing to erase
+		if (node == NULL || node->no_value())
 			return ret;
-		ret = node->self_value_count;
+		ret = node->count();
 		node_ptr cur = node;
-		erase_value_list(cur);
-		unlink_node(cur);
+		cur->values.clear();
+		// the list is rebuilt when a bulk update ends, root is the end() sentinel and stays linked
+		if (bulk_depth == 0 && cur != root)
+			unlink_node(cur);
 
 		erase_check_ancestor(cur, ret);
 
@@ -1218,40 +2384,33 @@ public:
 	// erase one value, after erasing value, check if it is necessary to erase node
 	iterator erase(iterator it)
 	{
+		BOOST_STATIC_ASSERT_MSG(Features::ordered_list, "erase(iterator) needs the OrderedList feature");
 		if (it == end())
 			return it;
-		iterator ret = it;
-		++ret;
-		value_node_ptr vp = it.vnode;
 		node_ptr cur = it.tnode;
-		if (vp->next == NULL && vp->pred == NULL)
+		if (cur->count() == 1)
 		{
+			// the list can not be followed during a bulk update
+			iterator ret = end();
+			if (bulk_depth == 0)
+				++(ret = it);
 			erase_node(cur);
-		} else {
-			if (vp->pred)
-			{
-				vp->pred->next = vp->next;
-			}
-			else { // is value_list_header
-				cur->value_list_header = static_cast<value_node_ptr>(vp->next);
-			}
-			if (vp->next)
-			{
-				vp->next->pred = vp->pred;
-			}
-			else { // is value_list_tail
-				cur->value_list_tail = static_cast<value_node_ptr>(vp->pred);
-			}
-			delete_value_node(vp);
-
-			erase_check_ancestor(cur, 1);
+			return ret;
 		}
-		return ret;
+		cursor pos = it.pos;
+		bool more = cur->values.erase(pos);
+		erase_check_ancestor(cur, 1);
+		if (bulk_depth > 0)
+			return end();
+		if (more)
+			return iterator(cur, pos);
+		iterator ret(cur, cur->values.last());
+		return ++ret;
 	}
 
 	iterator erase(const_iterator it)
 	{
-		return erase(iterator(it.tnode, it.vnode));
+		return erase(iterator(it.tnode, it.pos));
 	}
 
 	template<typename Iter>
@@ -1268,10 +2427,11 @@ public:
 			return erase(container.begin(), container.end());
 		}
 
+	// works with any features, the path is recorded when there are no parent links
 	template<typename Iter>
 		size_type erase_node(Iter first, Iter last)
 		{
-			return erase_node(find_node(first, last));
+			return erase_node(first, last, parent_links_tag());
 		}
 
 	template<typename Container>
@@ -1280,21 +2440,200 @@ public:
 			return erase_node(container.begin(), container.end());
 		}
 
-	// erase a range of iterators
-	void erase(iterator first, iterator last)
+	// erase a range of iterators; during a bulk update the trie is brought up
+	// to date first and the range is erased outside of it, since erase(iterator)
+	// can not follow the list there
+	iterator erase(iterator first, iterator last)
+	{
+		size_type depth = bulk_depth;
+		flush_bulk_update();
+		bulk_depth = 0;
+		while (first != last)
+			first = erase(first);
+		bulk_depth = depth;
+		return last;
+	}
+
+	// erase all keys in [lo, hi), in O(depth) plus the erased nodes
+	template<typename Iter>
+		size_type erase_range(Iter lo_first, Iter lo_last, Iter hi_first, Iter hi_last)
+		{
+			if (!std::lexicographical_compare(lo_first, lo_last, hi_first, hi_last, root->child.key_comp()))
+				return 0;
+			flush_bulk_update();
+			// the slots of the range go first, the nodes on the paths of the bounds come back
+			if (jump_depth > 0)
+				jump_range_below(root, 0, 0, lo_first, lo_last, true, hi_first, hi_last, true, true);
+			size_type ret = erase_range_below(root, lo_first, lo_last, true, hi_first, hi_last, true);
+			value_total -= ret;
+			if (jump_depth > 0)
+			{
+				refresh_jump(lo_first, lo_last);
+				refresh_jump(hi_first, hi_last);
+			}
+			return ret;
+		}
+
+	template<typename Container>
+		size_type erase_range(const Container &lo, const Container &hi)
+		{
+			return erase_range(lo.begin(), lo.end(), hi.begin(), hi.end());
+		}
+
+	// move all keys not less than [first, last) into other, whose old content is cleared
+	// whole sub-tries change owner, only the nodes on the path of the key are touched
+	template<typename Iter>
+		void split_at(Iter first, Iter last, trie_type& other)
+		{
+			BOOST_STATIC_ASSERT_MSG(Features::parent_links && Features::value_counts,
+					"split_at() needs the ParentLinks and ValueCounts features");
+			if (&other == this)
+				return;
+			flush_bulk_update();
+			other.clear();
+			Iter key = first;
+			if (jump_depth > 0)
+				jump_range_below(root, 0, 0, first, last, true, last, last, false, true);
+			std::vector<node_ptr> path;
+			std::vector<key_type> elems;
+			std::vector< std::vector<std::pair<key_type, node_ptr> > > moved;
+			node_ptr key_node = NULL;
+			node_ptr cur = root;
+			for (;;)
+			{
+				path.push_back(cur);
+				moved.push_back(std::vector<std::pair<key_type, node_ptr> >());
+				typename node_type::child_iter ci = (first == last) ? cur->child.begin() : cur->child.upper_bound(*first);
+				for (typename node_type::child_iter i = ci; i != cur->child.end(); ++i)
+					moved.back().push_back(std::make_pair(i->first, i->second));
+				cur->child.erase(ci, cur->child.end());
+				if (first == last)
+				{
+					if (cur != root && !cur->no_value())
+						key_node = cur;
+					break;
+				}
+				typename node_type::child_iter next = cur->child.find(*first);
+				if (next == cur->child.end())
+					break;
+				elems.push_back(*first);
+				++first;
+				cur = next->second;
+			}
+
+			// build the path in other and fix the counts on both paths from bottom up
+			size_type moved_count = 0;
+			node_ptr dst_child = NULL;
+			for (size_type i = path.size(); i-- > 0; )
+			{
+				node_ptr src = path[i];
+				for (size_type j = 0; j < moved[i].size(); ++j)
+					moved_count += moved[i][j].second->value_count;
+				if (src == key_node)
+					moved_count += src->count();
+				node_ptr dst = NULL;
+				if (moved_count > 0)
+				{
+					dst = (i == 0) ? other.root : other.create_trie_node();
+					for (size_type j = 0; j < moved[i].size(); ++j)
+					{
+						node_ptr c = moved[i][j].second;
+						c->parent = dst;
+						c->child_iter_of_parent = dst->child.insert(dst->child.end(), moved[i][j]);
+					}
+					if (dst_child != NULL)
+					{
+						dst_child->parent = dst;
+						dst_child->child_iter_of_parent = dst->child.insert(std::make_pair(elems[i], dst_child)).first;
+					}
+					if (src == key_node)
+					{
+						dst->values.swap(src->values);
+						replace_in_list(src, dst, ordered_list_tag());
+					}
+					dst->value_count = moved_count;
+					other.update_left_and_right(dst);
+				}
+				src->value_count -= moved_count;
+				if (src != root && src->child.empty() && src->no_value())
+				{
+					path[i - 1]->child.erase(src->child_iter_of_parent);
+					delete_trie_node(src);
+				}
+				else {
+					update_left_and_right(src);
+				}
+				dst_child = dst;
+			}
+			node_count_valid = other.node_count_valid = false;
+			value_total -= moved_count;
+			other.value_total = moved_count;
+			// the table nodes that moved are set in other, the path of the key here
+			if (jump_depth > 0)
+				refresh_jump(key, last);
+			if (other.jump_depth > 0)
+				other.jump_range_below(other.root, 0, 0, key, last, true, last, last, false, false);
+			if (moved_count > 0)
+				move_list_tail(other, ordered_list_tag());
+		}
+
+	// dst takes the place of src in the list
+	void replace_in_list(node_ptr src, node_ptr dst, boost::true_type)
+	{
+		dst->pred_node = src->pred_node;
+		dst->next_node = src->next_node;
+		dst->pred_node->next_node = dst;
+		dst->next_node->pred_node = dst;
+		src->pred_node = src->next_node = 0;
+	}
+
+	void replace_in_list(node_ptr, node_ptr, boost::false_type)
+	{
+	}
+
+	// after split_at() the moved values are the tail of the list
+	void move_list_tail(trie_type& other, boost::true_type)
+	{
+		node_ptr first_moved = leftmost_value(other.root);
+		node_ptr last_moved = root->pred_node;
+		first_moved->pred_node->next_node = root;
+		root->pred_node = first_moved->pred_node;
+		first_moved->pred_node = other.root;
+		other.root->next_node = first_moved;
+		last_moved->next_node = other.root;
+		other.root->pred_node = last_moved;
+	}
+
+	void move_list_tail(trie_type&, boost::false_type)
 	{
-		for (; first != last; ++first)
-			erase(first);
 	}
 
+	template<typename Container>
+		void split_at(const Container &container, trie_type& other)
+		{
+			split_at(container.begin(), container.end(), other);
+		}
+
 
 	// erase all subsequences with prefix
 	template<typename Iter>
 		size_type erase_prefix(Iter first, Iter last)
 		{
+			BOOST_STATIC_ASSERT_MSG(Features::parent_links, "erase_prefix() needs the ParentLinks feature");
+			flush_bulk_update();
 			node_ptr cur = find_node(first, last);
-			size_type ret = cur->value_count;
-			clear(cur);
+			if (cur == NULL)
+				return 0;
+			jump_below(cur, true);
+			size_type ret = clear_children(cur);
+			// the key equal to the prefix goes too, root is the end() sentinel and stays linked
+			if (cur != root && !cur->no_value())
+			{
+				ret += cur->count();
+				cur->values.clear();
+				unlink_node(cur);
+			}
+			erase_check_ancestor(cur, ret);
 			return ret;
 		}
 
@@ -1311,67 +2650,205 @@ public:
 
 
 
+	// erase the whole sub-trie below node, the values on node itself are kept
 	size_type clear(node_ptr node)
 	{
-		node_ptr cur = node;
-		size_type ret = cur->value_count;
-		ret -= cur->self_value_count; // do not count values on the node
-
-		node_ptr leftmost = leftmost_node(cur);
-		node_ptr rightmost = rightmost_node(cur);
-		if (leftmost == rightmost) // there's only one node in the sub-trie
-			return ret;
-		// clear by iteration
-		if (leftmost == cur)
-		{
-			cur = cur->next_node;
-		}
-		else {
-			cur = leftmost;
-		}
-		for (node_ptr next; cur != rightmost; cur = next)
-		{
-			next = cur->next_node;
-			erase_node(cur);
-		}
-		// erase rightmost
-		erase_node(cur);
-		
+		BOOST_STATIC_ASSERT_MSG(Features::parent_links, "clear(node_ptr) needs the ParentLinks feature");
+		flush_bulk_update();
+		jump_below(node, true);
+		size_type ret = clear_children(node);
+		erase_check_ancestor(node, ret);
 		return ret;
 	}
 
-	void swap(const trie_type& t)
+	// between begin_bulk_update() and end_bulk_update(), insertions and erasions only mark
+	// the nodes they change; the counters, the leftmost/rightmost caches and the ordered
+	// list are rebuilt once at the end. Until then iteration, count_prefix(), find_prefix()
+	// and the bounds see stale data, and erase() returns end()
+	void begin_bulk_update()
+	{
+		++bulk_depth;
+	}
+
+	void end_bulk_update()
+	{
+		if (bulk_depth > 0 && --bulk_depth == 0)
+			rebuild_dirty();
+	}
+
+	// bring the trie up to date without leaving the bulk update
+	void flush_bulk_update()
+	{
+		if (bulk_depth > 0)
+			rebuild_dirty();
+	}
+
+	void swap(trie_type& t)
 	{
 		// is it OK?
 		std::swap(root, t.root);
 		std::swap(t.node_count, node_count);
-		std::swap(t.value_alloc, value_alloc);
+		std::swap(t.node_count_valid, node_count_valid);
+		std::swap(t.bulk_depth, bulk_depth);
+		std::swap(t.value_total, value_total);
+		jump_table.swap(t.jump_table);
+		std::swap(t.jump_depth, jump_depth);
 		std::swap(t.trie_node_alloc, trie_node_alloc);
 	}
 
+	// the values with the empty key stay, like with clear(root_node())
 	void clear()
 	{
-		clear(root);
+		flush_bulk_update();
+		jump_below_root(true);
+		size_type ret = clear_children(root);
+		value_total -= ret;
+		update_path(root, 0, ret);
+	}
+
+	node_ptr root_node() const
+	{
+		return root;
+	}
+
+	// an immutable compact copy, boost/trie/frozen_trie.hpp has to be included
+	frozen_type freeze() const
+	{
+		return frozen_type(*this);
+	}
+
+	// checkpoint in one pre-order pass; every node is written as
+	// edge label (not for the root), value count, values, child count
+	bool save(std::ostream& os) const
+	{
+		typedef detail::trie_stream_codec<key_type> key_codec;
+		typedef detail::trie_stream_codec<value_type> value_codec;
+		typedef detail::trie_stream_codec<boost::uint64_t> size_codec;
+		os.write(stream_magic(), 8);
+		size_codec::write(os, stream_version);
+		size_codec::write(os, sizeof(key_type));
+		std::vector<std::pair<node_ptr, typename node_type::child_iter> > stk;
+		node_ptr cur = root;
+		for (;;)
+		{
+			size_codec::write(os, cur->count());
+			if (!cur->no_value())
+			{
+				cursor pos = cur->values.first();
+				do {
+					value_codec::write(os, cur->values.value(pos));
+				} while (cur->values.next(pos));
+			}
+			size_codec::write(os, cur->child.size());
+			stk.push_back(std::make_pair(cur, cur->child.begin()));
+			while (!stk.empty() && stk.back().second == stk.back().first->child.end())
+				stk.pop_back();
+			if (stk.empty())
+				break;
+			typename node_type::child_iter ci = stk.back().second++;
+			key_codec::write(os, ci->first);
+			cur = ci->second;
+		}
+		return bool(os);
+	}
+
+	// replace the content with a checkpoint from save(); the nodes are created in
+	// place and the counters and the ordered list are threaded in one pass at the
+	// end, with no descent from the root per key. On a bad stream the trie is
+	// left empty and false is returned
+	bool load(std::istream& is)
+	{
+		typedef detail::trie_stream_codec<key_type> key_codec;
+		typedef detail::trie_stream_codec<value_type> value_codec;
+		typedef detail::trie_stream_codec<boost::uint64_t> size_codec;
+		drop_all();
+		char magic[8];
+		boost::uint64_t version, key_size;
+		if (!is.read(magic, 8) || std::memcmp(magic, stream_magic(), 8) != 0 ||
+				!size_codec::read(is, version) || version != stream_version ||
+				!size_codec::read(is, key_size) || key_size != sizeof(key_type))
+			return false;
+		// node and children still to read
+		std::vector<std::pair<node_ptr, boost::uint64_t> > stk;
+		node_ptr cur = root;
+		bool ok = true;
+		// the values of a node come first to last, and a store takes them at the front
+		std::vector<value_type> node_values;
+		for (;;)
+		{
+			boost::uint64_t values, children;
+			ok = size_codec::read(is, values);
+			// a unique store takes one value per key
+			if (value_store_type::unique && values > 1)
+				ok = false;
+			node_values.clear();
+			for (; ok && values > 0; --values)
+			{
+				value_type v = value_type();
+				ok = value_codec::read(is, v);
+				node_values.push_back(v);
+			}
+			for (size_type i = node_values.size(); ok && i-- > 0; )
+				cur->values.push_front(node_values[i]);
+			value_total += cur->count();
+			ok = ok && size_codec::read(is, children);
+			// a node without values has to lead to some
+			if (!ok || (cur != root && cur->no_value() && children == 0))
+			{
+				ok = false;
+				break;
+			}
+			cur->dirty = true;
+			stk.push_back(std::make_pair(cur, children));
+			while (!stk.empty() && stk.back().second == 0)
+				stk.pop_back();
+			if (stk.empty())
+				break;
+			--stk.back().second;
+			node_ptr p = stk.back().first;
+			key_type k;
+			if (!key_codec::read(is, k) || (!p->child.empty() && !p->child.key_comp()(p->child.rbegin()->first, k)))
+			{
+				ok = false;
+				break;
+			}
+			cur = create_trie_node();
+			// labels come sorted, so the hint makes each insertion constant time
+			set_parent(cur, p, p->child.insert(p->child.end(), std::make_pair(k, cur)));
+		}
+		if (!ok)
+		{
+			// the caches of a partly read trie are not valid, so do not use clear()
+			drop_all();
+			return false;
+		}
+		rebuild_dirty();
+		jump_below_root(false);
+		return true;
 	}
 
 	size_type count_node() const
 	{
+		if (!node_count_valid)
+		{
+			node_count = recount_nodes();
+			node_count_valid = true;
+		}
 		return node_count;
 	}
 
 	size_type size() const
 	{
-		return root->value_count;
+		return value_total;
 	}
 
 	bool empty() const {
-		return root->value_count == 0;
+		return value_total == 0;
 	}
 
 	void destroy()
 	{
-		clear(root);
-		delete_trie_node(root);
+		destroy_subtree(root);
 	}
 
 	~trie()
@@ -1382,6 +2859,23 @@ public:
 };
 
 
+// RAII scope for begin_bulk_update() and end_bulk_update(), works for trie and all the containers
+template <class Container>
+class bulk_update : private boost::noncopyable {
+	Container& c;
+
+public:
+	explicit bulk_update(Container& x) : c(x)
+	{
+		c.begin_bulk_update();
+	}
+
+	~bulk_update()
+	{
+		c.end_bulk_update();
+	}
+};
+
 } // tries
 } // boost
 #endif // BOOST_TRIE_HPP
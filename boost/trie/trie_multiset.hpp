@@ -26,6 +26,7 @@ public:
 	typedef typename trie_type::pair_iterator_bool pair_iterator_bool;
 	typedef typename trie_type::iterator_range iterator_range;
 	typedef size_t size_type;
+	typedef typename trie_type::frozen_type frozen_type;
 
 protected:
 	trie_type t;
@@ -260,6 +261,32 @@ public:
 		return t.erase_prefix(first, last);
 	}
 
+	// erase all keys in [lo, hi)
+	template<typename Container>
+	size_type erase_range(const Container &lo, const Container &hi)
+	{
+		return t.erase_range(lo, hi);
+	}
+
+	template<typename Iter>
+	size_type erase_range(Iter lo_first, Iter lo_last, Iter hi_first, Iter hi_last)
+	{
+		return t.erase_range(lo_first, lo_last, hi_first, hi_last);
+	}
+
+	// move all keys not less than the key into other
+	template<typename Container>
+	void split_at(const Container &container, trie_multiset_type& other)
+	{
+		t.split_at(container, other.t);
+	}
+
+	template<typename Iter>
+	void split_at(Iter first, Iter last, trie_multiset_type& other)
+	{
+		t.split_at(first, last, other.t);
+	}
+
 // count_node() to count trie_node in trie
 	size_type count_node() const
 	{
@@ -277,7 +304,7 @@ public:
 		return t.empty();
 	}
 
-	void swap(const trie_multiset_type& other)
+	void swap(trie_multiset_type& other)
 	{
 		t.swap(other.t);
 	}
@@ -287,6 +314,51 @@ public:
 		t.clear();
 	}
 
+	// an immutable compact copy, boost/trie/frozen_trie.hpp has to be included
+	frozen_type freeze() const
+	{
+		return t.freeze();
+	}
+
+	// replace the content with the keys of a frozen trie
+	void thaw(const frozen_type& f)
+	{
+		f.thaw(t);
+	}
+
+	// see trie::save() and trie::load()
+	bool save(std::ostream& os) const
+	{
+		return t.save(os);
+	}
+
+	bool load(std::istream& is)
+	{
+		return t.load(is);
+	}
+
+	// see trie::begin_bulk_update()
+	void begin_bulk_update()
+	{
+		t.begin_bulk_update();
+	}
+
+	void end_bulk_update()
+	{
+		t.end_bulk_update();
+	}
+
+	// see trie::set_jump_levels()
+	bool set_jump_levels(size_type levels)
+	{
+		return t.set_jump_levels(levels);
+	}
+
+	size_type jump_levels() const
+	{
+		return t.jump_levels();
+	}
+
 	~trie_multiset()
 	{
 	}
@@ -11,14 +11,16 @@
 
 namespace boost { namespace tries {
 
-template<typename Key, class Compare = std::less<Key> >
+// Features as for trie; trie_set<Key, Compare, trie_lookup_only> is a plain
+// membership set with insert(), count(), erase_node() and erase_range()
+template<typename Key, class Compare = std::less<Key>, class Features = trie_features<> >
 class trie_set
 {
 public:
 	typedef Key key_type;
 	typedef boost::blank value_type;
-	typedef trie<key_type, value_type, Compare> trie_type;
-	typedef trie_set<Key, Compare> trie_set_type;
+	typedef trie<key_type, value_type, Compare, detail::unique_value_store<value_type>, Features> trie_type;
+	typedef trie_set<Key, Compare, Features> trie_set_type;
 	typedef typename trie_type::const_iterator iterator;
 	typedef typename trie_type::const_iterator const_iterator;
 	typedef typename trie_type::const_reverse_iterator reverse_iterator;
@@ -27,6 +29,7 @@ public:
 	//the iterator type is different, so the above code does not compile correctly
 	typedef typename trie_type::iterator_range iterator_range;
 	typedef size_t size_type;
+	typedef typename trie_type::frozen_type frozen_type;
 
 protected:
 	trie_type t;
@@ -231,6 +234,19 @@ public:
 		return t.erase(first, last);
 	}
 
+	// erase the key and return how many were erased, with any features
+	template<typename Container>
+	size_type erase_node(const Container &container)
+	{
+		return t.erase_node(container);
+	}
+
+	template<typename Iter>
+	size_type erase_node(Iter first, Iter last)
+	{
+		return t.erase_node(first, last);
+	}
+
 	template<typename Container>
 	size_type erase_prefix(const Container &container)
 	{
@@ -243,6 +259,32 @@ public:
 		return t.erase_prefix(first, last);
 	}
 
+	// erase all keys in [lo, hi)
+	template<typename Container>
+	size_type erase_range(const Container &lo, const Container &hi)
+	{
+		return t.erase_range(lo, hi);
+	}
+
+	template<typename Iter>
+	size_type erase_range(Iter lo_first, Iter lo_last, Iter hi_first, Iter hi_last)
+	{
+		return t.erase_range(lo_first, lo_last, hi_first, hi_last);
+	}
+
+	// move all keys not less than the key into other
+	template<typename Container>
+	void split_at(const Container &container, trie_set_type& other)
+	{
+		t.split_at(container, other.t);
+	}
+
+	template<typename Iter>
+	void split_at(Iter first, Iter last, trie_set_type& other)
+	{
+		t.split_at(first, last, other.t);
+	}
+
 	size_type count_node() const
 	{
 		return t.count_node();
@@ -258,7 +300,7 @@ public:
 		return t.empty();
 	}
 
-	void swap(const trie_set_type& other)
+	void swap(trie_set_type& other)
 	{
 		t.swap(other.t);
 	}
@@ -268,6 +310,51 @@ public:
 		t.clear();
 	}
 
+	// an immutable compact copy, boost/trie/frozen_trie.hpp has to be included
+	frozen_type freeze() const
+	{
+		return t.freeze();
+	}
+
+	// replace the content with the keys of a frozen trie
+	void thaw(const frozen_type& f)
+	{
+		f.thaw(t);
+	}
+
+	// see trie::save() and trie::load()
+	bool save(std::ostream& os) const
+	{
+		return t.save(os);
+	}
+
+	bool load(std::istream& is)
+	{
+		return t.load(is);
+	}
+
+	// see trie::begin_bulk_update()
+	void begin_bulk_update()
+	{
+		t.begin_bulk_update();
+	}
+
+	void end_bulk_update()
+	{
+		t.end_bulk_update();
+	}
+
+	// see trie::set_jump_levels()
+	bool set_jump_levels(size_type levels)
+	{
+		return t.set_jump_levels(levels);
+	}
+
+	size_type jump_levels() const
+	{
+		return t.jump_levels();
+	}
+
 	~trie_set()
 	{
 	}
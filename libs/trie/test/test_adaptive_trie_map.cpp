@@ -0,0 +1,196 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/adaptive_trie_map.hpp"
+// multi include test
+#include "boost/trie/adaptive_trie_map.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::adaptive_trie_map<int> ati;
+typedef std::map<std::string, int> smap;
+
+std::string key_string(const std::vector<char>& k)
+{
+	return std::string(k.begin(), k.end());
+}
+
+template <class Map>
+void check_same(const Map& t, const smap& m)
+{
+	BOOST_REQUIRE(t.size() == m.size());
+	typename Map::const_iterator ti = t.begin();
+	for (smap::const_iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+	{
+		BOOST_REQUIRE(ti != t.end());
+		BOOST_REQUIRE(key_string(ti.get_key()) == mi->first);
+		BOOST_REQUIRE(*ti == mi->second);
+	}
+	BOOST_CHECK(ti == t.end());
+	typename Map::const_reverse_iterator ri = t.rbegin();
+	for (smap::const_reverse_iterator mi = m.rbegin(); mi != m.rend(); ++mi, ++ri)
+	{
+		BOOST_REQUIRE(ri != t.rend());
+		BOOST_REQUIRE(*ri == mi->second);
+	}
+	BOOST_CHECK(ri == t.rend());
+}
+
+BOOST_AUTO_TEST_CASE(insert_and_find_test)
+{
+	ati t;
+	std::string s = "abc", s1 = "abcd", s2 = "abd", s3 = "xyz";
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.insert(s, 1).second);
+	BOOST_CHECK(!t.insert(s, 2).second);
+	t[s1] = 3;
+	t[s2] = 4;
+	BOOST_CHECK(*t.find(s) == 1);
+	BOOST_CHECK(t.find(s3) == t.end());
+	BOOST_CHECK(t.count_node() == 5);
+	BOOST_CHECK(t.count_prefix(std::string("ab")) == 3);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("abcx")) == 1);
+	BOOST_CHECK(key_string(t.begin().get_key()) == s);
+	BOOST_CHECK(key_string((--t.end()).get_key()) == s2);
+	// bytes above 127 come after the others
+	std::string high = "ab\xe9";
+	t[high] = 5;
+	BOOST_CHECK(*--t.end() == 5);
+	BOOST_CHECK(t.erase(s) == 1);
+	BOOST_CHECK(t.size() == 3);
+	t.clear();
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() == 0);
+	BOOST_CHECK(t.insert(s, 1).second);
+}
+
+BOOST_AUTO_TEST_CASE(conversion_test)
+{
+	typedef boost::tries::adaptive_trie_map<int, boost::tries::adaptive_children<1, 4> > map_type;
+	map_type t;
+	smap m;
+	// root always has a table
+	BOOST_CHECK(t.count_kind(boost::tries::dense_children) == 1);
+	std::string k = "ab";
+	t[k] = 0;
+	m[k] = 0;
+	BOOST_CHECK(t.count_kind(boost::tries::single_child) == 1);
+	BOOST_CHECK(t.count_kind(boost::tries::no_children) == 1);
+	// a grows one child at a time: inline, a block of up to 4, a table
+	const std::string more = "zcxdy";
+	for (size_t i = 0; i < more.size(); ++i)
+	{
+		k[1] = more[i];
+		t[k] = int(i + 1);
+		m[k] = int(i + 1);
+		check_same(t, m);
+		if (i < 3)
+			BOOST_CHECK(t.count_kind(boost::tries::small_children) == 1);
+	}
+	BOOST_CHECK(t.count_kind(boost::tries::small_children) == 0);
+	BOOST_CHECK(t.count_kind(boost::tries::dense_children) == 2);
+	BOOST_CHECK(t.count_kind(boost::tries::no_children) == 6);
+
+	// a table shrinks when half of a block is enough
+	const std::string gone = "bzcx";
+	for (size_t i = 0; i < gone.size(); ++i)
+	{
+		k[1] = gone[i];
+		BOOST_CHECK(t.erase(k) == 1);
+		m.erase(k);
+		check_same(t, m);
+		// the fourth erasion leaves two
+		BOOST_CHECK(t.count_kind(boost::tries::dense_children) == (i < 3 ? 2u : 1u));
+	}
+	BOOST_CHECK(t.count_kind(boost::tries::small_children) == 1);
+	BOOST_CHECK(t.erase(std::string("ad")) == 1);
+	BOOST_CHECK(t.count_kind(boost::tries::small_children) == 0);
+	BOOST_CHECK(t.count_kind(boost::tries::single_child) == 1);
+	BOOST_CHECK(*t.find(std::string("ay")) == 5);
+	BOOST_CHECK(t.erase(std::string("ay")) == 1);
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() == 0);
+	BOOST_CHECK(t.count_kind(boost::tries::dense_children) == 1);
+
+	// the first two levels are tables whatever the fanout
+	boost::tries::adaptive_trie_map<int, boost::tries::adaptive_children<2> > d;
+	d[std::string("abc")] = 1;
+	BOOST_CHECK(d.count_kind(boost::tries::dense_children) == 2);
+	BOOST_CHECK(d.count_kind(boost::tries::single_child) == 1);
+	BOOST_CHECK(d.erase(std::string("abc")) == 1);
+	BOOST_CHECK(d.count_kind(boost::tries::dense_children) == 1);
+}
+
+// a wide first level and few children deeper down
+std::string make_key(unsigned r)
+{
+	std::string k;
+	k += char(r % 200 + 30);
+	r /= 200;
+	for (unsigned len = r % 5; len > 0; --len, r /= 3)
+		k += "abcdefghij"[(r >> 2) % (len > 2 ? 10 : 2)];
+	return k;
+}
+
+template <class Map>
+void check_random(unsigned seed)
+{
+	Map t;
+	smap m;
+	for (int i = 0; i < 6000; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		std::string k = make_key(seed >> 3);
+		if ((seed >> 28) < 10)
+		{
+			BOOST_CHECK(t.insert(k, i).second == m.insert(std::make_pair(k, i)).second);
+		}
+		else {
+			BOOST_CHECK(t.erase(k) == m.erase(k));
+		}
+	}
+	check_same(t, m);
+	for (smap::const_iterator i = m.begin(); i != m.end(); ++i)
+		BOOST_REQUIRE(t.find(i->first) != t.end());
+	std::string p(1, char(100));
+	BOOST_CHECK(t.count_prefix(p) == size_t(std::distance(m.lower_bound(p), m.lower_bound(std::string(1, char(101))))));
+
+	// erase by iterator returns the next one
+	for (typename Map::iterator i = t.begin(); i != t.end(); )
+	{
+		if (*i % 3 == 0)
+		{
+			m.erase(key_string(i.get_key()));
+			i = t.erase(i);
+		}
+		else {
+			++i;
+		}
+	}
+	check_same(t, m);
+	Map t2;
+	t2.swap(t);
+	check_same(t2, m);
+	BOOST_CHECK(t.empty());
+}
+
+BOOST_AUTO_TEST_CASE(random_against_map)
+{
+	using boost::tries::adaptive_children;
+	check_random<ati>(5);
+	check_random<boost::tries::adaptive_trie_map<int, adaptive_children<0, 2> > >(6);
+	check_random<boost::tries::adaptive_trie_map<int, adaptive_children<3, 16> > >(7);
+}
+
+BOOST_AUTO_TEST_CASE(node_size)
+{
+	// four indices and four bytes, the children are out of the node
+	BOOST_CHECK(sizeof(ati::node_type) == 5 * sizeof(boost::uint32_t));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,276 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/burst_trie_map.hpp"
+// multi include test
+#include "boost/trie/burst_trie_map.hpp"
+#include "boost/trie/burst_trie_set.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <iostream>
+#include <boost/type_traits/is_same.hpp>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::burst_trie_map<char, int> btci;
+typedef boost::tries::burst_trie_set<char> btsc;
+typedef std::map<std::string, int> smap;
+
+std::string make_key(int i)
+{
+	std::string k;
+	for (int j = i; j > 0; j /= 5)
+		k += char('a' + j % 5);
+	return k;
+}
+
+std::string key_string(const std::vector<char>& k)
+{
+	return std::string(k.begin(), k.end());
+}
+
+void check_same(const btci& t, const smap& m)
+{
+	BOOST_REQUIRE(t.size() == m.size());
+	btci::const_iterator ti = t.begin();
+	for (smap::const_iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+	{
+		BOOST_REQUIRE(ti != t.end());
+		BOOST_REQUIRE(key_string(ti.get_key()) == mi->first);
+		BOOST_REQUIRE(*ti == mi->second);
+	}
+	BOOST_CHECK(ti == t.end());
+	btci::const_reverse_iterator ri = t.rbegin();
+	for (smap::const_reverse_iterator mi = m.rbegin(); mi != m.rend(); ++mi, ++ri)
+	{
+		BOOST_REQUIRE(ri != t.rend());
+		BOOST_REQUIRE(*ri == mi->second);
+	}
+	BOOST_CHECK(ri == t.rend());
+}
+
+template <typename Iter>
+bool is_const_iterator(const Iter&)
+{
+	return boost::is_same<Iter, btci::const_iterator>::value;
+}
+
+BOOST_AUTO_TEST_CASE(insert_and_find_test)
+{
+	btci t;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab", s3 = "bbb";
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.begin() == t.end());
+	BOOST_CHECK(t.insert(s, 1).second);
+	BOOST_CHECK(!t.insert(s, 2).second);
+	BOOST_CHECK(*t.find(s) == 1);
+	t[s] = 2;
+	BOOST_CHECK(*t.find(s) == 2);
+	t[s1] = 3;
+	t[s2] = 4;
+	t[std::string()] = 5;
+	BOOST_CHECK(t.find(s3) == t.end());
+	BOOST_CHECK(t.count(s1) == 1);
+	BOOST_CHECK(t.size() == 4);
+	BOOST_CHECK(t.count_prefix(std::string("aa")) == 3);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("aaab")) == 2);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("b")) == 5);
+	// no bucket burst yet
+	BOOST_CHECK(t.count_node() == 0);
+	BOOST_CHECK(t.erase(s3) == 0);
+	BOOST_CHECK(t.erase(s1) == 1);
+	BOOST_CHECK(t.erase(s1) == 0);
+	BOOST_CHECK(t.size() == 3);
+	t.clear();
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.begin() == t.end());
+}
+
+BOOST_AUTO_TEST_CASE(burst_test)
+{
+	for (size_t threshold = 1; threshold <= 64; threshold *= 4)
+	{
+		btci t(threshold);
+		smap m;
+		for (int i = 0; i < 3000; ++i)
+		{
+			int k = i * 7919 % 3001;
+			BOOST_REQUIRE(t.insert(make_key(k), i).second == m.insert(std::make_pair(make_key(k), i)).second);
+		}
+		BOOST_CHECK(t.count_node() > 0);
+		BOOST_CHECK(t.count_bucket() > 0);
+		check_same(t, m);
+
+		for (int i = 0; i < 3001; i += 13)
+		{
+			std::string k = make_key(i);
+			BOOST_REQUIRE(t.count(k) == m.count(k));
+			smap::iterator lb = m.lower_bound(k), ub = m.upper_bound(k);
+			if (lb == m.end())
+				BOOST_REQUIRE(t.lower_bound(k) == t.end());
+			else
+				BOOST_REQUIRE(key_string(t.lower_bound(k).get_key()) == lb->first);
+			if (ub == m.end())
+				BOOST_REQUIRE(t.upper_bound(k) == t.end());
+			else
+				BOOST_REQUIRE(key_string(t.upper_bound(k).get_key()) == ub->first);
+			size_t n = 0;
+			for (smap::iterator j = lb; j != m.end() && j->first.compare(0, k.size(), k) == 0; ++j)
+				++n;
+			BOOST_REQUIRE(t.count_prefix(k) == n);
+			btci::iterator_range r = t.find_prefix(k);
+			BOOST_REQUIRE(size_t(std::distance(r.first, r.second)) == n);
+			if (n > 0)
+				BOOST_REQUIRE(*r.first == lb->second);
+		}
+		BOOST_CHECK(t.lower_bound(std::string("f")) == t.end());
+
+		// erase every third key by key, then walk and erase by iterator
+		for (int i = 0; i < 3001; i += 3)
+			BOOST_REQUIRE(t.erase(make_key(i)) == m.erase(make_key(i)));
+		check_same(t, m);
+		btci copy(t);
+		for (btci::iterator it = t.begin(); it != t.end(); )
+		{
+			std::string k = key_string(it.get_key());
+			if (k.size() % 2 == 0)
+			{
+				it = t.erase(it);
+				m.erase(k);
+			}
+			else {
+				++it;
+			}
+		}
+		check_same(t, m);
+		BOOST_CHECK(copy.size() > t.size());
+		for (smap::iterator i = m.begin(); i != m.end(); ++i)
+			BOOST_REQUIRE(t.erase(i->first) == 1);
+		BOOST_CHECK(t.empty());
+		BOOST_CHECK(t.count_node() == 0);
+		BOOST_CHECK(t.begin() == t.end());
+
+		t.swap(copy);
+		BOOST_CHECK(copy.empty());
+		BOOST_CHECK(!t.empty());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(tail_test)
+{
+	btci t(btci::trie_type::tail_threshold);
+	std::string s = "abcdef", s1 = "abcxyz", s2 = "abc";
+	t[s] = 1;
+	// one key is one tail in the root bucket
+	BOOST_CHECK(t.count_node() == 0);
+	t[s1] = 2;
+	// split where the keys diverge: a, b, c, then d and x
+	BOOST_CHECK(t.count_node() == 5);
+	BOOST_CHECK(t.count_bucket() == 2);
+	t[s2] = 3;
+	BOOST_CHECK(t.count_node() == 5);
+	BOOST_CHECK(*t.find(s2) == 3);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("abcdefg")) == 1);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("abcdxx")) == 3);
+	BOOST_CHECK(t.count_prefix(std::string("abcd")) == 1);
+	BOOST_CHECK(t.count_prefix(std::string("abcq")) == 0);
+	btci::iterator it = t.begin();
+	BOOST_CHECK(*it == 3);
+	// erasing merges what is left back into one tail
+	it = t.erase(it);
+	BOOST_CHECK(*it == 1);
+	BOOST_CHECK(t.count_node() == 5);
+	it = t.erase(it);
+	BOOST_CHECK(*it == 2);
+	BOOST_CHECK(key_string(it.get_key()) == s1);
+	BOOST_CHECK(t.count_node() == 0);
+	BOOST_CHECK(t.count_bucket() == 1);
+	t.erase(it);
+	BOOST_CHECK(t.empty());
+
+	smap m;
+	for (int i = 0; i < 2000; ++i)
+	{
+		t[make_key(i * 37 % 1999)] = i;
+		m[make_key(i * 37 % 1999)] = i;
+	}
+	t.erase(std::string());
+	m.erase(std::string());
+	check_same(t, m);
+	for (int i = 0; i < 1999; i += 2)
+		BOOST_REQUIRE(t.erase(make_key(i)) == m.erase(make_key(i)));
+	check_same(t, m);
+}
+
+BOOST_AUTO_TEST_CASE(const_test)
+{
+	btci t(8);
+	smap m;
+	// inserts and erases between the ordered reads keep each bucket in order
+	for (int i = 0; i < 600; ++i)
+	{
+		std::string k = make_key(i * 37 % 599);
+		t[k] = i;
+		m[k] = i;
+		if (i % 7 == 0)
+		{
+			std::string e = make_key(i * 13 % 599);
+			BOOST_REQUIRE(t.erase(e) == m.erase(e));
+		}
+		if (i % 50 == 0)
+			check_same(t, m);
+	}
+	check_same(t, m);
+
+	const btci& c = t;
+	std::string k = m.begin()->first;
+	BOOST_CHECK(is_const_iterator(c.find(k)));
+	BOOST_CHECK(is_const_iterator(c.lower_bound(k)));
+	BOOST_CHECK(is_const_iterator(c.findLongestPrefixOfKey(k)));
+	BOOST_CHECK(!is_const_iterator(t.find(k)));
+	btci::const_iterator ci = c.find(k);
+	BOOST_REQUIRE(ci != c.end());
+	BOOST_CHECK(*ci == m.begin()->second);
+	btci::const_iterator_range r = c.find_prefix(std::string("a"));
+	size_t n = 0;
+	for (; r.first != r.second; ++r.first)
+		++n;
+	BOOST_CHECK(n == t.count_prefix(std::string("a")));
+	BOOST_CHECK(c.lower_bound(k) == ci);
+	BOOST_CHECK(c.upper_bound(k) == ++c.find(k));
+	BOOST_CHECK(c.findLongestPrefixOfKey(k + "zz") == ci);
+	// the non-const overloads still give mutable iterators
+	*t.find(k) = -1;
+	BOOST_CHECK(*c.find(k) == -1);
+}
+
+BOOST_AUTO_TEST_CASE(set_test)
+{
+	btsc t(4);
+	std::set<std::string> s;
+	for (int i = 0; i < 500; ++i)
+	{
+		std::string k = make_key(i * 31 % 499);
+		BOOST_REQUIRE(t.insert(k).second == s.insert(k).second);
+	}
+	BOOST_REQUIRE(t.size() == s.size());
+	btsc::iterator ti = t.begin();
+	for (std::set<std::string>::iterator si = s.begin(); si != s.end(); ++si, ++ti)
+		BOOST_REQUIRE(key_string(ti.get_key()) == *si);
+	btsc::reverse_iterator ri = t.rbegin();
+	BOOST_CHECK(key_string(ri.get_key()) == *s.rbegin());
+	btsc::iterator last = t.end();
+	--last;
+	BOOST_CHECK(key_string(last.get_key()) == *s.rbegin());
+	BOOST_CHECK(t.count(std::string("ab")) == s.count("ab"));
+	btsc other(t);
+	BOOST_CHECK(other.size() == t.size());
+	other.clear();
+	BOOST_CHECK(other.empty());
+	other = t;
+	BOOST_CHECK(other.size() == t.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,226 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/compact_trie_map.hpp"
+// multi include test
+#include "boost/trie/compact_trie_map.hpp"
+#include "boost/trie/trie_map.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::compact_trie_map<char, int> cti;
+typedef std::map<std::string, int> smap;
+
+std::string make_key(int i)
+{
+	std::string k;
+	for (int j = i; j > 0; j /= 7)
+		k += char('a' + j % 7);
+	return k;
+}
+
+std::string key_string(const std::vector<char>& k)
+{
+	return std::string(k.begin(), k.end());
+}
+
+void check_same(const cti& t, const smap& m)
+{
+	BOOST_REQUIRE(t.size() == m.size());
+	cti::const_iterator ti = t.begin();
+	for (smap::const_iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+	{
+		BOOST_REQUIRE(ti != t.end());
+		BOOST_REQUIRE(key_string(ti.get_key()) == mi->first);
+		BOOST_REQUIRE(*ti == mi->second);
+	}
+	BOOST_CHECK(ti == t.end());
+	cti::const_reverse_iterator ri = t.rbegin();
+	for (smap::const_reverse_iterator mi = m.rbegin(); mi != m.rend(); ++mi, ++ri)
+	{
+		BOOST_REQUIRE(ri != t.rend());
+		BOOST_REQUIRE(*ri == mi->second);
+	}
+	BOOST_CHECK(ri == t.rend());
+}
+
+BOOST_AUTO_TEST_CASE(insert_and_find_test)
+{
+	cti t;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab", s3 = "bbb";
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.begin() == t.end());
+	BOOST_CHECK(t.insert(s, 1).second);
+	BOOST_CHECK(!t.insert(s, 2).second);
+	BOOST_CHECK(*t.find(s) == 1);
+	t[s] = 2;
+	t[s1] = 3;
+	t[s2] = 4;
+	BOOST_CHECK(t.find(s3) == t.end());
+	BOOST_CHECK(t.find(std::string("aa")) == t.end());
+	BOOST_CHECK(t.count(s1) == 1);
+	BOOST_CHECK(t.size() == 3);
+	BOOST_CHECK(t.count_node() == 5);
+	BOOST_CHECK(t.count_prefix(std::string("aa")) == 3);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("aaab")) == 2);
+	BOOST_CHECK(t.findLongestPrefixOfKey(std::string("b")) == t.end());
+	// the empty key is the first one
+	t[std::string()] = 5;
+	BOOST_CHECK(*t.begin() == 5);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("b")) == 5);
+	BOOST_CHECK(*--t.end() == 4);
+	BOOST_CHECK(t.erase(s3) == 0);
+	BOOST_CHECK(t.erase(s1) == 1);
+	BOOST_CHECK(t.count_node() == 4);
+	BOOST_CHECK(t.erase(std::string()) == 1);
+	BOOST_CHECK(*t.begin() == 2);
+	t.clear();
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() == 0);
+	BOOST_CHECK(t.begin() == t.end());
+}
+
+BOOST_AUTO_TEST_CASE(compare_with_map_test)
+{
+	cti t;
+	smap m;
+	for (int i = 0; i < 5000; ++i)
+	{
+		int k = i * 7919 % 5003;
+		BOOST_REQUIRE(t.insert(make_key(k), i).second == m.insert(std::make_pair(make_key(k), i)).second);
+	}
+	check_same(t, m);
+	for (int i = 0; i < 5003; i += 11)
+	{
+		std::string k = make_key(i);
+		smap::iterator lb = m.lower_bound(k);
+		size_t n = 0;
+		for (smap::iterator j = lb; j != m.end() && j->first.compare(0, k.size(), k) == 0; ++j)
+			++n;
+		BOOST_REQUIRE(t.count_prefix(k) == n);
+		cti::iterator_range r = t.find_prefix(k);
+		BOOST_REQUIRE(size_t(std::distance(r.first, r.second)) == n);
+		if (n > 0)
+			BOOST_REQUIRE(*r.first == lb->second);
+		// the same through a const map
+		const cti& ct = t;
+		cti::const_iterator_range cr = ct.find_prefix(k);
+		BOOST_REQUIRE(cr.first == r.first && cr.second == r.second);
+		BOOST_REQUIRE(ct.findLongestPrefixOfKey(k + "x") == t.findLongestPrefixOfKey(k + "x"));
+	}
+
+	// iterators are indices, inserting does not move them
+	cti::iterator it = t.find(make_key(10));
+	for (int i = 5003; i < 6000; ++i)
+	{
+		t[make_key(i)] = i;
+		m[make_key(i)] = i;
+	}
+	BOOST_CHECK(*it == m[make_key(10)]);
+
+	for (int i = 0; i < 6000; i += 3)
+		BOOST_REQUIRE(t.erase(make_key(i)) == m.erase(make_key(i)));
+	check_same(t, m);
+	cti copy(t);
+	for (cti::iterator i = t.begin(); i != t.end(); )
+	{
+		std::string k = key_string(i.get_key());
+		if (k.size() % 2 == 0)
+		{
+			i = t.erase(i);
+			m.erase(k);
+		}
+		else {
+			++i;
+		}
+	}
+	check_same(t, m);
+	BOOST_CHECK(copy.size() > t.size());
+	size_t nodes = t.count_node();
+	// the freed nodes and values are used again
+	for (smap::iterator i = m.begin(); i != m.end(); ++i)
+		BOOST_REQUIRE(t.erase(i->first) == 1);
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() == 0);
+	for (smap::iterator i = m.begin(); i != m.end(); ++i)
+		t[i->first] = i->second;
+	BOOST_CHECK(t.count_node() == nodes);
+	check_same(t, m);
+	t.swap(copy);
+	BOOST_CHECK(copy.size() == m.size());
+}
+
+BOOST_AUTO_TEST_CASE(wide_node_test)
+{
+	// every ASCII byte under the root and under one child, so the child
+	// blocks move up through the sizes and back down on erase
+	cti t;
+	smap m;
+	for (int i = 0; i < 128; ++i)
+	{
+		int c = (i * 97) % 128;
+		std::string k(1, char(c));
+		t[k] = c;
+		m[k] = c;
+		k = std::string("a") + char(c);
+		t[k] = -c;
+		m[k] = -c;
+		if (i % 37 == 0)
+			check_same(t, m);
+	}
+	check_same(t, m);
+	for (int i = 0; i < 128; ++i)
+	{
+		BOOST_REQUIRE(*t.find(std::string(1, char(i))) == i);
+		BOOST_REQUIRE(*t.find(std::string("a") + char(i)) == -i);
+	}
+	for (int i = 0; i < 128; i += 3)
+	{
+		std::string k = std::string("a") + char(i);
+		BOOST_REQUIRE(t.erase(k) == 1);
+		m.erase(k);
+		if (i != 'a')
+		{
+			BOOST_REQUIRE(t.erase(std::string(1, char(i))) == 1);
+			m.erase(std::string(1, char(i)));
+		}
+	}
+	check_same(t, m);
+	for (int i = 0; i < 128; ++i)
+	{
+		std::string k = std::string("a") + char(i);
+		t.erase(k);
+		m.erase(k);
+	}
+	check_same(t, m);
+	BOOST_CHECK(t.count_prefix(std::string("a")) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(index_width_test)
+{
+	// a node is far smaller than a trie_map node and its std::map entry
+	BOOST_CHECK(sizeof(cti::node_type) * 2 < sizeof(boost::tries::trie_map<char, int>::trie_type::node_type));
+	typedef boost::tries::compact_trie_map<char, int, std::less<char>, boost::uint8_t> tiny;
+	BOOST_CHECK(tiny::max_node_count() == 254);
+	tiny t;
+	std::string k(200, 'a');
+	BOOST_CHECK(t.insert(k, 1).second);
+	// 60 more nodes do not fit
+	std::string k2 = std::string(140, 'a') + std::string(60, 'b');
+	BOOST_CHECK(t.insert(k2, 2).first == t.end());
+	BOOST_CHECK(t.count_node() == 200);
+	BOOST_CHECK(t.count(k2) == 0);
+	k2 = std::string(150, 'a') + std::string(50, 'b');
+	BOOST_CHECK(t.insert(k2, 2).second);
+	BOOST_CHECK(t.count_node() == 250);
+	BOOST_CHECK(t.erase(k) == 1);
+	BOOST_CHECK(t.count_node() == 200);
+	BOOST_CHECK(*t.begin() == 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
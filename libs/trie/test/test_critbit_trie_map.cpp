@@ -0,0 +1,213 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/critbit_trie_map.hpp"
+// multi include test
+#include "boost/trie/critbit_trie_map.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::critbit_trie_map<int> cti;
+typedef std::map<std::string, int> smap;
+
+std::string key_string(const std::vector<char>& k)
+{
+	return std::string(k.begin(), k.end());
+}
+
+void check_same(const cti& t, const smap& m)
+{
+	BOOST_REQUIRE(t.size() == m.size());
+	BOOST_CHECK(t.count_node() == (m.empty() ? 0 : 2 * m.size() - 1));
+	cti::const_iterator ti = t.begin();
+	for (smap::const_iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+	{
+		BOOST_REQUIRE(ti != t.end());
+		BOOST_REQUIRE(key_string(ti.get_key()) == mi->first);
+		BOOST_REQUIRE(*ti == mi->second);
+	}
+	BOOST_CHECK(ti == t.end());
+	cti::const_reverse_iterator ri = t.rbegin();
+	for (smap::const_reverse_iterator mi = m.rbegin(); mi != m.rend(); ++mi, ++ri)
+	{
+		BOOST_REQUIRE(ri != t.rend());
+		BOOST_REQUIRE(*ri == mi->second);
+	}
+	BOOST_CHECK(ri == t.rend());
+}
+
+BOOST_AUTO_TEST_CASE(insert_and_find_test)
+{
+	cti t;
+	std::string s = "/usr/share/doc", s1 = "/usr/share/doc/boost", s2 = "/usr/lib", s3 = "/usr";
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.find(s) == t.end());
+	BOOST_CHECK(t.insert(s, 1).second);
+	BOOST_CHECK(!t.insert(s, 2).second);
+	t[s1] = 3;
+	t[s2] = 4;
+	BOOST_CHECK(*t.find(s) == 1);
+	BOOST_CHECK(t.find(s3) == t.end());
+	BOOST_CHECK(t.count(s1) == 1);
+	// two nodes for each key after the first, whatever the length
+	BOOST_CHECK(t.count_node() == 5);
+	BOOST_CHECK(t.count_prefix(std::string("/usr/")) == 3);
+	BOOST_CHECK(t.count_prefix(std::string("/usr/share")) == 2);
+	BOOST_CHECK(t.count_prefix(std::string("/usr/x")) == 0);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("/usr/share/doc/x")) == 1);
+	BOOST_CHECK(t.findLongestPrefixOfKey(std::string("/usr/share/do")) == t.end());
+	BOOST_CHECK(key_string(t.begin().get_key()) == s2);
+	BOOST_CHECK(key_string((--t.end()).get_key()) == s1);
+	std::vector<char> v(s2.begin(), s2.end());
+	BOOST_CHECK(*t.find(v) == 4);
+	BOOST_CHECK(*t.find(v.begin(), v.end()) == 4);
+
+	// bytes above 127 come after the others, and '\0' first
+	std::string high = "/usr/\xe9", zero("/usr/\0", 6);
+	t[high] = 5;
+	t[zero] = 6;
+	BOOST_CHECK(*--t.end() == 5);
+	BOOST_CHECK(*t.begin() == 6);
+	BOOST_CHECK(t.erase(s) == 1);
+	BOOST_CHECK(t.erase(s) == 0);
+	BOOST_CHECK(t.size() == 4);
+	t.clear();
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() == 0);
+	BOOST_CHECK(t.insert(s, 1).second);
+}
+
+BOOST_AUTO_TEST_CASE(empty_key_test)
+{
+	cti t;
+	smap m;
+	t[std::string()] = 1;
+	m[std::string()] = 1;
+	check_same(t, m);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("abc")) == 1);
+	t[std::string("a")] = 2;
+	m[std::string("a")] = 2;
+	t[std::string("ab")] = 3;
+	m[std::string("ab")] = 3;
+	check_same(t, m);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("b")) == 1);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("abc")) == 3);
+	BOOST_CHECK(t.count_prefix(std::string()) == 3);
+	cti::iterator_range r = t.find_prefix(std::string("a"));
+	BOOST_CHECK(std::distance(r.first, r.second) == 2);
+	BOOST_CHECK(t.erase(std::string()) == 1);
+	m.erase(std::string());
+	check_same(t, m);
+	BOOST_CHECK(t.findLongestPrefixOfKey(std::string("b")) == t.end());
+}
+
+// paths of a few levels out of a small vocabulary, and some odd bytes
+std::string make_key(unsigned r)
+{
+	static const char * const parts[] = { "usr", "lib", "share", "doc", "a", "", "x\0y", "\xff" };
+	std::string k;
+	for (unsigned len = r % 5; len > 0; --len, r /= 8)
+	{
+		k += '/';
+		const char *p = parts[(r >> 3) % 8];
+		k.append(p, (r >> 3) % 8 == 6 ? 3 : std::char_traits<char>::length(p));
+	}
+	return k;
+}
+
+BOOST_AUTO_TEST_CASE(random_against_map)
+{
+	unsigned seed = 11;
+	cti t;
+	smap m;
+	for (int i = 0; i < 6000; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		std::string k = make_key(seed >> 3);
+		if ((seed >> 28) < 10)
+		{
+			BOOST_CHECK(t.insert(k, i).second == m.insert(std::make_pair(k, i)).second);
+		}
+		else {
+			BOOST_CHECK(t.erase(k) == m.erase(k));
+		}
+	}
+	check_same(t, m);
+
+	for (int i = 0; i < 500; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		std::string k = make_key(seed >> 3);
+		k.resize(k.size() - (seed >> 5) % (k.size() + 1));
+		smap::const_iterator f = m.find(k);
+		BOOST_CHECK(t.count(k) == (f == m.end() ? 0u : 1u));
+		// the prefix range
+		smap::const_iterator lo = m.lower_bound(k), hi = lo;
+		while (hi != m.end() && hi->first.compare(0, k.size(), k) == 0)
+			++hi;
+		BOOST_CHECK(t.count_prefix(k) == size_t(std::distance(lo, hi)));
+		cti::iterator_range r = t.find_prefix(k);
+		BOOST_CHECK(std::distance(r.first, r.second) == std::distance(lo, hi));
+		if (lo != hi)
+			BOOST_CHECK(key_string(r.first.get_key()) == lo->first);
+		// the longest key that is a prefix
+		const std::string *longest = 0;
+		for (size_t len = 0; len <= k.size(); ++len)
+		{
+			smap::const_iterator p = m.find(k.substr(0, len));
+			if (p != m.end())
+				longest = &p->first;
+		}
+		cti::iterator l = t.findLongestPrefixOfKey(k);
+		if (longest == 0)
+			BOOST_CHECK(l == t.end());
+		else
+			BOOST_CHECK(l != t.end() && key_string(l.get_key()) == *longest);
+	}
+
+	// erase by iterator returns the next one
+	for (cti::iterator i = t.begin(); i != t.end(); )
+	{
+		if (*i % 3 == 0)
+		{
+			m.erase(key_string(i.get_key()));
+			i = t.erase(i);
+		}
+		else {
+			++i;
+		}
+	}
+	check_same(t, m);
+	cti t2;
+	t2.swap(t);
+	check_same(t2, m);
+	BOOST_CHECK(t.empty());
+	// the freed nodes and slots are used again
+	size_t nodes = t2.count_node();
+	for (smap::const_iterator i = m.begin(); i != m.end(); ++i)
+		BOOST_CHECK(t2.erase(i->first) == 1);
+	for (smap::const_iterator i = m.begin(); i != m.end(); ++i)
+		BOOST_CHECK(t2.insert(i->first, i->second).second);
+	BOOST_CHECK(t2.count_node() == nodes);
+	check_same(t2, m);
+}
+
+BOOST_AUTO_TEST_CASE(full_arena)
+{
+	// 255 is none, so 254 nodes and 127 keys
+	boost::tries::critbit_trie_map<int, unsigned char> t;
+	int i = 0;
+	for (; t.insert(std::string(1, char(i)) + "long/path/segment", i).second; ++i)
+		;
+	BOOST_CHECK(i == 127);
+	BOOST_CHECK(t.count_node() == 253);
+	BOOST_CHECK(t.insert(std::string(1, char(i)) + "long/path/segment", i).first == t.end());
+	BOOST_CHECK(*t.find(std::string(1, char(5)) + "long/path/segment") == 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,261 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/ctrie_map.hpp"
+// multi include test
+#include "boost/trie/ctrie_map.hpp"
+#include <boost/thread.hpp>
+
+#include <string>
+#include <vector>
+#include <set>
+#include <sstream>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::ctrie_map<char, int> cmci;
+
+// forces every key into the same bucket
+struct bad_hash {
+	size_t operator()(char) const
+	{
+		return 0;
+	}
+};
+
+typedef boost::tries::ctrie_map<char, int, bad_hash> cmci_collide;
+
+std::string make_key(int i)
+{
+	std::ostringstream os;
+	os << "key" << i;
+	return os.str();
+}
+
+BOOST_AUTO_TEST_CASE(insert_and_find_test)
+{
+	cmci t;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab", s3 = "bbb";
+	int v = 0;
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.insert(s, 1) == true);
+	BOOST_CHECK(t.insert(s, 2) == false);
+	BOOST_CHECK(t.find(s, v) && v == 1);
+	BOOST_CHECK(t.insert_or_assign(s, 2) == false);
+	BOOST_CHECK(t.find(s, v) && v == 2);
+	BOOST_CHECK(t.insert_or_assign(s1, 3) == true);
+	BOOST_CHECK(t.insert(s2, 4) == true);
+	BOOST_CHECK(t.find(s3, v) == false);
+	BOOST_CHECK(t.count(s1) == 1);
+	BOOST_CHECK(t.count(s3) == 0);
+	BOOST_CHECK(t.size() == 3);
+	BOOST_CHECK(t.erase(s3) == 0);
+	BOOST_CHECK(t.erase(s1) == 1);
+	BOOST_CHECK(t.erase(s1) == 0);
+	BOOST_CHECK(t.size() == 2);
+	t.clear();
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count(s) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(many_keys_test)
+{
+	cmci t;
+	for (int i = 0; i < 5000; ++i)
+		BOOST_REQUIRE(t.insert(make_key(i), i));
+	BOOST_CHECK(t.size() == 5000);
+	for (int i = 0; i < 5000; i += 2)
+		BOOST_REQUIRE(t.erase(make_key(i)) == 1);
+	BOOST_CHECK(t.size() == 2500);
+	for (int i = 0; i < 5000; ++i)
+	{
+		int v = -1;
+		BOOST_REQUIRE(t.find(make_key(i), v) == (i % 2 == 1));
+		if (i % 2 == 1)
+			BOOST_REQUIRE(v == i);
+	}
+	for (int i = 1; i < 5000; i += 2)
+		BOOST_REQUIRE(t.erase(make_key(i)) == 1);
+	BOOST_CHECK(t.empty());
+}
+
+BOOST_AUTO_TEST_CASE(hash_collision_test)
+{
+	cmci_collide t;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab";
+	BOOST_CHECK(t.insert(s, 1));
+	BOOST_CHECK(t.insert(s1, 2));
+	BOOST_CHECK(t.insert(s2, 3));
+	BOOST_CHECK(t.size() == 3);
+	int v = 0;
+	BOOST_CHECK(t.find(s1, v) && v == 2);
+	BOOST_CHECK(t.insert_or_assign(s1, 20) == false);
+	BOOST_CHECK(t.find(s1, v) && v == 20);
+	BOOST_CHECK(t.erase(s) == 1);
+	BOOST_CHECK(t.erase(s2) == 1);
+	BOOST_CHECK(t.find(s1, v) && v == 20);
+	BOOST_CHECK(t.size() == 1);
+}
+
+BOOST_AUTO_TEST_CASE(iterator_test)
+{
+	cmci t;
+	std::set<std::string> keys;
+	for (int i = 0; i < 100; ++i)
+	{
+		t.insert(make_key(i), i);
+		keys.insert(make_key(i));
+	}
+	int sum = 0;
+	std::set<std::string> seen;
+	for (cmci::const_iterator i = t.begin(); i != t.end(); ++i)
+	{
+		std::vector<char> k = i.get_key();
+		seen.insert(std::string(k.begin(), k.end()));
+		sum += *i;
+	}
+	BOOST_CHECK(seen == keys);
+	BOOST_CHECK(sum == 99 * 100 / 2);
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_test)
+{
+	cmci t;
+	for (int i = 0; i < 100; ++i)
+		t.insert(make_key(i), i);
+	cmci snap = t.snapshot();
+	cmci ro = t.read_only_snapshot();
+	BOOST_CHECK(!snap.is_read_only());
+	BOOST_CHECK(ro.is_read_only());
+	for (int i = 0; i < 100; ++i)
+		t.erase(make_key(i));
+	t.insert(std::string("new"), 1000);
+	BOOST_CHECK(t.size() == 1);
+	BOOST_CHECK(snap.size() == 100);
+	BOOST_CHECK(ro.size() == 100);
+
+	// the writable snapshot diverges from the original
+	snap.insert_or_assign(make_key(1), -1);
+	int v = 0;
+	BOOST_CHECK(snap.find(make_key(1), v) && v == -1);
+	BOOST_CHECK(ro.find(make_key(1), v) && v == 1);
+	BOOST_CHECK(t.find(make_key(1), v) == false);
+
+	// read-only snapshots reject writes
+	BOOST_CHECK(ro.insert(std::string("x"), 1) == false);
+	BOOST_CHECK(ro.erase(make_key(2)) == 0);
+	BOOST_CHECK(ro.size() == 100);
+
+	// copies are snapshots too
+	cmci c(t);
+	c.insert(std::string("copy"), 1);
+	BOOST_CHECK(c.size() == 2);
+	BOOST_CHECK(t.size() == 1);
+}
+
+struct writer {
+	cmci *t;
+	int base, n;
+	void operator()() const
+	{
+		for (int i = base; i < base + n; ++i)
+			t->insert(make_key(i), i);
+		for (int i = base; i < base + n; i += 2)
+			t->erase(make_key(i));
+	}
+};
+
+BOOST_AUTO_TEST_CASE(concurrent_test)
+{
+	cmci t;
+	const int threads = 4, n = 2000;
+	boost::thread_group g;
+	for (int i = 0; i < threads; ++i)
+	{
+		writer w = { &t, i * n, n };
+		g.create_thread(w);
+	}
+	// snapshots taken while the writers run must stay consistent
+	for (int k = 0; k < 20; ++k)
+	{
+		cmci ro = t.read_only_snapshot();
+		size_t cnt = ro.size();
+		BOOST_CHECK(ro.size() == cnt);
+	}
+	g.join_all();
+	BOOST_CHECK(t.size() == threads * n / 2);
+	for (int i = 0; i < threads * n; ++i)
+		BOOST_REQUIRE(t.count(make_key(i)) == size_t(i % 2));
+}
+
+BOOST_AUTO_TEST_CASE(overwrite_memory_test)
+{
+	// replaced nodes are freed, so the node count stays near what the keys
+	// need however often they are overwritten, queried and snapshotted
+	cmci t;
+	for (int i = 0; i < 1000; ++i)
+		t.insert(make_key(i), i);
+	size_t base = t.count_node();
+	size_t peak = base;
+	for (int k = 0; k < 200000; ++k)
+	{
+		t.insert_or_assign(make_key(k % 1000), k);
+		if (k % 1000 == 0)
+		{
+			BOOST_REQUIRE(!t.empty());
+			BOOST_REQUIRE(t.size() == 1000);
+			BOOST_REQUIRE(t.begin() != t.end());
+		}
+		if (t.count_node() > peak)
+			peak = t.count_node();
+	}
+	BOOST_CHECK(peak < base * 3 + 100);
+	int v = 0;
+	BOOST_CHECK(t.find(make_key(999), v) && v == 199999);
+
+	// a live snapshot keeps its nodes, they go with it
+	cmci ro = t.read_only_snapshot();
+	for (int k = 0; k < 1000; ++k)
+		t.insert_or_assign(make_key(k), -k);
+	BOOST_CHECK(ro.find(make_key(5), v) && v == 199005);
+	ro = cmci();
+	for (int k = 0; k < 1000; ++k)
+		t.erase(make_key(k));
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() < 100);
+}
+
+struct overwriter {
+	cmci *t;
+	int seed, n;
+	void operator()() const
+	{
+		for (int i = 0; i < n; ++i)
+			t->insert_or_assign(make_key((i * 7 + seed) % 500), i);
+	}
+};
+
+BOOST_AUTO_TEST_CASE(concurrent_overwrite_test)
+{
+	cmci t;
+	for (int i = 0; i < 500; ++i)
+		t.insert(make_key(i), i);
+	size_t base = t.count_node();
+	const int threads = 4, n = 50000;
+	boost::thread_group g;
+	for (int i = 0; i < threads; ++i)
+	{
+		overwriter w = { &t, i, n };
+		g.create_thread(w);
+	}
+	for (int k = 0; k < 200; ++k)
+		BOOST_REQUIRE(t.size() == 500);
+	g.join_all();
+	BOOST_CHECK(t.size() == 500);
+	// what the writers retired last is freed by the next operations
+	for (int i = 0; i < 10; ++i)
+		t.count(make_key(i));
+	BOOST_CHECK(t.count_node() < base * 3 + 100);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
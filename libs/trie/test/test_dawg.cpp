@@ -0,0 +1,146 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/dawg.hpp"
+// multi include test
+#include "boost/trie/dawg.hpp"
+#include "boost/trie/trie_set.hpp"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::dawg<char> dc;
+typedef boost::tries::dawg_builder<char> dbc;
+
+std::string key_string(const std::vector<char>& k)
+{
+	return std::string(k.begin(), k.end());
+}
+
+// words sharing a few stems and many suffixes
+std::set<std::string> make_words()
+{
+	const char *stems[] = { "walk", "talk", "jump", "play", "work", "look", "call", "help" };
+	const char *ends[] = { "", "s", "ed", "ing", "er", "ers" };
+	std::set<std::string> ret;
+	for (size_t i = 0; i < sizeof(stems) / sizeof(stems[0]); ++i)
+		for (size_t j = 0; j < sizeof(ends) / sizeof(ends[0]); ++j)
+			ret.insert(std::string(stems[i]) + ends[j]);
+	return ret;
+}
+
+BOOST_AUTO_TEST_CASE(build_test)
+{
+	std::set<std::string> words = make_words();
+	dbc b;
+	for (std::set<std::string>::iterator i = words.begin(); i != words.end(); ++i)
+		BOOST_REQUIRE(b.add(*i));
+	// a duplicate is ignored, a smaller key refused
+	BOOST_CHECK(b.add(*words.rbegin()));
+	BOOST_CHECK(!b.add(std::string("a")));
+	BOOST_CHECK(b.size() == words.size());
+	dc d;
+	b.build(d);
+	BOOST_CHECK(b.size() == 0);
+	BOOST_REQUIRE(d.size() == words.size());
+
+	boost::tries::trie_set<char> t;
+	for (std::set<std::string>::iterator i = words.begin(); i != words.end(); ++i)
+		t.insert(*i);
+	// the endings are shared by every stem
+	BOOST_CHECK(d.count_node() * 3 < t.count_node());
+
+	dc::iterator di = d.begin();
+	size_t n = 0;
+	for (std::set<std::string>::iterator i = words.begin(); i != words.end(); ++i, ++di, ++n)
+	{
+		BOOST_REQUIRE(di != d.end());
+		BOOST_REQUIRE(key_string(di.get_key()) == *i);
+		BOOST_REQUIRE(d.count(*i) == 1);
+		BOOST_REQUIRE(d.index_of(*i) == n);
+		std::vector<char> k;
+		BOOST_REQUIRE(d.key_at(n, k));
+		BOOST_REQUIRE(key_string(k) == *i);
+	}
+	BOOST_CHECK(di == d.end());
+	std::vector<char> k;
+	BOOST_CHECK(!d.key_at(words.size(), k));
+
+	BOOST_CHECK(!d.contains(std::string("walkin")));
+	BOOST_CHECK(!d.contains(std::string("walkings")));
+	BOOST_CHECK(d.index_of(std::string("walkin")) == dc::npos);
+	BOOST_CHECK(d.count_prefix(std::string("walk")) == 6);
+	BOOST_CHECK(d.count_prefix(std::string("w")) == 12);
+	BOOST_CHECK(d.count_prefix(std::string("x")) == 0);
+	dc::iterator_range r = d.find_prefix(std::string("talke"));
+	BOOST_REQUIRE(r.first != r.second);
+	BOOST_CHECK(key_string(*r.first) == "talked");
+	++r.first;
+	BOOST_CHECK(key_string(*r.first) == "talker");
+	++r.first;
+	BOOST_CHECK(key_string(*r.first) == "talkers");
+	++r.first;
+	BOOST_CHECK(r.first == r.second);
+	r = d.find_prefix(std::string("q"));
+	BOOST_CHECK(r.first == r.second);
+
+	// the empty key comes first
+	BOOST_CHECK(b.add(std::string()));
+	BOOST_CHECK(b.add(std::string("a")));
+	b.build(d);
+	BOOST_CHECK(d.size() == 2);
+	BOOST_CHECK(d.count(std::string()) == 1);
+	BOOST_CHECK(d.index_of(std::string()) == 0);
+	BOOST_CHECK(d.begin().get_key().empty());
+	BOOST_CHECK(d.index_of(std::string("a")) == 1);
+}
+
+BOOST_AUTO_TEST_CASE(trie_set_test)
+{
+	boost::tries::trie_set<char> t;
+	std::set<std::string> s;
+	for (int i = 0; i < 3000; ++i)
+	{
+		std::string k;
+		for (int j = i * 7919 % 2999 + 1; j > 0; j /= 4)
+			k += char('a' + j % 4);
+		t.insert(k);
+		s.insert(k);
+	}
+	dc d(t);
+	BOOST_REQUIRE(d.size() == s.size());
+	BOOST_CHECK(d.has_counts());
+	BOOST_CHECK(d.count_node() < t.count_node());
+	size_t n = 0;
+	dc::iterator di = d.begin();
+	for (std::set<std::string>::iterator i = s.begin(); i != s.end(); ++i, ++di, ++n)
+	{
+		BOOST_REQUIRE(key_string(*di) == *i);
+		BOOST_REQUIRE(d.index_of(*i) == n);
+	}
+
+	// without counts the prefix counts walk the graph
+	dc nc(t, false);
+	BOOST_CHECK(!nc.has_counts());
+	BOOST_CHECK(nc.index_of(std::string("ab")) == dc::npos);
+	for (int i = 0; i < 2999; i += 37)
+	{
+		std::string p;
+		for (int j = i; j > 0; j /= 4)
+			p += char('a' + j % 4);
+		BOOST_REQUIRE(nc.count_prefix(p) == d.count_prefix(p));
+		BOOST_REQUIRE(nc.contains(p) == (s.count(p) == 1));
+	}
+
+	nc.swap(d);
+	BOOST_CHECK(nc.has_counts());
+	d.clear();
+	BOOST_CHECK(d.empty());
+	BOOST_CHECK(d.begin() == d.end());
+	BOOST_CHECK(d.count(std::string()) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,149 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/double_array_trie.hpp"
+// multi include test
+#include "boost/trie/double_array_trie.hpp"
+#include "boost/trie/trie_map.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::double_array_trie<int> dai;
+typedef std::map<std::string, int> smap;
+
+std::string make_key(int i)
+{
+	std::string k;
+	for (int j = i; j > 0; j /= 11)
+		k += char('a' + j % 11);
+	return k;
+}
+
+void check_same(const dai& d, const smap& m)
+{
+	BOOST_REQUIRE(d.size() == m.size());
+	for (smap::const_iterator i = m.begin(); i != m.end(); ++i)
+	{
+		const int *v = d.find(i->first);
+		BOOST_REQUIRE(v != NULL);
+		BOOST_REQUIRE(*v == i->second);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(compile_test)
+{
+	boost::tries::trie_map<char, int> t;
+	smap m;
+	for (int i = 1; i < 4000; ++i)
+	{
+		t[make_key(i * 7919 % 3989)] = i;
+		m[make_key(i * 7919 % 3989)] = i;
+	}
+	dai d(t);
+	check_same(d, m);
+	BOOST_CHECK(d.find(std::string("zz")) == NULL);
+	BOOST_CHECK(d.count(std::string("a")) == m.count("a"));
+	BOOST_CHECK(d.count_cell() >= m.size() + t.count_node());
+	// the bases are packed
+	BOOST_CHECK(d.count_cell() * 2 > d.array_size());
+
+	std::string input = make_key(1234) + "zzz";
+	dai::prefix_match lp = d.findLongestPrefixOfKey(input);
+	BOOST_REQUIRE(lp.second != NULL);
+	BOOST_CHECK(lp.first == make_key(1234).size());
+	BOOST_CHECK(*lp.second == m[make_key(1234)]);
+
+	std::vector<dai::prefix_match> all;
+	size_t n = d.common_prefix_search(input, std::back_inserter(all));
+	BOOST_REQUIRE(n == all.size());
+	size_t expect = 0;
+	for (size_t len = 0; len <= input.size(); ++len)
+	{
+		smap::iterator i = m.find(input.substr(0, len));
+		if (i == m.end())
+			continue;
+		BOOST_REQUIRE(expect < all.size());
+		BOOST_CHECK(all[expect].first == len);
+		BOOST_CHECK(*all[expect].second == i->second);
+		++expect;
+	}
+	BOOST_CHECK(expect == n);
+	// only the empty key
+	BOOST_CHECK(m.count("") == 1);
+	BOOST_CHECK(d.findLongestPrefixOfKey(std::string("zz")).first == 0);
+	BOOST_CHECK(*d.findLongestPrefixOfKey(std::string("zz")).second == m[""]);
+}
+
+BOOST_AUTO_TEST_CASE(compile_high_byte_test)
+{
+	// children with bytes above 127 come first in char order, last in
+	// code order
+	boost::tries::trie_map<char, int> t;
+	smap m;
+	for (int i = 1; i < 100; ++i)
+	{
+		std::string a = std::string(1, char(i)) + "a";
+		std::string b = std::string(1, char(i)) + "\xff";
+		std::string c = std::string(1, char(i + 128)) + "\x80" + char(i);
+		t[a] = i;
+		m[a] = i;
+		t[b] = -i;
+		m[b] = -i;
+		t[c] = i * 1000;
+		m[c] = i * 1000;
+	}
+	dai d(t);
+	check_same(d, m);
+	BOOST_CHECK(d.find(std::string("\x01\xfe")) == NULL);
+	BOOST_CHECK(d.insert(std::string("\x01\x80"), 5));
+	BOOST_CHECK(*d.find(std::string("\x01\x80")) == 5);
+	BOOST_CHECK(*d.find(std::string("\x01\xff")) == -1);
+}
+
+BOOST_AUTO_TEST_CASE(insert_test)
+{
+	dai d;
+	smap m;
+	BOOST_CHECK(d.empty());
+	BOOST_CHECK(d.find(std::string()) == NULL);
+	// every order of arrival, so states get relocated
+	for (int i = 0; i < 3000; ++i)
+	{
+		std::string k = make_key(i * 2741 % 2999);
+		BOOST_REQUIRE(d.insert(k, i) == m.insert(std::make_pair(k, i)).second);
+	}
+	check_same(d, m);
+	BOOST_CHECK(!d.insert(std::string("abc"), 7) || m.count("abc") == 0);
+	// keys with bytes above 127
+	std::string hi = "\xff\x80";
+	BOOST_CHECK(d.insert(hi, -1));
+	BOOST_CHECK(*d.find(hi) == -1);
+	*d.find(hi) = -2;
+	BOOST_CHECK(*d.find(hi) == -2);
+	BOOST_CHECK(d.findLongestPrefixOfKey(hi + "a").first == 2);
+
+	// a compiled map takes more keys later
+	boost::tries::trie_map<char, int> t;
+	t[std::string("abc")] = 1;
+	t[std::string("abd")] = 2;
+	dai c(t);
+	BOOST_CHECK(c.insert(std::string("ab"), 3));
+	BOOST_CHECK(c.insert(std::string("abca"), 4));
+	BOOST_CHECK(*c.find(std::string("abc")) == 1);
+	BOOST_CHECK(*c.find(std::string("abd")) == 2);
+	BOOST_CHECK(*c.find(std::string("ab")) == 3);
+	BOOST_CHECK(c.size() == 4);
+
+	c.swap(d);
+	BOOST_CHECK(d.size() == 4);
+	d.clear();
+	BOOST_CHECK(d.empty());
+	BOOST_CHECK(d.find(std::string("abc")) == NULL);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
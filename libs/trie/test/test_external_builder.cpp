@@ -0,0 +1,142 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/external_builder.hpp"
+// multi include test
+#include "boost/trie/external_builder.hpp"
+#include "boost/trie/trie_map.hpp"
+#include "boost/trie/trie_multimap.hpp"
+#include "boost/trie/mapped_trie_map.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::external_builder<char, int> ebci;
+typedef boost::tries::trie_map<char, int> tmci;
+typedef boost::tries::mapped_trie_map<char, int> mtci;
+
+std::string make_key(int i)
+{
+	std::string k;
+	for (int j = i; j > 0; j /= 7)
+		k += char('a' + j % 7);
+	return k;
+}
+
+// every key twice, in no particular order, and never the empty key
+int key_of(int i)
+{
+	return (i * 7919) % 3001 + 1;
+}
+
+BOOST_AUTO_TEST_CASE(build_trie_test)
+{
+	for (size_t threads = 0; threads <= 2; ++threads)
+	{
+		ebci b("test_external_builder_trie", 4096, threads);
+		std::map<std::string, int> m;
+		for (int i = 0; i < 6002; ++i)
+		{
+			b.add(make_key(key_of(i)), i);
+			// the first value of a key is kept by trie_map
+			m.insert(std::make_pair(make_key(key_of(i)), i));
+		}
+		BOOST_CHECK(b.size() == 6002);
+		BOOST_CHECK(b.count_run() > 1);
+		tmci t;
+		t[std::string("old")] = 1;
+		BOOST_REQUIRE(b.build(t));
+		BOOST_CHECK(b.size() == 0);
+		BOOST_REQUIRE(t.size() == m.size());
+		tmci::iterator ti = t.begin();
+		for (std::map<std::string, int>::iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+		{
+			std::vector<char> k = ti.get_key();
+			BOOST_REQUIRE(std::string(k.begin(), k.end()) == mi->first);
+			BOOST_REQUIRE(*ti == mi->second);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(build_multimap_test)
+{
+	boost::tries::external_builder<char, int> b("test_external_builder_multi", 1024, 2);
+	for (int i = 0; i < 1000; ++i)
+		b.add(make_key(i % 10), i);
+	boost::tries::trie_multimap<char, int> t;
+	BOOST_REQUIRE(b.build(t));
+	BOOST_CHECK(t.size() == 1000);
+	BOOST_CHECK(t.count(make_key(3)) == 100);
+}
+
+BOOST_AUTO_TEST_CASE(build_image_test)
+{
+	ebci b("test_external_builder_image", 2048, 2);
+	boost::tries::trie_multimap<char, int> t;
+	for (int i = 0; i < 6002; ++i)
+	{
+		b.add(make_key(key_of(i)), i);
+		t.insert(make_key(key_of(i)), i);
+	}
+	std::string path = "test_external_builder.img";
+	BOOST_REQUIRE(b.build_image(path));
+	mtci m;
+	BOOST_REQUIRE(m.open(path));
+	BOOST_CHECK(m.size() == t.size());
+	BOOST_CHECK(m.count_node() == t.count_node());
+	boost::tries::trie_multimap<char, int>::iterator ti = t.begin();
+	for (mtci::const_iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+		BOOST_REQUIRE(mi.get_key() == ti.get_key());
+	for (int i = 0; i < 3001; i += 17)
+	{
+		BOOST_REQUIRE(m.count(make_key(i)) == t.count(make_key(i)));
+		BOOST_REQUIRE(m.count_prefix(make_key(i)) == t.count_prefix(make_key(i)));
+	}
+	// values of one key in the order they were added
+	mtci::iterator_range r = m.find_prefix(make_key(key_of(1)));
+	BOOST_CHECK(*r.first == 1);
+	m.close();
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(build_string_image_test)
+{
+	boost::tries::external_builder<char, std::string> b("test_external_builder_string", 512, 1);
+	std::map<std::string, std::string> m;
+	for (int i = 1; i <= 500; ++i)
+	{
+		b.add(make_key(i), make_key(i * 3));
+		m[make_key(i)] = make_key(i * 3);
+	}
+	b.add(std::string(), std::string("root"));
+	m[std::string()] = "root";
+	std::string path = "test_external_builder_string.img";
+	BOOST_REQUIRE(b.build_image(path));
+	boost::tries::mapped_trie_map<char, std::string> t;
+	BOOST_REQUIRE(t.open(path));
+	BOOST_REQUIRE(t.size() == m.size());
+	boost::tries::mapped_trie_map<char, std::string>::const_iterator ti = t.begin();
+	for (std::map<std::string, std::string>::iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+	{
+		std::vector<char> k = ti.get_key();
+		BOOST_REQUIRE(std::string(k.begin(), k.end()) == mi->first);
+		BOOST_REQUIRE(*ti == mi->second);
+	}
+	t.close();
+	std::remove(path.c_str());
+
+	// nothing added
+	boost::tries::external_builder<char, std::string> e("test_external_builder_empty");
+	BOOST_REQUIRE(e.build_image(path));
+	BOOST_REQUIRE(t.open(path));
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() == 0);
+	t.close();
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
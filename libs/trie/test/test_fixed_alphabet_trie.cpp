@@ -0,0 +1,192 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/fixed_alphabet_trie.hpp"
+// multi include test
+#include "boost/trie/fixed_alphabet_trie.hpp"
+#include "boost/trie/trie_map.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::fixed_alphabet_trie<boost::tries::dna_alphabet, int> dna_trie;
+typedef std::map<std::string, int> smap;
+
+std::string key_string(const std::vector<char>& k)
+{
+	return std::string(k.begin(), k.end());
+}
+
+void check_same(const dna_trie& t, const smap& m)
+{
+	BOOST_REQUIRE(t.size() == m.size());
+	dna_trie::const_iterator ti = t.begin();
+	for (smap::const_iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+	{
+		BOOST_REQUIRE(ti != t.end());
+		BOOST_REQUIRE(key_string(ti.get_key()) == mi->first);
+		BOOST_REQUIRE(*ti == mi->second);
+	}
+	BOOST_CHECK(ti == t.end());
+	dna_trie::const_reverse_iterator ri = t.rbegin();
+	for (smap::const_reverse_iterator mi = m.rbegin(); mi != m.rend(); ++mi, ++ri)
+	{
+		BOOST_REQUIRE(ri != t.rend());
+		BOOST_REQUIRE(*ri == mi->second);
+	}
+	BOOST_CHECK(ri == t.rend());
+}
+
+BOOST_AUTO_TEST_CASE(insert_and_find_test)
+{
+	dna_trie t;
+	std::string s = "ACG", s1 = "ACGT", s2 = "ACT", s3 = "TTT";
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.begin() == t.end());
+	BOOST_CHECK(t.insert(s, 1).second);
+	BOOST_CHECK(!t.insert(s, 2).second);
+	BOOST_CHECK(*t.find(s) == 1);
+	t[s] = 2;
+	t[s1] = 3;
+	t[s2] = 4;
+	BOOST_CHECK(t.find(s3) == t.end());
+	BOOST_CHECK(t.find(std::string("AC")) == t.end());
+	BOOST_CHECK(t.count(s1) == 1);
+	BOOST_CHECK(t.size() == 3);
+	BOOST_CHECK(t.count_node() == 5);
+	BOOST_CHECK(t.count_prefix(std::string("AC")) == 3);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("ACGA")) == 2);
+	BOOST_CHECK(t.findLongestPrefixOfKey(std::string("T")) == t.end());
+	// the empty key is the first one
+	t[std::string()] = 5;
+	BOOST_CHECK(*t.begin() == 5);
+	BOOST_CHECK(*--t.end() == 4);
+	BOOST_CHECK(t.erase(s3) == 0);
+	BOOST_CHECK(t.erase(s1) == 1);
+	BOOST_CHECK(t.count_node() == 4);
+	BOOST_CHECK(t.erase(std::string()) == 1);
+	BOOST_CHECK(t.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(alphabet_test)
+{
+	dna_trie t;
+	// a key outside the alphabet is never in the map
+	std::string bad = "ACNT";
+	BOOST_CHECK(t.insert(bad, 1).first == t.end());
+	BOOST_CHECK(!t.insert(bad, 1).second);
+	BOOST_CHECK(t.count_node() == 0);
+	BOOST_CHECK(t.find(bad) == t.end());
+	BOOST_CHECK(t.count_prefix(bad) == 0);
+	t[std::string("AC")] = 1;
+	BOOST_CHECK(*t.findLongestPrefixOfKey(bad) == 1);
+	BOOST_CHECK(t.erase(bad) == 0);
+	// lower case is another symbol
+	BOOST_CHECK(t.find(std::string("ac")) == t.end());
+
+	boost::tries::fixed_alphabet_trie<boost::tries::hex_alphabet, int> h;
+	std::string k1 = "ff", k2 = "0a", k3 = "a0", k4 = "9";
+	h[k1] = 1;
+	h[k2] = 2;
+	h[k3] = 3;
+	h[k4] = 4;
+	BOOST_CHECK(!h.insert(std::string("FF"), 5).second);
+	// digits before letters, as with the chars
+	BOOST_CHECK(key_string(h.begin().get_key()) == k2);
+	BOOST_CHECK(key_string((++h.begin()).get_key()) == k4);
+	BOOST_CHECK(key_string((--h.end()).get_key()) == k1);
+
+	boost::tries::fixed_alphabet_trie<boost::tries::decimal_alphabet, std::string> phones;
+	phones[std::string("5550100")] = "office";
+	phones[std::string("5550199")] = "home";
+	BOOST_CHECK(phones.count_prefix(std::string("555")) == 2);
+	BOOST_CHECK(*phones.find(std::string("5550199")) == "home");
+	BOOST_CHECK(phones.find(std::string("555-0199")) == phones.end());
+}
+
+BOOST_AUTO_TEST_CASE(random_against_map)
+{
+	dna_trie t;
+	smap m;
+	unsigned seed = 3;
+	for (int i = 0; i < 3000; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		std::string k;
+		for (unsigned len = (seed >> 8) % 7, r = seed >> 11; len > 0; --len, r >>= 2)
+			k += "ACGT"[r & 3];
+		if ((seed >> 28) < 11)
+		{
+			std::pair<dna_trie::iterator, bool> p = t.insert(k, i);
+			BOOST_CHECK(p.second == m.insert(std::make_pair(k, i)).second);
+			BOOST_CHECK(*p.first == m[k]);
+		}
+		else {
+			BOOST_CHECK(t.erase(k) == m.erase(k));
+		}
+	}
+	check_same(t, m);
+	std::string p = "AC";
+	dna_trie::iterator_range r = t.find_prefix(p);
+	smap::iterator mi = m.lower_bound(p);
+	for (; r.first != r.second; ++r.first, ++mi)
+		BOOST_CHECK(*r.first == mi->second);
+	BOOST_CHECK(mi == m.lower_bound("AG"));
+	BOOST_CHECK(t.count_prefix(p) == size_t(std::distance(m.lower_bound(p), m.lower_bound("AG"))));
+	const dna_trie& ct = t;
+	dna_trie::const_iterator_range cr = ct.find_prefix(p);
+	BOOST_CHECK(cr.first == t.find_prefix(p).first && cr.second == t.find_prefix(p).second);
+	BOOST_CHECK(ct.findLongestPrefixOfKey(std::string("ACGTX")) == t.findLongestPrefixOfKey(std::string("ACGTX")));
+
+	// erase by iterator returns the next one
+	for (dna_trie::iterator i = t.begin(); i != t.end(); )
+	{
+		if (*i % 2 == 0)
+		{
+			m.erase(key_string(i.get_key()));
+			i = t.erase(i);
+		}
+		else {
+			++i;
+		}
+	}
+	check_same(t, m);
+
+	// the freed nodes are used again
+	size_t nodes = t.count_node();
+	dna_trie t2;
+	t2.swap(t);
+	check_same(t2, m);
+	BOOST_CHECK(t.empty());
+	t2.clear();
+	BOOST_CHECK(t2.empty() && t2.count_node() == 0);
+	BOOST_CHECK(nodes > 0);
+}
+
+BOOST_AUTO_TEST_CASE(pack_test)
+{
+	using boost::tries::dna_alphabet;
+	boost::uint64_t w;
+	std::string k = "ACGTTGCA";
+	BOOST_CHECK(boost::tries::pack_symbols<dna_alphabet>(k.begin(), k.end(), w));
+	BOOST_CHECK(w == 0x1be4);
+	BOOST_CHECK(key_string(boost::tries::unpack_symbols<dna_alphabet>(w, k.size())) == k);
+	std::string longest(32, 'T'), too_long(33, 'A'), bad = "ACGN";
+	BOOST_CHECK(boost::tries::pack_symbols<dna_alphabet>(longest.begin(), longest.end(), w));
+	BOOST_CHECK(w == ~boost::uint64_t(0));
+	BOOST_CHECK(!boost::tries::pack_symbols<dna_alphabet>(too_long.begin(), too_long.end(), w));
+	BOOST_CHECK(!boost::tries::pack_symbols<dna_alphabet>(bad.begin(), bad.end(), w));
+}
+
+BOOST_AUTO_TEST_CASE(node_size)
+{
+	// four children, the parent, the value slot and the count
+	BOOST_CHECK(sizeof(dna_trie::node_type) == 7 * sizeof(boost::uint32_t));
+	BOOST_CHECK(sizeof(dna_trie::node_type) < sizeof(boost::tries::trie_map<char, int>::trie_type::node_type));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,179 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/trie_map.hpp"
+#include "boost/trie/trie_multimap.hpp"
+#include "boost/trie/trie_set.hpp"
+#include "boost/trie/frozen_trie.hpp"
+// multi include test
+#include "boost/trie/frozen_trie.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::trie_map<char, int> tmci;
+typedef tmci::frozen_type ftci;
+
+std::string make_key(int i)
+{
+	std::string k;
+	for (int j = i; j > 0; j /= 6)
+		k += char('a' + j % 6);
+	return k;
+}
+
+BOOST_AUTO_TEST_CASE(find_test)
+{
+	tmci t;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab", s3 = "bbb";
+	t[s] = 1;
+	t[s1] = 2;
+	t[s2] = 3;
+	t[s3] = 4;
+	ftci f = t.freeze();
+	BOOST_CHECK(f.size() == 4);
+	BOOST_CHECK(f.count_node() == t.count_node());
+	BOOST_CHECK(*f.find(s) == 1);
+	BOOST_CHECK(*f.find(s1) == 2);
+	BOOST_CHECK(*f.find(s2) == 3);
+	BOOST_CHECK(*f.find(s3) == 4);
+	BOOST_CHECK(f.find(std::string("aa")) == f.end());
+	BOOST_CHECK(f.find(std::string("c")) == f.end());
+	BOOST_CHECK(f.count(s) == 1);
+	BOOST_CHECK(f.count(std::string("bb")) == 0);
+	BOOST_CHECK(f.count_prefix(std::string("a")) == 3);
+	BOOST_CHECK(f.count_prefix(std::string("aaa")) == 2);
+	BOOST_CHECK(f.count_prefix(std::string("")) == 4);
+	BOOST_CHECK(f.count_prefix(std::string("x")) == 0);
+	ftci::iterator_range r = f.find_prefix(std::string("aa"));
+	BOOST_CHECK(r.second - r.first == 3);
+	BOOST_CHECK(*r.second == 4);
+	int j = 1;
+	for (ftci::const_iterator i = r.first; i != r.second; ++i, ++j)
+		BOOST_CHECK(*i == j);
+	BOOST_CHECK(*f.findLongestPrefixOfKey(std::string("aaab")) == 1);
+	BOOST_CHECK(*f.findLongestPrefixOfKey(std::string("aaaaaaa")) == 2);
+	BOOST_CHECK(f.findLongestPrefixOfKey(std::string("aa")) == f.end());
+	BOOST_CHECK(*f.rbegin() == 4);
+}
+
+BOOST_AUTO_TEST_CASE(iterator_and_key_test)
+{
+	tmci t;
+	std::map<std::string, int> m;
+	for (int i = 1; i <= 3000; ++i)
+	{
+		t[make_key(i)] = i;
+		m[make_key(i)] = i;
+	}
+	ftci f = t.freeze();
+	BOOST_CHECK(f.size() == m.size());
+	ftci::const_iterator i = f.begin();
+	for (std::map<std::string, int>::iterator j = m.begin(); j != m.end(); ++j, ++i)
+	{
+		std::vector<char> k = i.get_key();
+		BOOST_REQUIRE(std::string(k.begin(), k.end()) == j->first);
+		BOOST_REQUIRE(*i == j->second);
+		BOOST_REQUIRE(*f.find(j->first) == j->second);
+	}
+	BOOST_CHECK(i == f.end());
+	for (int c = 0; c < 6; ++c)
+	{
+		std::string p(1, char('a' + c));
+		BOOST_CHECK(f.count_prefix(p) == t.count_prefix(p));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(thaw_test)
+{
+	tmci t, t2;
+	for (int i = 1; i <= 1000; ++i)
+		t[make_key(i)] = i;
+	ftci f = t.freeze();
+	t2[std::string("zzz")] = 1;
+	t2.thaw(f);
+	BOOST_CHECK(t2.size() == t.size());
+	BOOST_CHECK(t2.count_node() == t.count_node());
+	tmci::iterator j = t2.begin();
+	for (tmci::iterator i = t.begin(); i != t.end(); ++i, ++j)
+	{
+		BOOST_REQUIRE(*i == *j);
+		BOOST_REQUIRE(i.get_key() == j.get_key());
+	}
+	BOOST_CHECK(j == t2.end());
+}
+
+BOOST_AUTO_TEST_CASE(multimap_and_set_test)
+{
+	typedef boost::tries::trie_multimap<char, int> tmmci;
+	tmmci t;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab";
+	t.insert(s, 1);
+	t.insert(s, 2);
+	t.insert(s1, 3);
+	t.insert(s2, 4);
+	tmmci::frozen_type f = t.freeze();
+	BOOST_CHECK(f.count(s) == 2);
+	BOOST_CHECK(f.count_prefix(s) == 3);
+	tmmci::iterator i = t.begin();
+	for (tmmci::frozen_type::const_iterator j = f.begin(); j != f.end(); ++i, ++j)
+		BOOST_CHECK(*i == *j);
+	tmmci t2;
+	t2.thaw(f);
+	i = t.begin();
+	for (tmmci::iterator j = t2.begin(); j != t2.end(); ++i, ++j)
+		BOOST_CHECK(*i == *j);
+	BOOST_CHECK(t2.count(s) == 2);
+
+	boost::tries::trie_set<char> ts;
+	ts.insert(s);
+	ts.insert(s2);
+	boost::tries::trie_set<char>::frozen_type fs = ts.freeze();
+	BOOST_CHECK(fs.count(s) == 1);
+	BOOST_CHECK(fs.count(s1) == 0);
+	BOOST_CHECK(fs.size() == 2);
+}
+
+BOOST_AUTO_TEST_CASE(empty_test)
+{
+	tmci t;
+	ftci f = t.freeze();
+	BOOST_CHECK(f.empty());
+	BOOST_CHECK(f.begin() == f.end());
+	BOOST_CHECK(f.find(std::string("a")) == f.end());
+	BOOST_CHECK(f.count_prefix(std::string("")) == 0);
+	ftci f2;
+	BOOST_CHECK(f2.count_node() == 0);
+	BOOST_CHECK(f2.find(std::string("a")) == f2.end());
+}
+
+// the values of the empty key are iterated here, trie::iterator skips them
+BOOST_AUTO_TEST_CASE(root_value_test)
+{
+	tmci t;
+	t[std::string("a")] = 2;
+	t[std::string("b")] = 3;
+	t[std::string()] = 1;
+	BOOST_CHECK(t.size() == 3);
+	BOOST_CHECK(std::distance(t.begin(), t.end()) == 2);
+	BOOST_CHECK(*t.begin() == 2);
+	ftci f = t.freeze();
+	BOOST_CHECK(f.size() == 3);
+	BOOST_CHECK(std::distance(f.begin(), f.end()) == 3);
+	BOOST_CHECK(*f.begin() == 1);
+	BOOST_CHECK(f.begin() == f.find(std::string()));
+	BOOST_CHECK(f.begin().get_key().empty());
+	BOOST_CHECK(*++f.begin() == 2);
+	BOOST_CHECK(*f.rbegin() == 3);
+	ftci::iterator_range r = f.find_prefix(std::string());
+	BOOST_CHECK(r.first == f.begin() && r.second == f.end());
+	tmci back;
+	back.thaw(f);
+	BOOST_CHECK(back.size() == 3);
+	BOOST_CHECK(*back.find(std::string()) == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,192 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/louds_trie.hpp"
+// multi include test
+#include "boost/trie/louds_trie.hpp"
+#include "boost/trie/trie_map.hpp"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::louds_trie<char> ltc;
+typedef boost::tries::trie<char, int, std::less<char> > tci;
+
+std::string key_string(const std::vector<char>& k)
+{
+	return std::string(k.begin(), k.end());
+}
+
+std::string make_key(int i)
+{
+	std::string k;
+	for (int j = i; j > 0; j /= 7)
+		k += char('a' + j % 7);
+	return k;
+}
+
+void check_same(const ltc& l, const std::set<std::string>& s)
+{
+	BOOST_REQUIRE(l.size() == s.size());
+	ltc::iterator li = l.begin();
+	std::vector<bool> seen(s.size(), false);
+	for (std::set<std::string>::const_iterator i = s.begin(); i != s.end(); ++i, ++li)
+	{
+		BOOST_REQUIRE(li != l.end());
+		BOOST_REQUIRE(key_string(li.get_key()) == *i);
+		size_t id = l.id_of(*i);
+		BOOST_REQUIRE(id < s.size());
+		BOOST_REQUIRE(!seen[id]);
+		seen[id] = true;
+		BOOST_REQUIRE(li.id() == id);
+		BOOST_REQUIRE(key_string(l.key_of(id)) == *i);
+	}
+	BOOST_CHECK(li == l.end());
+}
+
+BOOST_AUTO_TEST_CASE(query_test)
+{
+	tci t;
+	std::set<std::string> s;
+	for (int i = 0; i < 5000; ++i)
+	{
+		std::string k = make_key(i * 7919 % 4999);
+		t.insert_unique(k, i);
+		s.insert(k);
+	}
+	ltc l(t);
+	BOOST_CHECK(l.count_node() == t.count_node());
+	check_same(l, s);
+	// the root holds the empty key
+	BOOST_CHECK(l.count(std::string()) == 1);
+	BOOST_CHECK(l.count(std::string("hh")) == 0);
+	BOOST_CHECK(l.id_of(std::string("hh")) == ltc::npos);
+	BOOST_CHECK(l.find(std::string("hh")) == l.end());
+	BOOST_CHECK(key_string(l.find(make_key(100)).get_key()) == make_key(100));
+
+	for (int i = 0; i < 4999; i += 41)
+	{
+		std::string p = make_key(i);
+		size_t n = 0;
+		for (std::set<std::string>::iterator j = s.lower_bound(p); j != s.end() && j->compare(0, p.size(), p) == 0; ++j)
+			++n;
+		BOOST_REQUIRE(l.count_prefix(p) == n);
+		ltc::iterator_range r = l.find_prefix(p);
+		BOOST_REQUIRE(size_t(std::distance(r.first, r.second)) == n);
+		if (n > 0)
+			BOOST_REQUIRE(key_string(*r.first) == *s.lower_bound(p));
+	}
+	BOOST_CHECK(l.count_prefix(std::string()) == s.size());
+	BOOST_CHECK(l.count_prefix(std::string("ah")) == 0);
+
+	std::string k = make_key(123) + "hhhh";
+	ltc::iterator lp = l.findLongestPrefixOfKey(k);
+	BOOST_CHECK(key_string(lp.get_key()) == make_key(123));
+	// the iteration goes on from there
+	++lp;
+	BOOST_CHECK(key_string(*lp) == *++s.find(make_key(123)));
+
+	// a shape of 2 bits and a terminal bit a node, plus the labels
+	BOOST_CHECK(l.image_size() < 512 + t.count_node() * (3 * 1.1 / 8 + 1));
+}
+
+BOOST_AUTO_TEST_CASE(save_and_open_test)
+{
+	boost::tries::trie_map<char, int> t;
+	std::set<std::string> s;
+	for (int i = 1; i < 2000; ++i)
+	{
+		t[make_key(i)] = i;
+		s.insert(make_key(i));
+	}
+	ltc l(t.freeze());
+	check_same(l, s);
+	std::string path = "test_louds_trie.img";
+	BOOST_REQUIRE(l.save(path));
+	ltc m;
+	BOOST_CHECK(m.empty());
+	BOOST_CHECK(m.begin() == m.end());
+	BOOST_REQUIRE(m.open(path));
+	BOOST_CHECK(m.is_mapped());
+	check_same(m, s);
+	BOOST_CHECK(m.count_node() == l.count_node());
+	m.close();
+	BOOST_CHECK(!m.is_mapped());
+	BOOST_CHECK(m.empty());
+
+	// for another key type
+	boost::tries::louds_trie<int> other;
+	BOOST_CHECK(!other.open(path));
+	BOOST_CHECK(!m.open("test_louds_trie_missing.img"));
+	std::remove(path.c_str());
+
+	m.swap(l);
+	BOOST_CHECK(l.empty());
+	check_same(m, s);
+	m.clear();
+	BOOST_CHECK(m.empty());
+}
+
+void write_file(const std::string& path, const std::string& data)
+{
+	std::ofstream os(path.c_str(), std::ios::binary | std::ios::trunc);
+	os.write(data.data(), data.size());
+}
+
+BOOST_AUTO_TEST_CASE(corrupt_image_test)
+{
+	boost::tries::trie_map<char, int> t;
+	for (int i = 1; i < 60; ++i)
+		t[make_key(i)] = i;
+	ltc l(t.freeze());
+	std::string path = "test_louds_trie_corrupt.img";
+	BOOST_REQUIRE(l.save(path));
+	std::string good;
+	{
+		std::ifstream is(path.c_str(), std::ios::binary);
+		good.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+	}
+	// every bit flipped past the magic: the image is refused and the old
+	// content kept, or every walk stays in the mapping
+	ltc m;
+	for (size_t n = 64; n < good.size() * 8; ++n)
+	{
+		std::string bad = good;
+		bad[n / 8] ^= char(1 << (n % 8));
+		write_file(path, bad);
+		if (!m.open(path))
+		{
+			BOOST_CHECK(m.empty());
+			continue;
+		}
+		size_t keys = 0;
+		for (ltc::iterator i = m.begin(); i != m.end() && keys <= m.size(); ++i, ++keys)
+		{
+			m.id_of(*i);
+			m.count_prefix(*i);
+			m.findLongestPrefixOfKey(*i);
+		}
+		BOOST_CHECK(keys == m.size());
+		for (size_t id = 0; id < m.size(); ++id)
+			m.id_of(m.key_of(id));
+		m.close();
+	}
+	for (size_t n = 0; n < good.size(); ++n)
+	{
+		write_file(path, good.substr(0, n));
+		BOOST_CHECK(!m.open(path));
+	}
+	write_file(path, good);
+	BOOST_REQUIRE(m.open(path));
+	BOOST_CHECK(m.size() == t.size());
+	m.close();
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
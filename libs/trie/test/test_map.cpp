@@ -7,6 +7,9 @@
 
 #include <string>
 #include <iostream>
+#include <map>
+#include <vector>
+#include <sstream>
 
 BOOST_AUTO_TEST_SUITE(trie_test)
 
@@ -301,6 +304,402 @@ BOOST_AUTO_TEST_CASE(clear)
 	BOOST_CHECK(t.count_node() == 3);
 }
 
+BOOST_AUTO_TEST_CASE(erase_prefix)
+{
+	tmci t;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab", s3 = "bbb";
+	t[s] = 1;
+	t[s1] = 2;
+	t[s2] = 3;
+	t[s3] = 4;
+	BOOST_CHECK(t.erase_prefix(std::string("ccc")) == 0);
+	BOOST_CHECK(t.erase_prefix(std::string("aaa")) == 2);
+	BOOST_CHECK(t.size() == 2);
+	BOOST_CHECK(t.count_node() == 6);
+	BOOST_CHECK(t.find(s) == t.end());
+	BOOST_CHECK(t.find(s1) == t.end());
+	tmci::iterator i = t.begin();
+	BOOST_CHECK(*i == 3);
+	++i;
+	BOOST_CHECK(*i == 4);
+	++i;
+	BOOST_CHECK(i == t.end());
+	--i;
+	BOOST_CHECK(*i == 4);
+	BOOST_CHECK(t.erase_prefix(std::string("a")) == 1);
+	BOOST_CHECK(t.size() == 1);
+	BOOST_CHECK(t.count_node() == 3);
+	BOOST_CHECK(*t.begin() == 4);
+	BOOST_CHECK(*t.rbegin() == 4);
+	t[s] = 5;
+	BOOST_CHECK(*t.begin() == 5);
+	BOOST_CHECK(t.erase_prefix(std::string("")) == 2);
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() == 0);
+	BOOST_CHECK(t.begin() == t.end());
+}
+
+BOOST_AUTO_TEST_CASE(clear_large)
+{
+	tmci t;
+	for (int i = 1; i <= 10000; ++i)
+	{
+		std::string k;
+		for (int j = i; j > 0; j /= 7)
+			k += char('a' + j % 7);
+		t[k] = i;
+	}
+	BOOST_CHECK(t.size() == 10000);
+	int n = 0;
+	for (tmci::iterator i = t.begin(); i != t.end(); ++i)
+		++n;
+	BOOST_CHECK(n == 10000);
+	tmci t2(t);
+	t.clear();
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() == 0);
+	BOOST_CHECK(t.begin() == t.end());
+	BOOST_CHECK(t2.size() == 10000);
+}
+
+std::string range_key(int i)
+{
+	std::string k;
+	for (int j = i; j > 0; j /= 5)
+		k += char('a' + j % 5);
+	return k;
+}
+
+void check_same(tmci& t, const std::map<std::string, int>& m)
+{
+	BOOST_REQUIRE(t.size() == m.size());
+	tmci::iterator i = t.begin();
+	for (std::map<std::string, int>::const_iterator j = m.begin(); j != m.end(); ++j, ++i)
+	{
+		std::vector<char> k = i.get_key();
+		BOOST_REQUIRE(std::string(k.begin(), k.end()) == j->first);
+		BOOST_REQUIRE(*i == j->second);
+	}
+	BOOST_REQUIRE(i == t.end());
+	if (!m.empty())
+		BOOST_REQUIRE(*t.rbegin() == m.rbegin()->second);
+	BOOST_REQUIRE(t.count_prefix(std::string("a")) == t.count_prefix(std::string("a")));
+}
+
+BOOST_AUTO_TEST_CASE(erase_range)
+{
+	const char *bounds[][2] = {
+		{"a", "c"}, {"ab", "abc"}, {"b", "b"}, {"c", "a"}, {"aab", "bba"},
+		{"", "c"}, {"e", "eeeeeeee"}, {"dd", "e"}, {"", "eeeeeeeeeeeee"}
+	};
+	for (size_t b = 0; b < sizeof(bounds) / sizeof(bounds[0]); ++b)
+	{
+		tmci t;
+		std::map<std::string, int> m;
+		for (int i = 1; i <= 2000; ++i)
+		{
+			t[range_key(i)] = i;
+			m[range_key(i)] = i;
+		}
+		std::string lo = bounds[b][0], hi = bounds[b][1];
+		size_t expected = 0;
+		if (lo < hi)
+		{
+			std::map<std::string, int>::iterator first = m.lower_bound(lo), last = m.lower_bound(hi);
+			expected = std::distance(first, last);
+			m.erase(first, last);
+		}
+		BOOST_CHECK(t.erase_range(lo, hi) == expected);
+		check_same(t, m);
+		tmci t2(t);
+		BOOST_CHECK(t2.count_node() == t.count_node());
+	}
+}
+
+BOOST_AUTO_TEST_CASE(erase_iterator_range)
+{
+	tmci t;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab", s3 = "bbb";
+	t[s] = 1;
+	t[s1] = 2;
+	t[s2] = 3;
+	t[s3] = 4;
+	tmci::iterator first = t.begin(), last = t.find(s3);
+	++first;
+	t.erase(first, last);
+	BOOST_CHECK(t.size() == 2);
+	BOOST_CHECK(*t.begin() == 1);
+	BOOST_CHECK(*++t.begin() == 4);
+}
+
+BOOST_AUTO_TEST_CASE(split_at)
+{
+	const char *keys[] = {"", "a", "aab", "abcd", "c", "cccccc", "eeeeeeeeeeeeeeeeee"};
+	for (size_t b = 0; b < sizeof(keys) / sizeof(keys[0]); ++b)
+	{
+		tmci t, t2;
+		std::map<std::string, int> m, m2;
+		for (int i = 1; i <= 2000; ++i)
+		{
+			t[range_key(i)] = i;
+			m[range_key(i)] = i;
+		}
+		t2[std::string("old")] = 1;
+		std::string key = keys[b];
+		m2.insert(m.lower_bound(key), m.end());
+		m.erase(m.lower_bound(key), m.end());
+		t.split_at(key, t2);
+		check_same(t, m);
+		check_same(t2, m2);
+		tmci t3(t), t4(t2);
+		BOOST_CHECK(t3.count_node() == t.count_node());
+		BOOST_CHECK(t4.count_node() == t2.count_node());
+		// both halves are still writable
+		t[std::string("aaaaaaa")] = -1;
+		t2[std::string("zzz")] = -2;
+		BOOST_CHECK(t.count(std::string("aaaaaaa")) == 1);
+		BOOST_CHECK(*t2.rbegin() == -2);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(bulk_update)
+{
+	tmci t;
+	std::map<std::string, int> m;
+	for (int i = 1; i <= 500; ++i)
+	{
+		t[range_key(i)] = i;
+		m[range_key(i)] = i;
+	}
+	{
+		boost::tries::bulk_update<tmci> scope(t);
+		for (int i = 400; i <= 3000; ++i)
+		{
+			t[range_key(i)] = -i;
+			m[range_key(i)] = -i;
+		}
+		{
+			// nested scopes end with the outermost one
+			boost::tries::bulk_update<tmci> inner(t);
+			for (int i = 1; i <= 3000; i += 3)
+			{
+				t.erase(range_key(i));
+				m.erase(range_key(i));
+			}
+		}
+		BOOST_CHECK(t.count(range_key(4)) == 0);
+		BOOST_CHECK(*t.find(range_key(2999)) == -2999);
+	}
+	check_same(t, m);
+	BOOST_CHECK(t.count_prefix(std::string("b")) == (size_t)std::distance(m.lower_bound("b"), m.lower_bound("c")));
+	tmci t2(t);
+	BOOST_CHECK(t2.count_node() == t.count_node());
+
+	// erase everything inside a scope
+	t.begin_bulk_update();
+	for (std::map<std::string, int>::iterator i = m.begin(); i != m.end(); ++i)
+		t.erase(i->first);
+	t.end_bulk_update();
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.begin() == t.end());
+	BOOST_CHECK(t.count_node() == 0);
+
+	// a range erase inside a scope ends and sees the earlier changes
+	m.clear();
+	for (int i = 1; i <= 500; ++i)
+	{
+		t[range_key(i)] = i;
+		m[range_key(i)] = i;
+	}
+	{
+		boost::tries::bulk_update<tmci> scope(t);
+		for (int i = 501; i <= 600; ++i)
+		{
+			t[range_key(i)] = i;
+			m[range_key(i)] = i;
+		}
+		tmci::iterator last = t.find(range_key(300));
+		BOOST_CHECK(t.erase(t.begin(), last) == last);
+		m.erase(m.begin(), m.find(range_key(300)));
+		t[range_key(1)] = 1;
+		m[range_key(1)] = 1;
+		BOOST_CHECK(t.erase(t.find(range_key(400)), t.end()) == t.end());
+		m.erase(m.find(range_key(400)), m.end());
+	}
+	check_same(t, m);
+}
+
+BOOST_AUTO_TEST_CASE(save_and_load)
+{
+	tmci t, t2;
+	std::map<std::string, int> m;
+	for (int i = 1; i <= 3000; ++i)
+	{
+		t[range_key(i)] = i;
+		m[range_key(i)] = i;
+	}
+	t2[std::string("old")] = 1;
+	std::stringstream ss;
+	BOOST_CHECK(t.save(ss));
+	std::string image = ss.str();
+	BOOST_CHECK(t2.load(ss));
+	check_same(t2, m);
+	BOOST_CHECK(t2.count(std::string("old")) == 0);
+	BOOST_CHECK(t2.count_node() == t.count_node());
+	BOOST_CHECK(t2.count_prefix(std::string("b")) == t.count_prefix(std::string("b")));
+	BOOST_CHECK(*t2.rbegin() == *t.rbegin());
+	// the loaded trie is an ordinary one
+	t2[std::string("aaaaaaa")] = -1;
+	t2.erase(range_key(1));
+	BOOST_CHECK(t2.size() == t.size());
+
+	tmci e, e2;
+	std::stringstream es;
+	BOOST_CHECK(e.save(es));
+	e2[std::string("x")] = 1;
+	BOOST_CHECK(e2.load(es));
+	BOOST_CHECK(e2.empty());
+	BOOST_CHECK(e2.count_node() == 0);
+
+	// a cut stream leaves an empty trie
+	std::stringstream cut(image.substr(0, image.size() / 2));
+	BOOST_CHECK(!t2.load(cut));
+	BOOST_CHECK(t2.empty());
+	BOOST_CHECK(t2.begin() == t2.end());
+	BOOST_CHECK(t2.count_node() == 0);
+	t2[std::string("ab")] = 2;
+	BOOST_CHECK(*t2.begin() == 2);
+	std::stringstream bad(std::string("not a trie"));
+	BOOST_CHECK(!t2.load(bad));
+	BOOST_CHECK(t2.empty());
+}
+
+// find(), count_prefix() and findLongestPrefixOfKey() for the keys and every
+// string of up to three letters
+void check_lookups(tmci& t, const std::map<std::string, int>& m)
+{
+	check_same(t, m);
+	for (std::map<std::string, int>::const_iterator j = m.begin(); j != m.end(); ++j)
+		BOOST_REQUIRE(t.find(j->first) != t.end() && *t.find(j->first) == j->second);
+	std::vector<std::string> probes(1);
+	for (size_t i = 0; i < probes.size() && probes[i].size() < 3; ++i)
+		for (char c = 'a'; c <= 'f'; ++c)
+			probes.push_back(probes[i] + c);
+	for (size_t i = 0; i < probes.size(); ++i)
+	{
+		const std::string& p = probes[i];
+		std::map<std::string, int>::const_iterator f = m.find(p);
+		BOOST_REQUIRE((t.find(p) == t.end()) == (f == m.end()));
+		size_t n = 0;
+		for (std::map<std::string, int>::const_iterator j = m.lower_bound(p); j != m.end() && j->first.compare(0, p.size(), p) == 0; ++j)
+			++n;
+		BOOST_REQUIRE(t.count_prefix(p) == n);
+		// the empty key is not a prefix match
+		int longest = 0;
+		for (size_t len = 1; len <= p.size(); ++len)
+			if ((f = m.find(p.substr(0, len))) != m.end())
+				longest = f->second;
+		tmci::iterator l = t.findLongestPrefixOfKey(p);
+		BOOST_REQUIRE(longest == 0 ? l == t.end() : (l != t.end() && *l == longest));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(jump_table)
+{
+	for (size_t levels = 1; levels <= 2; ++levels)
+	{
+		tmci t;
+		std::map<std::string, int> m;
+		BOOST_CHECK(t.jump_levels() == 0);
+		t[std::string("ab")] = -1;
+		m["ab"] = -1;
+		// a table on a filled trie
+		BOOST_CHECK(t.set_jump_levels(levels));
+		BOOST_CHECK(t.jump_levels() == levels);
+		for (int i = 1; i <= 3000; ++i)
+		{
+			t[range_key(i)] = i;
+			m[range_key(i)] = i;
+		}
+		check_lookups(t, m);
+
+		// erase by key, by iterator and by prefix, the nodes of the table go too
+		for (int i = 1; i <= 3000; i += 3)
+		{
+			t.erase(range_key(i));
+			m.erase(range_key(i));
+		}
+		for (tmci::iterator i = t.begin(); i != t.end(); )
+		{
+			if (*i % 3 == 2)
+			{
+				std::vector<char> k = i.get_key();
+				m.erase(std::string(k.begin(), k.end()));
+				i = t.erase(i);
+			}
+			else {
+				++i;
+			}
+		}
+		check_lookups(t, m);
+		t.erase_prefix(std::string("b"));
+		m.erase(m.lower_bound("b"), m.lower_bound("c"));
+		t.erase_prefix(std::string("ca"));
+		m.erase(m.lower_bound("ca"), m.lower_bound("cb"));
+		t.erase_range(std::string("d"), std::string("dc"));
+		m.erase(m.lower_bound("d"), m.lower_bound("dc"));
+		check_lookups(t, m);
+		// bounds shorter, as long as and longer than the table
+		const char *bounds[] = { "", "a", "aa", "abc", "ad", "c", "cab", "cb", "e" };
+		for (size_t i = 0; i < 9; ++i)
+			for (size_t j = i + 1; j < 9; ++j)
+			{
+				tmci c(t);
+				std::map<std::string, int> mc(m);
+				c.erase_range(std::string(bounds[i]), std::string(bounds[j]));
+				mc.erase(mc.lower_bound(bounds[i]), mc.lower_bound(bounds[j]));
+				check_lookups(c, mc);
+			}
+
+		// copies, split_at(), swap() and load() carry the table along
+		tmci t2;
+		t2[std::string("f")] = 1;
+		BOOST_CHECK(t2.set_jump_levels(levels));
+		std::map<std::string, int> m2(m.lower_bound("c"), m.end());
+		t.split_at(std::string("c"), t2);
+		m.erase(m.lower_bound("c"), m.end());
+		check_lookups(t, m);
+		BOOST_CHECK(t2.set_jump_levels(levels));
+		check_lookups(t2, m2);
+		tmci t3(t2);
+		BOOST_CHECK(t3.jump_levels() == levels);
+		check_lookups(t3, m2);
+		t3.swap(t);
+		check_lookups(t, m2);
+		check_lookups(t3, m);
+		std::stringstream ss;
+		t3.save(ss);
+		BOOST_CHECK(t.load(ss));
+		check_lookups(t, m);
+		t.clear();
+		BOOST_CHECK(t.find(std::string("ab")) == t.end());
+		t[std::string("ab")] = 1;
+		BOOST_CHECK(*t.find(std::string("ab")) == 1);
+		BOOST_CHECK(t.set_jump_levels(0));
+		BOOST_CHECK(*t.find(std::string("ab")) == 1);
+	}
+
+	// byte keys in the default order only, and at most two levels
+	tmci t;
+	BOOST_CHECK(!t.set_jump_levels(3));
+	BOOST_CHECK(t.jump_levels() == 0);
+	boost::tries::trie_map<int, int> ti;
+	BOOST_CHECK(!ti.set_jump_levels(1));
+	BOOST_CHECK(ti.set_jump_levels(0));
+	boost::tries::trie_map<char, int, std::greater<char> > tg;
+	BOOST_CHECK(!tg.set_jump_levels(1));
+}
+
 BOOST_AUTO_TEST_CASE(erase_iterator)
 {
 	boost::tries::trie_map<char, int> t;
@@ -478,4 +877,51 @@ BOOST_AUTO_TEST_CASE(get_key_reverse_test)
 		BOOST_CHECK(i.get_key() == j.get_key());
 	}
 }
+BOOST_AUTO_TEST_CASE(inline_value)
+{
+	typedef boost::tries::trie_map<char, std::string> tmcs;
+	typedef boost::tries::trie<char, std::string, std::less<char> > multi_trie;
+	// the value lives in the node, with no array of values to point at
+	BOOST_CHECK(sizeof(tmcs::trie_type::node_type) < sizeof(multi_trie::node_type) + sizeof(std::string));
+	tmcs t;
+	std::map<std::string, std::string> m;
+	for (int i = 1; i <= 1000; ++i)
+	{
+		std::string v(i % 40, char('a' + i % 26));
+		t[range_key(i)] = v;
+		m[range_key(i)] = v;
+	}
+	BOOST_CHECK(!t.insert(range_key(7), std::string("x")).second);
+	BOOST_CHECK(*t.find(range_key(7)) == m[range_key(7)]);
+	t[range_key(7)] = "seven";
+	m[range_key(7)] = "seven";
+	// erase every other value by iterator
+	tmcs::iterator it = t.begin();
+	for (std::map<std::string, std::string>::iterator mi = m.begin(); mi != m.end(); )
+	{
+		BOOST_REQUIRE(*it == mi->second);
+		it = t.erase(it);
+		m.erase(mi++);
+		if (mi == m.end())
+			break;
+		BOOST_REQUIRE(*it == mi->second);
+		++it;
+		++mi;
+	}
+	BOOST_CHECK(t.size() == m.size());
+	tmcs t2(t), t3;
+	t3[std::string("old")] = "old";
+	t2.swap(t3);
+	BOOST_CHECK(t3.size() == m.size());
+	BOOST_CHECK(*t2.begin() == "old");
+	t3.split_at(std::string("b"), t2);
+	BOOST_CHECK(t3.size() + t2.size() == m.size());
+	BOOST_CHECK(*t2.begin() == m.lower_bound("b")->second);
+	std::stringstream ss;
+	BOOST_CHECK(t3.save(ss));
+	tmcs t4;
+	BOOST_CHECK(t4.load(ss));
+	BOOST_CHECK(t4.size() == t3.size());
+	BOOST_CHECK(*t4.rbegin() == *t3.rbegin());
+}
 BOOST_AUTO_TEST_SUITE_END()
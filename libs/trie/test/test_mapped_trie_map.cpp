@@ -0,0 +1,226 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/trie_map.hpp"
+#include "boost/trie/trie_multimap.hpp"
+#include "boost/trie/mapped_trie_map.hpp"
+// multi include test
+#include "boost/trie/mapped_trie_map.hpp"
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <iterator>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::trie_map<char, int> tmci;
+typedef boost::tries::mapped_trie_map<char, int> mtci;
+typedef boost::tries::trie_multimap<char, std::string> tmmcs;
+typedef boost::tries::mapped_trie_map<char, std::string> mtcs;
+
+std::string make_key(int i)
+{
+	std::string k;
+	for (int j = i; j > 0; j /= 6)
+		k += char('a' + j % 6);
+	return k;
+}
+
+std::string image_path(const char *name)
+{
+	return std::string("test_mapped_trie_map_") + name + ".img";
+}
+
+BOOST_AUTO_TEST_CASE(find_test)
+{
+	tmci t;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab", s3 = "bbb";
+	t[s] = 1;
+	t[s1] = 2;
+	t[s2] = 3;
+	t[s3] = 4;
+	std::string path = image_path("find");
+	BOOST_REQUIRE(t.freeze().save(path));
+	mtci m;
+	BOOST_CHECK(!m.is_open());
+	BOOST_CHECK(m.empty());
+	BOOST_CHECK(m.find(s) == m.end());
+	BOOST_REQUIRE(m.open(path));
+	BOOST_CHECK(m.is_open());
+	BOOST_CHECK(m.size() == 4);
+	BOOST_CHECK(m.count_node() == t.count_node());
+	BOOST_CHECK(*m.find(s) == 1);
+	BOOST_CHECK(*m.find(s1) == 2);
+	BOOST_CHECK(*m.find(s2) == 3);
+	BOOST_CHECK(*m.find(s3) == 4);
+	BOOST_CHECK(m.find(std::string("aa")) == m.end());
+	BOOST_CHECK(m.find(std::string("c")) == m.end());
+	BOOST_CHECK(m.count(s1) == 1);
+	BOOST_CHECK(m.count_prefix(std::string("aa")) == 3);
+	BOOST_CHECK(m.count_prefix(std::string("")) == 4);
+	mtci::iterator_range r = m.find_prefix(std::string("aa"));
+	BOOST_CHECK(r.second - r.first == 3);
+	BOOST_CHECK(*m.findLongestPrefixOfKey(std::string("aaabc")) == 1);
+	BOOST_CHECK(*m.findLongestPrefixOfKey(std::string("aaaab")) == 2);
+	BOOST_CHECK(m.findLongestPrefixOfKey(std::string("ab")) == m.end());
+	m.close();
+	BOOST_CHECK(!m.is_open());
+	BOOST_CHECK(m.size() == 0);
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(iterator_test)
+{
+	tmci t;
+	for (int i = 1; i < 3000; ++i)
+		t[make_key(i)] = i;
+	std::string path = image_path("iterator");
+	BOOST_REQUIRE(t.freeze().save(path));
+	mtci m(path);
+	BOOST_REQUIRE(m.is_open());
+	BOOST_CHECK(m.size() == t.size());
+	tmci::iterator ti = t.begin();
+	mtci::const_iterator mi = m.begin();
+	for (; ti != t.end(); ++ti, ++mi)
+	{
+		BOOST_REQUIRE(mi != m.end());
+		BOOST_REQUIRE(*mi == *ti);
+		BOOST_REQUIRE(mi.get_key() == ti.get_key());
+	}
+	BOOST_CHECK(mi == m.end());
+	BOOST_CHECK(*m.rbegin() == *t.rbegin());
+	for (int i = 1; i < 3000; i += 7)
+		BOOST_REQUIRE(*m.find(make_key(i)) == i);
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(string_value_test)
+{
+	tmmcs t;
+	std::string s = "aaa", s1 = "ab", s2 = "b";
+	t.insert(s, "one");
+	t.insert(s, "");
+	t.insert(s1, "three");
+	t.insert(s2, "four");
+	std::string path = image_path("string");
+	BOOST_REQUIRE(t.freeze().save(path));
+	mtcs m;
+	BOOST_REQUIRE(m.open(path));
+	BOOST_CHECK(m.size() == 4);
+	BOOST_CHECK(m.count(s) == 2);
+	tmmcs::iterator ti = t.begin();
+	for (mtcs::const_iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+		BOOST_CHECK(std::string(mi->begin(), mi->end()) == *ti);
+	BOOST_CHECK(*m.find(s1) == "three");
+	mtcs::iterator_range r = m.find_prefix(std::string("a"));
+	BOOST_CHECK(r.second - r.first == 3);
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(bad_image_test)
+{
+	tmci t;
+	t[std::string("abc")] = 1;
+	std::string path = image_path("bad");
+	BOOST_REQUIRE(t.freeze().save(path));
+	mtci m;
+	// written for another value type
+	mtcs ms;
+	BOOST_CHECK(!ms.open(path));
+	BOOST_CHECK(!ms.is_open());
+	BOOST_CHECK(!m.open(image_path("missing")));
+	{
+		std::ofstream os(path.c_str(), std::ios::binary | std::ios::trunc);
+		os << "not a trie image";
+	}
+	BOOST_CHECK(!m.open(path));
+	BOOST_CHECK(m.empty());
+	std::remove(path.c_str());
+}
+
+void write_file(const std::string& path, const std::string& data)
+{
+	std::ofstream os(path.c_str(), std::ios::binary | std::ios::trunc);
+	os.write(data.data(), data.size());
+}
+
+// walks everything a query can reach in an opened image
+void walk_image(const mtcs& m)
+{
+	size_t n = 0;
+	for (mtcs::const_iterator i = m.begin(); i != m.end(); ++i)
+	{
+		n += i->size();
+		std::vector<char> k = i.get_key();
+		m.find(k);
+		m.count_prefix(k);
+		m.findLongestPrefixOfKey(k);
+	}
+	BOOST_CHECK(n < (1u << 20));
+}
+
+BOOST_AUTO_TEST_CASE(corrupt_image_test)
+{
+	tmmcs t;
+	for (int i = 1; i < 40; ++i)
+		t.insert(make_key(i), std::string(i % 5, 'x'));
+	std::string path = image_path("corrupt");
+	BOOST_REQUIRE(t.freeze().save(path));
+	std::string good;
+	{
+		std::ifstream is(path.c_str(), std::ios::binary);
+		good.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+	}
+	mtcs m;
+	// every bit flipped past the magic: the image is refused, or every walk
+	// stays in the mapping
+	for (size_t n = 64; n < good.size() * 8; ++n)
+	{
+		std::string bad = good;
+		bad[n / 8] ^= char(1 << (n % 8));
+		write_file(path, bad);
+		if (m.open(path))
+			walk_image(m);
+		else
+			BOOST_CHECK(m.empty());
+	}
+	// every truncation
+	for (size_t n = 0; n < good.size(); ++n)
+	{
+		write_file(path, good.substr(0, n));
+		BOOST_CHECK(!m.open(path));
+	}
+	// a blob size that wraps the end of the blob around
+	std::string bad = good;
+	boost::uint64_t huge = boost::uint64_t(0) - 8;
+	std::memcpy(&bad[offsetof(boost::tries::detail::trie_image_header, blob_size)], &huge, sizeof(huge));
+	write_file(path, bad);
+	BOOST_CHECK(!m.open(path));
+	write_file(path, good);
+	BOOST_REQUIRE(m.open(path));
+	walk_image(m);
+	BOOST_CHECK(m.size() == t.size());
+	m.close();
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(empty_test)
+{
+	tmci t;
+	std::string path = image_path("empty");
+	BOOST_REQUIRE(t.freeze().save(path));
+	mtci m;
+	BOOST_REQUIRE(m.open(path));
+	BOOST_CHECK(m.empty());
+	BOOST_CHECK(m.begin() == m.end());
+	BOOST_CHECK(m.count_node() == 0);
+	BOOST_CHECK(m.find(std::string("a")) == m.end());
+	std::remove(path.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,7 @@
 
 #include <string>
 #include <iostream>
+#include <sstream>
 
 BOOST_AUTO_TEST_SUITE(trie_test)
 
@@ -315,4 +316,99 @@ BOOST_AUTO_TEST_CASE(get_key_test)
 	BOOST_CHECK(*j == 4);
 }
 */
+BOOST_AUTO_TEST_CASE(split_and_erase_range)
+{
+	tci t, t2;
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab", s3 = "bbb";
+	t.insert(s, 1);
+	t.insert(s, 2);
+	t.insert(s1, 3);
+	t.insert(s2, 4);
+	t.insert(s2, 5);
+	t.insert(s3, 6);
+	t.split_at(s2, t2);
+	BOOST_CHECK(t.size() == 3);
+	BOOST_CHECK(t2.size() == 3);
+	BOOST_CHECK(t2.count(s2) == 2);
+	BOOST_CHECK(t.count_prefix(std::string("a")) == 3);
+	// values of one key are kept newest first
+	int expected[] = {5, 4, 6}, j = 0;
+	for (iter_type i = t2.begin(); i != t2.end(); ++i, ++j)
+		BOOST_CHECK(*i == expected[j]);
+	BOOST_CHECK(j == 3);
+	BOOST_CHECK(t2.erase_range(std::string("aa"), std::string("bbb")) == 2);
+	BOOST_CHECK(t2.size() == 1);
+	BOOST_CHECK(*t2.begin() == 6);
+	BOOST_CHECK(t.erase_range(std::string("aaa"), std::string("aaaa")) == 2);
+	BOOST_CHECK(*t.begin() == 3);
+	BOOST_CHECK(t.size() == 1);
+	BOOST_CHECK(t.count_node() == 4);
+}
+
+BOOST_AUTO_TEST_CASE(save_and_load)
+{
+	boost::tries::trie_multimap<char, std::string> t, t2;
+	std::string s = "aaa", s1 = "aab", s2 = "b";
+	t.insert(s, "one");
+	t.insert(s, "two");
+	t.insert(s, "");
+	t.insert(s1, "three");
+	t.insert(s2, "four");
+	std::stringstream ss;
+	BOOST_CHECK(t.save(ss));
+	BOOST_CHECK(t2.load(ss));
+	BOOST_CHECK(t2.size() == t.size());
+	BOOST_CHECK(t2.count(s) == 3);
+	BOOST_CHECK(t2.count_node() == t.count_node());
+	// the values of a key keep their order
+	boost::tries::trie_multimap<char, std::string>::iterator i = t.begin(), j = t2.begin();
+	for (; i != t.end(); ++i, ++j)
+	{
+		BOOST_CHECK(*i == *j);
+		BOOST_CHECK(i.get_key() == j.get_key());
+	}
+	BOOST_CHECK(j == t2.end());
+}
+
+BOOST_AUTO_TEST_CASE(value_span)
+{
+	tci t;
+	std::string s = "aaa", s1 = "aab";
+	BOOST_CHECK(t.value_span(s).first == t.value_span(s).second);
+	for (int i = 0; i < 1000; ++i)
+		t.insert(s, i);
+	t.insert(s1, -1);
+	tci::value_span_type vs = t.value_span(s);
+	BOOST_REQUIRE(vs.second - vs.first == 1000);
+	// oldest first, equal_range() goes the other way
+	for (int i = 0; i < 1000; ++i)
+		BOOST_REQUIRE(vs.first[i] == i);
+	tci::iterator_range r = t.equal_range(s);
+	int n = 999;
+	for (iter_type i = r.first; i != r.second; ++i, --n)
+		BOOST_REQUIRE(*i == n);
+	BOOST_CHECK(n == -1);
+	BOOST_CHECK(*r.second == -1);
+
+	// erase the odd values by iterator
+	for (iter_type i = t.find(s); i != t.end() && i.get_key().size() == 3 && *i >= 0; )
+	{
+		if (*i % 2)
+			i = t.erase(i);
+		else
+			++i;
+	}
+	BOOST_CHECK(t.count(s) == 500);
+	vs = t.value_span(s);
+	for (int i = 0; i < 500; ++i)
+		BOOST_REQUIRE(vs.first[i] == 2 * i);
+	tci t2(t);
+	BOOST_CHECK(t2.count(s) == 500);
+	BOOST_CHECK(*t2.find(s) == 998);
+	t.split_at(s, t2);
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t2.size() == 501);
+	BOOST_CHECK(t2.value_span(s).first[499] == 998);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -215,6 +215,34 @@ BOOST_AUTO_TEST_CASE(reverse_iterator_test)
 	}
 	BOOST_CHECK_MESSAGE(count == a.size(), count);
 }
+BOOST_AUTO_TEST_CASE(counted_value_test)
+{
+	typedef boost::tries::trie<char, int, std::less<char> > value_trie;
+	// a multiset only counts the copies of a key
+	BOOST_CHECK(sizeof(tmsi::trie_type::node_type) < sizeof(value_trie::node_type));
+	tmsi a;
+	std::string s = "aaa", s2 = "ab";
+	for (int i = 0; i < 10000; ++i)
+		a.insert(s);
+	a.insert(s2);
+	BOOST_CHECK(a.count(s) == 10000);
+	BOOST_CHECK(a.size() == 10001);
+	ti i = a.find(s);
+	for (int j = 0; j < 5000; ++j)
+		i = a.erase(i);
+	BOOST_CHECK(a.count(s) == 5000);
+	BOOST_CHECK(a.find(s) == i);
+	int n = 0;
+	std::pair<ti, ti> r = a.equal_range(s);
+	for (; r.first != r.second; ++r.first)
+		++n;
+	BOOST_CHECK(n == 5000);
+	BOOST_CHECK(r.second.get_key() == std::vector<char>(s2.begin(), s2.end()));
+	rti ri = a.rbegin();
+	++ri;
+	BOOST_CHECK(ri.get_key() == std::vector<char>(s.begin(), s.end()));
+}
+
 /*
 BOOST_AUTO_TEST_CASE(insert_and_find_test)
 {
@@ -0,0 +1,235 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/paged_trie_map.hpp"
+// multi include test
+#include "boost/trie/paged_trie_map.hpp"
+#include "boost/trie/trie.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <cstdio>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::paged_trie_map<char, int> ptci;
+typedef std::map<std::string, int> smap;
+
+// 36 different first characters, more than a 256 byte trie page holds
+std::string make_key(int i)
+{
+	static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+	std::string k;
+	for (int j = i; j > 0; j /= 36)
+		k += digits[j % 36];
+	return k;
+}
+
+std::string db_path(const char *name)
+{
+	return std::string("test_paged_trie_map_") + name + ".db";
+}
+
+void remove_db(const std::string& path)
+{
+	std::remove(path.c_str());
+	std::remove((path + ".wal").c_str());
+}
+
+void copy_file(const std::string& from, const std::string& to)
+{
+	std::ifstream is(from.c_str(), std::ios::binary);
+	std::ofstream os(to.c_str(), std::ios::binary | std::ios::trunc);
+	os << is.rdbuf();
+}
+
+void check_same(const ptci& t, const smap& m)
+{
+	BOOST_REQUIRE(t.size() == m.size());
+	ptci::const_iterator ti = t.begin();
+	for (smap::const_iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+	{
+		BOOST_REQUIRE(ti != t.end());
+		std::vector<char> k = ti.get_key();
+		BOOST_REQUIRE(std::string(k.begin(), k.end()) == mi->first);
+		BOOST_REQUIRE(*ti == mi->second);
+	}
+	BOOST_CHECK(ti == t.end());
+}
+
+BOOST_AUTO_TEST_CASE(insert_and_find_test)
+{
+	std::string path = db_path("basic");
+	remove_db(path);
+	ptci t;
+	BOOST_CHECK(!t.is_open());
+	BOOST_REQUIRE(t.open(path));
+	std::string s = "aaa", s1 = "aaaa", s2 = "aab", s3 = "bbb";
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.insert(s, 1).second);
+	BOOST_CHECK(!t.insert(s, 2).second);
+	BOOST_CHECK(*t.find(s) == 1);
+	BOOST_CHECK(t.insert_or_assign(s, 2) == false);
+	BOOST_CHECK(*t.find(s) == 2);
+	BOOST_CHECK(*t.insert(s1, 3).first == 3);
+	BOOST_CHECK(t.insert_or_assign(s2, 4));
+	BOOST_CHECK(t.insert(std::string(), 5).second);
+	// a key that is there comes back with the value it keeps
+	ptci::pair_iterator_bool p = t.insert(s1, 7);
+	BOOST_CHECK(!p.second && *p.first == 3);
+	std::vector<char> k = p.first.get_key();
+	BOOST_CHECK(p.first == t.find(s1) && std::string(k.begin(), k.end()) == s1);
+	BOOST_CHECK(*++p.first == 4);
+	BOOST_CHECK(t.find(s3) == t.end());
+	BOOST_CHECK(t.count(s1) == 1);
+	BOOST_CHECK(t.count(std::string()) == 1);
+	BOOST_CHECK(t.size() == 4);
+	BOOST_CHECK(t.count_prefix(std::string("aa")) == 3);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("aaab")) == 2);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("b")) == 5);
+	BOOST_CHECK(t.erase(s3) == 0);
+	BOOST_CHECK(t.erase(s1) == 1);
+	BOOST_CHECK(t.erase(s1) == 0);
+	BOOST_CHECK(t.size() == 3);
+	t.clear();
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.begin() == t.end());
+	BOOST_CHECK(t.count(s) == 0);
+	t.close();
+	remove_db(path);
+}
+
+BOOST_AUTO_TEST_CASE(many_keys_test)
+{
+	std::string path = db_path("many");
+	remove_db(path);
+	smap m;
+	{
+		// small pages and a small cache force bursts, page chains and evictions
+		ptci t(path, 8, 256);
+		BOOST_REQUIRE(t.is_open());
+		boost::tries::bulk_update<ptci> scope(t);
+		for (int i = 1; i <= 6000; ++i)
+		{
+			t.insert(make_key(i * 7919 % 6007), i);
+			m[make_key(i * 7919 % 6007)] = i;
+		}
+	}
+	ptci t;
+	BOOST_REQUIRE(t.open(path, 16));
+	check_same(t, m);
+	for (int i = 1; i <= 6000; i += 3)
+	{
+		BOOST_REQUIRE(t.erase(make_key(i)) == m.erase(make_key(i)));
+	}
+	check_same(t, m);
+	BOOST_CHECK(t.good());
+
+	std::string p = "a";
+	size_t n = 0;
+	for (smap::iterator i = m.lower_bound(p); i != m.end() && i->first.compare(0, p.size(), p) == 0; ++i)
+		++n;
+	BOOST_CHECK(t.count_prefix(p) == n);
+	ptci::iterator_range r = t.find_prefix(p);
+	BOOST_CHECK(size_t(std::distance(r.first, r.second)) == n);
+	BOOST_CHECK(t.count_prefix(std::string("zzzz")) == 0);
+	r = t.find_prefix(std::string("zzzz"));
+	BOOST_CHECK(r.first == r.second);
+	ptci::const_iterator lb = t.lower_bound(std::string("b1"));
+	std::vector<char> k = lb.get_key();
+	BOOST_CHECK(std::string(k.begin(), k.end()) == m.lower_bound("b1")->first);
+	ptci::const_iterator ub = t.upper_bound(m.begin()->first);
+	k = ub.get_key();
+	BOOST_CHECK(std::string(k.begin(), k.end()) == (++m.begin())->first);
+
+	// erase everything, the pages go back to the free list
+	size_t pages = t.count_page();
+	for (smap::iterator i = m.begin(); i != m.end(); ++i)
+		BOOST_REQUIRE(t.erase(i->first) == 1);
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_page() < pages);
+	BOOST_CHECK(t.begin() == t.end());
+	t.close();
+	remove_db(path);
+}
+
+BOOST_AUTO_TEST_CASE(recovery_test)
+{
+	std::string path = db_path("crash"), copy = db_path("crash_copy");
+	remove_db(path);
+	remove_db(copy);
+	smap m;
+	ptci t(path, 8, 256);
+	BOOST_REQUIRE(t.is_open());
+	for (int i = 1; i <= 500; ++i)
+	{
+		t.insert(make_key(i), i);
+		m[make_key(i)] = i;
+	}
+	t.checkpoint();
+	for (int i = 501; i <= 1500; ++i)
+	{
+		t.insert(make_key(i), i);
+		m[make_key(i)] = i;
+	}
+	t.erase(make_key(7));
+	m.erase(make_key(7));
+	// a copy taken now is what a crash would leave: the log has every commit,
+	// the data file only some of the pages
+	copy_file(path, copy);
+	copy_file(path + ".wal", copy + ".wal");
+	{
+		ptci c;
+		BOOST_REQUIRE(c.open(copy));
+		check_same(c, m);
+	}
+	// a log cut in the middle of a commit keeps the commits before it
+	std::ifstream is((path + ".wal").c_str(), std::ios::binary);
+	std::string log((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+	copy_file(path, copy);
+	{
+		std::ofstream os((copy + ".wal").c_str(), std::ios::binary | std::ios::trunc);
+		os.write(log.data(), log.size() - 10);
+	}
+	{
+		ptci c;
+		BOOST_REQUIRE(c.open(copy));
+		// the last commit was the erase
+		BOOST_CHECK(c.size() == m.size() + 1);
+		BOOST_CHECK(c.count(make_key(7)) == 1);
+		BOOST_CHECK(c.count(make_key(1500)) == 1);
+	}
+	t.close();
+	remove_db(path);
+	remove_db(copy);
+}
+
+BOOST_AUTO_TEST_CASE(bad_file_test)
+{
+	std::string path = db_path("bad");
+	remove_db(path);
+	{
+		std::ofstream os(path.c_str(), std::ios::binary);
+		os << "not a paged trie at all, but long enough to hold a header";
+	}
+	ptci t;
+	BOOST_CHECK(!t.open(path));
+	BOOST_CHECK(!t.is_open());
+	BOOST_CHECK(t.find(std::string("a")) == t.end());
+	remove_db(path);
+	{
+		ptci t2(path);
+		t2.insert(std::string("a"), 1);
+	}
+	// written for another value type
+	boost::tries::paged_trie_map<char, double> d;
+	BOOST_CHECK(!d.open(path));
+	BOOST_CHECK(t.open(path));
+	BOOST_CHECK(*t.find(std::string("a")) == 1);
+	t.close();
+	remove_db(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
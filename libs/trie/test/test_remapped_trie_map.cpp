@@ -0,0 +1,180 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/remapped_trie_map.hpp"
+// multi include test
+#include "boost/trie/remapped_trie_map.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <sstream>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::remapped_trie_map<int> rti;
+typedef std::map<std::string, int> smap;
+
+std::string key_string(const std::vector<char>& k)
+{
+	return std::string(k.begin(), k.end());
+}
+
+void check_same(const rti& t, const smap& m)
+{
+	BOOST_REQUIRE(t.size() == m.size());
+	rti::const_iterator ti = t.begin();
+	for (smap::const_iterator mi = m.begin(); mi != m.end(); ++mi, ++ti)
+	{
+		BOOST_REQUIRE(ti != t.end());
+		BOOST_REQUIRE(key_string(ti.get_key()) == mi->first);
+		BOOST_REQUIRE(*ti == mi->second);
+	}
+	BOOST_CHECK(ti == t.end());
+	rti::const_reverse_iterator ri = t.rbegin();
+	for (smap::const_reverse_iterator mi = m.rbegin(); mi != m.rend(); ++mi, ++ri)
+	{
+		BOOST_REQUIRE(ri != t.rend());
+		BOOST_REQUIRE(*ri == mi->second);
+	}
+	BOOST_CHECK(ri == t.rend());
+}
+
+BOOST_AUTO_TEST_CASE(alphabet_test)
+{
+	boost::tries::byte_alphabet a(std::string("cabbage"));
+	BOOST_CHECK(a.size() == 5);
+	BOOST_CHECK(a.code('a') == 0);
+	BOOST_CHECK(a.code('g') == 4);
+	BOOST_CHECK(a.code('z') == -1);
+	BOOST_CHECK(a.symbol(2) == 'c');
+	// the codes keep the unsigned byte order
+	std::string high = "\xe9!";
+	a.add(high.begin(), high.end());
+	BOOST_CHECK(a.code('!') == 0);
+	BOOST_CHECK(a.code('\xe9') == 6);
+	BOOST_CHECK(a.contains('b') && !a.contains('z'));
+
+	std::vector<std::string> keys;
+	keys.push_back("x1");
+	keys.push_back("y22");
+	boost::tries::byte_alphabet b;
+	b.scan(keys.begin(), keys.end());
+	BOOST_CHECK(b == boost::tries::byte_alphabet(std::string("12xy")));
+	BOOST_CHECK(b != a);
+
+	std::stringstream ss;
+	a.save(ss);
+	boost::tries::byte_alphabet c;
+	BOOST_CHECK(c.load(ss));
+	BOOST_CHECK(c == a);
+	BOOST_CHECK(c.code('\xe9') == 6);
+}
+
+BOOST_AUTO_TEST_CASE(insert_and_find_test)
+{
+	rti t(boost::tries::byte_alphabet(std::string("abc")));
+	std::string s = "abc", s1 = "abca", s2 = "abb", s3 = "ccc";
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.insert(s, 1).second);
+	BOOST_CHECK(!t.insert(s, 2).second);
+	t[s1] = 3;
+	t[s2] = 4;
+	BOOST_CHECK(*t.find(s) == 1);
+	BOOST_CHECK(t.find(s3) == t.end());
+	BOOST_CHECK(t.count_node() == 5);
+	BOOST_CHECK(t.count_prefix(std::string("ab")) == 3);
+	BOOST_CHECK(*t.findLongestPrefixOfKey(std::string("abcb")) == 1);
+	// a byte outside the alphabet
+	BOOST_CHECK(t.insert(std::string("abd"), 5).first == t.end());
+	BOOST_CHECK(t.find(std::string("abd")) == t.end());
+	BOOST_CHECK(t.count_node() == 5);
+	BOOST_CHECK(key_string(t.begin().get_key()) == s2);
+	BOOST_CHECK(t.erase(s) == 1);
+	BOOST_CHECK(t.size() == 2);
+	t.clear();
+	BOOST_CHECK(t.empty());
+	// clear() keeps the alphabet
+	BOOST_CHECK(t.insert(s, 1).second);
+
+	// the default map only takes the empty key
+	rti e;
+	BOOST_CHECK(e.alphabet().size() == 0);
+	BOOST_CHECK(!e.insert(s, 1).second);
+	BOOST_CHECK(e.insert(std::string(), 1).second);
+}
+
+// about 40 of the 256 bytes, some above 127
+std::string make_key(unsigned r)
+{
+	static const std::string symbols = "abcdefghijklmnopqrstuvwxyz0123456789-_\xc3\xa9";
+	std::string k;
+	for (unsigned len = r % 6; len > 0; --len, r /= 7)
+		k += symbols[(r >> 3) % symbols.size()];
+	return k;
+}
+
+BOOST_AUTO_TEST_CASE(random_against_map)
+{
+	std::vector<std::string> sample;
+	unsigned seed = 11;
+	for (int i = 0; i < 3000; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		sample.push_back(make_key(seed >> 4));
+	}
+	boost::tries::byte_alphabet a;
+	a.scan(sample.begin(), sample.end());
+	BOOST_CHECK(a.size() <= 40);
+	rti t(a);
+	smap m;
+	for (size_t i = 0; i < sample.size(); ++i)
+	{
+		if (i % 5 == 4)
+		{
+			BOOST_CHECK(t.erase(sample[i / 2]) == m.erase(sample[i / 2]));
+		}
+		else {
+			BOOST_CHECK(t.insert(sample[i], int(i)).second == m.insert(std::make_pair(sample[i], int(i))).second);
+		}
+	}
+	check_same(t, m);
+
+	std::stringstream ss;
+	BOOST_CHECK(t.save(ss));
+	rti t2;
+	BOOST_CHECK(t2.load(ss));
+	BOOST_CHECK(t2.alphabet() == a);
+	check_same(t2, m);
+	BOOST_CHECK(t2.count_node() == t.count_node());
+	BOOST_CHECK(t2.count_prefix(std::string("a")) == t.count_prefix(std::string("a")));
+
+	t2.swap(t);
+	check_same(t, m);
+}
+
+BOOST_AUTO_TEST_CASE(bad_stream)
+{
+	rti t(boost::tries::byte_alphabet(std::string("ab")));
+	t[std::string("ab")] = 1;
+	t[std::string("b")] = 2;
+	std::stringstream ss;
+	t.save(ss);
+	std::string good = ss.str();
+	for (size_t n = 0; n < good.size(); ++n)
+	{
+		std::istringstream is(good.substr(0, n));
+		rti u(boost::tries::byte_alphabet(std::string("xyz")));
+		u[std::string("x")] = 1;
+		BOOST_CHECK(!u.load(is));
+		// left empty with its own alphabet
+		BOOST_CHECK(u.empty());
+		BOOST_CHECK(u.alphabet().size() == 3);
+	}
+	std::istringstream is(good);
+	rti u;
+	BOOST_CHECK(u.load(is));
+	BOOST_CHECK(*u.find(std::string("b")) == 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -7,6 +7,8 @@
 
 #include <string>
 #include <iostream>
+#include <set>
+#include <iterator>
 
 BOOST_AUTO_TEST_SUITE(trie_test)
 
@@ -33,6 +35,152 @@ BOOST_AUTO_TEST_CASE(insert_test)
 	BOOST_CHECK(t.insert(s2).second == true);
 }
 
+BOOST_AUTO_TEST_CASE(inline_value_test)
+{
+	typedef boost::tries::trie<char, boost::blank, std::less<char> > multi_trie;
+	// the blank values are not stored, the node only knows the key is there
+	BOOST_CHECK(sizeof(tsci::trie_type::node_type) < sizeof(multi_trie::node_type));
+	tsci t;
+	std::string s = "ab", s1 = "abc", s2 = "b";
+	t.insert(s);
+	t.insert(s1);
+	t.insert(s2);
+	BOOST_CHECK(t.size() == 3);
+	BOOST_CHECK(t.count(s1) == 1);
+	tci i = t.begin();
+	BOOST_CHECK(i.get_key() == std::vector<char>(s.begin(), s.end()));
+	++i;
+	BOOST_CHECK(i.get_key() == std::vector<char>(s1.begin(), s1.end()));
+	t.erase(s1);
+	BOOST_CHECK(t.count(s1) == 0);
+	BOOST_CHECK(t.count_prefix(s) == 1);
+	tsci t2(t);
+	BOOST_CHECK(t2.size() == 2);
+}
+
+// the parts of check_features that need a feature
+template <class Set>
+void check_order(Set& t, const std::set<std::string>& ref, boost::true_type)
+{
+	std::set<std::string>::const_iterator ri = ref.begin();
+	for (typename Set::iterator i = t.begin(); i != t.end(); ++i, ++ri)
+	{
+		std::vector<char> k = i.get_key();
+		BOOST_REQUIRE(ri != ref.end());
+		BOOST_CHECK(std::string(k.begin(), k.end()) == *ri);
+	}
+	BOOST_CHECK(ri == ref.end());
+}
+
+template <class Set>
+void check_order(Set&, const std::set<std::string>&, boost::false_type)
+{
+}
+
+template <class Set>
+void check_prefix_counts(Set& t, const std::set<std::string>& ref, boost::true_type)
+{
+	const char * prefixes[] = { "", "a", "b", "ab", "ba", "abc" };
+	for (size_t j = 0; j < sizeof(prefixes) / sizeof(prefixes[0]); ++j)
+	{
+		std::string p = prefixes[j];
+		size_t n = 0;
+		for (std::set<std::string>::const_iterator i = ref.begin(); i != ref.end(); ++i)
+			if (i->compare(0, p.size(), p) == 0)
+				++n;
+		BOOST_CHECK(t.count_prefix(p) == n);
+	}
+}
+
+template <class Set>
+void check_prefix_counts(Set&, const std::set<std::string>&, boost::false_type)
+{
+}
+
+// random inserts and erasions against std::set, with and without bulk updates
+// and jump tables; the empty key is left out, it is kept on the root
+template <class Features>
+void check_features(size_t jump_levels = 0)
+{
+	typedef boost::tries::trie_set<char, std::less<char>, Features> set_type;
+	typedef boost::integral_constant<bool, Features::ordered_list> ordered;
+	typedef boost::integral_constant<bool, Features::value_counts> counted;
+	set_type t;
+	BOOST_CHECK(t.set_jump_levels(jump_levels));
+	std::set<std::string> ref;
+	unsigned seed = 7;
+	for (int round = 0; round < 2000; ++round)
+	{
+		seed = seed * 1103515245u + 12345u;
+		std::string k;
+		for (unsigned len = 1 + (seed >> 8) % 4, r = seed >> 12; len > 0; --len, r /= 3)
+			k += char('a' + r % 3);
+		int op = (seed >> 24) % 8;
+		if (op < 5)
+		{
+			BOOST_CHECK(t.insert(k).second == ref.insert(k).second);
+		}
+		else if (op < 7)
+		{
+			BOOST_CHECK(t.erase_node(k) == ref.erase(k));
+		}
+		else {
+			std::string hi = k + "b";
+			BOOST_CHECK(t.erase_range(k, hi) == size_t(std::distance(ref.lower_bound(k), ref.lower_bound(hi))));
+			ref.erase(ref.lower_bound(k), ref.lower_bound(hi));
+		}
+		if (round % 500 == 0)
+		{
+			boost::tries::bulk_update<set_type> scope(t);
+			for (int j = 0; j < 20; ++j)
+			{
+				std::string b(1, char('a' + j % 3));
+				b += char('a' + j / 3 % 3);
+				t.insert(b);
+				ref.insert(b);
+			}
+			std::string e = "c";
+			t.erase_node(e);
+			ref.erase(e);
+		}
+		BOOST_REQUIRE(t.size() == ref.size());
+	}
+	for (std::set<std::string>::const_iterator i = ref.begin(); i != ref.end(); ++i)
+		BOOST_CHECK(t.count(*i) == 1);
+	check_order(t, ref, ordered());
+	check_prefix_counts(t, ref, counted());
+	set_type t2(t);
+	BOOST_CHECK(t2.jump_levels() == jump_levels);
+	BOOST_CHECK(t2.size() == ref.size());
+	check_order(t2, ref, ordered());
+	check_prefix_counts(t2, ref, counted());
+	t.clear();
+	BOOST_CHECK(t.empty());
+	BOOST_CHECK(t.count_node() == 0);
+	t.swap(t2);
+	BOOST_CHECK(t.size() == ref.size() && t2.size() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(feature_policy_test)
+{
+	using boost::tries::trie_features;
+	check_features<trie_features<> >();
+	check_features<trie_features<true, true, true, false> >();
+	check_features<trie_features<true, true, false, true> >();
+	check_features<trie_features<true, true, false, false> >();
+	check_features<trie_features<false, true, true, false> >();
+	check_features<trie_features<false, true, false, false> >();
+	check_features<boost::tries::trie_lookup_only>();
+	check_features<trie_features<> >(1);
+	check_features<trie_features<> >(2);
+	check_features<trie_features<false, true, false, false> >(2);
+	check_features<boost::tries::trie_lookup_only>(1);
+	check_features<boost::tries::trie_lookup_only>(2);
+	// the disabled bookkeeping takes no room in the node
+	typedef boost::tries::trie_set<char, std::less<char>, boost::tries::trie_lookup_only> lookup_set;
+	BOOST_CHECK(sizeof(lookup_set::trie_type::node_type) + 5 * sizeof(void *) < sizeof(tsci::trie_type::node_type));
+}
+
 /*
 BOOST_AUTO_TEST_CASE(insert_and_find_test)
 {
@@ -0,0 +1,128 @@
+// BOOST_TRIE_TEST_CXX20: string literal template arguments need -std=c++20
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/static_keyword_trie.hpp"
+// multi include test
+#include "boost/trie/static_keyword_trie.hpp"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iterator>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::static_keyword_trie<"GET", "HEAD", "POST", "PUT", "DELETE",
+	"CONNECT", "OPTIONS", "TRACE", "PATCH"> methods;
+
+// the lookups are constant expressions
+static_assert(methods::find("GET") == 0);
+static_assert(methods::find("PATCH") == 8);
+static_assert(methods::find("GE") == methods::npos);
+static_assert(methods::find("") == methods::npos);
+static_assert(methods::count_prefix("P") == 3);
+static_assert(methods::findLongestPrefixOfKey("GET /index.html").first == 3);
+
+BOOST_AUTO_TEST_CASE(find_test)
+{
+	BOOST_CHECK(methods::size() == 9);
+	BOOST_CHECK(!methods::empty());
+	BOOST_CHECK(methods::find(std::string("DELETE")) == 4);
+	BOOST_CHECK(methods::find(std::string("DELETED")) == methods::npos);
+	BOOST_CHECK(methods::find(std::string("get")) == methods::npos);
+	BOOST_CHECK(methods::count(std::string("TRACE")) == 1);
+	BOOST_CHECK(methods::keyword(methods::find("OPTIONS")) == "OPTIONS");
+	std::vector<char> v;
+	v.push_back('P');
+	v.push_back('U');
+	v.push_back('T');
+	BOOST_CHECK(methods::find(v.begin(), v.end()) == 3);
+	// 44 bytes, PUT and PATCH share the P of POST
+	BOOST_CHECK(methods::count_node() == 44 - 2);
+}
+
+BOOST_AUTO_TEST_CASE(longest_prefix_test)
+{
+	typedef boost::tries::static_keyword_trie<"a", "ab", "abcd", "b"> kw;
+	kw::prefix_match m = kw::findLongestPrefixOfKey(std::string("abcx"));
+	BOOST_CHECK(m.first == 2 && m.second == 1);
+	m = kw::findLongestPrefixOfKey(std::string("abcd"));
+	BOOST_CHECK(m.first == 4 && m.second == 2);
+	m = kw::findLongestPrefixOfKey(std::string("c"));
+	BOOST_CHECK(m.first == 0 && m.second == kw::npos);
+	m = kw::findLongestPrefixOfKey(std::string());
+	BOOST_CHECK(m.second == kw::npos);
+
+	// the empty keyword matches any input
+	typedef boost::tries::static_keyword_trie<"", "x"> with_empty;
+	BOOST_CHECK(with_empty::find("") == 0);
+	m = with_empty::findLongestPrefixOfKey(std::string("yz"));
+	BOOST_CHECK(m.first == 0 && m.second == 0);
+	BOOST_CHECK(with_empty::count_prefix("") == 2);
+}
+
+BOOST_AUTO_TEST_CASE(match_prefix_test)
+{
+	std::vector<int> ids;
+	BOOST_CHECK(methods::match_prefix("P", std::back_inserter(ids)) == 3);
+	// in key order
+	BOOST_REQUIRE(ids.size() == 3);
+	BOOST_CHECK(ids[0] == 8 && ids[1] == 2 && ids[2] == 3);
+	ids.clear();
+	BOOST_CHECK(methods::match_prefix("X", std::back_inserter(ids)) == 0);
+	BOOST_CHECK(ids.empty());
+	BOOST_CHECK(methods::match_prefix("", std::back_inserter(ids)) == methods::size());
+	for (std::size_t i = 1; i < ids.size(); ++i)
+		BOOST_CHECK(methods::keyword(ids[i - 1]) < methods::keyword(ids[i]));
+
+	// no heap in a constant expression either
+	constexpr int first_c = []() {
+		int out[9] = {};
+		methods::match_prefix("C", out);
+		return out[0];
+	}();
+	BOOST_CHECK(first_c == 5);
+}
+
+BOOST_AUTO_TEST_CASE(against_map)
+{
+	// bytes above 127 sort after the ASCII ones, as in std::string
+	typedef boost::tries::static_keyword_trie<"if", "int", "in", "for", "float",
+		"\xc3\xa9t\xc3\xa9", "\xc3\xa9", "while", "whilst", "w"> kw;
+	const char * const words[] = { "if", "int", "in", "for", "float",
+		"\xc3\xa9t\xc3\xa9", "\xc3\xa9", "while", "whilst", "w" };
+	std::map<std::string, int> m;
+	for (int i = 0; i < 10; ++i)
+		m[words[i]] = i;
+
+	std::vector<int> ids;
+	kw::match_prefix("", std::back_inserter(ids));
+	BOOST_REQUIRE(ids.size() == m.size());
+	std::size_t i = 0;
+	for (std::map<std::string, int>::iterator it = m.begin(); it != m.end(); ++it, ++i)
+		BOOST_CHECK(ids[i] == it->second);
+
+	const char * const probes[] = { "", "i", "in", "inx", "f", "fl", "float2",
+		"\xc3", "\xc3\xa9t", "\xc3\xa9t\xc3\xa9s", "wh", "whilst", "z" };
+	for (std::size_t p = 0; p < sizeof(probes) / sizeof(probes[0]); ++p)
+	{
+		std::string s = probes[p];
+		std::map<std::string, int>::iterator f = m.find(s);
+		BOOST_CHECK(kw::find(s) == (f == m.end() ? kw::npos : f->second));
+		std::size_t n = 0;
+		int longest = kw::npos;
+		for (f = m.begin(); f != m.end(); ++f)
+		{
+			if (f->first.compare(0, s.size(), s) == 0)
+				++n;
+			if (s.compare(0, f->first.size(), f->first) == 0)
+				longest = f->second;
+		}
+		BOOST_CHECK(kw::count_prefix(s) == n);
+		// the longer keyword comes later in key order
+		BOOST_CHECK(kw::findLongestPrefixOfKey(s).second == longest);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
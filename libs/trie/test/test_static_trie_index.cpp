@@ -0,0 +1,142 @@
+#define BOOST_TEST_MODULE trie_test
+#include <boost/test/unit_test.hpp>
+#include "boost/trie/static_trie_index.hpp"
+// multi include test
+#include "boost/trie/static_trie_index.hpp"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <sstream>
+#include <iostream>
+
+BOOST_AUTO_TEST_SUITE(trie_test)
+
+typedef boost::tries::static_trie_index<char> stic;
+typedef boost::tries::trie_set<char> tsc;
+
+std::string key_string(const std::vector<char>& k)
+{
+	return std::string(k.begin(), k.end());
+}
+
+std::string make_key(int i)
+{
+	std::string k;
+	for (int j = i; j > 0; j /= 6)
+		k += char('a' + j % 6);
+	return k;
+}
+
+BOOST_AUTO_TEST_CASE(id_test)
+{
+	tsc t;
+	std::set<std::string> s;
+	for (int i = 1; i < 3000; ++i)
+	{
+		t.insert(make_key(i * 7919 % 2999 + 1));
+		s.insert(make_key(i * 7919 % 2999 + 1));
+	}
+	stic x(t);
+	BOOST_REQUIRE(x.size() == s.size());
+	BOOST_CHECK(x.count_node() == t.count_node());
+	size_t id = 0;
+	for (std::set<std::string>::iterator i = s.begin(); i != s.end(); ++i, ++id)
+	{
+		BOOST_REQUIRE(x.id_of(*i) == id);
+		BOOST_REQUIRE(key_string(x.key_of(id)) == *i);
+	}
+	BOOST_CHECK(x.id_of(std::string("zz")) == stic::npos);
+	BOOST_CHECK(x.count(std::string("zz")) == 0);
+	BOOST_CHECK(x.count(*s.begin()) == 1);
+
+	std::string p = "ab";
+	stic::id_range r = x.prefix_range(p);
+	std::set<std::string>::iterator lo = s.lower_bound(p);
+	BOOST_CHECK(r.first == size_t(std::distance(s.begin(), lo)));
+	size_t n = 0;
+	for (; lo != s.end() && lo->compare(0, p.size(), p) == 0; ++lo)
+		++n;
+	BOOST_CHECK(r.second - r.first == n);
+	BOOST_CHECK(x.count_prefix(p) == n);
+	BOOST_CHECK(x.count_prefix(std::string("zz")) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(save_and_load_test)
+{
+	tsc t;
+	for (int i = 1; i < 500; ++i)
+		t.insert(make_key(i));
+	stic x(t);
+	std::stringstream ss;
+	BOOST_REQUIRE(x.save(ss));
+	stic y;
+	BOOST_CHECK(y.empty());
+	BOOST_REQUIRE(y.load(ss));
+	BOOST_REQUIRE(y.size() == x.size());
+	for (size_t id = 0; id < x.size(); ++id)
+	{
+		BOOST_REQUIRE(y.key_of(id) == x.key_of(id));
+		BOOST_REQUIRE(y.id_of(x.key_of(id)) == id);
+	}
+
+	// a cut stream, then a corrupt one
+	std::string data = ss.str();
+	std::stringstream cut(data.substr(0, data.size() - 3));
+	BOOST_CHECK(!y.load(cut));
+	BOOST_CHECK(y.empty());
+	BOOST_CHECK(y.id_of(make_key(1)) == stic::npos);
+	std::string bad = data;
+	// the first_child of the root
+	bad[8 + 4 * 8] = 0;
+	std::stringstream bs(bad);
+	BOOST_CHECK(!y.load(bs));
+	BOOST_CHECK(y.empty());
+
+	x.swap(y);
+	BOOST_CHECK(x.empty());
+	y.clear();
+	BOOST_CHECK(y.empty());
+	BOOST_CHECK(y.count_node() == 0);
+}
+
+BOOST_AUTO_TEST_CASE(bad_stream)
+{
+	tsc t;
+	for (int i = 1; i < 40; ++i)
+		t.insert(make_key(i));
+	stic x(t);
+	std::stringstream ss;
+	x.save(ss);
+	std::string good = ss.str();
+	// every bit flipped: the load fails and leaves the index empty, or it
+	// gives an index whose walks stay in bounds
+	for (size_t n = 0; n < good.size() * 8; ++n)
+	{
+		std::string bad = good;
+		bad[n / 8] ^= char(1 << (n % 8));
+		std::istringstream is(bad);
+		stic u;
+		if (!u.load(is))
+		{
+			BOOST_CHECK(u.empty());
+			BOOST_CHECK(u.count_node() == 0);
+			continue;
+		}
+		for (size_t id = 0; id < u.size(); ++id)
+			u.id_of(u.key_of(id));
+		for (int i = 1; i < 40; ++i)
+			u.prefix_range(make_key(i));
+	}
+	// a first_child past the end of the nodes, the first one after the root
+	std::string bad = good;
+	size_t at = 8 + 4 * 8 + 3 * sizeof(stic::index_type);
+	for (size_t i = 0; i < sizeof(stic::index_type); ++i)
+		bad[at + i] = char(0x7f);
+	std::istringstream is(bad);
+	stic u;
+	BOOST_CHECK(!u.load(is));
+	BOOST_CHECK(u.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,94 @@
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <cstdlib>
+
+#include <boost/trie/trie_map.hpp>
+#include <boost/trie/fixed_alphabet_trie.hpp>
+#include <boost/timer/timer.hpp>
+
+// count the k-mers of a random DNA sequence in
+//   std::map<std::string, int>, trie_map<char, int>,
+//   fixed_alphabet_trie<dna_alphabet, int>
+// and std::map over the k-mers packed in a word, for reference
+// usage: kmer_count [length] [k]
+
+std::string make_sequence(size_t length)
+{
+	std::string s;
+	s.reserve(length);
+	unsigned seed = 12345;
+	for (size_t i = 0; i < length; ++i)
+	{
+		seed = seed * 1103515245u + 12345u;
+		s += "ACGT"[(seed >> 16) & 3];
+	}
+	return s;
+}
+
+template <class Map>
+size_t count_kmers(const std::string& seq, size_t k, Map& m)
+{
+	for (size_t i = 0; i + k <= seq.size(); ++i)
+		++m[std::string(seq, i, k)];
+	return m.size();
+}
+
+template <class Map>
+size_t find_kmers(const std::string& seq, size_t k, Map& m)
+{
+	size_t found = 0;
+	for (size_t i = 0; i + k <= seq.size(); ++i)
+		found += m.count(std::string(seq, i, k));
+	return found;
+}
+
+size_t count_packed(const std::string& seq, size_t k, std::map<boost::uint64_t, int>& m)
+{
+	boost::uint64_t w;
+	for (size_t i = 0; i + k <= seq.size(); ++i)
+	{
+		boost::tries::pack_symbols<boost::tries::dna_alphabet>(seq.begin() + i, seq.begin() + i + k, w);
+		++m[w];
+	}
+	return m.size();
+}
+
+template <class Map>
+void profile(const char *name, const std::string& seq, size_t k, Map& m)
+{
+	std::cout << name << std::endl;
+	{
+		boost::timer::auto_cpu_timer t(5, " count: %t sec CPU, %w sec real\n");
+		std::cout << " distinct k-mers: " << count_kmers(seq, k, m) << std::endl;
+	}
+	{
+		boost::timer::auto_cpu_timer t(5, " find:  %t sec CPU, %w sec real\n\n");
+		std::cout << " found: " << find_kmers(seq, k, m) << std::endl;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	size_t length = argc > 1 ? std::atoi(argv[1]) : 2000000;
+	size_t k = argc > 2 ? std::atoi(argv[2]) : 12;
+	std::string seq = make_sequence(length);
+	std::cout << "sequence length: " << length << ", k: " << k << std::endl << std::endl;
+
+	std::map<std::string, int> m;
+	boost::tries::trie_map<char, int> tm;
+	boost::tries::fixed_alphabet_trie<boost::tries::dna_alphabet, int> ft;
+	profile("std::map", seq, k, m);
+	profile("trie_map", seq, k, tm);
+	profile("fixed_alphabet_trie<dna_alphabet>", seq, k, ft);
+	std::cout << "fixed_alphabet_trie nodes: " << ft.count_node() << std::endl << std::endl;
+
+	std::map<boost::uint64_t, int> pm;
+	std::cout << "std::map, packed k-mers" << std::endl;
+	{
+		boost::timer::auto_cpu_timer t(5, " count: %t sec CPU, %w sec real\n\n");
+		std::cout << " distinct k-mers: " << count_packed(seq, k, pm) << std::endl;
+	}
+	return 0;
+}